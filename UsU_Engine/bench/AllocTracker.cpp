@@ -0,0 +1,89 @@
+#include "AllocTracker.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{ 0 };
+std::atomic<uint64_t> g_bytes{ 0 };
+std::atomic<int64_t> g_liveBytes{ 0 };
+std::atomic<int64_t> g_peakBytes{ 0 };
+
+// Every block starts with the raw malloc pointer and the requested size
+// right below the address handed out; 16 bytes keeps operator new's
+// default alignment
+const size_t kHeader = 16;
+
+void* Allocate(size_t size, size_t alignment)
+{
+    if (alignment < kHeader) alignment = kHeader;
+    uint8_t* raw = static_cast<uint8_t*>(malloc(size + kHeader + alignment));
+    if (!raw) return nullptr;
+    const uintptr_t first = reinterpret_cast<uintptr_t>(raw) + kHeader;
+    uint8_t* user = reinterpret_cast<uint8_t*>((first + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+    reinterpret_cast<void**>(user)[-1] = raw;
+    reinterpret_cast<size_t*>(user)[-2] = size;
+
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    const int64_t live = g_liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+    int64_t peak = g_peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return user;
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment)
+{
+    void* p = Allocate(size, alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void Free(void* p)
+{
+    if (!p) return;
+    const size_t size = reinterpret_cast<size_t*>(p)[-2];
+    g_liveBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    free(reinterpret_cast<void**>(p)[-1]);
+}
+
+} // namespace
+
+AllocCounters GetAllocCounters()
+{
+    AllocCounters c;
+    c.allocations = g_allocations.load(std::memory_order_relaxed);
+    c.bytes = g_bytes.load(std::memory_order_relaxed);
+    c.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    c.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+    return c;
+}
+
+void ResetAllocPeak()
+{
+    g_peakBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t al) { return AllocateOrThrow(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return AllocateOrThrow(size, static_cast<size_t>(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<size_t>(al)); }
+
+void operator delete(void* p) noexcept { Free(p); }
+void operator delete[](void* p) noexcept { Free(p); }
+void operator delete(void* p, size_t) noexcept { Free(p); }
+void operator delete[](void* p, size_t) noexcept { Free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { Free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { Free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { Free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { Free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { Free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { Free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { Free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { Free(p); }
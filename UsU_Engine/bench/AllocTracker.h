@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+// Counts every global operator new/delete of the process (the tracker
+// replaces them), so the benchmarks can report allocations per iteration and
+// the heap high-water mark of a run. malloc and friends called directly are
+// not seen; the engine code allocates through std containers only.
+struct AllocCounters
+{
+    uint64_t allocations = 0; // since process start
+    uint64_t bytes = 0;       // requested, since process start
+    int64_t  liveBytes = 0;
+    int64_t  peakBytes = 0;   // highest liveBytes since ResetAllocPeak
+};
+
+AllocCounters GetAllocCounters();
+// Restarts the high-water mark at the current live size
+void ResetAllocPeak();
@@ -0,0 +1,453 @@
+// usu_bench: the engine's platform-independent CPU paths on synthetic
+// assets, reported as JSON for tracking across releases. See --help.
+#include "BenchmarkRunner.h"
+#include "ObjGenerator.h"
+#include "TextureGenerator.h"
+#include "ImageDecoder.h"
+#include "ImageWriter.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "ObjParser.h"
+#include "TransformStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace DirectX;
+
+namespace {
+
+struct Scale
+{
+    const char* name;
+    uint32_t cells;      // OBJ grid is cells x cells
+    uint32_t resolution; // textures are resolution x resolution
+    uint32_t objects;    // transforms
+};
+
+const Scale kScales[] = {
+    { "small", 128, 256, 10000 },
+    { "medium", 512, 1024, 100000 },
+    { "large", 1024, 2048, 400000 },
+};
+
+const char* ImageSimdName(ImageSimd level)
+{
+    switch (level) {
+    case ImageSimd::Scalar: return "scalar";
+    case ImageSimd::SSSE3:  return "ssse3";
+    default:                return "avx2";
+    }
+}
+
+bool WriteFile(const std::filesystem::path& path, const void* data, size_t size)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return static_cast<bool>(out);
+}
+
+// OBJ text in memory through ParseOBJ: tokenizing, float parsing and the
+// v/vt/vn deduplication, which the topologies stress differently
+void BenchmarkObjParse(BenchmarkRunner& runner, const Scale& scale)
+{
+    struct Variant
+    {
+        const char* name;
+        ObjTopology topology;
+        bool quads, texcoords, normals, negative;
+        uint32_t materials;
+    };
+    const Variant variants[] = {
+        { "grid", ObjTopology::Grid, false, true, true, false, 1 },
+        { "grid_quads", ObjTopology::Grid, true, true, true, false, 1 },
+        { "grid_positions_only", ObjTopology::Grid, false, false, false, false, 1 },
+        { "grid_negative_indices", ObjTopology::Grid, false, true, true, true, 1 },
+        { "grid_64_materials", ObjTopology::Grid, false, true, true, false, 64 },
+        { "faceted", ObjTopology::Faceted, false, true, true, false, 1 },
+        { "soup", ObjTopology::Soup, false, true, true, false, 1 },
+    };
+    for (const Variant& v : variants) {
+        const std::string name = std::string("obj_parse/") + v.name;
+        if (!runner.Wants(name)) continue;
+        ObjGenOptions options;
+        options.cellsX = options.cellsZ = scale.cells;
+        options.topology = v.topology;
+        options.quads = v.quads;
+        options.texcoords = v.texcoords;
+        options.normals = v.normals;
+        options.negativeIndices = v.negative;
+        options.materials = v.materials;
+        std::string text;
+        ObjGenStats stats;
+        GenerateObj(options, text, &stats);
+
+        BenchWork work;
+        work.items = static_cast<double>(stats.triangles);
+        work.itemUnit = "triangles";
+        work.bytes = static_cast<double>(text.size());
+        size_t vertexCount = 0, submeshCount = 0;
+        BenchResult& r = runner.Run(name, work, [&]() {
+            // Fresh outputs, as a load gets
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+            std::vector<MeshSubmesh> submeshes;
+            if (!ParseOBJ(text.data(), text.size(), vertices, indices, submeshes)) return false;
+            vertexCount = vertices.size();
+            submeshCount = submeshes.size();
+            return vertexCount == stats.uniqueCorners && indices.size() == stats.triangles * 3;
+        });
+        const double corners = static_cast<double>(stats.faces) * (v.quads ? 4 : 3);
+        r.counters.emplace_back("vertices", static_cast<double>(vertexCount));
+        r.counters.emplace_back("cornersPerVertex", vertexCount ? corners / vertexCount : 0.0);
+        r.counters.emplace_back("submeshes", static_cast<double>(submeshCount));
+    }
+}
+
+// Mesh::LoadOBJ from a file: mapping, parsing and bounds
+void BenchmarkMeshLoad(BenchmarkRunner& runner, const Scale& scale, const std::filesystem::path& tempDir)
+{
+    const std::string name = "mesh_load_obj/grid";
+    if (!runner.Wants(name)) return;
+    ObjGenOptions options;
+    options.cellsX = options.cellsZ = scale.cells;
+    std::string text;
+    ObjGenStats stats;
+    GenerateObj(options, text, &stats);
+    const std::filesystem::path path = tempDir / "usu_bench_grid.obj";
+    if (!WriteFile(path, text.data(), text.size())) {
+        fprintf(stderr, "%s: cannot write %s\n", name.c_str(), path.string().c_str());
+        return;
+    }
+    BenchWork work;
+    work.items = static_cast<double>(stats.triangles);
+    work.itemUnit = "triangles";
+    work.bytes = static_cast<double>(text.size());
+    const std::wstring widePath = path.wstring();
+    runner.Run(name, work, [&]() {
+        Mesh mesh;
+        return mesh.LoadOBJ(widePath) && mesh.GetIndices().size() == stats.triangles * 3;
+    });
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+// DecodeImage into a reused buffer (inflate, unfiltering, row conversion)
+// and MergeAlphaPlane, at every SIMD level the CPU has
+void BenchmarkImages(BenchmarkRunner& runner, const Scale& scale)
+{
+    if (!runner.Wants("image_")) return;
+    const uint32_t size = scale.resolution;
+    struct Encoded
+    {
+        const char* name;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<Encoded> images;
+    TextureData tex;
+    TextureGenOptions options;
+    options.width = options.height = size;
+    for (TexturePattern pattern : { TexturePattern::Skin, TexturePattern::Noise }) {
+        options.pattern = pattern;
+        GenerateTexture(options, tex);
+        images.push_back(Encoded{ pattern == TexturePattern::Skin ? "png_skin" : "png_noise", {} });
+        EncodePng(tex.MipData(0), tex.mips[0].rowPitch, size, size, images.back().bytes);
+    }
+    images.push_back(Encoded{ "bmp32", {} });
+    EncodeBmp(tex.MipData(0), tex.mips[0].rowPitch, size, size, images.back().bytes);
+    TextureData alpha;
+    GenerateAlphaPlane(size, size, 1, alpha);
+    std::vector<uint8_t> alphaBmp;
+    EncodeBmp(alpha.MipData(0), alpha.mips[0].rowPitch, size, size, alphaBmp);
+
+    std::vector<uint8_t> rgba(static_cast<size_t>(size) * size * 4);
+    const size_t pitch = static_cast<size_t>(size) * 4;
+    BenchWork work;
+    work.items = static_cast<double>(size) * size;
+    work.itemUnit = "pixels";
+    work.bytes = static_cast<double>(rgba.size());
+
+    const ImageSimd best = GetImageSimd();
+    const ImageSimd levels[] = { ImageSimd::Scalar, ImageSimd::SSSE3, ImageSimd::AVX2 };
+    for (ImageSimd level : levels) {
+        if (level > best) break;
+        SetImageSimd(level);
+        for (const Encoded& image : images) {
+            const std::string name = std::string("image_decode/") + image.name + "/" + ImageSimdName(level);
+            if (!runner.Wants(name)) continue;
+            BenchResult& r = runner.Run(name, work, [&]() { return DecodeImage(image.bytes.data(), image.bytes.size(), rgba.data(), pitch); });
+            r.counters.emplace_back("encodedBytes", static_cast<double>(image.bytes.size()));
+        }
+        const std::string name = std::string("image_merge_alpha/bmp/") + ImageSimdName(level);
+        if (runner.Wants(name)) {
+            runner.Run(name, work, [&]() { return MergeAlphaPlane(alphaBmp.data(), alphaBmp.size(), rgba.data(), pitch, size, size); });
+        }
+    }
+    SetImageSimd(best);
+}
+
+// Untransposed perspective * view of a camera looking down +z, slid
+// sideways by t so every call counts as a camera move
+XMFLOAT4X4 ViewProj(float t)
+{
+    XMFLOAT4X4 m = {};
+    m._11 = 1.357f;
+    m._22 = 2.414f;
+    m._33 = 1.0001f;
+    m._34 = 1.0f;
+    m._41 = -1.357f * t;
+    m._43 = 4.9f;
+    return m;
+}
+
+// TransformStore::Update batches: world = S * R * T * parent and
+// MVP = world * viewProj, single-threaded and across every core
+void BenchmarkTransforms(BenchmarkRunner& runner, const Scale& scale)
+{
+    enum class Case { CameraMoves, AnimateAll, MoveLot, SparseEdits };
+    struct Variant
+    {
+        const char* name;
+        Case kind;
+        bool hierarchy; // lot -> cars -> 4 wheels each, else flat roots
+    };
+    const Variant variants[] = {
+        { "camera_moves", Case::CameraMoves, false },
+        { "animate_all", Case::AnimateAll, false },
+        { "move_lot", Case::MoveLot, true },
+        { "sparse_edits", Case::SparseEdits, true },
+    };
+    const uint32_t threadCounts[] = { 1, 0 };
+    for (const Variant& v : variants) {
+        for (uint32_t threads : threadCounts) {
+            const std::string name = std::string("transform/") + v.name + (threads == 1 ? "/1_thread" : "/all_threads");
+            if (!runner.Wants(name)) continue;
+            TransformStore store;
+            store.Reserve(scale.objects);
+            std::vector<uint32_t> edited;
+            if (v.hierarchy) {
+                const uint32_t lot = store.Create();
+                while (store.Size() + 5 <= scale.objects) {
+                    const uint32_t car = store.Create(lot);
+                    const uint32_t gx = car % 256, gz = car / 256;
+                    store.SetPosition(car, XMFLOAT3(gx * 0.6f, 0.0f, gz * 0.6f));
+                    edited.push_back(car);
+                    for (int w = 0; w < 4; ++w) {
+                        const uint32_t wheel = store.Create(car);
+                        store.SetPosition(wheel, XMFLOAT3(w & 1 ? 0.1f : -0.1f, 0.03f, w & 2 ? 0.15f : -0.15f));
+                    }
+                }
+            } else {
+                for (uint32_t i = 0; i < scale.objects; ++i) {
+                    const uint32_t id = store.Create();
+                    store.SetPosition(id, XMFLOAT3((i % 256) * 0.6f, 0.0f, (i / 256) * 0.6f));
+                    edited.push_back(id);
+                }
+            }
+            // Every hundredth car for the sparse case
+            if (v.kind == Case::SparseEdits) {
+                std::vector<uint32_t> sparse;
+                for (size_t i = 0; i < edited.size(); i += 100) sparse.push_back(edited[i]);
+                edited.swap(sparse);
+            }
+            store.Update(ViewProj(0.0f), threads);
+
+            // One trial step for the item count, then the same step timed
+            uint32_t step = 0;
+            auto Step = [&]() {
+                ++step;
+                const float angle = 0.001f * step;
+                const XMFLOAT4 rotation(0.0f, std::sin(angle), 0.0f, std::cos(angle));
+                switch (v.kind) {
+                case Case::CameraMoves: break;
+                case Case::AnimateAll:
+                case Case::SparseEdits:
+                    for (uint32_t id : edited) store.SetRotation(id, rotation);
+                    break;
+                case Case::MoveLot: store.SetRotation(0, rotation); break;
+                }
+                store.Update(ViewProj(v.kind == Case::SparseEdits ? 0.0f : 0.01f * step), threads);
+            };
+            Step();
+            const TransformUpdateStats trial = store.GetLastUpdateStats();
+            BenchWork work;
+            work.items = static_cast<double>(trial.worlds + trial.mvps);
+            work.itemUnit = "matrices";
+            work.bytes = work.items * sizeof(XMFLOAT4X4);
+            BenchResult& r = runner.Run(name, work, [&]() {
+                Step();
+                return store.GetLastUpdateStats().worlds + store.GetLastUpdateStats().mvps == trial.worlds + trial.mvps;
+            });
+            r.counters.emplace_back("objects", static_cast<double>(store.Size()));
+            r.counters.emplace_back("worlds", trial.worlds);
+            r.counters.emplace_back("mvps", trial.mvps);
+            r.counters.emplace_back("levels", trial.levels);
+        }
+    }
+}
+
+int64_t PeakRssBytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<int64_t>(usage.ru_maxrss);
+#else
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+std::string CompilerName()
+{
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+void PrintUsage()
+{
+    fprintf(stderr,
+        "usu_bench [options]\n"
+        "  --size small|medium|large   input sizes (default medium)\n"
+        "  --cells N                   OBJ grid of N x N cells\n"
+        "  --resolution N              N x N textures\n"
+        "  --objects N                 transforms\n"
+        "  --filter TEXT               only benchmarks whose name contains TEXT\n"
+        "  --min-time SECONDS          measured time per benchmark (default 0.5)\n"
+        "  --out FILE                  JSON report to FILE instead of stdout\n"
+        "Generators (write the file and exit):\n"
+        "  --generate-obj FILE         with --cells, --topology grid|faceted|soup, --quads,\n"
+        "                              --no-texcoords, --no-normals, --negative-indices,\n"
+        "                              --materials N, --seed N\n"
+        "  --generate-texture FILE     .png or .bmp, with --resolution,\n"
+        "                              --pattern skin|smooth|noise, --opaque, --seed N\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Scale scale = kScales[1];
+    BenchOptions options;
+    std::string outPath, objPath, texturePath;
+    ObjGenOptions objOptions;
+    TextureGenOptions textureOptions;
+    bool cellsSet = false, resolutionSet = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto Number = [&]() { ++i; return static_cast<uint32_t>(strtoul(value, nullptr, 10)); };
+        if (arg == "--quads") objOptions.quads = true;
+        else if (arg == "--no-texcoords") objOptions.texcoords = false;
+        else if (arg == "--no-normals") objOptions.normals = false;
+        else if (arg == "--negative-indices") objOptions.negativeIndices = true;
+        else if (arg == "--opaque") textureOptions.alpha = false;
+        else if (arg == "--help" || arg == "-h") { PrintUsage(); return 0; }
+        else if (!value) { PrintUsage(); return 1; }
+        else if (arg == "--size") {
+            const Scale* found = nullptr;
+            for (const Scale& s : kScales) if (strcmp(s.name, value) == 0) found = &s;
+            if (!found) { PrintUsage(); return 1; }
+            scale = *found;
+            ++i;
+        }
+        else if (arg == "--cells") { scale.cells = (std::max)(Number(), 1u); cellsSet = true; }
+        else if (arg == "--resolution") { scale.resolution = (std::max)(Number(), 1u); resolutionSet = true; }
+        else if (arg == "--objects") scale.objects = (std::max)(Number(), 1u);
+        else if (arg == "--filter") { options.filter = value; ++i; }
+        else if (arg == "--min-time") { options.minSeconds = atof(value); ++i; }
+        else if (arg == "--out") { outPath = value; ++i; }
+        else if (arg == "--generate-obj") { objPath = value; ++i; }
+        else if (arg == "--generate-texture") { texturePath = value; ++i; }
+        else if (arg == "--materials") objOptions.materials = Number();
+        else if (arg == "--seed") objOptions.seed = textureOptions.seed = Number();
+        else if (arg == "--topology") {
+            const std::string t = value;
+            objOptions.topology = t == "soup" ? ObjTopology::Soup : t == "faceted" ? ObjTopology::Faceted : ObjTopology::Grid;
+            ++i;
+        }
+        else if (arg == "--pattern") {
+            const std::string p = value;
+            textureOptions.pattern = p == "noise" ? TexturePattern::Noise : p == "smooth" ? TexturePattern::Smooth : TexturePattern::Skin;
+            ++i;
+        }
+        else { PrintUsage(); return 1; }
+    }
+
+    if (!objPath.empty() || !texturePath.empty()) {
+        if (!objPath.empty()) {
+            objOptions.cellsX = objOptions.cellsZ = cellsSet ? scale.cells : objOptions.cellsX;
+            std::string text;
+            ObjGenStats stats;
+            GenerateObj(objOptions, text, &stats);
+            if (!WriteFile(std::filesystem::u8path(objPath), text.data(), text.size())) return 1;
+            fprintf(stderr, "%s: %zu triangles, %zu positions, %zu vertices after dedup, %zu bytes\n", objPath.c_str(),
+                stats.triangles, stats.positions, stats.uniqueCorners, text.size());
+        }
+        if (!texturePath.empty()) {
+            textureOptions.width = textureOptions.height = resolutionSet ? scale.resolution : textureOptions.width;
+            TextureData tex;
+            GenerateTexture(textureOptions, tex);
+            if (!WriteImageFile(std::filesystem::u8path(texturePath).wstring(), tex)) return 1;
+            fprintf(stderr, "%s: %ux%u %s\n", texturePath.c_str(), tex.width, tex.height, TexturePatternName(textureOptions.pattern));
+        }
+        return 0;
+    }
+
+    std::error_code ec;
+    std::filesystem::path tempDir = std::filesystem::temp_directory_path(ec);
+    if (ec) tempDir = ".";
+
+    BenchmarkRunner runner(options);
+    BenchmarkObjParse(runner, scale);
+    BenchmarkMeshLoad(runner, scale, tempDir);
+    BenchmarkImages(runner, scale);
+    BenchmarkTransforms(runner, scale);
+
+    std::vector<std::pair<std::string, std::string>> environment = {
+        { "compiler", JsonString(CompilerName()) },
+#if defined(NDEBUG)
+        { "optimized", "true" },
+#else
+        { "optimized", "false" },
+#endif
+        { "threads", std::to_string(GetJobSystem().GetThreadCount()) },
+        { "imageSimd", JsonString(ImageSimdName(GetImageSimd())) },
+        { "size", JsonString(scale.name) },
+        { "cells", std::to_string(scale.cells) },
+        { "resolution", std::to_string(scale.resolution) },
+        { "objects", std::to_string(scale.objects) },
+        { "peakRssBytes", std::to_string(PeakRssBytes()) },
+    };
+    FILE* out = stdout;
+    if (!outPath.empty() && !(out = fopen(outPath.c_str(), "w"))) {
+        fprintf(stderr, "cannot write %s\n", outPath.c_str());
+        return 1;
+    }
+    const bool written = runner.WriteJson(out, environment);
+    if (out != stdout) fclose(out);
+
+    bool ok = written;
+    for (const BenchResult& r : runner.GetResults()) ok = ok && r.ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include "BenchmarkRunner.h"
+#include "AllocTracker.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+bool BenchmarkRunner::Wants(const std::string& name) const
+{
+    return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+}
+
+BenchResult& BenchmarkRunner::Run(const std::string& name, const BenchWork& work, const std::function<bool()>& fn)
+{
+    typedef std::chrono::steady_clock Clock;
+    m_results.emplace_back();
+    BenchResult& r = m_results.back();
+    r.name = name;
+    r.work = work;
+
+    // The warm-up also faults in whatever the first call allocates
+    r.ok = fn();
+    std::vector<double> times;
+    times.reserve(m_options.maxIterations); // outside the counted window
+    const AllocCounters before = GetAllocCounters();
+    ResetAllocPeak();
+    double totalMs = 0.0;
+    while (r.ok && times.size() < m_options.maxIterations &&
+           (times.size() < m_options.minIterations || totalMs < m_options.minSeconds * 1000.0)) {
+        const auto t0 = Clock::now();
+        r.ok = fn();
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        times.push_back(ms);
+        totalMs += ms;
+    }
+    const AllocCounters after = GetAllocCounters();
+
+    r.iterations = static_cast<uint32_t>(times.size());
+    if (!times.empty()) {
+        const double n = static_cast<double>(times.size());
+        r.meanMs = totalMs / n;
+        r.allocationsPerIteration = (after.allocations - before.allocations) / n;
+        r.allocatedBytesPerIteration = (after.bytes - before.bytes) / n;
+        r.peakHeapBytes = (std::max)(after.peakBytes - before.liveBytes, int64_t(0));
+        std::sort(times.begin(), times.end());
+        r.minMs = times.front();
+        const size_t mid = times.size() / 2;
+        r.medianMs = times.size() % 2 ? times[mid] : 0.5 * (times[mid - 1] + times[mid]);
+    }
+    fprintf(stderr, "%-40s %s %8.3f ms median, %5u iteration(s), %10.0f %s/s\n", name.c_str(), r.ok ? "  " : "!!", r.medianMs,
+        r.iterations, r.medianMs > 0.0 ? work.items * 1000.0 / r.medianMs : 0.0, work.itemUnit);
+    return r;
+}
+
+std::string JsonString(const std::string& text)
+{
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+namespace {
+
+// JSON has no NaN or infinity
+double Finite(double v)
+{
+    return std::isfinite(v) ? v : 0.0;
+}
+
+} // namespace
+
+bool BenchmarkRunner::WriteJson(FILE* out, const std::vector<std::pair<std::string, std::string>>& environment) const
+{
+    fprintf(out, "{\n  \"format\": \"usu-bench\",\n  \"version\": 1");
+    for (const auto& field : environment) fprintf(out, ",\n  %s: %s", JsonString(field.first).c_str(), field.second.c_str());
+    fprintf(out, ",\n  \"benchmarks\": [");
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const BenchResult& r = m_results[i];
+        const double seconds = r.medianMs / 1000.0;
+        fprintf(out, "%s\n    {\n      \"name\": %s,\n      \"ok\": %s,\n      \"iterations\": %u,\n", i ? "," : "",
+            JsonString(r.name).c_str(), r.ok ? "true" : "false", r.iterations);
+        fprintf(out, "      \"ms\": { \"min\": %.6f, \"median\": %.6f, \"mean\": %.6f },\n", r.minMs, r.medianMs, r.meanMs);
+        fprintf(out, "      \"items\": %.0f,\n      \"itemUnit\": %s,\n      \"itemsPerSecond\": %.3f,\n", r.work.items,
+            JsonString(r.work.itemUnit).c_str(), Finite(seconds > 0.0 ? r.work.items / seconds : 0.0));
+        if (r.work.bytes > 0.0) {
+            fprintf(out, "      \"bytes\": %.0f,\n      \"bytesPerSecond\": %.3f,\n", r.work.bytes,
+                Finite(seconds > 0.0 ? r.work.bytes / seconds : 0.0));
+        }
+        fprintf(out, "      \"allocationsPerIteration\": %.3f,\n      \"allocatedBytesPerIteration\": %.3f,\n"
+                     "      \"peakHeapBytes\": %lld",
+            r.allocationsPerIteration, r.allocatedBytesPerIteration, static_cast<long long>(r.peakHeapBytes));
+        if (!r.counters.empty()) {
+            fprintf(out, ",\n      \"counters\": {");
+            for (size_t c = 0; c < r.counters.size(); ++c)
+                fprintf(out, "%s %s: %.6g", c ? "," : "", JsonString(r.counters[c].first).c_str(), Finite(r.counters[c].second));
+            fprintf(out, " }");
+        }
+        fprintf(out, "\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+    return !ferror(out);
+}
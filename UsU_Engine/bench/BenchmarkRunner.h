@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// What one iteration processes, for the throughput figures. bytes is the
+// benchmark's natural data size (OBJ text read, RGBA written, matrices
+// written); 0 leaves bytes/s out.
+struct BenchWork
+{
+    double items = 0.0;
+    const char* itemUnit = "items";
+    double bytes = 0.0;
+};
+
+struct BenchResult
+{
+    std::string name;
+    bool ok = true;
+    uint32_t iterations = 0;
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+    BenchWork work;
+    double allocationsPerIteration = 0.0;
+    double allocatedBytesPerIteration = 0.0;
+    // Heap high-water mark of the timed iterations above what was live when
+    // they started (inputs excluded)
+    int64_t peakHeapBytes = 0;
+    std::vector<std::pair<std::string, double>> counters; // benchmark specific
+};
+
+struct BenchOptions
+{
+    double minSeconds = 0.5;   // keep iterating until this much time is measured
+    uint32_t minIterations = 3;
+    uint32_t maxIterations = 1000;
+    std::string filter;        // substring of the names to run; empty runs all
+};
+
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const BenchOptions& options) : m_options(options) {}
+
+    // Lets callers skip the setup of benchmarks the filter excludes
+    bool Wants(const std::string& name) const;
+    // One untimed warm-up call, then timed calls of fn (false = failed,
+    // which stops the benchmark). Progress goes to stderr.
+    BenchResult& Run(const std::string& name, const BenchWork& work, const std::function<bool()>& fn);
+
+    const std::vector<BenchResult>& GetResults() const { return m_results; }
+    // The whole run as JSON; environment is extra top-level fields
+    // ("key": value, ...), already formatted
+    bool WriteJson(FILE* out, const std::vector<std::pair<std::string, std::string>>& environment) const;
+
+private:
+    BenchOptions m_options;
+    std::vector<BenchResult> m_results;
+};
+
+// "text" with quotes and escapes, for WriteJson's environment
+std::string JsonString(const std::string& text);
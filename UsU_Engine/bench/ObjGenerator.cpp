@@ -0,0 +1,195 @@
+#include "ObjGenerator.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+struct Float3
+{
+    float x, y, z;
+};
+
+float Height(uint32_t x, uint32_t z, uint32_t seed)
+{
+    uint32_t h = (x * 73856093u) ^ (z * 19349663u) ^ (seed * 83492791u);
+    h ^= h >> 13;
+    h *= 0x5BD1E995u;
+    h ^= h >> 15;
+    return 0.05f * std::sin(x * 0.37f + static_cast<float>(seed)) * std::cos(z * 0.23f) + (h & 1023) * (0.01f / 1023.0f);
+}
+
+Float3 Normalize(Float3 v)
+{
+    const float len = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return len > 0.0f ? Float3{ v.x / len, v.y / len, v.z / len } : Float3{ 0.0f, 1.0f, 0.0f };
+}
+
+void AppendFloat(std::string& out, float value)
+{
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, 6);
+    out += ' ';
+    out.append(text, result.ptr);
+}
+
+// 1-based, or relative to the count written so far
+void AppendIndex(std::string& out, size_t index, size_t count, bool negative)
+{
+    char text[24];
+    const auto result = negative ? std::to_chars(text, text + sizeof(text), static_cast<long long>(index) - static_cast<long long>(count))
+                                 : std::to_chars(text, text + sizeof(text), index + 1);
+    out.append(text, result.ptr);
+}
+
+class Grid
+{
+public:
+    explicit Grid(const ObjGenOptions& options) : m_options(options), m_cellsX((std::max)(options.cellsX, 1u)), m_cellsZ((std::max)(options.cellsZ, 1u)) {}
+
+    uint32_t CellsX() const { return m_cellsX; }
+    uint32_t CellsZ() const { return m_cellsZ; }
+    uint32_t CornersPerFace() const { return m_options.quads ? 4 : 3; }
+    size_t FacesPerCell() const { return m_options.quads ? 1 : 2; }
+
+    // Corner c of face f as grid coordinates; cells go row by row, each as
+    // one quad (a b c d) or two triangles (a b c, a c d)
+    void Corner(size_t f, uint32_t c, uint32_t& gx, uint32_t& gz) const
+    {
+        static const uint8_t kQuad[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } };
+        static const uint8_t kTriangles[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+        const size_t cell = f / FacesPerCell();
+        const uint32_t q = m_options.quads ? c : kTriangles[f & 1][c];
+        gx = static_cast<uint32_t>(cell % m_cellsX) + kQuad[q][0];
+        gz = static_cast<uint32_t>(cell / m_cellsX) + kQuad[q][1];
+    }
+
+    Float3 Position(uint32_t gx, uint32_t gz) const
+    {
+        return Float3{ -1.0f + 2.0f * gx / m_cellsX, Height(gx, gz, m_options.seed), -1.0f + 2.0f * gz / m_cellsZ };
+    }
+
+    // Central differences of the height field
+    Float3 SmoothNormal(uint32_t gx, uint32_t gz) const
+    {
+        const uint32_t x0 = gx > 0 ? gx - 1 : gx, x1 = (std::min)(gx + 1, m_cellsX);
+        const uint32_t z0 = gz > 0 ? gz - 1 : gz, z1 = (std::min)(gz + 1, m_cellsZ);
+        const float dx = (Height(x1, gz, m_options.seed) - Height(x0, gz, m_options.seed)) / (2.0f * (x1 - x0) / m_cellsX);
+        const float dz = (Height(gx, z1, m_options.seed) - Height(gx, z0, m_options.seed)) / (2.0f * (z1 - z0) / m_cellsZ);
+        return Normalize(Float3{ -dx, 1.0f, -dz });
+    }
+
+    Float3 FaceNormal(size_t f) const
+    {
+        uint32_t x[3], z[3];
+        for (uint32_t c = 0; c < 3; ++c) Corner(f, c, x[c], z[c]);
+        const Float3 a = Position(x[0], z[0]), b = Position(x[1], z[1]), c = Position(x[2], z[2]);
+        const Float3 u{ b.x - a.x, b.y - a.y, b.z - a.z }, v{ c.x - a.x, c.y - a.y, c.z - a.z };
+        return Normalize(Float3{ u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x });
+    }
+
+private:
+    const ObjGenOptions& m_options;
+    uint32_t m_cellsX, m_cellsZ;
+};
+
+} // namespace
+
+const char* ObjTopologyName(ObjTopology topology)
+{
+    switch (topology) {
+    case ObjTopology::Grid:    return "grid";
+    case ObjTopology::Faceted: return "faceted";
+    default:                   return "soup";
+    }
+}
+
+void GenerateObj(const ObjGenOptions& options, std::string& out, ObjGenStats* stats)
+{
+    const Grid grid(options);
+    const uint32_t cellsX = grid.CellsX(), cellsZ = grid.CellsZ();
+    const uint32_t cornersPerFace = grid.CornersPerFace();
+    const size_t faces = static_cast<size_t>(cellsX) * cellsZ * grid.FacesPerCell();
+    const size_t gridPoints = static_cast<size_t>(cellsX + 1) * (cellsZ + 1);
+    const bool soup = options.topology == ObjTopology::Soup;
+    const bool faceNormals = soup || options.topology == ObjTopology::Faceted;
+
+    ObjGenStats s;
+    s.faces = faces;
+    s.triangles = faces * (cornersPerFace - 2);
+    s.positions = soup ? faces * cornersPerFace : gridPoints;
+    s.texcoords = options.texcoords ? s.positions : 0;
+    s.normals = !options.normals ? 0 : faceNormals ? faces : gridPoints;
+    s.uniqueCorners = soup || (faceNormals && options.normals) ? faces * cornersPerFace : gridPoints;
+    if (stats) *stats = s;
+
+    out.clear();
+    out.reserve(s.positions * 30 + s.texcoords * 20 + s.normals * 30 + faces * (2 + cornersPerFace * 24));
+    char line[160];
+    snprintf(line, sizeof(line), "# UsU_Engine synthetic mesh: %ux%u cells, %s, %s\nmtllib synthetic.mtl\no synthetic\n",
+        cellsX, cellsZ, ObjTopologyName(options.topology), options.quads ? "quads" : "triangles");
+    out += line;
+
+    // Soup positions and texcoords are per face corner, in face order
+    uint32_t gx = 0, gz = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1 && !options.texcoords) break;
+        const size_t count = soup ? faces * cornersPerFace : gridPoints;
+        for (size_t i = 0; i < count; ++i) {
+            if (soup) {
+                grid.Corner(i / cornersPerFace, static_cast<uint32_t>(i % cornersPerFace), gx, gz);
+            } else {
+                gx = static_cast<uint32_t>(i % (cellsX + 1));
+                gz = static_cast<uint32_t>(i / (cellsX + 1));
+            }
+            if (pass == 0) {
+                const Float3 p = grid.Position(gx, gz);
+                out += 'v';
+                AppendFloat(out, p.x);
+                AppendFloat(out, p.y);
+                AppendFloat(out, p.z);
+            } else {
+                out += "vt";
+                AppendFloat(out, static_cast<float>(gx) / cellsX);
+                AppendFloat(out, static_cast<float>(gz) / cellsZ);
+            }
+            out += '\n';
+        }
+    }
+    if (options.normals) {
+        for (size_t i = 0; i < s.normals; ++i) {
+            const Float3 n = faceNormals ? grid.FaceNormal(i)
+                                         : grid.SmoothNormal(static_cast<uint32_t>(i % (cellsX + 1)), static_cast<uint32_t>(i / (cellsX + 1)));
+            out += "vn";
+            AppendFloat(out, n.x);
+            AppendFloat(out, n.y);
+            AppendFloat(out, n.z);
+            out += '\n';
+        }
+    }
+
+    const uint32_t materials = (std::min)((std::max)(options.materials, 1u), cellsZ);
+    const size_t facesPerRow = static_cast<size_t>(cellsX) * grid.FacesPerCell();
+    for (uint32_t m = 0; m < materials; ++m) {
+        snprintf(line, sizeof(line), "usemtl material%u\n", m);
+        out += line;
+        const size_t rowBegin = static_cast<size_t>(cellsZ) * m / materials, rowEnd = static_cast<size_t>(cellsZ) * (m + 1) / materials;
+        for (size_t f = rowBegin * facesPerRow; f < rowEnd * facesPerRow; ++f) {
+            out += 'f';
+            for (uint32_t c = 0; c < cornersPerFace; ++c) {
+                grid.Corner(f, c, gx, gz);
+                const size_t v = soup ? f * cornersPerFace + c : static_cast<size_t>(gz) * (cellsX + 1) + gx;
+                out += ' ';
+                AppendIndex(out, v, s.positions, options.negativeIndices);
+                if (options.texcoords || options.normals) out += '/';
+                if (options.texcoords) AppendIndex(out, v, s.texcoords, options.negativeIndices);
+                if (options.normals) {
+                    out += '/';
+                    AppendIndex(out, faceNormals ? f : v, s.normals, options.negativeIndices);
+                }
+            }
+            out += '\n';
+        }
+    }
+}
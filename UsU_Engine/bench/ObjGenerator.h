@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Layout of the generated mesh: a cellsX x cellsZ grid over a rolling
+// height field, which decides how many corners ParseOBJ can merge
+enum class ObjTopology
+{
+    Grid,    // corners shared by up to six triangles, smooth normals
+    Faceted, // positions shared, one normal per face: every corner distinct
+    Soup,    // own positions per face, nothing shared at all
+};
+
+struct ObjGenOptions
+{
+    uint32_t cellsX = 256;
+    uint32_t cellsZ = 256;
+    ObjTopology topology = ObjTopology::Grid;
+    bool quads = false;           // one 4-corner face per cell instead of two triangles
+    bool texcoords = true;
+    bool normals = true;
+    bool negativeIndices = false; // relative (-n) indices
+    uint32_t materials = 1;       // usemtl groups, whole rows each
+    uint32_t seed = 1;            // height field jitter
+};
+
+struct ObjGenStats
+{
+    size_t positions = 0;
+    size_t texcoords = 0;
+    size_t normals = 0;
+    size_t faces = 0;
+    size_t triangles = 0;
+    size_t uniqueCorners = 0; // distinct v/vt/vn triples: ParseOBJ's vertex count
+};
+
+const char* ObjTopologyName(ObjTopology topology);
+
+// Wavefront OBJ text, as an exporter would write it: header, v / vt / vn
+// blocks, then the faces per material
+void GenerateObj(const ObjGenOptions& options, std::string& out, ObjGenStats* stats = nullptr);
@@ -0,0 +1,91 @@
+#include "TextureGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint32_t Hash(uint32_t x, uint32_t y, uint32_t seed)
+{
+    uint32_t h = x * 0x8DA6B343u ^ y * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+uint8_t ToByte(float v)
+{
+    return static_cast<uint8_t>((std::min)((std::max)(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+} // namespace
+
+const char* TexturePatternName(TexturePattern pattern)
+{
+    switch (pattern) {
+    case TexturePattern::Smooth: return "smooth";
+    case TexturePattern::Noise:  return "noise";
+    default:                     return "skin";
+    }
+}
+
+void GenerateTexture(const TextureGenOptions& options, TextureData& out)
+{
+    const uint32_t width = (std::max)(options.width, 1u), height = (std::max)(options.height, 1u);
+    AllocateTexture(out, TextureFormat::RGBA8, width, height);
+    uint8_t* base = out.MipData(0);
+    const uint32_t pitch = out.mips[0].rowPitch;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = base + static_cast<size_t>(y) * pitch;
+        const float v = (y + 0.5f) / height;
+        for (uint32_t x = 0; x < width; ++x) {
+            const float u = (x + 0.5f) / width;
+            const uint32_t h = Hash(x, y, options.seed);
+            float r, g, b;
+            if (options.pattern == TexturePattern::Noise) {
+                r = (h & 255) / 255.0f;
+                g = ((h >> 8) & 255) / 255.0f;
+                b = ((h >> 16) & 255) / 255.0f;
+            } else {
+                r = 0.2f + 0.6f * u;
+                g = 0.3f + 0.4f * v;
+                b = 0.5f + 0.3f * u * v;
+                if (options.pattern == TexturePattern::Skin) {
+                    // Panel seams every 1/8, a round decal, a little paint speckle
+                    const bool seam = std::fabs(u * 8.0f - std::floor(u * 8.0f + 0.5f)) < 0.004f * 8.0f ||
+                                      std::fabs(v * 8.0f - std::floor(v * 8.0f + 0.5f)) < 0.004f * 8.0f;
+                    const float du = u - 0.65f, dv = v - 0.4f;
+                    if (seam) r = g = b = 0.1f;
+                    else if (du * du + dv * dv < 0.01f) { r = 0.9f; g = 0.8f; b = 0.1f; }
+                    const float speckle = ((h & 31) - 15.5f) / 400.0f;
+                    r += speckle; g += speckle; b += speckle;
+                }
+            }
+            row[x * 4 + 0] = ToByte(r);
+            row[x * 4 + 1] = ToByte(g);
+            row[x * 4 + 2] = ToByte(b);
+            row[x * 4 + 3] = options.alpha ? ToByte(0.25f + 0.75f * std::sqrt(u * v)) : 255;
+        }
+    }
+}
+
+void GenerateAlphaPlane(uint32_t width, uint32_t height, uint32_t seed, TextureData& out)
+{
+    width = (std::max)(width, 1u);
+    height = (std::max)(height, 1u);
+    AllocateTexture(out, TextureFormat::RGBA8, width, height);
+    uint8_t* base = out.MipData(0);
+    const uint32_t pitch = out.mips[0].rowPitch;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = base + static_cast<size_t>(y) * pitch;
+        for (uint32_t x = 0; x < width; ++x) {
+            // Windows cut out of an opaque body, slightly dithered
+            const bool window = ((x * 4 / width) + (y * 4 / height)) % 3 == 0;
+            const uint8_t a = static_cast<uint8_t>((window ? 96 : 255) - (Hash(x, y, seed) & 7));
+            row[x * 4 + 0] = row[x * 4 + 1] = row[x * 4 + 2] = a;
+            row[x * 4 + 3] = 255;
+        }
+    }
+}
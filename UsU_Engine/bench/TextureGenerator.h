@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include "Texture.h"
+
+// Content decides how well PNG's filters and deflate do, and so how much of
+// a decode is inflate and how much is row conversion
+enum class TexturePattern
+{
+    Smooth, // gradients: compresses very well
+    Noise,  // white noise: barely compresses
+    Skin,   // gradients, panel lines, decals and speckle, like a car skin
+};
+
+struct TextureGenOptions
+{
+    uint32_t width = 1024;
+    uint32_t height = 1024;
+    TexturePattern pattern = TexturePattern::Skin;
+    bool alpha = true; // varying alpha, otherwise opaque
+    uint32_t seed = 1;
+};
+
+const char* TexturePatternName(TexturePattern pattern);
+
+// A single-level RGBA8 texture
+void GenerateTexture(const TextureGenOptions& options, TextureData& out);
+// The first channel of an alpha plane for MergeAlphaPlane, as RGBA8 grey
+void GenerateAlphaPlane(uint32_t width, uint32_t height, uint32_t seed, TextureData& out);
@@ -0,0 +1,49 @@
+# DirectXMath for the CMake builds (bench/, tests/). It is header only and
+# the engine's portable code uses just its types and a few matrix helpers.
+# Set USU_DIRECTXMATH_DIR to a directory holding DirectXMath.h (plus sal.h
+# off Windows) to build offline; otherwise an installed package is used, or
+# the headers are downloaded.
+#
+# usu_use_directxmath(<target>) adds whichever was found to a target.
+include_guard(GLOBAL)
+
+set(USU_DIRECTXMATH_DIR "" CACHE PATH "Directory with DirectXMath.h (and sal.h on non-Windows)")
+set(USU_DIRECTXMATH_INCLUDE_DIRS "")
+if(USU_DIRECTXMATH_DIR)
+  set(USU_DIRECTXMATH_INCLUDE_DIRS "${USU_DIRECTXMATH_DIR}")
+else()
+  find_package(directxmath CONFIG QUIET)
+  if(NOT TARGET Microsoft::DirectXMath)
+    include(FetchContent)
+    FetchContent_Declare(directxmath
+      GIT_REPOSITORY https://github.com/microsoft/DirectXMath.git
+      GIT_TAG oct2024
+      GIT_SHALLOW TRUE)
+    FetchContent_GetProperties(directxmath)
+    if(NOT directxmath_POPULATED)
+      FetchContent_Populate(directxmath)
+    endif()
+    set(USU_DIRECTXMATH_INCLUDE_DIRS "${directxmath_SOURCE_DIR}/Inc")
+    if(NOT WIN32)
+      # The SAL annotations DirectXMath expects, as packaged for Linux by vcpkg
+      set(USU_SAL_DIR "${CMAKE_BINARY_DIR}/sal")
+      if(NOT EXISTS "${USU_SAL_DIR}/sal.h")
+        file(DOWNLOAD https://raw.githubusercontent.com/dotnet/runtime/v8.0.0/src/coreclr/pal/inc/rt/sal.h
+          "${USU_SAL_DIR}/sal.h" STATUS USU_SAL_STATUS)
+        list(GET USU_SAL_STATUS 0 USU_SAL_ERROR)
+        if(USU_SAL_ERROR)
+          message(FATAL_ERROR "Could not download sal.h; set USU_DIRECTXMATH_DIR instead")
+        endif()
+      endif()
+      list(APPEND USU_DIRECTXMATH_INCLUDE_DIRS "${USU_SAL_DIR}")
+    endif()
+  endif()
+endif()
+
+function(usu_use_directxmath target)
+  if(USU_DIRECTXMATH_INCLUDE_DIRS)
+    target_include_directories(${target} PRIVATE ${USU_DIRECTXMATH_INCLUDE_DIRS})
+  elseif(TARGET Microsoft::DirectXMath)
+    target_link_libraries(${target} PRIVATE Microsoft::DirectXMath)
+  endif()
+endfunction()
@@ -0,0 +1,179 @@
+// usu_headless: loads an OBJ and its skin, draws them with the software
+// renderer and writes the frame as PNG or BMP; no GPU or window needed (batch
+// thumbnails, servers). With --reference it also compares the frame against
+// an image and fails on a difference, for rendering regression checks.
+#include "ImageDecoder.h"
+#include "ImageWriter.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "MipGenerator.h"
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+using namespace DirectX;
+
+namespace {
+
+struct Options
+{
+    std::string objPath, texturePath, alphaPath, outPath = "snapshot.png", referencePath;
+    uint32_t width = 1280, height = 720, threads = 0;
+    float yaw = 0.0f;
+    float scale = 0.0f; // 0 fits the mesh's bounding sphere to the view
+    bool depthTest = true;
+    uint32_t tolerance = 8;        // per-channel difference still counted as equal
+    double maxMismatch = 0.002;    // fraction of pixels allowed to differ beyond it
+};
+
+void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: usu_headless --obj FILE [options]\n"
+        "  --texture FILE         skin (PNG or BMP); without it a grey 1x1 texture\n"
+        "  --alpha FILE           separate alpha plane merged into the skin\n"
+        "  --out FILE             .png or .bmp (default snapshot.png)\n"
+        "  --width N --height N   frame size (default 1280x720)\n"
+        "  --yaw RADIANS          model rotation around y, as the arrow keys\n"
+        "  --scale S              model scale; default fits the mesh to the view\n"
+        "  --no-depth             draw order wins, like the D3D pipeline\n"
+        "  --threads N            rasterizer threads (default every core)\n"
+        "  --reference FILE       fail unless the frame matches this image\n"
+        "  --tolerance N          per-channel difference ignored (default 8)\n"
+        "  --max-mismatch F       fraction of pixels allowed past it (default 0.002)\n");
+}
+
+std::wstring WidePath(const std::string& path)
+{
+    return std::filesystem::u8path(path).wstring();
+}
+
+// The D3D app's camera (see ComputeMvp in WinMain.cpp): the eye at
+// (0, 0, -2) looking at the origin; an unscaled mesh is also recentered
+XMFLOAT4X4 ComputeMvp(const Options& options, const MeshBounds& bounds)
+{
+    XMMATRIX world = XMMatrixRotationY(options.yaw);
+    if (options.scale > 0.0f) {
+        world = world * XMMatrixScaling(options.scale, options.scale, options.scale);
+    } else {
+        const float fit = bounds.radius > 0.0f ? 0.75f / bounds.radius : 1.0f;
+        world = XMMatrixTranslation(-bounds.center.x, -bounds.center.y, -bounds.center.z) * world * XMMatrixScaling(fit, fit, fit);
+    }
+    const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -2.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+        XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, static_cast<float>(options.width) / options.height, 0.1f, 100.0f);
+    XMFLOAT4X4 mvp;
+    XMStoreFloat4x4(&mvp, XMMatrixTranspose(world * view * proj));
+    return mvp;
+}
+
+// Pixels whose largest RGB difference exceeds tolerance (alpha is written
+// opaque, so it is not compared)
+bool CompareWithReference(const TextureData& frame, const Options& options)
+{
+    TextureData reference;
+    if (!LoadImageFile(WidePath(options.referencePath), reference)) {
+        fprintf(stderr, "cannot read reference %s\n", options.referencePath.c_str());
+        return false;
+    }
+    if (reference.width != frame.width || reference.height != frame.height) {
+        fprintf(stderr, "reference is %ux%u, frame is %ux%u\n", reference.width, reference.height, frame.width, frame.height);
+        return false;
+    }
+    uint64_t mismatched = 0;
+    int maxDiff = 0;
+    for (uint32_t y = 0; y < frame.height; ++y) {
+        const uint8_t* a = frame.MipData(0) + static_cast<size_t>(y) * frame.mips[0].rowPitch;
+        const uint8_t* b = reference.MipData(0) + static_cast<size_t>(y) * reference.mips[0].rowPitch;
+        for (uint32_t x = 0; x < frame.width; ++x) {
+            int diff = 0;
+            for (int c = 0; c < 3; ++c) diff = (std::max)(diff, std::abs(a[x * 4 + c] - b[x * 4 + c]));
+            maxDiff = (std::max)(maxDiff, diff);
+            mismatched += diff > static_cast<int>(options.tolerance);
+        }
+    }
+    const double fraction = static_cast<double>(mismatched) / (static_cast<double>(frame.width) * frame.height);
+    const bool match = fraction <= options.maxMismatch;
+    fprintf(stderr, "reference %s: %s, %llu pixel(s) (%.4f%%) differ by more than %u, max difference %d\n",
+        options.referencePath.c_str(), match ? "match" : "MISMATCH", static_cast<unsigned long long>(mismatched),
+        100.0 * fraction, options.tolerance, maxDiff);
+    return match;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--no-depth") options.depthTest = false;
+        else if (arg == "--help" || arg == "-h") { PrintUsage(); return 0; }
+        else if (!value) { PrintUsage(); return 1; }
+        else if (arg == "--obj") { options.objPath = value; ++i; }
+        else if (arg == "--texture") { options.texturePath = value; ++i; }
+        else if (arg == "--alpha") { options.alphaPath = value; ++i; }
+        else if (arg == "--out") { options.outPath = value; ++i; }
+        else if (arg == "--reference") { options.referencePath = value; ++i; }
+        else if (arg == "--width") { options.width = static_cast<uint32_t>(strtoul(value, nullptr, 10)); ++i; }
+        else if (arg == "--height") { options.height = static_cast<uint32_t>(strtoul(value, nullptr, 10)); ++i; }
+        else if (arg == "--threads") { options.threads = static_cast<uint32_t>(strtoul(value, nullptr, 10)); ++i; }
+        else if (arg == "--tolerance") { options.tolerance = static_cast<uint32_t>(strtoul(value, nullptr, 10)); ++i; }
+        else if (arg == "--max-mismatch") { options.maxMismatch = atof(value); ++i; }
+        else if (arg == "--yaw") { options.yaw = static_cast<float>(atof(value)); ++i; }
+        else if (arg == "--scale") { options.scale = static_cast<float>(atof(value)); ++i; }
+        else { PrintUsage(); return 1; }
+    }
+    if (options.objPath.empty() || options.width == 0 || options.height == 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    const auto start = Clock::now();
+    Mesh mesh;
+    if (!mesh.LoadOBJ(WidePath(options.objPath))) {
+        fprintf(stderr, "cannot load %s\n", options.objPath.c_str());
+        return 1;
+    }
+    TextureData skin;
+    if (options.texturePath.empty()) {
+        AllocateTexture(skin, TextureFormat::RGBA8, 1, 1);
+        const uint8_t grey[4] = { 192, 192, 192, 255 };
+        std::copy(grey, grey + 4, skin.bytes.begin());
+    } else if (!LoadImageFile(WidePath(options.texturePath), skin, options.alphaPath.empty() ? std::wstring() : WidePath(options.alphaPath)) ||
+               !GenerateMips(skin)) {
+        fprintf(stderr, "cannot load %s\n", options.texturePath.c_str());
+        return 1;
+    }
+
+    SoftwareRenderer renderer;
+    if (!renderer.Initialize(options.width, options.height, options.threads) || !renderer.UploadMesh(mesh) ||
+        !renderer.LoadTexture(skin)) {
+        fprintf(stderr, "cannot set up a %ux%u software renderer\n", options.width, options.height);
+        return 1;
+    }
+    const double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Same clear color as the D3D app
+    renderer.SetDepthTest(options.depthTest);
+    renderer.Clear(0.0f, 0.0f, 1.0f, 1.0f);
+    renderer.UpdateCB(ComputeMvp(options, mesh.GetBounds()));
+    renderer.RecordDraw(renderer.GetIndexCount());
+    const SoftwareDrawStats& stats = renderer.GetLastDrawStats();
+    fprintf(stderr, "%s: %u tris (%u binned) at %ux%u on %u thread(s): load %.1f ms, vertex %.2f ms, bin %.2f ms, raster %.2f ms\n",
+        options.objPath.c_str(), stats.triangles, stats.binned, options.width, options.height,
+        options.threads ? options.threads : GetJobSystem().GetThreadCount(), loadMs, stats.vertexMs, stats.binMs, stats.rasterMs);
+
+    if (!renderer.WriteImage(WidePath(options.outPath))) {
+        fprintf(stderr, "cannot write %s\n", options.outPath.c_str());
+        return 1;
+    }
+    if (!options.referencePath.empty() && !CompareWithReference(renderer.GetFramebuffer(), options)) return 1;
+    return 0;
+}
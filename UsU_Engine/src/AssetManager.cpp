@@ -0,0 +1,194 @@
+#include "AssetManager.h"
+#include "Profiler.h"
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+
+const char* AssetStateName(AssetState state)
+{
+    switch (state) {
+    case AssetState::Queued:    return "queued";
+    case AssetState::Loading:   return "loading";
+    case AssetState::Loaded:    return "loaded";
+    case AssetState::Ready:     return "ready";
+    case AssetState::Failed:    return "failed";
+    case AssetState::Cancelled: return "cancelled";
+    default:                    return "unknown";
+    }
+}
+
+bool AssetManager::Start()
+{
+    if (m_loader.joinable()) return true;
+    m_stop = false;
+    m_loader = std::thread([this]() { LoaderMain(); });
+    return true;
+}
+
+void AssetManager::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        for (Entry* e : m_queue) Finish(*e, AssetState::Cancelled);
+        m_queue.clear();
+        if (m_loading) m_loading->cancelled.store(true);
+    }
+    m_wake.notify_all();
+    if (m_loader.joinable()) m_loader.join();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Entry* e : m_finished) Finish(*e, AssetState::Cancelled);
+    m_finished.clear();
+}
+
+AssetHandle AssetManager::Request(const std::string& name, AssetPriority priority, LoadFunction load, PublishFunction publish)
+{
+    if (!load) return kInvalidAsset;
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->name = name;
+    entry->priority = priority;
+    entry->load = std::move(load);
+    entry->publish = std::move(publish);
+    entry->requested = Clock::now();
+    AssetHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return kInvalidAsset;
+        handle = entry->handle = m_nextHandle++;
+        entry->order = m_nextOrder++;
+        m_queue.push_back(entry.get());
+        m_entries[handle] = std::move(entry);
+    }
+    m_wake.notify_one();
+    return handle;
+}
+
+void AssetManager::SetPriority(AssetHandle handle, AssetPriority priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it != m_entries.end() && it->second->state == AssetState::Queued) it->second->priority = priority;
+}
+
+bool AssetManager::Cancel(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end()) return false;
+    Entry& e = *it->second;
+    switch (e.state) {
+    case AssetState::Queued:
+        m_queue.erase(std::find(m_queue.begin(), m_queue.end(), &e));
+        Finish(e, AssetState::Cancelled);
+        return true;
+    case AssetState::Loading:
+        // The loader drops it when load returns
+        e.cancelled.store(true);
+        return true;
+    case AssetState::Loaded:
+        m_finished.erase(std::find(m_finished.begin(), m_finished.end(), &e));
+        Finish(e, AssetState::Cancelled);
+        return true;
+    default:
+        return false;
+    }
+}
+
+AssetState AssetManager::GetState(AssetHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(handle);
+    return it == m_entries.end() ? AssetState::Unknown : it->second->state;
+}
+
+uint32_t AssetManager::Publish()
+{
+    std::vector<Entry*> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_finished);
+    }
+    // Entries only leave m_finished on this thread, so no lock while publishing
+    for (Entry* e : finished) {
+        const auto t0 = Clock::now();
+        const bool ok = !e->publish || e->publish();
+        const double publishMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Finish(*e, ok ? AssetState::Ready : AssetState::Failed);
+        Log(*e, publishMs);
+    }
+    return static_cast<uint32_t>(finished.size());
+}
+
+bool AssetManager::HasPublishable() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_finished.empty();
+}
+
+bool AssetManager::IsIdle() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.empty() && !m_loading && m_finished.empty();
+}
+
+AssetCounts AssetManager::GetCounts() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counts;
+}
+
+void AssetManager::Finish(Entry& entry, AssetState state)
+{
+    entry.state = state;
+    entry.load = nullptr;
+    entry.publish = nullptr;
+    if (state == AssetState::Ready) ++m_counts.ready;
+    else if (state == AssetState::Failed) ++m_counts.failed;
+    else if (state == AssetState::Cancelled) ++m_counts.cancelled;
+}
+
+void AssetManager::Log(const Entry& entry, double publishMs) const
+{
+    typedef std::chrono::duration<double, std::milli> Ms;
+    char msg[256];
+    sprintf_s(msg, "[Assets] %s: %s, queued %.1f ms, load %.1f ms, publish %.1f ms\n", entry.name.c_str(),
+        AssetStateName(entry.state), Ms(entry.started - entry.requested).count(), Ms(entry.loaded - entry.started).count(),
+        publishMs);
+    OutputDebugStringA(msg);
+}
+
+void AssetManager::LoaderMain()
+{
+    Profiler::SetThreadName("Asset loader");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+        if (m_stop) break;
+        auto next = std::min_element(m_queue.begin(), m_queue.end(), [](const Entry* a, const Entry* b) {
+            return a->priority != b->priority ? a->priority > b->priority : a->order < b->order;
+        });
+        Entry& e = **next;
+        m_queue.erase(next);
+        e.state = AssetState::Loading;
+        e.started = Clock::now();
+        m_loading = &e;
+
+        lock.unlock();
+        const bool ok = e.load(e.cancelled);
+        lock.lock();
+
+        m_loading = nullptr;
+        e.loaded = Clock::now();
+        if (e.cancelled.load()) {
+            Finish(e, AssetState::Cancelled);
+            Log(e, 0.0);
+        } else if (!ok) {
+            Finish(e, AssetState::Failed);
+            Log(e, 0.0);
+        } else {
+            e.state = AssetState::Loaded;
+            m_finished.push_back(&e);
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t AssetHandle;
+static const AssetHandle kInvalidAsset = 0;
+
+// Higher loads first; equal priorities load in request order
+enum class AssetPriority
+{
+    Low,
+    Normal,
+    High,
+};
+
+enum class AssetState
+{
+    Unknown,   // no such handle
+    Queued,
+    Loading,   // load running on the loader thread
+    Loaded,    // waiting for Publish()
+    Ready,     // published
+    Failed,
+    Cancelled,
+};
+
+const char* AssetStateName(AssetState state);
+
+struct AssetCounts
+{
+    uint32_t ready = 0;
+    uint32_t failed = 0;
+    uint32_t cancelled = 0;
+};
+
+// Background loads in two halves. load runs on the loader thread and does
+// the file I/O, parsing and decoding into storage the caller owns (usually
+// captured by shared_ptr in both halves); it may poll cancelled between
+// steps and give up. publish runs inside Publish(), which the frame loop
+// calls at a frame boundary, and hands the result to the renderer.
+// A single loader thread takes one file at a time, so priorities decide
+// what arrives first; decoders inside a load still fan out over the job
+// system. Whole loads stay off the pool because the frame loop runs pool
+// jobs while it waits on its own ones.
+// Everything but the load functions is called from one thread.
+class AssetManager
+{
+public:
+    typedef std::function<bool(const std::atomic<bool>& cancelled)> LoadFunction;
+    typedef std::function<bool()> PublishFunction;
+
+    ~AssetManager() { Shutdown(); }
+    bool Start();
+    // Cancels everything not yet published and waits for the running load
+    void Shutdown();
+
+    // name is for the log only
+    AssetHandle Request(const std::string& name, AssetPriority priority, LoadFunction load, PublishFunction publish);
+    // Reorders a load that has not started yet
+    void SetPriority(AssetHandle handle, AssetPriority priority);
+    // A queued or loaded asset is dropped, a running load sees its flag set;
+    // publish never runs. false once the asset is published or finished.
+    bool Cancel(AssetHandle handle);
+    AssetState GetState(AssetHandle handle) const;
+
+    // Runs publish for every load finished since the last call, in the
+    // order they finished; returns how many it ran
+    uint32_t Publish();
+    bool HasPublishable() const;
+    // Nothing queued, loading or waiting for Publish()
+    bool IsIdle() const;
+    AssetCounts GetCounts() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        AssetHandle handle = kInvalidAsset;
+        std::string name;
+        AssetPriority priority = AssetPriority::Normal;
+        uint64_t order = 0;
+        AssetState state = AssetState::Queued;
+        std::atomic<bool> cancelled{ false };
+        LoadFunction load;
+        PublishFunction publish;
+        Clock::time_point requested, started, loaded;
+    };
+
+    void LoaderMain();
+    void Finish(Entry& entry, AssetState state); // drops the functions and their captures
+    void Log(const Entry& entry, double publishMs) const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_loader;
+    bool m_stop = false;
+    std::unordered_map<AssetHandle, std::unique_ptr<Entry>> m_entries;
+    std::vector<Entry*> m_queue;    // Queued
+    std::vector<Entry*> m_finished; // Loaded, in finishing order
+    Entry* m_loading = nullptr;
+    AssetHandle m_nextHandle = 1;
+    uint64_t m_nextOrder = 0;
+    AssetCounts m_counts;
+};
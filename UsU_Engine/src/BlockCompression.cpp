@@ -0,0 +1,641 @@
+#include "BlockCompression.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USU_BC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 4x4 texels as floats in [0, 255], one array per channel (r, g, b, a)
+struct Block
+{
+    alignas(16) float c[4][16];
+};
+
+// Channels [first, end) take part in a fit: 0-3 for BC1 color, 3-4 for BC3
+// alpha, 0-4 for BC7
+struct Endpoints
+{
+    float e0[4];
+    float e1[4];
+};
+
+} // namespace
+
+// Palette weights of endpoint 1 per index; negative entries are fixed values
+// (BC3 six-value mode's 0 and 255) that the least-squares fit skips
+static const float kBc1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const float kBc3Weights8[8] = { 0.0f, 1.0f, 1.0f / 7, 2.0f / 7, 3.0f / 7, 4.0f / 7, 5.0f / 7, 6.0f / 7 };
+static const float kBc3Weights6[8] = { 0.0f, 1.0f, 1.0f / 5, 2.0f / 5, 3.0f / 5, 4.0f / 5, -1.0f, -1.0f };
+static const int kBc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static void LoadBlock(const TextureData& tex, size_t level, uint32_t bx, uint32_t by, Block& b)
+{
+    const TextureMip& mip = tex.mips[level];
+    const uint8_t* base = tex.MipData(level);
+    for (uint32_t y = 0; y < 4; ++y) {
+        const uint32_t sy = std::min(by * 4 + y, mip.height - 1);
+        for (uint32_t x = 0; x < 4; ++x) {
+            const uint32_t sx = std::min(bx * 4 + x, mip.width - 1);
+            const uint8_t* p = base + static_cast<size_t>(sy) * mip.rowPitch + sx * 4;
+            for (int ch = 0; ch < 4; ++ch) b.c[ch][y * 4 + x] = p[ch];
+        }
+    }
+}
+
+// Picks the nearest palette entry per texel (squared distance over channels
+// [first, end)) and returns the summed error
+static float FitIndices(const Block& b, const float (*palette)[4], int count, int first, int end, uint8_t* indices)
+{
+#if defined(USU_BC_SSE2)
+    __m128 total = _mm_setzero_ps();
+    for (int i = 0; i < 16; i += 4) {
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128i bestIndex = _mm_setzero_si128();
+        for (int k = 0; k < count; ++k) {
+            __m128 d = _mm_setzero_ps();
+            for (int ch = first; ch < end; ++ch) {
+                const __m128 diff = _mm_sub_ps(_mm_load_ps(b.c[ch] + i), _mm_set1_ps(palette[k][ch]));
+                d = _mm_add_ps(d, _mm_mul_ps(diff, diff));
+            }
+            const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            best = _mm_min_ps(d, best);
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, bestIndex));
+        }
+        total = _mm_add_ps(total, best);
+        alignas(16) int32_t idx[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx), bestIndex);
+        for (int j = 0; j < 4; ++j) indices[i + j] = static_cast<uint8_t>(idx[j]);
+    }
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+    float total = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float best = FLT_MAX;
+        int bestIndex = 0;
+        for (int k = 0; k < count; ++k) {
+            float d = 0.0f;
+            for (int ch = first; ch < end; ++ch) {
+                const float diff = b.c[ch][i] - palette[k][ch];
+                d += diff * diff;
+            }
+            if (d < best) { best = d; bestIndex = k; }
+        }
+        indices[i] = static_cast<uint8_t>(bestIndex);
+        total += best;
+    }
+    return total;
+#endif
+}
+
+// Channel-wise min/max with the diagonal flipped for channels that fall as
+// the widest one rises, inset by 1/16 of the range
+static void BoundingBoxEndpoints(const Block& b, int first, int end, Endpoints& ep)
+{
+    float lo[4] = {}, hi[4] = {}, mean[4] = {};
+    int widest = first;
+    for (int ch = first; ch < end; ++ch) {
+        lo[ch] = 255.0f;
+        hi[ch] = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            lo[ch] = std::min(lo[ch], b.c[ch][i]);
+            hi[ch] = std::max(hi[ch], b.c[ch][i]);
+            mean[ch] += b.c[ch][i];
+        }
+        mean[ch] /= 16.0f;
+        if (hi[ch] - lo[ch] > hi[widest] - lo[widest]) widest = ch;
+    }
+    for (int ch = first; ch < end; ++ch) {
+        if (ch != widest) {
+            float cov = 0.0f;
+            for (int i = 0; i < 16; ++i) cov += (b.c[ch][i] - mean[ch]) * (b.c[widest][i] - mean[widest]);
+            if (cov < 0.0f) std::swap(lo[ch], hi[ch]);
+        }
+        const float inset = (hi[ch] - lo[ch]) / 16.0f;
+        ep.e0[ch] = hi[ch] - inset;
+        ep.e1[ch] = lo[ch] + inset;
+    }
+}
+
+// Extremes of the texels projected on the principal axis of their covariance
+static void PrincipalAxisEndpoints(const Block& b, int first, int end, Endpoints& ep)
+{
+    float mean[4] = {};
+    for (int ch = first; ch < end; ++ch) {
+        for (int i = 0; i < 16; ++i) mean[ch] += b.c[ch][i];
+        mean[ch] /= 16.0f;
+    }
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; ++i)
+        for (int r = first; r < end; ++r)
+            for (int c = first; c < end; ++c) cov[r][c] += (b.c[r][i] - mean[r]) * (b.c[c][i] - mean[c]);
+
+    // Power iteration from the bounding-box diagonal
+    Endpoints box;
+    BoundingBoxEndpoints(b, first, end, box);
+    float axis[4] = {};
+    for (int ch = first; ch < end; ++ch) axis[ch] = box.e0[ch] - box.e1[ch] + 1e-3f;
+    for (int iter = 0; iter < 8; ++iter) {
+        float next[4] = {};
+        float len = 0.0f;
+        for (int r = first; r < end; ++r) {
+            for (int c = first; c < end; ++c) next[r] += cov[r][c] * axis[c];
+            len = std::max(len, std::fabs(next[r]));
+        }
+        if (len < 1e-6f) break;
+        for (int ch = first; ch < end; ++ch) axis[ch] = next[ch] / len;
+    }
+    float norm = 0.0f;
+    for (int ch = first; ch < end; ++ch) norm += axis[ch] * axis[ch];
+    if (norm < 1e-12f) {
+        for (int ch = first; ch < end; ++ch) ep.e0[ch] = ep.e1[ch] = mean[ch];
+        return;
+    }
+    float tMin = FLT_MAX, tMax = -FLT_MAX;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int ch = first; ch < end; ++ch) t += (b.c[ch][i] - mean[ch]) * axis[ch];
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+    for (int ch = first; ch < end; ++ch) {
+        ep.e0[ch] = std::min(std::max(mean[ch] + tMax * axis[ch] / norm, 0.0f), 255.0f);
+        ep.e1[ch] = std::min(std::max(mean[ch] + tMin * axis[ch] / norm, 0.0f), 255.0f);
+    }
+}
+
+// Endpoints minimizing the squared error for fixed indices; false when the
+// system is degenerate (all texels on one palette entry)
+static bool RefineEndpoints(const Block& b, int first, int end, const uint8_t* indices, const float* weights, Endpoints& ep)
+{
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; ++i) {
+        const float t = weights[indices[i]];
+        if (t < 0.0f) continue;
+        const float s = 1.0f - t;
+        aa += s * s;
+        bb += t * t;
+        ab += s * t;
+        for (int ch = first; ch < end; ++ch) {
+            ax[ch] += s * b.c[ch][i];
+            bx[ch] += t * b.c[ch][i];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) return false;
+    for (int ch = first; ch < end; ++ch) {
+        ep.e0[ch] = std::min(std::max((ax[ch] * bb - bx[ch] * ab) / det, 0.0f), 255.0f);
+        ep.e1[ch] = std::min(std::max((bx[ch] * aa - ax[ch] * ab) / det, 0.0f), 255.0f);
+    }
+    return true;
+}
+
+static void PutBits(uint8_t* out, int& pos, uint32_t value, int count)
+{
+    for (int i = 0; i < count; ++i, ++pos)
+        if ((value >> i) & 1u) out[pos >> 3] |= static_cast<uint8_t>(1u << (pos & 7));
+}
+
+static uint32_t GetBits(const uint8_t* in, int& pos, int count)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < count; ++i, ++pos) value |= static_cast<uint32_t>((in[pos >> 3] >> (pos & 7)) & 1u) << i;
+    return value;
+}
+
+// --- BC1 color ---------------------------------------------------------
+
+static uint16_t To565(const float* c)
+{
+    const int r = static_cast<int>(c[0] * (31.0f / 255.0f) + 0.5f);
+    const int g = static_cast<int>(c[1] * (63.0f / 255.0f) + 0.5f);
+    const int b = static_cast<int>(c[2] * (31.0f / 255.0f) + 0.5f);
+    return static_cast<uint16_t>((std::min(r, 31) << 11) | (std::min(g, 63) << 5) | std::min(b, 31));
+}
+
+static void From565(uint16_t v, int* c)
+{
+    const int r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+    c[0] = (r << 3) | (r >> 2);
+    c[1] = (g << 2) | (g >> 4);
+    c[2] = (b << 3) | (b >> 2);
+}
+
+// Four-color palette (c0 > c1); equal endpoints leave a single entry
+static int Bc1Palette(uint16_t c0, uint16_t c1, int (*palette)[4])
+{
+    From565(c0, palette[0]);
+    From565(c1, palette[1]);
+    for (int ch = 0; ch < 3; ++ch) {
+        palette[2][ch] = (2 * palette[0][ch] + palette[1][ch] + 1) / 3;
+        palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch] + 1) / 3;
+    }
+    for (int k = 0; k < 4; ++k) palette[k][3] = 255;
+    return c0 == c1 ? 1 : 4;
+}
+
+static float EncodeColorEndpoints(const Block& b, const Endpoints& ep, uint8_t* out, uint8_t* indices)
+{
+    uint16_t c0 = To565(ep.e0), c1 = To565(ep.e1);
+    if (c0 < c1) std::swap(c0, c1);
+    int ipal[4][4];
+    const int count = Bc1Palette(c0, c1, ipal);
+    float palette[4][4];
+    for (int k = 0; k < 4; ++k)
+        for (int ch = 0; ch < 4; ++ch) palette[k][ch] = static_cast<float>(ipal[k][ch]);
+    const float err = FitIndices(b, palette, count, 0, 3, indices);
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+    memcpy(out, &c0, 2);
+    memcpy(out + 2, &c1, 2);
+    memcpy(out + 4, &bits, 4);
+    return err;
+}
+
+static void EncodeColorBlock(const Block& b, BcQuality quality, uint8_t* out)
+{
+    Endpoints ep;
+    BoundingBoxEndpoints(b, 0, 3, ep);
+    uint8_t bestIndices[16];
+    float bestErr = EncodeColorEndpoints(b, ep, out, bestIndices);
+    if (quality == BcQuality::Fast || bestErr == 0.0f) return;
+
+    uint8_t block[8], indices[16];
+    PrincipalAxisEndpoints(b, 0, 3, ep);
+    float err = EncodeColorEndpoints(b, ep, block, indices);
+    if (err < bestErr) {
+        bestErr = err;
+        memcpy(out, block, 8);
+        memcpy(bestIndices, indices, 16);
+    }
+    for (int iter = 0; iter < 2; ++iter) {
+        if (!RefineEndpoints(b, 0, 3, bestIndices, kBc1Weights, ep)) break;
+        err = EncodeColorEndpoints(b, ep, block, indices);
+        if (err >= bestErr) break;
+        bestErr = err;
+        memcpy(out, block, 8);
+        memcpy(bestIndices, indices, 16);
+    }
+}
+
+// --- BC3 alpha ---------------------------------------------------------
+
+// Eight-value mode when a0 > a1, otherwise six values plus 0 and 255
+static void Bc3AlphaPalette(int a0, int a1, int* palette)
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 2; i < 8; ++i) palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+    } else {
+        for (int i = 2; i < 6; ++i) palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static float EncodeAlphaEndpoints(const Block& b, const Endpoints& ep, bool sixValues, uint8_t* out, uint8_t* indices)
+{
+    int a0 = static_cast<int>(ep.e0[3] + 0.5f), a1 = static_cast<int>(ep.e1[3] + 0.5f);
+    if (sixValues ? a0 > a1 : a0 < a1) std::swap(a0, a1);
+    int ipal[8];
+    Bc3AlphaPalette(a0, a1, ipal);
+    float palette[8][4] = {};
+    for (int k = 0; k < 8; ++k) palette[k][3] = static_cast<float>(ipal[k]);
+    const float err = FitIndices(b, palette, 8, 3, 4, indices);
+
+    memset(out, 0, 8);
+    out[0] = static_cast<uint8_t>(a0);
+    out[1] = static_cast<uint8_t>(a1);
+    int pos = 16;
+    for (int i = 0; i < 16; ++i) PutBits(out, pos, indices[i], 3);
+    return err;
+}
+
+static void EncodeAlphaBlock(const Block& b, BcQuality quality, uint8_t* out)
+{
+    Endpoints ep = {};
+    float lo = 255.0f, hi = 0.0f, innerLo = 255.0f, innerHi = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        const float a = b.c[3][i];
+        lo = std::min(lo, a);
+        hi = std::max(hi, a);
+        if (a > 0.0f && a < 255.0f) {
+            innerLo = std::min(innerLo, a);
+            innerHi = std::max(innerHi, a);
+        }
+    }
+    ep.e0[3] = hi;
+    ep.e1[3] = lo;
+    uint8_t bestIndices[16];
+    float bestErr = EncodeAlphaEndpoints(b, ep, false, out, bestIndices);
+    if (quality == BcQuality::Fast || bestErr == 0.0f) return;
+
+    uint8_t block[8], indices[16];
+    for (int iter = 0; iter < 2; ++iter) {
+        if (!RefineEndpoints(b, 3, 4, bestIndices, kBc3Weights8, ep)) break;
+        const float err = EncodeAlphaEndpoints(b, ep, false, block, indices);
+        if (err >= bestErr) break;
+        bestErr = err;
+        memcpy(out, block, 8);
+        memcpy(bestIndices, indices, 16);
+    }
+
+    // Six-value mode spends its interpolants on the range between the
+    // fully transparent/opaque texels, which get exact 0 and 255
+    if (innerLo > innerHi || (lo > 0.0f && hi < 255.0f)) return;
+    ep.e0[3] = innerLo;
+    ep.e1[3] = innerHi;
+    float err = EncodeAlphaEndpoints(b, ep, true, block, indices);
+    if (RefineEndpoints(b, 3, 4, indices, kBc3Weights6, ep)) {
+        uint8_t refined[8], refinedIndices[16];
+        const float refinedErr = EncodeAlphaEndpoints(b, ep, true, refined, refinedIndices);
+        if (refinedErr < err) {
+            err = refinedErr;
+            memcpy(block, refined, 8);
+        }
+    }
+    if (err < bestErr) memcpy(out, block, 8);
+}
+
+// --- BC7 mode 6 --------------------------------------------------------
+
+// 7-bit endpoint plus the p-bit (shared lowest bit) closest to e
+static void QuantizeBc7Endpoint(const float* e, uint32_t* q, uint32_t& pbit)
+{
+    float bestErr = FLT_MAX;
+    for (uint32_t p = 0; p < 2; ++p) {
+        uint32_t cand[4];
+        float err = 0.0f;
+        for (int ch = 0; ch < 4; ++ch) {
+            const int v = static_cast<int>((e[ch] - p) * 0.5f + 0.5f);
+            cand[ch] = static_cast<uint32_t>(std::min(std::max(v, 0), 127));
+            const float d = static_cast<float>((cand[ch] << 1) | p) - e[ch];
+            err += d * d;
+        }
+        if (err < bestErr) {
+            bestErr = err;
+            pbit = p;
+            memcpy(q, cand, sizeof(cand));
+        }
+    }
+}
+
+static void Bc7Palette(const uint32_t* q0, uint32_t p0, const uint32_t* q1, uint32_t p1, int (*palette)[4])
+{
+    for (int ch = 0; ch < 4; ++ch) {
+        const int e0 = static_cast<int>((q0[ch] << 1) | p0);
+        const int e1 = static_cast<int>((q1[ch] << 1) | p1);
+        for (int k = 0; k < 16; ++k) palette[k][ch] = ((64 - kBc7Weights4[k]) * e0 + kBc7Weights4[k] * e1 + 32) >> 6;
+    }
+}
+
+static float EncodeBc7Endpoints(const Block& b, const Endpoints& ep, uint8_t* out, uint8_t* indices)
+{
+    uint32_t q0[4], q1[4], p0 = 0, p1 = 0;
+    QuantizeBc7Endpoint(ep.e0, q0, p0);
+    QuantizeBc7Endpoint(ep.e1, q1, p1);
+    int ipal[16][4];
+    Bc7Palette(q0, p0, q1, p1, ipal);
+    float palette[16][4];
+    for (int k = 0; k < 16; ++k)
+        for (int ch = 0; ch < 4; ++ch) palette[k][ch] = static_cast<float>(ipal[k][ch]);
+    const float err = FitIndices(b, palette, 16, 0, 4, indices);
+
+    // The first texel's index drops its top bit, so it must be below 8
+    uint8_t stored[16];
+    memcpy(stored, indices, 16);
+    if (stored[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (int i = 0; i < 16; ++i) stored[i] = static_cast<uint8_t>(15 - stored[i]);
+    }
+
+    memset(out, 0, 16);
+    int pos = 0;
+    PutBits(out, pos, 1u << 6, 7); // mode 6
+    for (int ch = 0; ch < 4; ++ch) {
+        PutBits(out, pos, q0[ch], 7);
+        PutBits(out, pos, q1[ch], 7);
+    }
+    PutBits(out, pos, p0, 1);
+    PutBits(out, pos, p1, 1);
+    PutBits(out, pos, stored[0], 3);
+    for (int i = 1; i < 16; ++i) PutBits(out, pos, stored[i], 4);
+    return err;
+}
+
+static void EncodeBc7Block(const Block& b, BcQuality quality, uint8_t* out)
+{
+    float weights[16];
+    for (int k = 0; k < 16; ++k) weights[k] = kBc7Weights4[k] / 64.0f;
+
+    Endpoints ep;
+    BoundingBoxEndpoints(b, 0, 4, ep);
+    uint8_t bestIndices[16];
+    float bestErr = EncodeBc7Endpoints(b, ep, out, bestIndices);
+    if (quality == BcQuality::Fast || bestErr == 0.0f) return;
+
+    uint8_t block[16], indices[16];
+    PrincipalAxisEndpoints(b, 0, 4, ep);
+    float err = EncodeBc7Endpoints(b, ep, block, indices);
+    if (err < bestErr) {
+        bestErr = err;
+        memcpy(out, block, 16);
+        memcpy(bestIndices, indices, 16);
+    }
+    for (int iter = 0; iter < 2; ++iter) {
+        if (!RefineEndpoints(b, 0, 4, bestIndices, weights, ep)) break;
+        err = EncodeBc7Endpoints(b, ep, block, indices);
+        if (err >= bestErr) break;
+        bestErr = err;
+        memcpy(out, block, 16);
+        memcpy(bestIndices, indices, 16);
+    }
+}
+
+// --- Decoders ----------------------------------------------------------
+
+static void DecodeColorBlock(const uint8_t* in, bool bc1, uint8_t (*texels)[4])
+{
+    uint16_t c0, c1;
+    uint32_t bits;
+    memcpy(&c0, in, 2);
+    memcpy(&c1, in + 2, 2);
+    memcpy(&bits, in + 4, 4);
+    int palette[4][4];
+    Bc1Palette(c0, c1, palette);
+    if (bc1 && c0 <= c1) {
+        // Three colors plus transparent black
+        for (int ch = 0; ch < 3; ++ch) {
+            palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+            palette[3][ch] = 0;
+        }
+        palette[3][3] = 0;
+    }
+    for (int i = 0; i < 16; ++i)
+        for (int ch = 0; ch < 4; ++ch) texels[i][ch] = static_cast<uint8_t>(palette[(bits >> (i * 2)) & 3][ch]);
+}
+
+static void DecodeAlphaBlock(const uint8_t* in, uint8_t (*texels)[4])
+{
+    int palette[8];
+    Bc3AlphaPalette(in[0], in[1], palette);
+    int pos = 16;
+    for (int i = 0; i < 16; ++i) texels[i][3] = static_cast<uint8_t>(palette[GetBits(in, pos, 3)]);
+}
+
+static bool DecodeBc7Block(const uint8_t* in, uint8_t (*texels)[4])
+{
+    if ((in[0] & 0x7F) != 0x40) return false; // not mode 6
+    int pos = 7;
+    uint32_t q0[4], q1[4];
+    for (int ch = 0; ch < 4; ++ch) {
+        q0[ch] = GetBits(in, pos, 7);
+        q1[ch] = GetBits(in, pos, 7);
+    }
+    const uint32_t p0 = GetBits(in, pos, 1);
+    const uint32_t p1 = GetBits(in, pos, 1);
+    int palette[16][4];
+    Bc7Palette(q0, p0, q1, p1, palette);
+    for (int i = 0; i < 16; ++i) {
+        const uint32_t index = GetBits(in, pos, i == 0 ? 3 : 4);
+        for (int ch = 0; ch < 4; ++ch) texels[i][ch] = static_cast<uint8_t>(palette[index][ch]);
+    }
+    return true;
+}
+
+// --- Texture level loops -----------------------------------------------
+
+// Block rows four at a time on the shared job pool
+template <typename Fn>
+static void ParallelRows(size_t rows, Fn&& fn)
+{
+    GetJobSystem().ParallelFor(static_cast<uint32_t>(rows), 4, fn);
+}
+
+TextureFormat ChooseBcFormat(const TextureData& rgba, TextureFormat alphaFormat)
+{
+    if (rgba.format != TextureFormat::RGBA8 || rgba.mips.empty()) return rgba.format;
+    const TextureMip& mip = rgba.mips[0];
+    for (uint32_t y = 0; y < mip.height; ++y) {
+        const uint8_t* row = rgba.MipData(0) + static_cast<size_t>(y) * mip.rowPitch;
+        for (uint32_t x = 0; x < mip.width; ++x)
+            if (row[x * 4 + 3] != 255) return alphaFormat;
+    }
+    return TextureFormat::BC1;
+}
+
+bool CompressTexture(const TextureData& rgba, TextureFormat format, BcQuality quality, TextureData& out, BcEncodeStats* stats)
+{
+    USU_PROFILE_ZONE("CompressTexture");
+    if (rgba.format != TextureFormat::RGBA8 || rgba.mips.empty() || (rgba.width % 4) != 0 || (rgba.height % 4) != 0)
+        return false;
+    if (format != TextureFormat::BC1 && format != TextureFormat::BC3 && format != TextureFormat::BC7) return false;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    AllocateTexture(out, format, rgba.width, rgba.height, static_cast<uint32_t>(rgba.mips.size()));
+    size_t pixels = 0;
+    for (size_t level = 0; level < out.mips.size(); ++level) {
+        const TextureMip& mip = out.mips[level];
+        const uint32_t blocksX = std::max(1u, (mip.width + 3) / 4);
+        const uint32_t blocksY = std::max(1u, (mip.height + 3) / 4);
+        pixels += static_cast<size_t>(mip.width) * mip.height;
+        uint8_t* dst = out.MipData(level);
+        ParallelRows(blocksY, [&](size_t y0, size_t y1) {
+            Block b;
+            for (size_t by = y0; by < y1; ++by) {
+                uint8_t* row = dst + by * mip.rowPitch;
+                for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                    LoadBlock(rgba, level, bx, static_cast<uint32_t>(by), b);
+                    if (format == TextureFormat::BC1) {
+                        EncodeColorBlock(b, quality, row + bx * 8);
+                    } else if (format == TextureFormat::BC3) {
+                        EncodeAlphaBlock(b, quality, row + bx * 16);
+                        EncodeColorBlock(b, quality, row + bx * 16 + 8);
+                    } else {
+                        EncodeBc7Block(b, quality, row + bx * 16);
+                    }
+                }
+            }
+        });
+    }
+
+    if (stats) {
+        stats->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        stats->megapixelsPerSecond = stats->milliseconds > 0.0 ? pixels / (stats->milliseconds * 1000.0) : 0.0;
+    }
+    return true;
+}
+
+bool DecompressTextureLevel(const TextureData& tex, size_t level, uint8_t* rgba, size_t pitch)
+{
+    if (level >= tex.mips.size()) return false;
+    if (!IsBlockCompressed(tex.format)) return false;
+    const TextureMip& mip = tex.mips[level];
+    const size_t blockBytes = (tex.format == TextureFormat::BC1) ? 8 : 16;
+    const uint32_t blocksX = std::max(1u, (mip.width + 3) / 4);
+    const uint32_t blocksY = std::max(1u, (mip.height + 3) / 4);
+    for (uint32_t by = 0; by < blocksY; ++by) {
+        for (uint32_t bx = 0; bx < blocksX; ++bx) {
+            const uint8_t* in = tex.MipData(level) + static_cast<size_t>(by) * mip.rowPitch + bx * blockBytes;
+            uint8_t texels[16][4];
+            if (tex.format == TextureFormat::BC1) {
+                DecodeColorBlock(in, true, texels);
+            } else if (tex.format == TextureFormat::BC2) {
+                // Explicit 4-bit alpha, texel 0 in the low nibble
+                DecodeColorBlock(in + 8, false, texels);
+                uint64_t alpha;
+                memcpy(&alpha, in, 8);
+                for (int i = 0; i < 16; ++i) texels[i][3] = static_cast<uint8_t>(((alpha >> (4 * i)) & 0xF) * 17);
+            } else if (tex.format == TextureFormat::BC3) {
+                DecodeColorBlock(in + 8, false, texels);
+                DecodeAlphaBlock(in, texels);
+            } else if (!DecodeBc7Block(in, texels)) {
+                return false;
+            }
+            for (uint32_t y = 0; y < 4 && by * 4 + y < mip.height; ++y)
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < mip.width; ++x)
+                    memcpy(rgba + (by * 4 + y) * pitch + (bx * 4 + x) * 4, texels[y * 4 + x], 4);
+        }
+    }
+    return true;
+}
+
+bool MeasureCompressionPsnr(const TextureData& rgba, const TextureData& compressed, double& psnrRgb, double& psnrAlpha)
+{
+    if (rgba.format != TextureFormat::RGBA8 || rgba.mips.empty() || compressed.mips.empty() ||
+        rgba.width != compressed.width || rgba.height != compressed.height)
+        return false;
+    const uint32_t w = rgba.width, h = rgba.height;
+    std::vector<uint8_t> decoded(static_cast<size_t>(w) * h * 4);
+    if (!DecompressTextureLevel(compressed, 0, decoded.data(), w * 4)) return false;
+
+    double sumRgb = 0.0, sumAlpha = 0.0;
+    for (uint32_t y = 0; y < h; ++y) {
+        const uint8_t* a = rgba.MipData(0) + static_cast<size_t>(y) * rgba.mips[0].rowPitch;
+        const uint8_t* b = decoded.data() + static_cast<size_t>(y) * w * 4;
+        for (uint32_t i = 0; i < w * 4; ++i) {
+            const double d = static_cast<double>(a[i]) - b[i];
+            ((i & 3) == 3 ? sumAlpha : sumRgb) += d * d;
+        }
+    }
+    const double pixels = static_cast<double>(w) * h;
+    const double mseRgb = sumRgb / (pixels * 3.0), mseAlpha = sumAlpha / pixels;
+    psnrRgb = mseRgb > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mseRgb) : INFINITY;
+    psnrAlpha = mseAlpha > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mseAlpha) : INFINITY;
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Texture.h"
+
+// BC1/BC3/BC7 encoding of RGBA8 textures, D3D-independent. BC7 uses mode 6
+// only (one subset, RGBA endpoints with p-bits, 4-bit indices), which covers
+// skins with and without alpha well at a fraction of a full mode search.
+
+// Bump when encoder output changes so cached textures get rebuilt
+static const uint32_t kBcEncoderVersion = 1;
+
+enum class BcQuality
+{
+    Fast, // bounding-box endpoints, one index fit; for import-time iteration
+    High, // principal-axis endpoints plus least-squares refinement
+};
+
+struct BcEncodeStats
+{
+    double milliseconds = 0.0;
+    double megapixelsPerSecond = 0.0; // all levels
+};
+
+// BC1 when every texel is opaque, otherwise alphaFormat (BC3 or BC7). BC3
+// by default: its separate alpha block keeps cut-out edges sharper than
+// our BC7 (mode 6 only, alpha shares the color indices).
+TextureFormat ChooseBcFormat(const TextureData& rgba, TextureFormat alphaFormat = TextureFormat::BC3);
+
+// Encodes every level of an RGBA8 texture; rows of blocks are split across
+// threads. Level 0 must be a multiple of 4 in both dimensions (a D3D12
+// requirement for BC textures); smaller mips are padded by edge clamping.
+bool CompressTexture(const TextureData& rgba, TextureFormat format, BcQuality quality, TextureData& out,
+                     BcEncodeStats* stats = nullptr);
+
+// Decodes one level of a BC1/BC2/BC3/BC7 texture back to RGBA8 (BC7: mode 6
+// blocks only, as written by CompressTexture).
+bool DecompressTextureLevel(const TextureData& tex, size_t level, uint8_t* rgba, size_t pitch);
+
+// PSNR in dB of a compressed texture's level 0 against the RGBA8 source, for
+// the color channels together and for alpha (infinite when exact).
+bool MeasureCompressionPsnr(const TextureData& rgba, const TextureData& compressed, double& psnrRgb, double& psnrAlpha);
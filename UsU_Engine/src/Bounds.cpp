@@ -0,0 +1,84 @@
+#include "Bounds.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+MeshBounds ComputeMeshBounds(const Vertex* vertices, size_t count)
+{
+    MeshBounds b;
+    if (!vertices || count == 0) return b;
+    XMFLOAT3 lo = vertices[0].position, hi = vertices[0].position;
+    for (size_t i = 1; i < count; ++i) {
+        const XMFLOAT3& p = vertices[i].position;
+        lo.x = std::min(lo.x, p.x); hi.x = std::max(hi.x, p.x);
+        lo.y = std::min(lo.y, p.y); hi.y = std::max(hi.y, p.y);
+        lo.z = std::min(lo.z, p.z); hi.z = std::max(hi.z, p.z);
+    }
+    b.box.min = lo;
+    b.box.max = hi;
+    b.center = XMFLOAT3(0.5f * (lo.x + hi.x), 0.5f * (lo.y + hi.y), 0.5f * (lo.z + hi.z));
+    float r2 = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        const XMFLOAT3& p = vertices[i].position;
+        const float dx = p.x - b.center.x, dy = p.y - b.center.y, dz = p.z - b.center.z;
+        r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+    }
+    b.radius = std::sqrt(r2);
+    return b;
+}
+
+Aabb TransformAabb(const Aabb& box, const XMFLOAT4X4& m)
+{
+    // Arvo: per output axis, the translation plus the smaller/larger of each
+    // input axis' contribution
+    const float lo[3] = { box.min.x, box.min.y, box.min.z };
+    const float hi[3] = { box.max.x, box.max.y, box.max.z };
+    float outLo[3], outHi[3];
+    for (int j = 0; j < 3; ++j) {
+        outLo[j] = outHi[j] = m.m[3][j];
+        for (int i = 0; i < 3; ++i) {
+            const float a = m.m[i][j] * lo[i], b = m.m[i][j] * hi[i];
+            outLo[j] += std::min(a, b);
+            outHi[j] += std::max(a, b);
+        }
+    }
+    Aabb out;
+    out.min = XMFLOAT3(outLo[0], outLo[1], outLo[2]);
+    out.max = XMFLOAT3(outHi[0], outHi[1], outHi[2]);
+    return out;
+}
+
+Frustum ExtractFrustum(const XMFLOAT4X4& viewProj)
+{
+    // clip = (x, y, z, 1) * viewProj, so clip component j is column j
+    const auto column = [&](int j) { return XMFLOAT4(viewProj.m[0][j], viewProj.m[1][j], viewProj.m[2][j], viewProj.m[3][j]); };
+    const XMFLOAT4 cx = column(0), cy = column(1), cz = column(2), cw = column(3);
+    Frustum f;
+    f.planes[0] = XMFLOAT4(cw.x + cx.x, cw.y + cx.y, cw.z + cx.z, cw.w + cx.w); // -w <= x
+    f.planes[1] = XMFLOAT4(cw.x - cx.x, cw.y - cx.y, cw.z - cx.z, cw.w - cx.w); // x <= w
+    f.planes[2] = XMFLOAT4(cw.x + cy.x, cw.y + cy.y, cw.z + cy.z, cw.w + cy.w);
+    f.planes[3] = XMFLOAT4(cw.x - cy.x, cw.y - cy.y, cw.z - cy.z, cw.w - cy.w);
+    f.planes[4] = cz;                                                           // 0 <= z
+    f.planes[5] = XMFLOAT4(cw.x - cz.x, cw.y - cz.y, cw.z - cz.z, cw.w - cz.w); // z <= w
+    for (XMFLOAT4& p : f.planes) {
+        const float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        if (len > 0.0f) {
+            p.x /= len; p.y /= len; p.z /= len; p.w /= len;
+        }
+    }
+    return f;
+}
+
+bool IsAabbVisible(const Frustum& frustum, const Aabb& box)
+{
+    for (const XMFLOAT4& p : frustum.planes) {
+        // The corner farthest along the plane normal
+        const float x = p.x >= 0.0f ? box.max.x : box.min.x;
+        const float y = p.y >= 0.0f ? box.max.y : box.min.y;
+        const float z = p.z >= 0.0f ? box.max.z : box.min.z;
+        if (p.x * x + p.y * y + p.z * z + p.w < 0.0f) return false;
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <DirectXMath.h>
+
+struct Vertex;
+
+struct Aabb
+{
+    DirectX::XMFLOAT3 min = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+    DirectX::XMFLOAT3 max = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+};
+
+// Object-space bounds; the sphere is centered on the box, radius to the
+// farthest vertex (tighter than the box's half diagonal for rounded meshes)
+struct MeshBounds
+{
+    Aabb box;
+    DirectX::XMFLOAT3 center = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+    float radius = 0.0f;
+};
+
+MeshBounds ComputeMeshBounds(const Vertex* vertices, size_t count);
+
+// Box around box transformed by m (untransposed, row vectors as in
+// DirectXMath); exact for the transformed corners
+Aabb TransformAabb(const Aabb& box, const DirectX::XMFLOAT4X4& m);
+
+// Plane (a, b, c, d): a point is inside when a*x + b*y + c*z + d >= 0.
+// Normals point inward and are unit length.
+struct Frustum
+{
+    DirectX::XMFLOAT4 planes[6]; // left, right, bottom, top, near, far
+};
+
+// From an untransposed view * proj with D3D clip space (0 <= z <= w)
+Frustum ExtractFrustum(const DirectX::XMFLOAT4X4& viewProj);
+
+// Outside only when entirely behind one plane (conservative near corners)
+bool IsAabbVisible(const Frustum& frustum, const Aabb& box);
@@ -0,0 +1,302 @@
+#include "Bvh.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USU_BVH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace DirectX;
+
+namespace {
+
+const uint32_t kLeafSize = 4;
+const double kRebuildCost = 1.5; // refit until the boxes' area grows past this ratio of a fresh build
+
+#if defined(USU_BVH_SSE2)
+struct V4 { __m128 v; };
+inline V4 Splat(float a) { return { _mm_set1_ps(a) }; }
+inline V4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+inline V4 operator+(V4 a, V4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline V4 operator*(V4 a, V4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+// Bit k set when lane k < 0
+inline uint32_t NegativeMask(V4 a) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a.v, _mm_setzero_ps()))); }
+#else
+struct V4 { float v[4]; };
+inline V4 Splat(float a) { return { { a, a, a, a } }; }
+inline V4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+inline V4 operator+(V4 a, V4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline V4 operator*(V4 a, V4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+inline uint32_t NegativeMask(V4 a)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < 4; ++i) mask |= (a.v[i] < 0.0f ? 1u : 0u) << i;
+    return mask;
+}
+#endif
+
+// One frustum plane splatted across lanes, with the box arrays (0-2 min,
+// 3-5 max) holding its farthest and nearest corner along the normal
+struct CullPlane
+{
+    V4 n[3];
+    V4 d;
+    int far[3];
+    int near[3];
+};
+
+// Four boxes against every plane: out gets a bit per box entirely behind
+// some plane, cross (when wanted) a bit per box straddling one
+inline void TestBoxes(const CullPlane* planes, const float* const box[6], uint32_t valid, uint32_t& out, uint32_t* cross)
+{
+    out = 0;
+    uint32_t straddle = 0;
+    for (int p = 0; p < 6; ++p) {
+        const CullPlane& pl = planes[p];
+        const V4 far = pl.n[0] * Load(box[pl.far[0]]) + pl.n[1] * Load(box[pl.far[1]]) + pl.n[2] * Load(box[pl.far[2]]) + pl.d;
+        out |= NegativeMask(far);
+        if ((out & valid) == valid) break;
+        if (cross) {
+            const V4 near = pl.n[0] * Load(box[pl.near[0]]) + pl.n[1] * Load(box[pl.near[1]]) + pl.n[2] * Load(box[pl.near[2]]) + pl.d;
+            straddle |= NegativeMask(near);
+        }
+    }
+    if (cross) *cross = straddle;
+}
+
+inline double HalfArea(const float box[6][4], int lane)
+{
+    const double dx = box[3][lane] - box[0][lane];
+    const double dy = box[4][lane] - box[1][lane];
+    const double dz = box[5][lane] - box[2][lane];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+} // namespace
+
+void Bvh::Clear()
+{
+    m_nodes.clear();
+    m_nodeParent.clear();
+    m_nodeDirty.clear();
+    for (auto& v : m_slotBox) v.clear();
+    m_slotObject.clear();
+    m_objectSlot.clear();
+    m_slotNode.clear();
+    m_builtCost = 0.0;
+    m_cost = 0.0;
+    m_dirty = false;
+}
+
+void Bvh::Build(const Aabb* boxes, uint32_t count)
+{
+    Clear();
+    if (!boxes || count == 0) return;
+
+    m_centroid.resize(static_cast<size_t>(count) * 3);
+    for (uint32_t i = 0; i < count; ++i) {
+        m_centroid[i * 3 + 0] = boxes[i].min.x + boxes[i].max.x;
+        m_centroid[i * 3 + 1] = boxes[i].min.y + boxes[i].max.y;
+        m_centroid[i * 3 + 2] = boxes[i].min.z + boxes[i].max.z;
+    }
+    m_slotObject.resize(count);
+    for (uint32_t i = 0; i < count; ++i) m_slotObject[i] = i;
+    m_nodes.reserve(count / 4 + 1);
+    m_slotNode.resize(count);
+    BuildNode(0, count);
+    m_nodeParent[0] = kLeaf;
+    m_nodeDirty.assign(m_nodes.size(), 0);
+
+    m_objectSlot.resize(count);
+    for (auto& v : m_slotBox) v.assign(static_cast<size_t>(count) + 3, 0.0f);
+    for (uint32_t s = 0; s < count; ++s) {
+        const Aabb& b = boxes[m_slotObject[s]];
+        m_objectSlot[m_slotObject[s]] = s;
+        m_slotBox[0][s] = b.min.x; m_slotBox[1][s] = b.min.y; m_slotBox[2][s] = b.min.z;
+        m_slotBox[3][s] = b.max.x; m_slotBox[4][s] = b.max.y; m_slotBox[5][s] = b.max.z;
+    }
+
+    // Children always come after their parent
+    for (size_t n = m_nodes.size(); n-- > 0;) {
+        for (uint32_t lane = 0; lane < m_nodes[n].childCount; ++lane) RefitLane(m_nodes[n], lane);
+    }
+    m_builtCost = m_cost;
+}
+
+// Splits [begin, end) of m_slotObject in two (then each half again) at the
+// centroid median along the widest axis, so a node gets up to four children
+uint32_t Bvh::BuildNode(uint32_t begin, uint32_t end)
+{
+    const auto split = [this](uint32_t b, uint32_t e) {
+        float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint32_t s = b; s < e; ++s) {
+            const float* c = &m_centroid[m_slotObject[s] * 3];
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], c[a]);
+                hi[a] = std::max(hi[a], c[a]);
+            }
+        }
+        int axis = 0;
+        if (hi[1] - lo[1] > hi[axis] - lo[axis]) axis = 1;
+        if (hi[2] - lo[2] > hi[axis] - lo[axis]) axis = 2;
+        const uint32_t mid = b + (e - b) / 2;
+        std::nth_element(m_slotObject.begin() + b, m_slotObject.begin() + mid, m_slotObject.begin() + e,
+            [this, axis](uint32_t x, uint32_t y) { return m_centroid[x * 3 + axis] < m_centroid[y * 3 + axis]; });
+        return mid;
+    };
+
+    uint32_t ranges[5] = { begin, end };
+    uint32_t parts = 1;
+    if (end - begin > kLeafSize) {
+        const uint32_t mid = split(begin, end);
+        uint32_t r = 0;
+        ranges[r++] = begin;
+        if (mid - begin > kLeafSize) ranges[r++] = split(begin, mid);
+        ranges[r++] = mid;
+        if (end - mid > kLeafSize) ranges[r++] = split(mid, end);
+        ranges[r] = end;
+        parts = r;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodeParent.push_back(0); // set by the caller
+    m_nodes[index].childCount = parts;
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+        // Unused lanes stay valid memory; childCount masks them out
+        if (lane >= parts) {
+            SetLane(m_nodes[index], lane, begin, begin);
+            continue;
+        }
+        SetLane(m_nodes[index], lane, ranges[lane], ranges[lane + 1]);
+        if (ranges[lane + 1] - ranges[lane] > kLeafSize) {
+            const uint32_t child = BuildNode(ranges[lane], ranges[lane + 1]);
+            m_nodes[index].child[lane] = child;
+            m_nodeParent[child] = index;
+        } else {
+            for (uint32_t s = ranges[lane]; s < ranges[lane + 1]; ++s) m_slotNode[s] = index;
+        }
+    }
+    return index;
+}
+
+void Bvh::SetLane(Node& node, int lane, uint32_t begin, uint32_t end)
+{
+    node.child[lane] = kLeaf;
+    node.first[lane] = begin;
+    node.count[lane] = end - begin;
+    for (int k = 0; k < 6; ++k) node.box[k][lane] = 0.0f;
+}
+
+void Bvh::RefitLane(Node& node, int lane)
+{
+    float box[6] = { FLT_MAX, FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    if (node.child[lane] == kLeaf) {
+        for (uint32_t s = node.first[lane]; s < node.first[lane] + node.count[lane]; ++s) {
+            for (int k = 0; k < 3; ++k) box[k] = std::min(box[k], m_slotBox[k][s]);
+            for (int k = 3; k < 6; ++k) box[k] = std::max(box[k], m_slotBox[k][s]);
+        }
+    } else {
+        const Node& child = m_nodes[node.child[lane]];
+        for (uint32_t c = 0; c < child.childCount; ++c) {
+            for (int k = 0; k < 3; ++k) box[k] = std::min(box[k], child.box[k][c]);
+            for (int k = 3; k < 6; ++k) box[k] = std::max(box[k], child.box[k][c]);
+        }
+    }
+    // Area is what a traversal pays for; new lanes start from zero boxes
+    m_cost -= HalfArea(node.box, lane);
+    for (int k = 0; k < 6; ++k) node.box[k][lane] = box[k];
+    m_cost += HalfArea(node.box, lane);
+}
+
+void Bvh::SetBox(uint32_t id, const Aabb& box)
+{
+    const uint32_t s = m_objectSlot[id];
+    m_slotBox[0][s] = box.min.x; m_slotBox[1][s] = box.min.y; m_slotBox[2][s] = box.min.z;
+    m_slotBox[3][s] = box.max.x; m_slotBox[4][s] = box.max.y; m_slotBox[5][s] = box.max.z;
+    m_nodeDirty[m_slotNode[s]] = 1;
+    m_dirty = true;
+}
+
+bool Bvh::Refit()
+{
+    if (!m_dirty) return false;
+    m_dirty = false;
+    // Only the paths from changed leaves to the root; a parent's index is
+    // lower than its children's, so it is reached after all of them
+    for (size_t n = m_nodes.size(); n-- > 0;) {
+        if (!m_nodeDirty[n]) continue;
+        m_nodeDirty[n] = 0;
+        for (uint32_t lane = 0; lane < m_nodes[n].childCount; ++lane) RefitLane(m_nodes[n], lane);
+        if (m_nodeParent[n] != kLeaf) m_nodeDirty[m_nodeParent[n]] = 1;
+    }
+    if (m_cost <= m_builtCost * kRebuildCost) return false;
+
+    std::vector<Aabb> boxes(m_objectSlot.size());
+    for (uint32_t id = 0; id < boxes.size(); ++id) {
+        const uint32_t s = m_objectSlot[id];
+        boxes[id].min = XMFLOAT3(m_slotBox[0][s], m_slotBox[1][s], m_slotBox[2][s]);
+        boxes[id].max = XMFLOAT3(m_slotBox[3][s], m_slotBox[4][s], m_slotBox[5][s]);
+    }
+    Build(boxes.data(), static_cast<uint32_t>(boxes.size()));
+    return true;
+}
+
+void Bvh::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    USU_PROFILE_ZONE("Cull");
+    m_stats = BvhCullStats();
+    if (m_nodes.empty()) return;
+    const size_t visibleBefore = visible.size();
+
+    CullPlane planes[6];
+    for (int p = 0; p < 6; ++p) {
+        const float n[3] = { frustum.planes[p].x, frustum.planes[p].y, frustum.planes[p].z };
+        for (int a = 0; a < 3; ++a) {
+            planes[p].n[a] = Splat(n[a]);
+            planes[p].far[a] = n[a] >= 0.0f ? a + 3 : a;
+            planes[p].near[a] = n[a] >= 0.0f ? a : a + 3;
+        }
+        planes[p].d = Splat(frustum.planes[p].w);
+    }
+
+    // Median splits keep the depth near log4(objects); three pending
+    // siblings per level at most
+    uint32_t stack[128];
+    uint32_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        ++m_stats.nodes;
+        const float* const box[6] = { node.box[0], node.box[1], node.box[2], node.box[3], node.box[4], node.box[5] };
+        const uint32_t valid = (1u << node.childCount) - 1;
+        uint32_t out = 0, cross = 0;
+        TestBoxes(planes, box, valid, out, &cross);
+
+        for (uint32_t lane = 0; lane < node.childCount; ++lane) {
+            if (out & (1u << lane)) continue;
+            const uint32_t first = node.first[lane], count = node.count[lane];
+            if (!(cross & (1u << lane))) {
+                visible.insert(visible.end(), m_slotObject.begin() + first, m_slotObject.begin() + first + count);
+            } else if (node.child[lane] != kLeaf) {
+                stack[top++] = node.child[lane];
+            } else {
+                ++m_stats.leaves;
+                const float* const objects[6] = {
+                    m_slotBox[0].data() + first, m_slotBox[1].data() + first, m_slotBox[2].data() + first,
+                    m_slotBox[3].data() + first, m_slotBox[4].data() + first, m_slotBox[5].data() + first,
+                };
+                const uint32_t objectsValid = (1u << count) - 1;
+                uint32_t objectsOut = 0;
+                TestBoxes(planes, objects, objectsValid, objectsOut, nullptr);
+                for (uint32_t k = 0; k < count; ++k) {
+                    if (!(objectsOut & (1u << k))) visible.push_back(m_slotObject[first + k]);
+                }
+            }
+        }
+    }
+    m_stats.visible = static_cast<uint32_t>(visible.size() - visibleBefore);
+}
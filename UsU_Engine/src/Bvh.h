@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+struct BvhCullStats
+{
+    uint32_t nodes = 0;   // internal nodes visited
+    uint32_t leaves = 0;  // leaves whose objects were tested one by one
+    uint32_t visible = 0;
+};
+
+// Four-wide bounding volume hierarchy over world-space object boxes for
+// frustum culling. Every node stores its children's boxes as structure of
+// arrays, so one SIMD compare (SSE2 where available) tests four boxes
+// against a plane; leaves hold up to four objects tested the same way.
+// Subtrees entirely inside the frustum are appended without further tests.
+// Objects that move go through SetBox + Refit, which regrows the boxes over
+// the existing tree and rebuilds it when refitting has loosened it too far.
+class Bvh
+{
+public:
+    // Replaces the tree; boxes[i] is object i
+    void Build(const Aabb* boxes, uint32_t count);
+    void Clear();
+    uint32_t GetObjectCount() const { return static_cast<uint32_t>(m_objectSlot.size()); }
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_nodes.size()); }
+
+    // Takes effect at the next Refit
+    void SetBox(uint32_t id, const Aabb& box);
+    // Returns true when it rebuilt instead of refitting
+    bool Refit();
+
+    // Appends the ids of objects whose box is not entirely outside a plane
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+    const BvhCullStats& GetLastCullStats() const { return m_stats; }
+
+private:
+    static const uint32_t kLeaf = ~0u;
+
+    struct alignas(16) Node
+    {
+        float box[6][4];      // minX, minY, minZ, maxX, maxY, maxZ by child
+        uint32_t child[4];    // node index, or kLeaf
+        uint32_t first[4];    // slots under the child, contiguous
+        uint32_t count[4];
+        uint32_t childCount;
+    };
+
+    uint32_t BuildNode(uint32_t begin, uint32_t end);
+    void SetLane(Node& node, int lane, uint32_t begin, uint32_t end);
+    void RefitLane(Node& node, int lane);
+
+    std::vector<Node> m_nodes;           // parents before children, root at 0
+    std::vector<uint32_t> m_nodeParent;  // kLeaf for the root
+    std::vector<uint8_t> m_nodeDirty;    // holds a box set since the last Refit
+    std::vector<float> m_slotBox[6];     // object boxes in tree order, padded by 3
+    std::vector<uint32_t> m_slotObject;  // tree order -> object id
+    std::vector<uint32_t> m_objectSlot;  // object id -> tree order
+    std::vector<uint32_t> m_slotNode;    // node whose leaf lane holds the slot
+    std::vector<float> m_centroid;       // build scratch, xyz by object
+    double m_builtCost = 0.0;
+    double m_cost = 0.0;                 // summed half surface area of every child box
+    bool m_dirty = false;
+    mutable BvhCullStats m_stats;
+};
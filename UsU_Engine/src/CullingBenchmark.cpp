@@ -0,0 +1,116 @@
+#include "CullingBenchmark.h"
+#include "Bvh.h"
+#include <windows.h>
+#include <DirectXMath.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace DirectX;
+
+// xorshift32 in [0, 1): the same scene on every run
+static float Random01(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Car-sized box at (x, z) turned by yaw
+static Aabb PlaceBox(float x, float z, float yaw)
+{
+    Aabb local;
+    local.min = XMFLOAT3(-0.9f, 0.0f, -2.2f);
+    local.max = XMFLOAT3(0.9f, 1.4f, 2.2f);
+    XMFLOAT4X4 world;
+    XMStoreFloat4x4(&world, XMMatrixRotationY(yaw) * XMMatrixTranslation(x, 0.0f, z));
+    return TransformAabb(local, world);
+}
+
+void BenchmarkCulling(uint32_t objectCount, int frames)
+{
+    typedef std::chrono::steady_clock Clock;
+    if (objectCount == 0) return;
+    if (frames < 1) frames = 1;
+
+    // About one car per 3x3 units, camera in the middle of the lot
+    const float half = 1.5f * std::sqrt(static_cast<float>(objectCount));
+    uint32_t seed = 0x9E3779B9u;
+    std::vector<Aabb> boxes(objectCount);
+    std::vector<XMFLOAT3> places(objectCount); // x, z, yaw
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        places[i] = XMFLOAT3((Random01(seed) * 2.0f - 1.0f) * half, (Random01(seed) * 2.0f - 1.0f) * half, Random01(seed) * XM_2PI);
+        boxes[i] = PlaceBox(places[i].x, places[i].y, places[i].z);
+    }
+
+    Bvh bvh;
+    auto t0 = Clock::now();
+    bvh.Build(boxes.data(), objectCount);
+    const double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, half);
+    const uint32_t movedPerFrame = (std::max)(1u, objectCount / 100);
+    std::vector<uint32_t> bruteVisible, bvhVisible;
+    bruteVisible.reserve(objectCount);
+    bvhVisible.reserve(objectCount);
+    double bruteMs = 0.0, bvhMs = 0.0, refitMs = 0.0;
+    uint64_t visibleTotal = 0, nodesTotal = 0;
+    int rebuilds = 0, mismatches = 0;
+    for (int f = 0; f < frames; ++f) {
+        // Drive a slice of the cars forward
+        for (uint32_t k = 0; k < movedPerFrame; ++k) {
+            const uint32_t i = (f * movedPerFrame + k) % objectCount;
+            places[i].x = (std::min)(half, (std::max)(-half, places[i].x + 0.5f * std::sin(places[i].z)));
+            places[i].y = (std::min)(half, (std::max)(-half, places[i].y + 0.5f * std::cos(places[i].z)));
+            boxes[i] = PlaceBox(places[i].x, places[i].y, places[i].z);
+            bvh.SetBox(i, boxes[i]);
+        }
+        t0 = Clock::now();
+        rebuilds += bvh.Refit() ? 1 : 0;
+        refitMs += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        const float yaw = XM_2PI * f / frames;
+        const XMMATRIX view = XMMatrixLookToLH(XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f),
+            XMVectorSet(std::sin(yaw), -0.1f, std::cos(yaw), 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, view * proj);
+        const Frustum frustum = ExtractFrustum(viewProj);
+
+        bruteVisible.clear();
+        t0 = Clock::now();
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            if (IsAabbVisible(frustum, boxes[i])) bruteVisible.push_back(i);
+        }
+        bruteMs += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        bvhVisible.clear();
+        t0 = Clock::now();
+        bvh.Cull(frustum, bvhVisible);
+        bvhMs += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        nodesTotal += bvh.GetLastCullStats().nodes;
+        visibleTotal += bvhVisible.size();
+
+        std::sort(bvhVisible.begin(), bvhVisible.end());
+        if (bvhVisible != bruteVisible) ++mismatches;
+    }
+
+    const double culled = 100.0 * (1.0 - static_cast<double>(visibleTotal) / (static_cast<double>(objectCount) * frames));
+    char msg[192];
+    sprintf_s(msg, "[Cull] %u objects, %d frames: BVH build %.2f ms, %u nodes\n", objectCount, frames, buildMs, bvh.GetNodeCount());
+    OutputDebugStringA(msg);
+    sprintf_s(msg, "[Cull] %-12s %8.3f ms/cull  %5.1f%% culled\n", "brute force", bruteMs / frames, culled);
+    OutputDebugStringA(msg);
+    sprintf_s(msg, "[Cull] %-12s %8.3f ms/cull  %5.1f%% culled  %llu nodes/cull\n", "BVH", bvhMs / frames, culled,
+        static_cast<unsigned long long>(nodesTotal / frames));
+    OutputDebugStringA(msg);
+    sprintf_s(msg, "[Cull] %-12s %8.3f ms/frame (%u moved), %d rebuild(s)%s\n", "refit", refitMs / frames, movedPerFrame,
+        rebuilds, mismatches ? "" : ", visible sets match");
+    OutputDebugStringA(msg);
+    if (mismatches) {
+        sprintf_s(msg, "[Cull] visible sets differ in %d of %d frames\n", mismatches, frames);
+        OutputDebugStringA(msg);
+    }
+}
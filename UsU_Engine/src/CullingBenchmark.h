@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+
+// Scatters objectCount car-sized boxes over a square lot, then for each
+// frame turns the camera a step, moves 1% of the boxes, and culls them
+// against the frustum by brute force (IsAabbVisible per box) and through a
+// refitted Bvh. Logs time per cull, percent culled and refit cost as
+// "[Cull] ..." lines, and flags any frame where the two visible sets differ.
+void BenchmarkCulling(uint32_t objectCount = 100000, int frames = 120);
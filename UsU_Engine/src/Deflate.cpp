@@ -0,0 +1,166 @@
+#include "Deflate.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int kWindowBits = 15;
+const size_t kWindowSize = size_t(1) << kWindowBits;
+const int kHashBits = 15;
+const int kMinMatch = 3;
+const int kMaxMatch = 258;
+const int kMaxChain = 16;   // candidates tried per position
+const int kGoodMatch = 64;  // stop searching once a match is this long
+
+struct BitWriter
+{
+    std::vector<uint8_t>& out;
+    uint64_t bits = 0;
+    int count = 0;
+
+    explicit BitWriter(std::vector<uint8_t>& o) : out(o) {}
+    void Put(uint32_t v, int n)
+    {
+        bits |= static_cast<uint64_t>(v) << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+    void Flush()
+    {
+        if (count > 0) out.push_back(static_cast<uint8_t>(bits));
+        bits = 0;
+        count = 0;
+    }
+};
+
+} // namespace
+
+static const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t kDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                                        513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t kDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+                                        8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Huffman codes are sent most significant bit first
+static uint32_t Reverse(uint32_t code, int n)
+{
+    uint32_t r = 0;
+    for (int i = 0; i < n; ++i) {
+        r = (r << 1) | (code & 1);
+        code >>= 1;
+    }
+    return r;
+}
+
+// Fixed literal/length code (RFC 1951 3.2.6)
+static void PutSymbol(BitWriter& w, int sym)
+{
+    if (sym < 144)      w.Put(Reverse(0x30 + sym, 8), 8);
+    else if (sym < 256) w.Put(Reverse(0x190 + sym - 144, 9), 9);
+    else if (sym < 280) w.Put(Reverse(sym - 256, 7), 7);
+    else                w.Put(Reverse(0xC0 + sym - 280, 8), 8);
+}
+
+static void PutMatch(BitWriter& w, int length, int distance)
+{
+    int l = 28;
+    while (kLengthBase[l] > length) --l;
+    PutSymbol(w, 257 + l);
+    if (kLengthExtra[l]) w.Put(length - kLengthBase[l], kLengthExtra[l]);
+    int d = 29;
+    while (kDistBase[d] > distance) --d;
+    w.Put(Reverse(d, 5), 5);
+    if (kDistExtra[d]) w.Put(distance - kDistBase[d], kDistExtra[d]);
+}
+
+static uint32_t Hash3(const uint8_t* p)
+{
+    const uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+static uint32_t Adler32(const uint8_t* data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        // 5552 bytes is the most that can be summed before b overflows
+        const size_t n = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < n; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += n;
+        size -= n;
+    }
+    return (b << 16) | a;
+}
+
+void DeflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+    out.clear();
+    out.reserve(size / 2 + 64);
+    out.push_back(0x78); // deflate, 32 KB window
+    out.push_back(0x01); // fastest, check bits
+    BitWriter w(out);
+    w.Put(1, 1); // final block
+    w.Put(1, 2); // fixed Huffman
+
+    // head: last position per hash (+1, 0 = none); prev: chain within the window
+    std::vector<uint32_t> head(size_t(1) << kHashBits, 0);
+    std::vector<uint32_t> prev(kWindowSize, 0);
+    size_t pos = 0;
+    while (pos < size) {
+        int bestLength = 0;
+        size_t bestDistance = 0;
+        if (pos + kMinMatch <= size) {
+            const uint32_t h = Hash3(data + pos);
+            const int maxLength = static_cast<int>(std::min<size_t>(kMaxMatch, size - pos));
+            uint32_t candidate = head[h];
+            for (int chain = 0; candidate && chain < kMaxChain; ++chain) {
+                const size_t c = candidate - 1;
+                if (pos - c > kWindowSize - 1) break;
+                if (data[c + bestLength] == data[pos + bestLength]) {
+                    int length = 0;
+                    while (length < maxLength && data[c + length] == data[pos + length]) ++length;
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = pos - c;
+                        if (length >= kGoodMatch || length == maxLength) break;
+                    }
+                }
+                const uint32_t next = prev[c & (kWindowSize - 1)];
+                if (next == 0 || next - 1 >= c) break;
+                candidate = next;
+            }
+        }
+
+        const size_t advance = bestLength >= kMinMatch ? static_cast<size_t>(bestLength) : 1;
+        if (bestLength >= kMinMatch) PutMatch(w, bestLength, static_cast<int>(bestDistance));
+        else PutSymbol(w, data[pos]);
+
+        // Index every position covered, so later matches can start inside this one
+        for (const size_t end = pos + advance; pos < end; ++pos) {
+            if (pos + kMinMatch > size) continue;
+            const uint32_t h = Hash3(data + pos);
+            prev[pos & (kWindowSize - 1)] = head[h];
+            head[h] = static_cast<uint32_t>(pos + 1);
+        }
+    }
+    PutSymbol(w, 256);
+    w.Flush();
+
+    const uint32_t adler = Adler32(data, size);
+    out.push_back(static_cast<uint8_t>(adler >> 24));
+    out.push_back(static_cast<uint8_t>(adler >> 16));
+    out.push_back(static_cast<uint8_t>(adler >> 8));
+    out.push_back(static_cast<uint8_t>(adler));
+}
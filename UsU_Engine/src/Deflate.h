@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// zlib stream (RFC 1950/1951) compression, the writing side of InflateZlib:
+// greedy LZ77 over a 32 KB window with the fixed Huffman code. Ratio is well
+// below zlib's but it is fast and small, which is what PNG output needs.
+// Replaces the contents of out.
+void DeflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
@@ -0,0 +1,396 @@
+#include "FshArchive.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static const size_t kFshRecordSize = 16;
+
+static inline uint16_t Read16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+static inline uint32_t Read32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline uint8_t Expand4(uint32_t v) { return static_cast<uint8_t>(v * 17); }
+static inline uint8_t Expand5(uint32_t v) { return static_cast<uint8_t>((v << 3) | (v >> 2)); }
+static inline uint8_t Expand6(uint32_t v) { return static_cast<uint8_t>((v << 2) | (v >> 4)); }
+
+static bool IsPaletteCode(uint8_t code)
+{
+    // 24-bit DOS (6 bits per channel), 24-bit, 16-bit 565, 32-bit, 16-bit 1555
+    return code == 0x22 || code == 0x24 || code == 0x29 || code == 0x2A || code == 0x2D;
+}
+
+static uint32_t PaletteEntryBytes(uint8_t code)
+{
+    switch (code) {
+    case 0x22: case 0x24: return 3;
+    case 0x2A: return 4;
+    default:   return 2;
+    }
+}
+
+static void PaletteColor(uint8_t code, const uint8_t* p, uint8_t rgba[4])
+{
+    switch (code) {
+    case 0x22: rgba[0] = static_cast<uint8_t>(p[0] << 2); rgba[1] = static_cast<uint8_t>(p[1] << 2);
+               rgba[2] = static_cast<uint8_t>(p[2] << 2); rgba[3] = 255; break;
+    case 0x24: rgba[0] = p[2]; rgba[1] = p[1]; rgba[2] = p[0]; rgba[3] = 255; break;
+    case 0x2A: rgba[0] = p[2]; rgba[1] = p[1]; rgba[2] = p[0]; rgba[3] = p[3]; break;
+    case 0x29: {
+        const uint32_t v = Read16(p);
+        rgba[0] = Expand5((v >> 11) & 31); rgba[1] = Expand6((v >> 5) & 63); rgba[2] = Expand5(v & 31); rgba[3] = 255;
+        break;
+    }
+    default: {
+        const uint32_t v = Read16(p);
+        rgba[0] = Expand5((v >> 10) & 31); rgba[1] = Expand5((v >> 5) & 31); rgba[2] = Expand5(v & 31);
+        rgba[3] = (v & 0x8000) ? 255 : 0;
+        break;
+    }
+    }
+}
+
+static FshFormat ToFshFormat(uint8_t code)
+{
+    switch (code) {
+    case 0x60: case 0x61: case 0x6D: case 0x78: case 0x7B: case 0x7D: case 0x7E: case 0x7F:
+        return static_cast<FshFormat>(code);
+    default:
+        return FshFormat::Unknown;
+    }
+}
+
+// Bytes per pixel of the uncompressed formats
+static uint32_t FshPixelBytes(FshFormat format)
+{
+    switch (format) {
+    case FshFormat::A8R8G8B8: return 4;
+    case FshFormat::R8G8B8:   return 3;
+    case FshFormat::Indexed8: return 1;
+    default:                  return 2;
+    }
+}
+
+const char* FshFormatName(FshFormat format)
+{
+    switch (format) {
+    case FshFormat::DXT1:     return "DXT1";
+    case FshFormat::DXT3:     return "DXT3";
+    case FshFormat::A4R4G4B4: return "A4R4G4B4";
+    case FshFormat::R5G6B5:   return "R5G6B5";
+    case FshFormat::Indexed8: return "8-bit indexed";
+    case FshFormat::A8R8G8B8: return "A8R8G8B8";
+    case FshFormat::A1R5G5B5: return "A1R5G5B5";
+    case FshFormat::R8G8B8:   return "R8G8B8";
+    default:                  return "unknown";
+    }
+}
+
+bool IsQfsCompressed(const uint8_t* data, size_t size)
+{
+    return size >= 5 && (data[0] & 0xFE) == 0x10 && data[1] == 0xFB;
+}
+
+bool DecompressQfs(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+    out.clear();
+    if (!IsQfsCompressed(data, size)) return false;
+    size_t pos = 2;
+    if (data[0] & 0x01) pos += 3; // stored compressed size
+    if (pos + 3 > size) return false;
+    const size_t outSize = (size_t(data[pos]) << 16) | (size_t(data[pos + 1]) << 8) | data[pos + 2];
+    pos += 3;
+    out.resize(outSize);
+
+    size_t w = 0;
+    auto literal = [&](size_t count) {
+        if (pos + count > size || w + count > outSize) return false;
+        memcpy(out.data() + w, data + pos, count);
+        pos += count;
+        w += count;
+        return true;
+    };
+    auto copy = [&](size_t offset, size_t count) {
+        if (offset > w || w + count > outSize) return false;
+        for (size_t i = 0; i < count; ++i, ++w) out[w] = out[w - offset]; // may overlap
+        return true;
+    };
+
+    while (pos < size) {
+        const uint8_t c = data[pos];
+        if (c < 0x80) {
+            if (pos + 2 > size) return false;
+            const uint8_t b1 = data[pos + 1];
+            pos += 2;
+            if (!literal(c & 3)) return false;
+            if (!copy(((c & 0x60u) << 3) + b1 + 1, ((c & 0x1Cu) >> 2) + 3)) return false;
+        } else if (c < 0xC0) {
+            if (pos + 3 > size) return false;
+            const uint8_t b1 = data[pos + 1], b2 = data[pos + 2];
+            pos += 3;
+            if (!literal(b1 >> 6)) return false;
+            if (!copy(((b1 & 0x3Fu) << 8) + b2 + 1, (c & 0x3Fu) + 4)) return false;
+        } else if (c < 0xE0) {
+            if (pos + 4 > size) return false;
+            const uint8_t b1 = data[pos + 1], b2 = data[pos + 2], b3 = data[pos + 3];
+            pos += 4;
+            if (!literal(c & 3)) return false;
+            if (!copy(((c & 0x10u) << 12) + (size_t(b1) << 8) + b2 + 1, ((c & 0x0Cu) << 6) + b3 + 5)) return false;
+        } else if (c < 0xFC) {
+            pos += 1;
+            if (!literal(((c & 0x1Fu) << 2) + 4)) return false;
+        } else {
+            pos += 1;
+            if (!literal(c & 3)) return false;
+            break; // end of stream
+        }
+    }
+    return w == outSize;
+}
+
+bool FshArchive::Open(const std::wstring& path)
+{
+    Close();
+    if (!m_file.Open(path) || m_file.Size() == 0) { Close(); return false; }
+
+    const uint8_t* data = m_file.Data();
+    const size_t size = m_file.Size();
+    static const char kIndexBanner[] = "FSHTool generated file";
+    bool ok = false;
+    if (size >= sizeof(kIndexBanner) - 1 && memcmp(data, kIndexBanner, sizeof(kIndexBanner) - 1) == 0) {
+        const size_t slash = path.find_last_of(L"/\\");
+        const std::wstring dir = (slash == std::wstring::npos) ? std::wstring() : path.substr(0, slash + 1);
+        m_isIndex = true;
+        ok = ParseIndex(reinterpret_cast<const char*>(data), size, dir);
+        m_file.Close();
+    } else if (IsQfsCompressed(data, size)) {
+        ok = DecompressQfs(data, size, m_decompressed) && ParseBinary(m_decompressed.data(), m_decompressed.size());
+        m_file.Close();
+    } else {
+        ok = ParseBinary(data, size);
+    }
+    if (!ok) Close();
+    return ok;
+}
+
+void FshArchive::Close()
+{
+    m_file.Close();
+    m_decompressed.clear();
+    m_decompressed.shrink_to_fit();
+    m_entries.clear();
+    m_tag.clear();
+    m_isIndex = false;
+}
+
+bool FshArchive::ParseBinary(const uint8_t* data, size_t size)
+{
+    if (size < 16 || memcmp(data, "SHPI", 4) != 0) return false;
+    const uint32_t count = Read32(data + 8);
+    m_tag.assign(reinterpret_cast<const char*>(data + 12), 4);
+    if (count > (size - 16) / 8) return false;
+
+    struct DirEntry { std::string name; uint32_t offset; };
+    std::vector<DirEntry> dir(count);
+    std::vector<uint32_t> starts;
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint8_t* d = data + 16 + i * 8;
+        dir[i].name.assign(reinterpret_cast<const char*>(d), strnlen(reinterpret_cast<const char*>(d), 4));
+        dir[i].offset = Read32(d + 4);
+        starts.push_back(dir[i].offset);
+    }
+    std::sort(starts.begin(), starts.end());
+
+    // An entry (with its attachments) runs up to the next entry or the end
+    auto entryEnd = [&](uint32_t offset) -> size_t {
+        auto it = std::upper_bound(starts.begin(), starts.end(), offset);
+        return it == starts.end() ? size : std::min<size_t>(*it, size);
+    };
+
+    const uint8_t* globalPalette = nullptr;
+    uint8_t globalPaletteCode = 0;
+    uint32_t globalPaletteColors = 0;
+
+    for (const DirEntry& d : dir) {
+        if (d.offset + kFshRecordSize > size) return false;
+        const size_t end = entryEnd(d.offset);
+        const uint8_t* rec = data + d.offset;
+        const uint32_t id = Read32(rec);
+        const uint8_t code = static_cast<uint8_t>(id & 0xFF);
+        size_t blockSize = id >> 8;
+
+        FshEntry e;
+        e.name = d.name;
+        e.code = code;
+        e.width = Read16(rec + 4);
+        e.height = Read16(rec + 6);
+        e.mipCount = 1 + (Read16(rec + 14) >> 12); // high nibble of the y position field
+        e.pixels = rec + kFshRecordSize;
+        const size_t dataEnd = blockSize ? std::min(end, d.offset + blockSize) : end;
+        e.pixelBytes = dataEnd > d.offset + kFshRecordSize ? dataEnd - d.offset - kFshRecordSize : 0;
+
+        if (IsPaletteCode(code)) {
+            // "!pal" is the archive-wide palette for 8-bit entries
+            if (d.name == "!pal") {
+                globalPalette = e.pixels;
+                globalPaletteCode = code;
+                globalPaletteColors = std::min<uint32_t>(e.width, static_cast<uint32_t>(e.pixelBytes / PaletteEntryBytes(code)));
+            }
+            continue;
+        }
+        // Bit 7 marks a bitmap compressed on its own; not used by our assets
+        e.format = (code & 0x80) ? FshFormat::Unknown : ToFshFormat(code);
+
+        // Attachments (palette, text, hotspots) follow the bitmap, chained by
+        // block size. A block shorter than its own record header is corrupt
+        // and ends the chain.
+        size_t next = d.offset + blockSize;
+        while (blockSize >= kFshRecordSize && next + kFshRecordSize <= end) {
+            const uint8_t* att = data + next;
+            const uint32_t attId = Read32(att);
+            const uint8_t attCode = static_cast<uint8_t>(attId & 0xFF);
+            blockSize = attId >> 8;
+            if (blockSize && blockSize < kFshRecordSize) break;
+            if (IsPaletteCode(attCode)) {
+                // The colors must fit in what is left of the block (or entry)
+                const size_t attEnd = blockSize ? std::min(end, next + blockSize) : end;
+                e.palette = att + kFshRecordSize;
+                e.paletteCode = attCode;
+                e.paletteColors = std::min<uint32_t>(Read16(att + 4),
+                    static_cast<uint32_t>((attEnd - next - kFshRecordSize) / PaletteEntryBytes(attCode)));
+            }
+            next += blockSize;
+        }
+        m_entries.push_back(e);
+    }
+
+    for (FshEntry& e : m_entries) {
+        if (e.format == FshFormat::Indexed8 && !e.palette && globalPalette) {
+            e.palette = globalPalette;
+            e.paletteCode = globalPaletteCode;
+            e.paletteColors = globalPaletteColors;
+        }
+    }
+    return true;
+}
+
+static std::wstring Widen(const std::string& s)
+{
+    return std::wstring(s.begin(), s.end());
+}
+
+// Width and height from a BMP header, without decoding it
+static void ReadBmpSize(const std::wstring& path, uint32_t& width, uint32_t& height)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.Size() < 26 || file.Data()[0] != 'B' || file.Data()[1] != 'M') return;
+    const int32_t w = static_cast<int32_t>(Read32(file.Data() + 18));
+    const int32_t h = static_cast<int32_t>(Read32(file.Data() + 22));
+    width = static_cast<uint32_t>(w < 0 ? -w : w);
+    height = static_cast<uint32_t>(h < 0 ? -h : h);
+}
+
+bool FshArchive::ParseIndex(const char* text, size_t size, const std::wstring& dir)
+{
+    // Layout written by FSHTool:
+    //   SHPI <n> objects, tag <tag>
+    //   <name> <image file>              starts an entry
+    //   <type> <hex code> [+<mips>] ...  format of the original bitmap
+    //   alpha <image file>               optional separate alpha plane
+    // Other lines (BUFSZ, !PAD, ETXT, ...) describe padding and attachments.
+    const char* p = text;
+    const char* end = text + size;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!eol) eol = end;
+        std::vector<std::string> tokens;
+        const char* q = p;
+        while (q < eol) {
+            while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r')) ++q;
+            const char* s = q;
+            while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') ++q;
+            if (q > s) tokens.emplace_back(s, q);
+        }
+        p = (eol < end) ? eol + 1 : end;
+        if (tokens.empty()) continue;
+
+        const std::string& t0 = tokens[0];
+        if (t0 == "SHPI") {
+            if (tokens.size() >= 5 && tokens[3] == "tag") m_tag = tokens[4];
+        } else if (t0 == "alpha") {
+            if (!m_entries.empty() && tokens.size() >= 2) m_entries.back().alphaFile = dir + Widen(tokens[1]);
+        } else if (tokens.size() >= 2 && !m_entries.empty() && m_entries.back().code == 0 &&
+                   (t0 == "BMP" || t0 == "PNG")) {
+            FshEntry& e = m_entries.back();
+            e.code = static_cast<uint8_t>(strtoul(tokens[1].c_str(), nullptr, 16));
+            e.format = ToFshFormat(e.code);
+            if (tokens.size() >= 3 && tokens[2][0] == '+')
+                e.mipCount = 1 + static_cast<uint32_t>(strtoul(tokens[2].c_str() + 1, nullptr, 10));
+        } else if (tokens.size() == 2 && t0[0] != '#' && t0[0] != '!' && tokens[1].find('.') != std::string::npos) {
+            FshEntry e;
+            e.name = t0;
+            e.colorFile = dir + Widen(tokens[1]);
+            ReadBmpSize(e.colorFile, e.width, e.height);
+            m_entries.push_back(e);
+        }
+    }
+    return !m_entries.empty();
+}
+
+bool FshArchive::Decode(size_t index, TextureData& out) const
+{
+    if (index >= m_entries.size()) return false;
+    const FshEntry& e = m_entries[index];
+    if (!e.pixels || e.width == 0 || e.height == 0 || e.format == FshFormat::Unknown) return false;
+
+    if (e.format == FshFormat::DXT1 || e.format == FshFormat::DXT3) {
+        // Native blocks straight through; keep as many stored levels as fit
+        const TextureFormat format = (e.format == FshFormat::DXT1) ? TextureFormat::BC1 : TextureFormat::BC2;
+        AllocateTexture(out, format, e.width, e.height, e.mipCount);
+        size_t levels = 0;
+        while (levels < out.mips.size() && out.mips[levels].offset + out.mips[levels].size <= e.pixelBytes) ++levels;
+        if (levels == 0) return false;
+        out.mips.resize(levels);
+        out.bytes.assign(e.pixels, e.pixels + out.mips.back().offset + out.mips.back().size);
+        return true;
+    }
+
+    // Uncompressed levels are stored back to back, each padded to 16 bytes
+    AllocateTexture(out, TextureFormat::RGBA8, e.width, e.height, e.mipCount);
+    const uint32_t bpp = FshPixelBytes(e.format);
+    size_t src = 0, levels = 0;
+    for (; levels < out.mips.size(); ++levels) {
+        const TextureMip& mip = out.mips[levels];
+        const size_t levelBytes = size_t(mip.width) * mip.height * bpp;
+        if (src + levelBytes > e.pixelBytes) break;
+        const uint8_t* s = e.pixels + src;
+        uint8_t* d = out.MipData(levels);
+        const size_t count = size_t(mip.width) * mip.height;
+        for (size_t i = 0; i < count; ++i, d += 4) {
+            switch (e.format) {
+            case FshFormat::A8R8G8B8: d[0] = s[i * 4 + 2]; d[1] = s[i * 4 + 1]; d[2] = s[i * 4 + 0]; d[3] = s[i * 4 + 3]; break;
+            case FshFormat::R8G8B8:   d[0] = s[i * 3 + 2]; d[1] = s[i * 3 + 1]; d[2] = s[i * 3 + 0]; d[3] = 255; break;
+            case FshFormat::A1R5G5B5: PaletteColor(0x2D, s + i * 2, d); break;
+            case FshFormat::R5G6B5:   PaletteColor(0x29, s + i * 2, d); break;
+            case FshFormat::A4R4G4B4: {
+                const uint32_t v = Read16(s + i * 2);
+                d[0] = Expand4((v >> 8) & 15); d[1] = Expand4((v >> 4) & 15); d[2] = Expand4(v & 15); d[3] = Expand4(v >> 12);
+                break;
+            }
+            default: { // Indexed8; grey ramp without a palette
+                const uint8_t c = s[i];
+                if (e.palette && c < e.paletteColors) PaletteColor(e.paletteCode, e.palette + c * PaletteEntryBytes(e.paletteCode), d);
+                else { d[0] = d[1] = d[2] = c; d[3] = 255; }
+                break;
+            }
+            }
+        }
+        src += (levelBytes + 15) & ~size_t(15);
+    }
+    if (levels == 0) return false;
+    out.mips.resize(levels);
+    out.bytes.resize(out.mips.back().offset + out.mips.back().size);
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Texture.h"
+
+// Bitmap record ids of EA's SHPI (.fsh) container
+enum class FshFormat : uint8_t
+{
+    Unknown  = 0,
+    DXT1     = 0x60,
+    DXT3     = 0x61,
+    A4R4G4B4 = 0x6D,
+    R5G6B5   = 0x78,
+    Indexed8 = 0x7B,
+    A8R8G8B8 = 0x7D,
+    A1R5G5B5 = 0x7E,
+    R8G8B8   = 0x7F,
+};
+
+const char* FshFormatName(FshFormat format);
+
+struct FshEntry
+{
+    std::string name;          // 4-character directory tag, e.g. "skin"
+    FshFormat   format = FshFormat::Unknown;
+    uint8_t     code = 0;      // raw record id, kept for formats we do not know
+    uint32_t    width = 0;
+    uint32_t    height = 0;
+    uint32_t    mipCount = 1;  // including the top level
+
+    // Binary archives: native pixel data (all levels) and optional palette
+    const uint8_t* pixels = nullptr;
+    size_t         pixelBytes = 0;
+    const uint8_t* palette = nullptr;
+    uint8_t        paletteCode = 0;
+    uint32_t       paletteColors = 0;
+
+    // FSHTool index: the unpacked image and its separate alpha plane
+    std::wstring colorFile;
+    std::wstring alphaFile;
+};
+
+// Reads either a binary SHPI archive (optionally QFS/RefPack compressed) or
+// the index.fsh text file FSHTool writes next to an unpacked archive.
+// Binary entries point into the mapped (or decompressed) file and stay
+// valid until Close().
+class FshArchive
+{
+public:
+    bool Open(const std::wstring& path);
+    void Close();
+
+    bool IsIndex() const { return m_isIndex; }
+    const std::string& GetTag() const { return m_tag; } // directory id, e.g. "G335"
+    const std::vector<FshEntry>& GetEntries() const { return m_entries; }
+
+    // DXT entries are passed through as BC1/BC2 with their stored mips;
+    // everything else is expanded to RGBA8. Index entries have no pixels
+    // here; load their colorFile/alphaFile instead.
+    bool Decode(size_t entry, TextureData& out) const;
+
+private:
+    bool ParseBinary(const uint8_t* data, size_t size);
+    bool ParseIndex(const char* text, size_t size, const std::wstring& dir);
+
+    MappedFile m_file;
+    std::vector<uint8_t> m_decompressed;
+    std::vector<FshEntry> m_entries;
+    std::string m_tag;
+    bool m_isIndex = false;
+};
+
+// QFS (RefPack) as used for compressed .fsh/.viv payloads.
+bool IsQfsCompressed(const uint8_t* data, size_t size);
+bool DecompressQfs(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
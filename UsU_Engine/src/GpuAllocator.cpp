@@ -0,0 +1,262 @@
+#include "GpuAllocator.h"
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+
+using Microsoft::WRL::ComPtr;
+
+static const uint64_t kPlacementAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT; // 64 KB
+static const uint64_t kPageGranularity = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT; // 256 B
+
+static uint64_t AlignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+static D3D12_RESOURCE_DESC BufferDesc(uint64_t size)
+{
+    D3D12_RESOURCE_DESC desc{};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    desc.Width = size;
+    desc.Height = 1;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    return desc;
+}
+
+static D3D12_RESOURCE_STATES BufferState(GpuMemoryKind kind)
+{
+    return kind == GpuMemoryKind::UploadBuffers ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON;
+}
+
+static const char* KindName(GpuMemoryKind kind)
+{
+    switch (kind) {
+    case GpuMemoryKind::Buffers:       return "buffers";
+    case GpuMemoryKind::UploadBuffers: return "upload";
+    default:                           return "textures";
+    }
+}
+
+bool GpuAllocator::Initialize(ID3D12Device* device, uint64_t heapSize)
+{
+    m_device = device;
+    m_heapSize = AlignUp((std::max)(heapSize, kPageSize), kPlacementAlignment);
+    m_pools.clear();
+    return m_device != nullptr;
+}
+
+uint32_t GpuAllocator::NewPool()
+{
+    for (uint32_t i = 0; i < m_pools.size(); ++i) {
+        if (!m_pools[i].live) return i;
+    }
+    m_pools.push_back(Pool());
+    return static_cast<uint32_t>(m_pools.size() - 1);
+}
+
+bool GpuAllocator::CreateHeapPool(GpuMemoryKind kind, uint64_t minSize, uint32_t& pool)
+{
+    // Tier 1 hardware can't mix buffers and textures in one heap
+    D3D12_HEAP_DESC desc{};
+    desc.SizeInBytes = (std::max)(kind == GpuMemoryKind::UploadBuffers ? kUploadHeapSize : m_heapSize,
+                                  AlignUp(minSize, kPlacementAlignment));
+    desc.Properties.Type = kind == GpuMemoryKind::UploadBuffers ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT;
+    desc.Flags = kind == GpuMemoryKind::Textures ? D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES : D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    ComPtr<ID3D12Heap> heap;
+    if (FAILED(m_device->CreateHeap(&desc, IID_PPV_ARGS(&heap)))) {
+        OutputDebugStringA("[GpuMem] CreateHeap failed\n");
+        return false;
+    }
+
+    pool = NewPool();
+    Pool& p = m_pools[pool];
+    p = Pool();
+    p.live = true;
+    p.kind = kind;
+    p.heap = heap;
+    // Small textures can be placed at 4 KB, everything else at 64 KB
+    p.ranges.Reset(desc.SizeInBytes, kind == GpuMemoryKind::Textures ? D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT : kPlacementAlignment);
+
+    char msg[128];
+    sprintf_s(msg, "[GpuMem] New %s heap %u, %.1f MB\n", KindName(kind), pool, desc.SizeInBytes / (1024.0 * 1024.0));
+    OutputDebugStringA(msg);
+    return true;
+}
+
+bool GpuAllocator::CreatePagePool(GpuMemoryKind kind, uint32_t& pool)
+{
+    uint64_t heapOffset = 0;
+    const uint32_t heap = AllocateRange(kind, false, kPageSize, kPlacementAlignment, heapOffset);
+    if (heap == ~0u) return false;
+    ComPtr<ID3D12Resource> page;
+    if (!CreatePlaced(heap, heapOffset, BufferDesc(kPageSize), BufferState(kind), page)) {
+        FreeRange(heap, heapOffset);
+        return false;
+    }
+    uint8_t* mapped = nullptr;
+    D3D12_RANGE noRead{ 0, 0 };
+    if (kind == GpuMemoryKind::UploadBuffers && FAILED(page->Map(0, &noRead, reinterpret_cast<void**>(&mapped)))) {
+        page.Reset();
+        FreeRange(heap, heapOffset);
+        return false;
+    }
+
+    pool = NewPool();
+    Pool& p = m_pools[pool];
+    p = Pool();
+    p.live = true;
+    p.kind = kind;
+    p.page = page;
+    p.mapped = mapped;
+    p.parent = heap;
+    p.parentOffset = heapOffset;
+    p.ranges.Reset(kPageSize, kPageGranularity);
+    return true;
+}
+
+uint32_t GpuAllocator::AllocateRange(GpuMemoryKind kind, bool page, uint64_t size, uint64_t alignment, uint64_t& offset)
+{
+    for (uint32_t i = 0; i < m_pools.size(); ++i) {
+        Pool& p = m_pools[i];
+        if (!p.live || p.kind != kind || (p.page != nullptr) != page) continue;
+        offset = p.ranges.Allocate(size, alignment);
+        if (offset != TlsfAllocator::kInvalidOffset) return i;
+    }
+
+    // Nothing fits: grow by one heap or page (which may itself add a heap)
+    uint32_t pool = ~0u;
+    if (page ? !CreatePagePool(kind, pool) : !CreateHeapPool(kind, size, pool)) return ~0u;
+    offset = m_pools[pool].ranges.Allocate(size, alignment);
+    return offset == TlsfAllocator::kInvalidOffset ? ~0u : pool;
+}
+
+bool GpuAllocator::CreatePlaced(uint32_t pool, uint64_t poolOffset, const D3D12_RESOURCE_DESC& desc,
+                                D3D12_RESOURCE_STATES initialState, ComPtr<ID3D12Resource>& out)
+{
+    if (pool >= m_pools.size() || !m_pools[pool].heap) return false;
+    return SUCCEEDED(m_device->CreatePlacedResource(m_pools[pool].heap.Get(), poolOffset, &desc, initialState,
+        nullptr, IID_PPV_ARGS(&out)));
+}
+
+bool GpuAllocator::CreateBuffer(uint64_t size, GpuMemoryKind kind, uint64_t alignment, GpuAllocation& out)
+{
+    out = GpuAllocation();
+    if (!m_device || size == 0 || kind == GpuMemoryKind::Textures) return false;
+
+    // Small buffers: a range of a shared page buffer
+    if (size < kSmallBufferSize) {
+        uint64_t offset = 0;
+        const uint32_t pool = AllocateRange(kind, true, size, (std::max)(alignment, uint64_t(1)), offset);
+        if (pool == ~0u) return false;
+        const Pool& p = m_pools[pool];
+        out.resource = p.page;
+        out.offset = offset;
+        out.size = size;
+        out.mapped = p.mapped ? p.mapped + offset : nullptr;
+        out.pool = pool;
+        out.poolOffset = offset;
+        return true;
+    }
+
+    uint64_t heapOffset = 0;
+    const uint32_t pool = AllocateRange(kind, false, size, kPlacementAlignment, heapOffset);
+    if (pool == ~0u) return false;
+    out.pool = pool;
+    out.poolOffset = heapOffset;
+    out.size = size;
+    if (!CreatePlaced(pool, heapOffset, BufferDesc(size), BufferState(kind), out.resource)) {
+        Free(out);
+        return false;
+    }
+    D3D12_RANGE noRead{ 0, 0 };
+    if (kind == GpuMemoryKind::UploadBuffers && FAILED(out.resource->Map(0, &noRead, reinterpret_cast<void**>(&out.mapped)))) {
+        Free(out);
+        return false;
+    }
+    return true;
+}
+
+bool GpuAllocator::CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, GpuAllocation& out)
+{
+    out = GpuAllocation();
+    if (!m_device || (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)))
+        return false;
+
+    // Ask for small placement first; the runtime answers with the default
+    // alignment if the texture doesn't qualify
+    D3D12_RESOURCE_DESC placed = desc;
+    placed.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+    D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &placed);
+    if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+        placed.Alignment = 0;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placed);
+    }
+    if (info.SizeInBytes == UINT64_MAX) return false;
+
+    uint64_t heapOffset = 0;
+    const uint32_t pool = AllocateRange(GpuMemoryKind::Textures, false, info.SizeInBytes, info.Alignment, heapOffset);
+    if (pool == ~0u) return false;
+    out.pool = pool;
+    out.poolOffset = heapOffset;
+    out.size = info.SizeInBytes;
+    if (!CreatePlaced(pool, heapOffset, placed, initialState, out.resource)) {
+        Free(out);
+        return false;
+    }
+    return true;
+}
+
+void GpuAllocator::Free(GpuAllocation& allocation)
+{
+    const uint32_t pool = allocation.pool;
+    const uint64_t offset = allocation.poolOffset;
+    allocation = GpuAllocation(); // drops the placed resource / page reference
+    FreeRange(pool, offset);
+}
+
+void GpuAllocator::FreeRange(uint32_t pool, uint64_t poolOffset)
+{
+    if (pool >= m_pools.size() || !m_pools[pool].live) return;
+    Pool& p = m_pools[pool];
+    p.ranges.Free(poolOffset);
+
+    // Empty pages give their space back to the heap; heaps are kept
+    if (p.page && p.ranges.Empty()) {
+        const uint32_t parent = p.parent;
+        const uint64_t parentOffset = p.parentOffset;
+        p = Pool();
+        FreeRange(parent, parentOffset);
+    }
+}
+
+size_t GpuAllocator::PlanDefragment(uint32_t pool, size_t maxMoves, std::vector<TlsfAllocator::Move>& moves)
+{
+    if (pool >= m_pools.size() || !m_pools[pool].live) return 0;
+    return m_pools[pool].ranges.PlanDefragment(maxMoves, moves);
+}
+
+void GpuAllocator::GetStats(std::vector<GpuPoolStats>& stats) const
+{
+    stats.assign(m_pools.size(), GpuPoolStats());
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        if (!m_pools[i].live) continue; // unused slot, zero capacity
+        stats[i].kind = m_pools[i].kind;
+        stats[i].page = m_pools[i].page != nullptr;
+        stats[i].usage = m_pools[i].ranges.GetStats();
+    }
+}
+
+void GpuAllocator::LogStats() const
+{
+    std::vector<GpuPoolStats> stats;
+    GetStats(stats);
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const TlsfAllocator::Stats& u = stats[i].usage;
+        if (u.capacity == 0) continue;
+        char msg[192];
+        sprintf_s(msg, "[GpuMem] %s %zu (%s): %.2f / %.2f MB, %u alloc(s), %u free block(s), largest free %.2f MB\n",
+            stats[i].page ? "page" : "heap", i, KindName(stats[i].kind), u.usedBytes / (1024.0 * 1024.0),
+            u.capacity / (1024.0 * 1024.0), u.allocationCount, u.freeBlockCount, u.largestFreeBlock / (1024.0 * 1024.0));
+        OutputDebugStringA(msg);
+    }
+}
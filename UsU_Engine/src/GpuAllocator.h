@@ -0,0 +1,93 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <vector>
+#include "TlsfAllocator.h"
+
+enum class GpuMemoryKind
+{
+    Buffers,       // DEFAULT heap buffers, created in COMMON
+    UploadBuffers, // UPLOAD heap buffers, GENERIC_READ and persistently mapped
+    Textures,      // DEFAULT heap non render target / depth textures
+};
+
+// A suballocated range. Small buffers share a page buffer (resource plus
+// offset); larger buffers and textures get their own placed resource at
+// offset 0. Either way GpuAddress() is where the data starts.
+struct GpuAllocation
+{
+    Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+    uint64_t offset = 0; // into resource
+    uint64_t size = 0;
+    uint8_t* mapped = nullptr; // upload buffers only, already offset
+    uint32_t pool = ~0u;       // owning heap or page
+    uint64_t poolOffset = 0;
+
+    bool Valid() const { return resource != nullptr; }
+    D3D12_GPU_VIRTUAL_ADDRESS GpuAddress() const { return resource ? resource->GetGPUVirtualAddress() + offset : 0; }
+};
+
+struct GpuPoolStats
+{
+    GpuMemoryKind kind = GpuMemoryKind::Buffers;
+    bool page = false; // small buffer page inside a heap rather than a heap
+    TlsfAllocator::Stats usage;
+};
+
+// Placed resources in large heaps instead of one committed resource each.
+// Heap space is carved up by TlsfAllocator; buffers below kSmallBufferSize
+// are packed into shared page buffers at 256 byte granularity, so they don't
+// each cost a 64 KB placement.
+class GpuAllocator
+{
+public:
+    static const uint64_t kHeapSize = 64ull << 20;
+    static const uint64_t kUploadHeapSize = 8ull << 20;
+    static const uint64_t kPageSize = 2ull << 20;
+    static const uint64_t kSmallBufferSize = 64ull << 10;
+
+    bool Initialize(ID3D12Device* device, uint64_t heapSize = kHeapSize);
+
+    // alignment applies within pages (e.g. 256 for constant buffers);
+    // placed buffers are always 64 KB aligned
+    bool CreateBuffer(uint64_t size, GpuMemoryKind kind, uint64_t alignment, GpuAllocation& out);
+    // Uses small (4 KB) placement when the texture qualifies
+    bool CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, GpuAllocation& out);
+    // The GPU must be done with the range; empty pages go back to their heap
+    void Free(GpuAllocation& allocation);
+
+    // Indexed like GpuAllocation::pool; unused slots have zero capacity
+    void GetStats(std::vector<GpuPoolStats>& stats) const;
+    void LogStats() const;
+
+    // Defragmentation hook for one pool. Destinations are reserved; for each
+    // move the owner of the range copies it (within the page resource, or
+    // into a resource from CreatePlaced for heaps), rebinds its views and
+    // then calls FreeRange(pool, move.from) once the copy has completed.
+    size_t PlanDefragment(uint32_t pool, size_t maxMoves, std::vector<TlsfAllocator::Move>& moves);
+    bool   CreatePlaced(uint32_t pool, uint64_t poolOffset, const D3D12_RESOURCE_DESC& desc,
+                        D3D12_RESOURCE_STATES initialState, Microsoft::WRL::ComPtr<ID3D12Resource>& out);
+    void   FreeRange(uint32_t pool, uint64_t poolOffset);
+
+private:
+    struct Pool
+    {
+        bool live = false;
+        GpuMemoryKind kind = GpuMemoryKind::Buffers;
+        Microsoft::WRL::ComPtr<ID3D12Heap> heap;     // heaps
+        Microsoft::WRL::ComPtr<ID3D12Resource> page; // pages
+        uint8_t* mapped = nullptr;                   // upload pages
+        uint32_t parent = ~0u;                       // pages: heap pool and offset
+        uint64_t parentOffset = 0;
+        TlsfAllocator ranges;
+    };
+
+    uint32_t AllocateRange(GpuMemoryKind kind, bool page, uint64_t size, uint64_t alignment, uint64_t& offset);
+    uint32_t NewPool();
+    bool     CreateHeapPool(GpuMemoryKind kind, uint64_t minSize, uint32_t& pool);
+    bool     CreatePagePool(GpuMemoryKind kind, uint32_t& pool);
+
+    ID3D12Device* m_device = nullptr;
+    uint64_t m_heapSize = kHeapSize;
+    std::vector<Pool> m_pools;
+};
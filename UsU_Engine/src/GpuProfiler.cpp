@@ -0,0 +1,125 @@
+#include "GpuProfiler.h"
+
+#if USU_PROFILE
+#include <windows.h>
+#include <algorithm>
+
+bool GpuProfiler::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, UINT frameCount)
+{
+    m_queue = queue;
+    m_frameCount = (std::max)(frameCount, 1u);
+    m_frame = 0;
+    m_heap.Reset();
+    if (FAILED(queue->GetTimestampFrequency(&m_frequency)) || m_frequency == 0) return false;
+    LARGE_INTEGER qpcFrequency;
+    QueryPerformanceFrequency(&qpcFrequency);
+    m_qpcFrequency = static_cast<UINT64>(qpcFrequency.QuadPart);
+
+    const UINT queries = m_frameCount * kMaxZonesPerFrame * 2;
+    D3D12_QUERY_HEAP_DESC heapDesc{};
+    heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    heapDesc.Count = queries;
+    ComPtr<ID3D12QueryHeap> heap;
+    if (FAILED(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&heap)))) return false;
+
+    D3D12_HEAP_PROPERTIES readbackHeap{}; readbackHeap.Type = D3D12_HEAP_TYPE_READBACK;
+    D3D12_RESOURCE_DESC desc{};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    desc.Width = static_cast<UINT64>(queries) * sizeof(UINT64);
+    desc.Height = 1;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    if (FAILED(device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr, IID_PPV_ARGS(&m_readback))))
+        return false;
+
+    m_allocators.assign(m_frameCount, nullptr);
+    for (auto& allocator : m_allocators) {
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator)))) return false;
+    }
+    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_allocators[0].Get(), nullptr,
+            IID_PPV_ARGS(&m_list))) || FAILED(m_list->Close()))
+        return false;
+
+    m_names.assign(m_frameCount * kMaxZonesPerFrame, nullptr);
+    m_resolved.assign(m_frameCount, 0);
+    m_heap = heap;
+    return true;
+}
+
+// Timestamps resolved for frame, converted to Profiler::Now() nanoseconds
+void GpuProfiler::ReadBack(UINT frame)
+{
+    const UINT count = m_resolved[frame];
+    m_resolved[frame] = 0;
+    UINT64 gpuNow = 0, cpuNow = 0;
+    if (count == 0 || FAILED(m_queue->GetClockCalibration(&gpuNow, &cpuNow))) return;
+
+    const size_t first = static_cast<size_t>(frame) * kMaxZonesPerFrame;
+    const D3D12_RANGE range{ first * 2 * sizeof(UINT64), (first + count) * 2 * sizeof(UINT64) };
+    void* mapped = nullptr;
+    if (FAILED(m_readback->Map(0, &range, &mapped))) return;
+    const UINT64* ticks = static_cast<const UINT64*>(mapped) + first * 2;
+    // The CPU side is in QueryPerformanceCounter ticks, which is also what
+    // steady_clock counts with MSVC
+    const double cpuNs = static_cast<double>(cpuNow) * (1e9 / static_cast<double>(m_qpcFrequency));
+    const double nsPerTick = 1e9 / static_cast<double>(m_frequency);
+    for (UINT i = 0; i < count; ++i) {
+        const UINT64 begin = ticks[2 * i], end = ticks[2 * i + 1];
+        if (end < begin) continue;
+        const double beginNs = cpuNs + static_cast<double>(static_cast<int64_t>(begin - gpuNow)) * nsPerTick;
+        if (beginNs < 0.0) continue;
+        Profiler::RecordGpu(m_names[first + i], static_cast<uint64_t>(beginNs),
+            static_cast<uint64_t>(beginNs + static_cast<double>(end - begin) * nsPerTick));
+    }
+    const D3D12_RANGE written{ 0, 0 };
+    m_readback->Unmap(0, &written);
+}
+
+void GpuProfiler::BeginFrame(UINT frameIndex, ID3D12GraphicsCommandList* list)
+{
+    if (!m_heap) return;
+    m_frame = frameIndex % m_frameCount;
+    ReadBack(m_frame);
+    m_zoneCount.store(0, std::memory_order_relaxed);
+    m_frameZone = BeginZone(list, "GPU frame");
+}
+
+UINT GpuProfiler::BeginZone(ID3D12GraphicsCommandList* list, const char* name)
+{
+    if (!m_heap) return kNoZone;
+    const UINT zone = m_zoneCount.fetch_add(1, std::memory_order_relaxed);
+    if (zone >= kMaxZonesPerFrame) return kNoZone;
+    const UINT index = m_frame * kMaxZonesPerFrame + zone;
+    m_names[index] = name;
+    list->EndQuery(m_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index * 2);
+    return zone;
+}
+
+void GpuProfiler::EndZone(ID3D12GraphicsCommandList* list, UINT zone)
+{
+    if (zone == kNoZone) return;
+    list->EndQuery(m_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, (m_frame * kMaxZonesPerFrame + zone) * 2 + 1);
+}
+
+ID3D12CommandList* GpuProfiler::EndFrame()
+{
+    if (!m_heap) return nullptr;
+    ID3D12CommandAllocator* allocator = m_allocators[m_frame].Get();
+    if (FAILED(allocator->Reset()) || FAILED(m_list->Reset(allocator, nullptr))) return nullptr;
+    EndZone(m_list.Get(), m_frameZone);
+    m_frameZone = kNoZone;
+    const UINT count = (std::min)(m_zoneCount.load(std::memory_order_relaxed), kMaxZonesPerFrame);
+    const UINT first = m_frame * kMaxZonesPerFrame * 2;
+    if (count > 0) {
+        m_list->ResolveQueryData(m_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, first, count * 2, m_readback.Get(),
+            static_cast<UINT64>(first) * sizeof(UINT64));
+    }
+    if (FAILED(m_list->Close())) return nullptr;
+    m_resolved[m_frame] = count;
+    return m_list.Get();
+}
+
+#endif
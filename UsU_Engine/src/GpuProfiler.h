@@ -0,0 +1,88 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include "Profiler.h"
+
+#if USU_PROFILE
+#include <atomic>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+// GPU zones from timestamp queries around command list sections. Every
+// frame in flight owns a range of the query heap and of a readback buffer.
+// EndFrame records a small list of its own that closes the frame zone and
+// resolves the range; BeginFrame, once the caller has waited for that
+// frame's previous submission, reads the times back and passes them to
+// Profiler::RecordGpu, mapped onto the CPU clock through the queue's clock
+// calibration. Zones may be opened on any list from any thread; a frame
+// with more than kMaxZonesPerFrame drops the rest.
+class GpuProfiler
+{
+public:
+    static const UINT kMaxZonesPerFrame = 64;
+    static const UINT kNoZone = ~0u;
+
+    // false (and every call a no-op) if the queue has no timestamps
+    bool Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, UINT frameCount);
+
+    // Opens the frame zone on list, the first of the frame
+    void BeginFrame(UINT frameIndex, ID3D12GraphicsCommandList* list);
+    UINT BeginZone(ID3D12GraphicsCommandList* list, const char* name);
+    void EndZone(ID3D12GraphicsCommandList* list, UINT zone);
+    // After every other list of the frame is recorded; submit the returned
+    // list (nullptr on failure) after them
+    ID3D12CommandList* EndFrame();
+
+private:
+    void ReadBack(UINT frame);
+
+    ID3D12CommandQueue* m_queue = nullptr;
+    ComPtr<ID3D12QueryHeap> m_heap;
+    ComPtr<ID3D12Resource> m_readback;
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_allocators; // [frame]
+    ComPtr<ID3D12GraphicsCommandList> m_list;
+    UINT m_frameCount = 0;
+    UINT m_frame = 0;
+    UINT64 m_frequency = 0;
+    UINT64 m_qpcFrequency = 0;
+    std::vector<const char*> m_names; // [frame * kMaxZonesPerFrame + zone]
+    std::vector<UINT> m_resolved;     // zones resolved per frame
+    std::atomic<UINT> m_zoneCount{ 0 };
+    UINT m_frameZone = kNoZone;
+};
+
+class GpuProfileZone
+{
+public:
+    GpuProfileZone(GpuProfiler& profiler, ID3D12GraphicsCommandList* list, const char* name)
+        : m_profiler(profiler), m_list(list), m_zone(profiler.BeginZone(list, name)) {}
+    ~GpuProfileZone() { m_profiler.EndZone(m_list, m_zone); }
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+private:
+    GpuProfiler& m_profiler;
+    ID3D12GraphicsCommandList* m_list;
+    UINT m_zone;
+};
+
+#define USU_PROFILE_GPU_ZONE(profiler, list, name) \
+    GpuProfileZone USU_PROFILE_CONCAT(usuGpuProfileZone, __LINE__)(profiler, list, name)
+
+#else
+
+class GpuProfiler
+{
+public:
+    static const UINT kNoZone = ~0u;
+    bool Initialize(ID3D12Device*, ID3D12CommandQueue*, UINT) { return true; }
+    void BeginFrame(UINT, ID3D12GraphicsCommandList*) {}
+    UINT BeginZone(ID3D12GraphicsCommandList*, const char*) { return kNoZone; }
+    void EndZone(ID3D12GraphicsCommandList*, UINT) {}
+    ID3D12CommandList* EndFrame() { return nullptr; }
+};
+
+#define USU_PROFILE_GPU_ZONE(profiler, list, name) ((void)0)
+
+#endif
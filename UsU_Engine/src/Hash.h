@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit content hash (XXH64). Used to key on-disk caches against their
+// source assets; not suitable for anything security related.
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed = 0);
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+#include "Texture.h"
+
+// Times decoding a color image (plus optional alpha plane) to RGBA8 with WIC
+// and with the built-in decoder at each available SIMD level; results go to
+// the debug output as "[Image] ..." lines.
+void BenchmarkImageDecode(const std::wstring& colorPath, const std::wstring& alphaPath, int iterations = 20);
+
+// Encodes an RGBA8 texture (all its levels) to BC1, BC3 and BC7 in both
+// quality modes and logs throughput and level-0 PSNR per combination.
+void BenchmarkBlockCompression(const TextureData& rgba);
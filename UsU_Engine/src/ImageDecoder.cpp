@@ -0,0 +1,522 @@
+#include "ImageDecoder.h"
+#include "Inflate.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define USU_IMAGE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define USU_TARGET(isa)
+#else
+#define USU_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+static inline uint32_t ReadLE32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+static inline uint16_t ReadLE16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+static inline uint32_t ReadBE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+// ---------------------------------------------------------------------------
+// SIMD level
+
+static ImageSimd DetectImageSimd()
+{
+#if defined(USU_IMAGE_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool ssse3 = (info[2] & (1 << 9)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool ssse3 = __builtin_cpu_supports("ssse3") != 0;
+    const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    if (avx2 && ssse3) return ImageSimd::AVX2;
+    if (ssse3) return ImageSimd::SSSE3;
+#endif
+    return ImageSimd::Scalar;
+}
+
+static const ImageSimd g_cpuSimd = DetectImageSimd();
+static std::atomic<int> g_imageSimd{ static_cast<int>(g_cpuSimd) };
+
+ImageSimd GetImageSimd() { return static_cast<ImageSimd>(g_imageSimd.load(std::memory_order_relaxed)); }
+
+void SetImageSimd(ImageSimd level)
+{
+    g_imageSimd.store(static_cast<int>((std::min)(level, g_cpuSimd)), std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Row conversions. Each SIMD variant handles what it can and returns the
+// number of pixels done; the scalar loop finishes the row.
+
+static void ExpandRGB24Scalar(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB)
+{
+    const int r = swapRB ? 2 : 0, b = swapRB ? 0 : 2;
+    for (size_t i = 0; i < n; ++i, src += 3, dst += 4) {
+        dst[0] = src[r];
+        dst[1] = src[1];
+        dst[2] = src[b];
+        dst[3] = 255;
+    }
+}
+
+static void Swizzle32Scalar(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB, bool opaque)
+{
+    const int r = swapRB ? 2 : 0, b = swapRB ? 0 : 2;
+    for (size_t i = 0; i < n; ++i, src += 4, dst += 4) {
+        const uint8_t a = opaque ? 255 : src[3];
+        const uint8_t cr = src[r], cg = src[1], cb = src[b];
+        dst[0] = cr;
+        dst[1] = cg;
+        dst[2] = cb;
+        dst[3] = a;
+    }
+}
+
+static void MergeAlphaScalar(uint8_t* rgba, const uint8_t* plane, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) rgba[i * 4 + 3] = plane[i * 4];
+}
+
+#if defined(USU_IMAGE_X86)
+
+USU_TARGET("ssse3")
+static size_t ExpandRGB24SSSE3(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB)
+{
+    // 4 pixels per 16-byte load; the load reads 4 bytes past the 12 used
+    const __m128i shuffle = swapRB
+        ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+        : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 6 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    return i;
+}
+
+USU_TARGET("ssse3")
+static size_t Swizzle32SSSE3(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB, bool opaque)
+{
+    const __m128i shuffle = swapRB
+        ? _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15)
+        : _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i alpha = _mm_set1_epi32(opaque ? static_cast<int>(0xFF000000u) : 0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    return i;
+}
+
+USU_TARGET("ssse3")
+static size_t MergeAlphaSSSE3(uint8_t* rgba, const uint8_t* plane, size_t n)
+{
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i* d = reinterpret_cast<__m128i*>(rgba + i * 4);
+        const __m128i a = _mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(plane + i * 4)), 24);
+        _mm_storeu_si128(d, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(d), colorMask), a));
+    }
+    return i;
+}
+
+USU_TARGET("avx2")
+static size_t ExpandRGB24AVX2(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB)
+{
+    // 8 pixels (24 bytes) per 32-byte load: dwords 0-2 to the low lane,
+    // dwords 3-5 to the high lane, then the same in-lane shuffle as SSSE3
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuffle = swapRB
+        ? _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                           2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+        : _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                           0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 11 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 3));
+        v = _mm256_permutevar8x32_epi32(v, lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha));
+    }
+    return i;
+}
+
+USU_TARGET("avx2")
+static size_t Swizzle32AVX2(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB, bool opaque)
+{
+    const __m256i shuffle = swapRB
+        ? _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                           2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15)
+        : _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                           0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i alpha = _mm256_set1_epi32(opaque ? static_cast<int>(0xFF000000u) : 0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha));
+    }
+    return i;
+}
+
+USU_TARGET("avx2")
+static size_t MergeAlphaAVX2(uint8_t* rgba, const uint8_t* plane, size_t n)
+{
+    const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i* d = reinterpret_cast<__m256i*>(rgba + i * 4);
+        const __m256i a = _mm256_slli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(plane + i * 4)), 24);
+        _mm256_storeu_si256(d, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(d), colorMask), a));
+    }
+    return i;
+}
+
+#endif // USU_IMAGE_X86
+
+static void ExpandRGB24(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB)
+{
+    size_t done = 0;
+#if defined(USU_IMAGE_X86)
+    const ImageSimd simd = GetImageSimd();
+    if (simd == ImageSimd::AVX2) done = ExpandRGB24AVX2(src, dst, n, swapRB);
+    else if (simd == ImageSimd::SSSE3) done = ExpandRGB24SSSE3(src, dst, n, swapRB);
+#endif
+    ExpandRGB24Scalar(src + done * 3, dst + done * 4, n - done, swapRB);
+}
+
+static void Swizzle32(const uint8_t* src, uint8_t* dst, size_t n, bool swapRB, bool opaque)
+{
+    size_t done = 0;
+#if defined(USU_IMAGE_X86)
+    const ImageSimd simd = GetImageSimd();
+    if (simd == ImageSimd::AVX2) done = Swizzle32AVX2(src, dst, n, swapRB, opaque);
+    else if (simd == ImageSimd::SSSE3) done = Swizzle32SSSE3(src, dst, n, swapRB, opaque);
+#endif
+    Swizzle32Scalar(src + done * 4, dst + done * 4, n - done, swapRB, opaque);
+}
+
+// plane is RGBA8 as well; its first channel becomes the alpha
+static void MergeAlpha(uint8_t* rgba, const uint8_t* plane, size_t n)
+{
+    size_t done = 0;
+#if defined(USU_IMAGE_X86)
+    const ImageSimd simd = GetImageSimd();
+    if (simd == ImageSimd::AVX2) done = MergeAlphaAVX2(rgba, plane, n);
+    else if (simd == ImageSimd::SSSE3) done = MergeAlphaSSSE3(rgba, plane, n);
+#endif
+    MergeAlphaScalar(rgba + done * 4, plane + done * 4, n - done);
+}
+
+static void ExpandPalette8(const uint8_t* src, uint8_t* dst, size_t n, const uint32_t* palette)
+{
+    for (size_t i = 0; i < n; ++i) memcpy(dst + i * 4, &palette[src[i]], 4);
+}
+
+// ---------------------------------------------------------------------------
+// BMP
+
+namespace {
+
+struct BmpHeader
+{
+    uint32_t width = 0, height = 0;
+    bool topDown = false;
+    uint32_t bpp = 0;
+    bool keepAlpha = false;
+    size_t pixelOffset = 0;
+    size_t stride = 0;
+    uint32_t palette[256] = {};
+};
+
+struct PngHeader
+{
+    uint32_t width = 0, height = 0;
+    uint32_t bitDepth = 0;
+    uint32_t colorType = 0;
+    uint32_t channels = 0;
+};
+
+} // namespace
+
+static bool ParseBmp(const uint8_t* data, size_t size, BmpHeader& h)
+{
+    if (size < 54 || data[0] != 'B' || data[1] != 'M') return false;
+    const uint32_t headerSize = ReadLE32(data + 14);
+    if (headerSize < 40 || 14 + size_t(headerSize) > size) return false;
+    const int32_t w = static_cast<int32_t>(ReadLE32(data + 18));
+    const int32_t hgt = static_cast<int32_t>(ReadLE32(data + 22));
+    h.bpp = ReadLE16(data + 28);
+    const uint32_t compression = ReadLE32(data + 30);
+    if (w <= 0 || hgt == 0 || hgt == INT32_MIN) return false;
+    h.width = static_cast<uint32_t>(w);
+    h.topDown = hgt < 0;
+    h.height = static_cast<uint32_t>(hgt < 0 ? -hgt : hgt);
+    h.pixelOffset = ReadLE32(data + 10);
+    h.stride = ((size_t(h.bpp) * h.width + 31) / 32) * 4;
+    if (h.pixelOffset > size || h.stride * h.height > size - h.pixelOffset) return false;
+
+    if (h.bpp == 8) {
+        if (compression != 0) return false; // no RLE
+        uint32_t colors = ReadLE32(data + 46);
+        if (colors == 0 || colors > 256) colors = 256;
+        const size_t palOffset = 14 + size_t(headerSize);
+        colors = std::min<uint32_t>(colors, static_cast<uint32_t>((h.pixelOffset - std::min(h.pixelOffset, palOffset)) / 4));
+        for (uint32_t i = 0; i < colors; ++i) {
+            const uint8_t* c = data + palOffset + i * 4; // B G R x
+            h.palette[i] = c[2] | (uint32_t(c[1]) << 8) | (uint32_t(c[0]) << 16) | 0xFF000000u;
+        }
+        return true;
+    }
+    if (h.bpp == 24) return compression == 0;
+    if (h.bpp == 32) {
+        if (compression == 0) return true; // BGRX
+        if (compression != 3) return false;
+        // BI_BITFIELDS: only the usual BGRA layout; masks follow a 40-byte header
+        const uint8_t* masks = data + 54;
+        if (size < 70) return false;
+        if (ReadLE32(masks) != 0x00FF0000u || ReadLE32(masks + 4) != 0x0000FF00u || ReadLE32(masks + 8) != 0x000000FFu)
+            return false;
+        h.keepAlpha = headerSize >= 56 && ReadLE32(masks + 12) == 0xFF000000u;
+        return true;
+    }
+    return false;
+}
+
+static bool DecodeBmp(const uint8_t* data, size_t size, uint8_t* dst, size_t dstPitch)
+{
+    BmpHeader h;
+    if (!ParseBmp(data, size, h)) return false;
+    for (uint32_t y = 0; y < h.height; ++y) {
+        const uint32_t srcRow = h.topDown ? y : h.height - 1 - y;
+        const uint8_t* src = data + h.pixelOffset + srcRow * h.stride;
+        uint8_t* row = dst + y * dstPitch;
+        if (h.bpp == 24)      ExpandRGB24(src, row, h.width, true);
+        else if (h.bpp == 32) Swizzle32(src, row, h.width, true, !h.keepAlpha);
+        else                  ExpandPalette8(src, row, h.width, h.palette);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PNG
+
+static const uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+static bool ParsePngHeader(const uint8_t* data, size_t size, PngHeader& h)
+{
+    if (size < 33 || memcmp(data, kPngSignature, 8) != 0 || memcmp(data + 12, "IHDR", 4) != 0) return false;
+    h.width = ReadBE32(data + 16);
+    h.height = ReadBE32(data + 20);
+    h.bitDepth = data[24];
+    h.colorType = data[25];
+    const uint32_t interlace = data[28];
+    if (h.width == 0 || h.height == 0 || h.width > (1u << 24) || h.height > (1u << 24) || interlace != 0) return false;
+    switch (h.colorType) {
+    case 0: h.channels = 1; break;
+    case 2: h.channels = 3; break;
+    case 3: h.channels = 1; break;
+    case 4: h.channels = 2; break;
+    case 6: h.channels = 4; break;
+    default: return false;
+    }
+    if (h.bitDepth != 8 && !(h.bitDepth == 16 && h.colorType != 3)) return false;
+    return true;
+}
+
+static inline uint8_t Paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = p > a ? p - a : a - p;
+    const int pb = p > b ? p - b : b - p;
+    const int pc = p > c ? p - c : c - p;
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+static bool Unfilter(uint8_t* row, const uint8_t* prev, size_t rowBytes, size_t bpp, uint8_t filter)
+{
+    switch (filter) {
+    case 0: break;
+    case 1: for (size_t i = bpp; i < rowBytes; ++i) row[i] = static_cast<uint8_t>(row[i] + row[i - bpp]); break;
+    case 2: if (prev) for (size_t i = 0; i < rowBytes; ++i) row[i] = static_cast<uint8_t>(row[i] + prev[i]); break;
+    case 3:
+        for (size_t i = 0; i < rowBytes; ++i) {
+            const int left = i >= bpp ? row[i - bpp] : 0;
+            const int up = prev ? prev[i] : 0;
+            row[i] = static_cast<uint8_t>(row[i] + ((left + up) >> 1));
+        }
+        break;
+    case 4:
+        for (size_t i = 0; i < rowBytes; ++i) {
+            const int left = i >= bpp ? row[i - bpp] : 0;
+            const int up = prev ? prev[i] : 0;
+            const int upLeft = (prev && i >= bpp) ? prev[i - bpp] : 0;
+            row[i] = static_cast<uint8_t>(row[i] + Paeth(left, up, upLeft));
+        }
+        break;
+    default: return false;
+    }
+    return true;
+}
+
+static bool DecodePng(const uint8_t* data, size_t size, uint8_t* dst, size_t dstPitch)
+{
+    PngHeader h;
+    if (!ParsePngHeader(data, size, h)) return false;
+
+    uint32_t palette[256];
+    for (uint32_t i = 0; i < 256; ++i) palette[i] = 0xFF000000u;
+    // IDAT payloads are usually one chunk; only concatenate when they are not
+    std::vector<uint8_t> joined;
+    const uint8_t* idat = nullptr;
+    size_t idatSize = 0;
+    size_t pos = 8;
+    while (pos + 12 <= size) {
+        const uint32_t len = ReadBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if (len > size - pos - 12) return false;
+        if (memcmp(type, "PLTE", 4) == 0) {
+            for (uint32_t i = 0; i < len / 3 && i < 256; ++i)
+                palette[i] = body[i * 3] | (uint32_t(body[i * 3 + 1]) << 8) | (uint32_t(body[i * 3 + 2]) << 16) | 0xFF000000u;
+        } else if (memcmp(type, "tRNS", 4) == 0 && h.colorType == 3) {
+            for (uint32_t i = 0; i < len && i < 256; ++i)
+                palette[i] = (palette[i] & 0x00FFFFFFu) | (uint32_t(body[i]) << 24);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (!idat) {
+                idat = body;
+                idatSize = len;
+            } else {
+                if (joined.empty()) joined.assign(idat, idat + idatSize);
+                joined.insert(joined.end(), body, body + len);
+                idat = joined.data();
+                idatSize = joined.size();
+            }
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + size_t(len);
+    }
+    if (!idat) return false;
+
+    const size_t bytesPerSample = h.bitDepth / 8;
+    const size_t bpp = h.channels * bytesPerSample;
+    const size_t rowBytes = size_t(h.width) * bpp;
+    std::vector<uint8_t> raw((rowBytes + 1) * h.height);
+    if (!InflateZlib(idat, idatSize, raw.data(), raw.size())) return false;
+
+    std::vector<uint8_t> narrow(h.bitDepth == 16 ? size_t(h.width) * h.channels : 0);
+    const uint8_t* prev = nullptr;
+    for (uint32_t y = 0; y < h.height; ++y) {
+        uint8_t* line = raw.data() + y * (rowBytes + 1);
+        uint8_t* row = line + 1;
+        if (!Unfilter(row, prev, rowBytes, bpp, line[0])) return false;
+        prev = row;
+
+        const uint8_t* src = row;
+        if (h.bitDepth == 16) {
+            for (size_t i = 0; i < narrow.size(); ++i) narrow[i] = row[i * 2]; // big endian: high byte first
+            src = narrow.data();
+        }
+        uint8_t* out = dst + y * dstPitch;
+        switch (h.colorType) {
+        case 2: ExpandRGB24(src, out, h.width, false); break;
+        case 6: Swizzle32(src, out, h.width, false, false); break;
+        case 3: ExpandPalette8(src, out, h.width, palette); break;
+        case 0:
+            for (uint32_t x = 0; x < h.width; ++x) { out[x * 4] = out[x * 4 + 1] = out[x * 4 + 2] = src[x]; out[x * 4 + 3] = 255; }
+            break;
+        default: // gray + alpha
+            for (uint32_t x = 0; x < h.width; ++x) {
+                out[x * 4] = out[x * 4 + 1] = out[x * 4 + 2] = src[x * 2];
+                out[x * 4 + 3] = src[x * 2 + 1];
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool ReadImageInfo(const uint8_t* data, size_t size, ImageInfo& info)
+{
+    info = ImageInfo();
+    if (!data) return false;
+    BmpHeader bmp;
+    if (ParseBmp(data, size, bmp)) {
+        info.width = bmp.width;
+        info.height = bmp.height;
+        return true;
+    }
+    PngHeader png;
+    if (ParsePngHeader(data, size, png)) {
+        info.width = png.width;
+        info.height = png.height;
+        return true;
+    }
+    return false;
+}
+
+bool DecodeImage(const uint8_t* data, size_t size, uint8_t* dst, size_t dstPitch)
+{
+    if (!data || !dst) return false;
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M') return DecodeBmp(data, size, dst, dstPitch);
+    if (size >= 8 && memcmp(data, kPngSignature, 8) == 0) return DecodePng(data, size, dst, dstPitch);
+    return false;
+}
+
+bool MergeAlphaPlane(const uint8_t* data, size_t size, uint8_t* rgba, size_t pitch, uint32_t width, uint32_t height)
+{
+    ImageInfo info;
+    if (!ReadImageInfo(data, size, info) || info.width != width || info.height != height) return false;
+    std::vector<uint8_t> plane(size_t(width) * height * 4);
+    if (!DecodeImage(data, size, plane.data(), size_t(width) * 4)) return false;
+    for (uint32_t y = 0; y < height; ++y)
+        MergeAlpha(rgba + y * pitch, plane.data() + size_t(y) * width * 4, width);
+    return true;
+}
+
+bool LoadImageFile(const std::wstring& path, TextureData& out, const std::wstring& alphaPath)
+{
+    MappedFile file;
+    if (!file.Open(path)) return false;
+    ImageInfo info;
+    if (!ReadImageInfo(file.Data(), file.Size(), info)) return false;
+    AllocateTexture(out, TextureFormat::RGBA8, info.width, info.height);
+    if (!DecodeImage(file.Data(), file.Size(), out.bytes.data(), out.mips[0].rowPitch)) return false;
+    if (!alphaPath.empty()) {
+        MappedFile alpha;
+        if (!alpha.Open(alphaPath) ||
+            !MergeAlphaPlane(alpha.Data(), alpha.Size(), out.bytes.data(), out.mips[0].rowPitch, info.width, info.height))
+            return false;
+    }
+    return true;
+}
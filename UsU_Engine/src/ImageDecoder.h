@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Texture.h"
+
+// Built-in BMP (8/24/32-bit, uncompressed) and PNG (8/16-bit, non-interlaced)
+// decoding to RGBA8, portable and without WIC/COM. Channel swizzles and the
+// alpha-plane merge use SSSE3/AVX2 when the CPU has them.
+struct ImageInfo
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Instruction set used by the row conversions; defaults to the best the CPU
+// supports. Set lower to compare paths; requests above support are clamped.
+enum class ImageSimd { Scalar, SSSE3, AVX2 };
+ImageSimd GetImageSimd();
+void      SetImageSimd(ImageSimd level);
+
+bool ReadImageInfo(const uint8_t* data, size_t size, ImageInfo& info);
+
+// Decodes into dst, width * 4 bytes per row, rows dstPitch apart. dst is the
+// caller's buffer (e.g. TextureData::bytes); 16/32-byte alignment helps the
+// SIMD paths but is not required.
+bool DecodeImage(const uint8_t* data, size_t size, uint8_t* dst, size_t dstPitch);
+
+// Replaces the alpha channel of an RGBA8 image with a separate alpha plane
+// (FSHTool's "-a" bitmaps): the first channel of the plane, same size.
+bool MergeAlphaPlane(const uint8_t* data, size_t size, uint8_t* rgba, size_t pitch, uint32_t width, uint32_t height);
+
+// Reads and decodes a file into a single-level RGBA8 texture, optionally
+// merging an alpha-plane file.
+bool LoadImageFile(const std::wstring& path, TextureData& out, const std::wstring& alphaPath = std::wstring());
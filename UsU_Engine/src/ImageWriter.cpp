@@ -0,0 +1,172 @@
+#include "ImageWriter.h"
+#include "Deflate.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+
+static void PutBE32(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void PutLE(std::vector<uint8_t>& out, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size)
+{
+    PutBE32(out, static_cast<uint32_t>(size));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size) out.insert(out.end(), data, data + size);
+    PutBE32(out, Crc32(out.data() + start, out.size() - start));
+}
+
+static uint8_t Paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// Filters one row with the given PNG filter type (4 bytes per pixel)
+static void FilterRow(int type, const uint8_t* row, const uint8_t* above, size_t bytes, uint8_t* out)
+{
+    for (size_t i = 0; i < bytes; ++i) {
+        const int a = i >= 4 ? row[i - 4] : 0;
+        const int b = above ? above[i] : 0;
+        const int c = (i >= 4 && above) ? above[i - 4] : 0;
+        int pred = 0;
+        switch (type) {
+        case 1: pred = a; break;
+        case 2: pred = b; break;
+        case 3: pred = (a + b) >> 1; break;
+        case 4: pred = Paeth(a, b, c); break;
+        default: break;
+        }
+        out[i] = static_cast<uint8_t>(row[i] - pred);
+    }
+}
+
+bool EncodePng(const uint8_t* rgba, size_t pitch, uint32_t width, uint32_t height, std::vector<uint8_t>& out)
+{
+    if (!rgba || width == 0 || height == 0) return false;
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+
+    // Per row, the filter with the smallest sum of signed residuals (the
+    // usual heuristic from the PNG spec)
+    std::vector<uint8_t> filtered((rowBytes + 1) * height);
+    std::vector<uint8_t> candidate(rowBytes);
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = rgba + y * pitch;
+        const uint8_t* above = y > 0 ? rgba + (y - 1) * pitch : nullptr;
+        uint8_t* dst = filtered.data() + y * (rowBytes + 1);
+        uint64_t bestCost = ~0ull;
+        for (int type = 0; type < 5; ++type) {
+            FilterRow(type, row, above, rowBytes, candidate.data());
+            uint64_t cost = 0;
+            for (size_t i = 0; i < rowBytes; ++i) cost += abs(static_cast<int8_t>(candidate[i]));
+            if (cost < bestCost) {
+                bestCost = cost;
+                dst[0] = static_cast<uint8_t>(type);
+                memcpy(dst + 1, candidate.data(), rowBytes);
+            }
+        }
+    }
+    std::vector<uint8_t> idat;
+    DeflateZlib(filtered.data(), filtered.size(), idat);
+
+    static const uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.assign(kSignature, kSignature + 8);
+    std::vector<uint8_t> ihdr;
+    PutBE32(ihdr, width);
+    PutBE32(ihdr, height);
+    ihdr.push_back(8); // bit depth
+    ihdr.push_back(6); // RGBA
+    ihdr.push_back(0); // deflate
+    ihdr.push_back(0); // adaptive filtering
+    ihdr.push_back(0); // not interlaced
+    PutChunk(out, "IHDR", ihdr.data(), ihdr.size());
+    PutChunk(out, "IDAT", idat.data(), idat.size());
+    PutChunk(out, "IEND", nullptr, 0);
+    return true;
+}
+
+bool EncodeBmp(const uint8_t* rgba, size_t pitch, uint32_t width, uint32_t height, std::vector<uint8_t>& out)
+{
+    if (!rgba || width == 0 || height == 0) return false;
+    const uint32_t imageBytes = width * height * 4;
+    out.clear();
+    out.reserve(54 + imageBytes);
+    // BITMAPFILEHEADER
+    out.push_back('B');
+    out.push_back('M');
+    PutLE(out, 54 + imageBytes, 4);
+    PutLE(out, 0, 4);
+    PutLE(out, 54, 4);
+    // BITMAPINFOHEADER: 32-bit BI_RGB, bottom-up
+    PutLE(out, 40, 4);
+    PutLE(out, width, 4);
+    PutLE(out, height, 4);
+    PutLE(out, 1, 2);
+    PutLE(out, 32, 2);
+    PutLE(out, 0, 4);
+    PutLE(out, imageBytes, 4);
+    PutLE(out, 2835, 4); // 72 dpi
+    PutLE(out, 2835, 4);
+    PutLE(out, 0, 4);
+    PutLE(out, 0, 4);
+    for (uint32_t y = height; y-- > 0;) {
+        const uint8_t* row = rgba + y * pitch;
+        for (uint32_t x = 0; x < width; ++x) {
+            const uint8_t* p = row + x * 4;
+            out.push_back(p[2]);
+            out.push_back(p[1]);
+            out.push_back(p[0]);
+            out.push_back(p[3]);
+        }
+    }
+    return true;
+}
+
+bool WriteImageFile(const std::wstring& path, const TextureData& image)
+{
+    if (image.format != TextureFormat::RGBA8 || image.mips.empty()) return false;
+    const std::filesystem::path p(path);
+    std::wstring ext = p.extension().wstring();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](wchar_t c) { return static_cast<wchar_t>(towlower(c)); });
+
+    std::vector<uint8_t> encoded;
+    const TextureMip& mip = image.mips[0];
+    const bool ok = ext == L".bmp" ? EncodeBmp(image.MipData(0), mip.rowPitch, mip.width, mip.height, encoded)
+                                   : EncodePng(image.MipData(0), mip.rowPitch, mip.width, mip.height, encoded);
+    if (!ok) return false;
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Texture.h"
+
+// RGBA8 image output, the counterpart to ImageDecoder: 8-bit RGBA PNG with
+// per-row adaptive filtering, or 32-bit BMP. Portable, no WIC.
+bool EncodePng(const uint8_t* rgba, size_t pitch, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+bool EncodeBmp(const uint8_t* rgba, size_t pitch, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+
+// Writes level 0 of an RGBA8 texture; the format follows the extension
+// (.bmp, anything else is PNG).
+bool WriteImageFile(const std::wstring& path, const TextureData& image);
@@ -0,0 +1,227 @@
+#include "Inflate.h"
+#include <cstring>
+
+namespace {
+
+const int kFastBits = 10;
+
+struct BitReader
+{
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t bits = 0;
+    int count = 0;
+    size_t padding = 0; // zero bytes fed past the end
+
+    void Refill()
+    {
+        while (count <= 56) {
+            uint64_t b = 0;
+            if (p < end) b = *p++;
+            else ++padding;
+            bits |= b << count;
+            count += 8;
+        }
+    }
+    uint32_t Read(int n)
+    {
+        if (count < n) Refill();
+        const uint32_t v = static_cast<uint32_t>(bits & ((1ull << n) - 1));
+        bits >>= n;
+        count -= n;
+        return v;
+    }
+    // Bits actually taken from the input are still buffered in 'bits'
+    bool Overrun() const { return padding * 8 > static_cast<size_t>(count); }
+};
+
+// Canonical Huffman code: a kFastBits lookup (symbol << 4 | length) for
+// short codes and the count/symbol lists for the rest.
+struct Huffman
+{
+    uint16_t fast[1 << kFastBits];
+    uint16_t counts[16];
+    uint16_t symbols[288];
+};
+
+} // namespace
+
+static const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t kDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                                        513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t kDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+                                        8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static bool BuildHuffman(Huffman& h, const uint8_t* lengths, int n)
+{
+    memset(h.counts, 0, sizeof(h.counts));
+    memset(h.fast, 0, sizeof(h.fast));
+    for (int i = 0; i < n; ++i) h.counts[lengths[i]]++;
+    h.counts[0] = 0;
+
+    // Over-subscribed sets are invalid; incomplete ones are allowed (single code)
+    int left = 1;
+    for (int len = 1; len < 16; ++len) {
+        left = (left << 1) - h.counts[len];
+        if (left < 0) return false;
+    }
+
+    uint16_t offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 15; ++len) offsets[len + 1] = static_cast<uint16_t>(offsets[len] + h.counts[len]);
+    for (int i = 0; i < n; ++i)
+        if (lengths[i]) h.symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+
+    // Codes are assigned MSB-first but read LSB-first, hence the reversal
+    uint32_t code = 0;
+    int index = 0;
+    for (int len = 1; len <= kFastBits; ++len) {
+        for (int k = 0; k < h.counts[len]; ++k, ++code, ++index) {
+            uint32_t rev = 0;
+            for (int b = 0; b < len; ++b) rev |= ((code >> b) & 1u) << (len - 1 - b);
+            for (uint32_t j = rev; j < (1u << kFastBits); j += 1u << len)
+                h.fast[j] = static_cast<uint16_t>((h.symbols[index] << 4) | len);
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+static int DecodeSymbol(BitReader& br, const Huffman& h)
+{
+    if (br.count < 16) br.Refill();
+    const uint16_t e = h.fast[br.bits & ((1u << kFastBits) - 1)];
+    if (e) {
+        const int len = e & 15;
+        br.bits >>= len;
+        br.count -= len;
+        return e >> 4;
+    }
+    // Long code: canonical decode one bit at a time
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; ++len) {
+        code |= static_cast<int>(br.bits & 1);
+        br.bits >>= 1;
+        br.count--;
+        const int count = h.counts[len];
+        if (code - count < first) return h.symbols[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static bool InflateBlock(BitReader& br, const Huffman& lit, const Huffman& dist, uint8_t* out, size_t& w, size_t outSize)
+{
+    for (;;) {
+        const int sym = DecodeSymbol(br, lit);
+        if (sym < 0) return false;
+        if (sym < 256) {
+            if (w >= outSize) return false;
+            out[w++] = static_cast<uint8_t>(sym);
+            continue;
+        }
+        if (sym == 256) return true;
+        const int li = sym - 257;
+        if (li >= 29) return false;
+        const size_t length = kLengthBase[li] + br.Read(kLengthExtra[li]);
+        const int ds = DecodeSymbol(br, dist);
+        if (ds < 0 || ds >= 30) return false;
+        const size_t distance = kDistBase[ds] + br.Read(kDistExtra[ds]);
+        if (distance > w || length > outSize - w) return false;
+        const uint8_t* src = out + w - distance;
+        uint8_t* dst = out + w;
+        if (distance >= length) {
+            memcpy(dst, src, length);
+        } else {
+            for (size_t i = 0; i < length; ++i) dst[i] = src[i]; // overlapping run
+        }
+        w += length;
+    }
+}
+
+bool InflateZlib(const uint8_t* data, size_t size, uint8_t* out, size_t expectedSize)
+{
+    if (!data || size < 2) return false;
+    const uint32_t cmf = data[0], flg = data[1];
+    if ((cmf & 15) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false;
+
+    BitReader br;
+    br.p = data + 2;
+    br.end = data + size;
+
+    struct FixedCodes
+    {
+        Huffman lit, dist;
+        FixedCodes()
+        {
+            uint8_t lengths[288];
+            for (int i = 0; i < 144; ++i) lengths[i] = 8;
+            for (int i = 144; i < 256; ++i) lengths[i] = 9;
+            for (int i = 256; i < 280; ++i) lengths[i] = 7;
+            for (int i = 280; i < 288; ++i) lengths[i] = 8;
+            BuildHuffman(lit, lengths, 288);
+            for (int i = 0; i < 30; ++i) lengths[i] = 5;
+            BuildHuffman(dist, lengths, 30);
+        }
+    };
+    static const FixedCodes fixed;
+
+    Huffman lit, dist;
+    size_t w = 0;
+    bool final = false;
+    while (!final) {
+        final = br.Read(1) != 0;
+        const uint32_t type = br.Read(2);
+        if (type == 0) {
+            // Stored: realign to a byte, then LEN/NLEN and raw bytes
+            br.Read(br.count & 7);
+            const uint32_t len = br.Read(16);
+            const uint32_t nlen = br.Read(16);
+            if ((len ^ 0xFFFF) != nlen || len > expectedSize - w) return false;
+            for (uint32_t i = 0; i < len; ++i) out[w++] = static_cast<uint8_t>(br.Read(8));
+        } else if (type == 1) {
+            if (!InflateBlock(br, fixed.lit, fixed.dist, out, w, expectedSize)) return false;
+        } else if (type == 2) {
+            const int hlit = static_cast<int>(br.Read(5)) + 257;
+            const int hdist = static_cast<int>(br.Read(5)) + 1;
+            const int hclen = static_cast<int>(br.Read(4)) + 4;
+            static const uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+            uint8_t lengths[320] = {};
+            for (int i = 0; i < hclen; ++i) lengths[kOrder[i]] = static_cast<uint8_t>(br.Read(3));
+            Huffman lenCode;
+            if (!BuildHuffman(lenCode, lengths, 19)) return false;
+            memset(lengths, 0, sizeof(lengths));
+            int n = 0;
+            while (n < hlit + hdist) {
+                const int sym = DecodeSymbol(br, lenCode);
+                if (sym < 0) return false;
+                if (sym < 16) { lengths[n++] = static_cast<uint8_t>(sym); continue; }
+                uint8_t value = 0;
+                int repeat;
+                if (sym == 16) {
+                    if (n == 0) return false;
+                    value = lengths[n - 1];
+                    repeat = 3 + static_cast<int>(br.Read(2));
+                } else if (sym == 17) {
+                    repeat = 3 + static_cast<int>(br.Read(3));
+                } else {
+                    repeat = 11 + static_cast<int>(br.Read(7));
+                }
+                if (n + repeat > hlit + hdist) return false;
+                while (repeat--) lengths[n++] = value;
+            }
+            if (lengths[256] == 0) return false;
+            if (!BuildHuffman(lit, lengths, hlit) || !BuildHuffman(dist, lengths + hlit, hdist)) return false;
+            if (!InflateBlock(br, lit, dist, out, w, expectedSize)) return false;
+        } else {
+            return false;
+        }
+        if (br.Overrun()) return false;
+    }
+    return w == expectedSize;
+}
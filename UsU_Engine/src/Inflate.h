@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// zlib stream (RFC 1950/1951) decompression into a buffer of known size, as
+// needed for PNG IDAT data. Fails on malformed input or if the stream does
+// not produce exactly expectedSize bytes.
+bool InflateZlib(const uint8_t* data, size_t size, uint8_t* out, size_t expectedSize);
@@ -0,0 +1,70 @@
+#include "JobBenchmark.h"
+#include "JobSystem.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const uint32_t kItems = 1u << 20;
+const uint32_t kGrain = 1024;
+const uint32_t kTinyJobs = 100000;
+
+// A few hundred cycles of dependent float math per item, no shared state
+float WorkItem(uint32_t i)
+{
+    float x = static_cast<float>(i & 1023) * 0.001f + 1.0f;
+    for (int k = 0; k < 48; ++k) x = std::sqrt(x * 1.0001f + 0.5f);
+    return x;
+}
+
+} // namespace
+
+void BenchmarkJobSystem(uint32_t maxThreads, int iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+    if (maxThreads == 0) maxThreads = (std::max)(1u, std::thread::hardware_concurrency());
+    if (iterations < 1) iterations = 1;
+    std::vector<float> results(kItems);
+    char msg[192];
+
+    double baseMs = 0.0;
+    for (uint32_t threads = 1; threads <= maxThreads; ++threads) {
+        JobSystem jobs;
+        jobs.Initialize(threads - 1);
+        // One untimed pass wakes the workers and warms the caches
+        double ms = 0.0;
+        for (int it = 0; it <= iterations; ++it) {
+            const auto t0 = Clock::now();
+            jobs.ParallelFor(kItems, kGrain, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; ++i) results[i] = WorkItem(i);
+            });
+            if (it > 0) ms += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        }
+        ms /= iterations;
+        if (threads == 1) baseMs = ms;
+        sprintf_s(msg, "[Jobs] parallel_for %2u thread(s) %8.2f ms  speedup %5.2fx  efficiency %3.0f%%\n", threads, ms,
+            baseMs / ms, 100.0 * baseMs / (ms * threads));
+        OutputDebugStringA(msg);
+    }
+
+    // Scheduling overhead: many empty jobs submitted from this thread
+    {
+        JobSystem jobs;
+        jobs.Initialize(maxThreads - 1);
+        std::atomic<uint32_t> ran{ 0 };
+        JobCounter counter;
+        const auto t0 = Clock::now();
+        for (uint32_t i = 0; i < kTinyJobs; ++i)
+            jobs.Run([](void* data) { static_cast<std::atomic<uint32_t>*>(data)->fetch_add(1, std::memory_order_relaxed); }, &ran, counter);
+        jobs.Wait(counter);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        sprintf_s(msg, "[Jobs] %u tiny Run() jobs on %u thread(s): %.2f ms, %.0f ns/job%s\n", kTinyJobs, maxThreads, ms,
+            ms * 1e6 / kTinyJobs, ran.load() == kTinyJobs ? "" : ", LOST JOBS");
+        OutputDebugStringA(msg);
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+
+// Runs the same embarrassingly parallel workload (independent per-item math,
+// ParallelFor) on job systems of 1..maxThreads threads and logs time,
+// speedup over one thread and parallel efficiency, then the cost per job of
+// tiny Run() jobs; results go to the debug output as "[Jobs] ..." lines.
+// maxThreads 0 uses every core.
+void BenchmarkJobSystem(uint32_t maxThreads = 0, int iterations = 5);
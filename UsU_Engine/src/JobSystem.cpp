@@ -0,0 +1,255 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const uint32_t kMaxWorkers = 64;
+const int kIdleSpins = 64; // failed steal rounds before a worker sleeps
+
+// Set on pool threads only: which pool, which worker
+thread_local const JobSystem* t_system = nullptr;
+thread_local uint32_t t_worker = 0;
+thread_local uint32_t t_random = 0x9E3779B9u;
+
+uint32_t NextRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+void JobSystem::Deque::Store(int64_t index, const Job& job)
+{
+    static_assert(std::is_trivially_copyable<Job>::value, "jobs are copied word by word");
+    uint64_t words[kJobWords] = {};
+    memcpy(words, &job, sizeof(Job));
+    Cell& cell = m_cells[index & (kCapacity - 1)];
+    for (size_t i = 0; i < kJobWords; ++i) cell.words[i].store(words[i], std::memory_order_relaxed);
+}
+
+void JobSystem::Deque::Load(int64_t index, Job& job) const
+{
+    uint64_t words[kJobWords];
+    const Cell& cell = m_cells[index & (kCapacity - 1)];
+    for (size_t i = 0; i < kJobWords; ++i) words[i] = cell.words[i].load(std::memory_order_relaxed);
+    memcpy(&job, words, sizeof(Job));
+}
+
+// Le, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (2013), with a fixed capacity
+bool JobSystem::Deque::Push(const Job& job)
+{
+    const int64_t b = m_bottom.load(std::memory_order_relaxed);
+    const int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t >= kCapacity) return false;
+    Store(b, job);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::Deque::Pop(Job& job)
+{
+    const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+    if (t > b) {
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    Load(b, job);
+    bool taken = true;
+    if (t == b) {
+        // Last one: race the thieves for it
+        taken = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return taken;
+}
+
+bool JobSystem::Deque::Steal(Job& job)
+{
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    // Copied while slot t is still ours to read; only kept if the CAS wins
+    Job copy;
+    Load(t, copy);
+    // Lost to the owner or another thief; the caller just tries elsewhere
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+    job = copy;
+    return true;
+}
+
+bool JobSystem::Deque::Empty() const
+{
+    return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+}
+
+bool JobSystem::Initialize(uint32_t workerCount)
+{
+    Shutdown();
+    workerCount = std::min(workerCount, kMaxWorkers);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(new Worker());
+        m_workers.back()->random = 0x9E3779B9u * (i + 1);
+    }
+    // Threads start only once every deque exists, since they steal from all
+    for (uint32_t i = 0; i < workerCount; ++i) m_workers[i]->thread = std::thread([this, i]() { WorkerMain(i); });
+    return true;
+}
+
+void JobSystem::Shutdown()
+{
+    if (m_workers.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop.store(true);
+        m_wakeEpoch.fetch_add(1);
+    }
+    m_sleep.notify_all();
+    for (auto& w : m_workers) w->thread.join();
+    m_workers.clear();
+    m_injected.clear();
+    m_injectedCount.store(0);
+    m_stop.store(false);
+}
+
+void JobSystem::Run(JobFunction function, void* data, JobCounter& counter)
+{
+    Job job;
+    job.entry = [](JobSystem&, const Job& j) { j.function(j.data); };
+    job.function = function;
+    job.data = data;
+    job.counter = &counter;
+    counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+    Submit(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone()) {
+        if (!RunOne()) std::this_thread::yield();
+    }
+}
+
+void JobSystem::Submit(const Job& job)
+{
+    if (t_system == this) {
+        if (!m_workers[t_worker]->deque.Push(job)) {
+            Execute(job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(m_injectedMutex);
+        m_injected.push_back(job);
+        m_injectedCount.fetch_add(1);
+    }
+    WakeWorkers();
+}
+
+bool JobSystem::RunOne()
+{
+    Worker* self = t_system == this ? m_workers[t_worker].get() : nullptr;
+    Job job;
+    bool found = false;
+    if (self) found = self->deque.Pop(job);
+    if (!found && m_injectedCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_injectedMutex);
+        if (!m_injected.empty()) {
+            job = m_injected.front();
+            m_injected.pop_front();
+            m_injectedCount.fetch_sub(1);
+            found = true;
+        }
+    }
+    if (!found && !m_workers.empty()) {
+        // Start at a random victim so thieves spread out
+        const size_t count = m_workers.size();
+        const size_t start = NextRandom(self ? self->random : t_random) % count;
+        for (size_t k = 0; k < count && !found; ++k) {
+            Worker* victim = m_workers[(start + k) % count].get();
+            if (victim == self) continue;
+            found = victim->deque.Steal(job);
+        }
+    }
+    if (!found) return false;
+    Execute(job);
+    return true;
+}
+
+void JobSystem::Execute(const Job& job)
+{
+    job.entry(*this, job);
+    job.counter->m_pending.fetch_sub(1, std::memory_order_release);
+}
+
+bool JobSystem::HasWork() const
+{
+    if (m_injectedCount.load() > 0) return true;
+    for (const auto& w : m_workers) {
+        if (!w->deque.Empty()) return true;
+    }
+    return false;
+}
+
+// Pairs with the sleeper's re-check in WorkerMain: either it sees the new
+// job, or this sees it counted as asleep and bumps the epoch it waits on
+void JobSystem::WakeWorkers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepers.load() == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wakeEpoch.fetch_add(1);
+    }
+    m_sleep.notify_all();
+}
+
+void JobSystem::WorkerMain(uint32_t index)
+{
+    t_system = this;
+    t_worker = index;
+#if USU_PROFILE
+    char name[32];
+    snprintf(name, sizeof(name), "Worker %u", index);
+    Profiler::SetThreadName(name);
+#endif
+    int idle = 0;
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        if (RunOne()) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < kIdleSpins) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint64_t epoch = m_wakeEpoch.load();
+        m_sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!HasWork()) {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleep.wait(lock, [&]() { return m_wakeEpoch.load() != epoch || m_stop.load(); });
+        }
+        m_sleepers.fetch_sub(1);
+        idle = 0;
+    }
+    t_system = nullptr;
+}
+
+JobSystem& GetJobSystem()
+{
+    static JobSystem system;
+    static const bool started = system.Initialize(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    (void)started;
+    return system;
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class JobSystem;
+
+// Jobs still to finish under this counter, children included: a job run
+// with a counter may Run() more jobs with the same counter (or Wait() on its
+// own), and the counter only reaches zero once all of them have finished.
+class JobCounter
+{
+public:
+    bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_pending{ 0 };
+};
+
+typedef void (*JobFunction)(void* data);
+
+// Fixed pool of worker threads, each with a lock-free work-stealing deque
+// (Chase-Lev): a worker pushes and pops its own jobs at the bottom, idle
+// workers steal from the top of the others. Threads outside the pool (the
+// main thread) submit through a small locked queue and, in Wait(), run or
+// steal jobs instead of blocking. ParallelFor splits a range in halves on
+// demand, so idle workers steal the big halves and the caller keeps the rest.
+class JobSystem
+{
+public:
+    ~JobSystem() { Shutdown(); }
+
+    // workerCount threads besides the callers; 0 runs everything inline
+    bool Initialize(uint32_t workerCount);
+    void Shutdown();
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+    // Workers plus the thread waiting on them
+    uint32_t GetThreadCount() const { return GetWorkerCount() + 1; }
+
+    // data must stay valid until the counter is done
+    void Run(JobFunction function, void* data, JobCounter& counter);
+    // Runs queued jobs on the calling thread until the counter is done
+    void Wait(JobCounter& counter);
+
+    // fn(begin, end) over [0, count) in ranges of at most grain (>= 1);
+    // returns once every range has run
+    template <typename Fn>
+    void ParallelFor(uint32_t count, uint32_t grain, Fn&& fn);
+
+private:
+    struct Job
+    {
+        void (*entry)(JobSystem& system, const Job& job) = nullptr;
+        JobFunction function = nullptr;
+        void* data = nullptr;
+        uint32_t begin = 0, end = 0, grain = 1;
+        JobCounter* counter = nullptr;
+    };
+
+    // Chase-Lev deque holding the jobs themselves; when full the owner runs
+    // the job itself
+    class Deque
+    {
+    public:
+        static const int64_t kCapacity = 1024;
+        bool Push(const Job& job);
+        bool Pop(Job& job);   // owner only
+        bool Steal(Job& job); // any thread
+        bool Empty() const;
+
+    private:
+        // A thief copies a cell before the CAS that claims it, and once that
+        // CAS has lost the owner may already be refilling the cell, so the
+        // words are relaxed atomics and a torn copy is simply discarded
+        static const size_t kJobWords = (sizeof(Job) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        struct Cell
+        {
+            std::atomic<uint64_t> words[kJobWords];
+        };
+        void Store(int64_t index, const Job& job);
+        void Load(int64_t index, Job& job) const;
+
+        std::atomic<int64_t> m_top{ 0 };
+        std::atomic<int64_t> m_bottom{ 0 };
+        Cell m_cells[kCapacity];
+    };
+
+    struct Worker
+    {
+        Deque deque;
+        uint32_t random = 0;
+        std::thread thread;
+    };
+
+    void Submit(const Job& job);
+    bool RunOne();
+    void Execute(const Job& job);
+    void WorkerMain(uint32_t index);
+    bool HasWork() const;
+    void WakeWorkers();
+
+    template <typename Fn>
+    static void ParallelForEntry(JobSystem& system, const Job& job);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::deque<Job> m_injected; // from threads outside the pool
+    std::mutex m_injectedMutex;
+    std::atomic<uint32_t> m_injectedCount{ 0 };
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleep;
+    std::atomic<uint32_t> m_sleepers{ 0 };
+    std::atomic<uint64_t> m_wakeEpoch{ 0 };
+    std::atomic<bool> m_stop{ false };
+};
+
+// The engine-wide pool, started on first use with one worker per core
+// besides the caller
+JobSystem& GetJobSystem();
+
+template <typename Fn>
+void JobSystem::ParallelForEntry(JobSystem& system, const Job& job)
+{
+    // Hand the upper half to whoever is idle until a grain is left
+    Job range = job;
+    while (range.end - range.begin > range.grain) {
+        Job upper = range;
+        upper.begin = range.begin + (range.end - range.begin) / 2;
+        range.end = upper.begin;
+        upper.counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        system.Submit(upper);
+    }
+    (*static_cast<Fn*>(range.data))(range.begin, range.end);
+}
+
+template <typename Fn>
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain, Fn&& fn)
+{
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    if (m_workers.empty() || count <= grain) {
+        fn(0u, count);
+        return;
+    }
+    typedef typename std::remove_reference<Fn>::type Body;
+    JobCounter counter;
+    Job job;
+    job.entry = &ParallelForEntry<Body>;
+    job.data = const_cast<void*>(static_cast<const void*>(&fn));
+    job.end = count;
+    job.grain = grain;
+    job.counter = &counter;
+    counter.m_pending.store(1, std::memory_order_relaxed);
+    Execute(job);
+    Wait(counter);
+}
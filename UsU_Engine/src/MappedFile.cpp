@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+#include <utility>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32)
+static std::string WideToUtf8(const std::wstring& w)
+{
+    // wchar_t is UTF-32 on the POSIX targets we build for
+    std::string out;
+    out.reserve(w.size());
+    for (wchar_t wc : w) {
+        uint32_t c = static_cast<uint32_t>(wc);
+        if (c < 0x80) {
+            out.push_back(static_cast<char>(c));
+        } else if (c < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        } else if (c < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (c >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (c >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+    return out;
+}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_opened = std::exchange(other.m_opened, false);
+#if defined(_WIN32)
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#else
+        m_fd = std::exchange(other.m_fd, -1);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::wstring& path)
+{
+    Close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return false; }
+    m_file = file;
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_opened = true;
+    // Zero-length files cannot be mapped; treat them as an open, empty view
+    if (m_size == 0) return true;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { Close(); return false; }
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) { Close(); return false; }
+    return true;
+#else
+    int fd = ::open(WideToUtf8(path).c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+    m_fd = fd;
+    m_size = static_cast<size_t>(st.st_size);
+    m_opened = true;
+    if (m_size == 0) return true;
+
+    void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) { Close(); return false; }
+    madvise(p, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(p);
+    return true;
+#endif
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_opened = false;
+}
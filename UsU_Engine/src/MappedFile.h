@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. The view stays valid until Close()
+// or destruction, so parsers can hand out pointers into it without copying.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::wstring& path);
+    void Close();
+
+    bool IsOpen() const { return m_opened; }
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_opened = false;
+#if defined(_WIN32)
+    void* m_file = nullptr;    // HANDLE
+    void* m_mapping = nullptr; // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
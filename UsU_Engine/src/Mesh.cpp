@@ -1,10 +1,19 @@
 #include "Mesh.h"
-#include <fstream>
-#include <sstream>
-#include <unordered_map>
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include "Profiler.h"
 #include <string>
-#include <windows.h>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+// Portable builds (tests, benchmarks) log to stderr
+static void OutputDebugStringA(const char* text) { fputs(text, stderr); }
+#endif
 
 using namespace DirectX;
 
@@ -16,81 +25,145 @@ void Mesh::SetDefaultTriangle()
         { XMFLOAT3( 0.5f, -0.5f, 0.0f), XMFLOAT3(0,0,-1), XMFLOAT2(1,1) }
     };
     m_indices = { 0,1,2 };
+    m_submeshes.assign(1, MeshSubmesh());
+    m_submeshes[0].indexCount = 3;
+    m_lods.clear();
+    m_lodIndices.clear();
+    m_bounds = ComputeMeshBounds(m_vertices.data(), m_vertices.size());
 }
 
-static std::string WStringToUtf8(const std::wstring& w)
+bool Mesh::LoadOBJ(const std::wstring& path)
 {
-    if (w.empty()) return {};
-    int size = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), -1, nullptr, 0, nullptr, nullptr);
-    if (size <= 0) return {};
-    std::string out(size - 1, '\0');
-    WideCharToMultiByte(CP_UTF8, 0, w.c_str(), -1, &out[0], size, nullptr, nullptr);
-    return out;
+    m_vertices.clear();
+    m_indices.clear();
+    m_submeshes.clear();
+    m_lods.clear();
+    m_lodIndices.clear();
+    m_bounds = MeshBounds();
+
+    MappedFile file;
+    if (!file.Open(path)) return false;
+
+    ObjParseStats stats;
+    if (!ParseOBJ(reinterpret_cast<const char*>(file.Data()), file.Size(), m_vertices, m_indices, m_submeshes, &stats))
+        return false;
+    m_bounds = ComputeMeshBounds(m_vertices.data(), m_vertices.size());
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), "[Mesh] OBJ parsed: %.2f MB in %.1f ms (%.1f MB/s, %u chunks, %zu verts, %zu indices, %zu submeshes)\n",
+        stats.bytes / (1024.0 * 1024.0), stats.seconds * 1000.0, stats.MegabytesPerSecond(), stats.chunks,
+        m_vertices.size(), m_indices.size(), m_submeshes.size());
+    OutputDebugStringA(msg);
+    return true;
 }
 
-static bool ParseOBJ(const std::wstring& path,
-                     std::vector<XMFLOAT3>& positions,
-                     std::vector<XMFLOAT3>& normals,
-                     std::vector<XMFLOAT2>& uvs,
-                     std::vector<uint32_t>& outIndices,
-                     std::vector<Vertex>& outVertices)
+MeshOptimizeReport Mesh::Optimize(bool reduceOverdraw)
 {
-    std::ifstream file(WStringToUtf8(path).c_str());
-    if (!file.is_open()) return false;
-
-    std::vector<XMFLOAT3> tempPos;
-    std::vector<XMFLOAT3> tempNrm;
-    std::vector<XMFLOAT2> tempUV;
-
-    std::string line;
-    std::unordered_map<std::string, uint32_t> vertMap;
-    outVertices.clear();
-    outIndices.clear();
-
-    while (std::getline(file, line))
-    {
-        std::istringstream iss(line);
-        std::string tag; iss >> tag;
-        if (tag == "v") {
-            float x,y,z; iss >> x >> y >> z; tempPos.push_back({x,y,z});
-        } else if (tag == "vn") {
-            float x,y,z; iss >> x >> y >> z; tempNrm.push_back({x,y,z});
-        } else if (tag == "vt") {
-            float u,v; iss >> u >> v; tempUV.push_back({u,v});
-        } else if (tag == "f") {
-            // supports triangles only
-            std::string vstr[3];
-            iss >> vstr[0] >> vstr[1] >> vstr[2];
-            for (int i=0;i<3;++i) {
-                auto it = vertMap.find(vstr[i]);
-                if (it == vertMap.end()) {
-                    // parse like pos/uv/nrm (indices are 1-based)
-                    int pi=0, ti=0, ni=0;
-                    sscanf_s(vstr[i].c_str(), "%d/%d/%d", &pi, &ti, &ni);
-                    Vertex v{};
-                    if (pi>0 && pi<= (int)tempPos.size()) v.position = tempPos[pi-1];
-                    if (ni>0 && ni<= (int)tempNrm.size()) v.normal = tempNrm[ni-1];
-                    if (ti>0 && ti<= (int)tempUV.size()) v.uv = tempUV[ti-1];
-                    uint32_t newIndex = (uint32_t)outVertices.size();
-                    outVertices.push_back(v);
-                    vertMap[vstr[i]] = newIndex;
-                    outIndices.push_back(newIndex);
-                } else {
-                    outIndices.push_back(it->second);
-                }
-            }
-        }
+    USU_PROFILE_ZONE("OptimizeMesh");
+    MeshOptimizeReport report;
+    m_lods.clear();
+    m_lodIndices.clear();
+    const size_t indexCount = m_indices.size() - m_indices.size() % 3;
+    if (indexCount == 0) return report;
+    if (m_submeshes.empty()) {
+        m_submeshes.assign(1, MeshSubmesh());
+        m_submeshes[0].indexCount = static_cast<uint32_t>(indexCount);
+    }
+    m_indices.resize(indexCount);
+
+    const VertexCacheStats before = AnalyzeVertexCache(m_indices.data(), indexCount, m_vertices.size());
+
+    // Triangles never move between submeshes
+    std::vector<uint32_t> reordered(indexCount);
+    for (const MeshSubmesh& sm : m_submeshes) {
+        uint32_t* range = m_indices.data() + sm.indexOffset;
+        uint32_t* scratch = reordered.data() + sm.indexOffset;
+        OptimizeVertexCache(scratch, range, sm.indexCount, m_vertices.size());
+        if (reduceOverdraw)
+            OptimizeOverdraw(range, scratch, sm.indexCount, m_vertices.data(), m_vertices.size());
+        else
+            memcpy(range, scratch, sm.indexCount * sizeof(uint32_t));
     }
-    return !outVertices.empty();
+
+    std::vector<Vertex> vertices(m_vertices.size());
+    vertices.resize(OptimizeVertexFetch(vertices.data(), m_indices.data(), indexCount, m_vertices.data(), m_vertices.size()));
+    m_vertices.swap(vertices);
+
+    const VertexCacheStats after = AnalyzeVertexCache(m_indices.data(), indexCount, m_vertices.size());
+    report.acmrBefore = before.acmr;
+    report.atvrBefore = before.atvr;
+    report.acmrAfter = after.acmr;
+    report.atvrAfter = after.atvr;
+
+    char msg[192];
+    snprintf(msg, sizeof(msg), "[Mesh] Optimize: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%zu tris, %zu submeshes)\n",
+        before.acmr, after.acmr, before.atvr, after.atvr, indexCount / 3, m_submeshes.size());
+    OutputDebugStringA(msg);
+    return report;
 }
 
-bool Mesh::LoadOBJ(const std::wstring& path)
+void Mesh::BuildLods(const std::vector<float>& ratios, float maxError)
 {
-    std::vector<XMFLOAT3> positions, normals;
-    std::vector<XMFLOAT2> uvs;
-    m_vertices.clear();
-    m_indices.clear();
-    if (!ParseOBJ(path, positions, normals, uvs, m_indices, m_vertices))
-        return false;
-    return true;
+    USU_PROFILE_ZONE("BuildLods");
+    m_lods.clear();
+    m_lodIndices.clear();
+    const size_t indexCount = m_indices.size() - m_indices.size() % 3;
+    if (indexCount == 0 || m_submeshes.empty()) return;
+
+    const size_t submeshCount = m_submeshes.size();
+    for (const MeshSubmesh& sm : m_submeshes) {
+        MeshLod lod0;
+        lod0.indexOffset = sm.indexOffset;
+        lod0.indexCount = sm.indexCount;
+        m_lods.push_back(lod0);
+    }
+
+    // Each level simplifies the previous one per submesh, so errors
+    // accumulate. A submesh that cannot shrink further keeps its last range.
+    std::vector<float> submeshError(submeshCount, 0.0f);
+    std::vector<uint32_t> source, simplified, reordered;
+    for (float ratio : ratios) {
+        const size_t prevLevel = m_lods.size() - submeshCount;
+        std::vector<MeshLod> level(m_lods.begin() + prevLevel, m_lods.end());
+        bool progress = false;
+        size_t levelIndices = 0;
+        for (size_t s = 0; s < submeshCount; ++s) {
+            const MeshLod& prev = m_lods[prevLevel + s];
+            levelIndices += prev.indexCount;
+            const size_t target = static_cast<size_t>(m_submeshes[s].indexCount * ratio) / 3 * 3;
+            if (target < 3 || target >= prev.indexCount) continue;
+
+            const uint32_t* src = prev.indexOffset < indexCount
+                ? m_indices.data() + prev.indexOffset
+                : m_lodIndices.data() + (prev.indexOffset - indexCount);
+            source.assign(src, src + prev.indexCount);
+            simplified.resize(source.size());
+            float error = 0.0f;
+            const size_t count = SimplifyMesh(simplified.data(), source.data(), source.size(),
+                                              m_vertices.data(), m_vertices.size(), target, maxError, &error);
+            // No meaningful progress: keep the previous range
+            if (count == 0 || count > source.size() - source.size() / 10) continue;
+
+            reordered.resize(count);
+            OptimizeVertexCache(reordered.data(), simplified.data(), count, m_vertices.size());
+            level[s].indexOffset = static_cast<uint32_t>(indexCount + m_lodIndices.size());
+            level[s].indexCount = static_cast<uint32_t>(count);
+            m_lodIndices.insert(m_lodIndices.end(), reordered.begin(), reordered.end());
+            submeshError[s] += error;
+            levelIndices += count;
+            levelIndices -= prev.indexCount;
+            progress = true;
+        }
+        // Nothing shrank: the rest of the chain would repeat this level
+        if (!progress) break;
+
+        const float error = *std::max_element(submeshError.begin(), submeshError.end());
+        for (MeshLod& lod : level) lod.error = error;
+        m_lods.insert(m_lods.end(), level.begin(), level.end());
+
+        char msg[160];
+        snprintf(msg, sizeof(msg), "[Mesh] LOD %zu: %zu tris (%.1f%%), error %g\n",
+            GetLodLevelCount() - 1, levelIndices / 3, 100.0 * levelIndices / indexCount, error);
+        OutputDebugStringA(msg);
+    }
 }
@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 #include <DirectXMath.h>
+#include <cstdint>
+#include "Bounds.h"
 
 struct Vertex
 {
@@ -10,17 +12,64 @@ struct Vertex
     DirectX::XMFLOAT2 uv;
 };
 
+struct MeshOptimizeReport
+{
+    float acmrBefore = 0.0f, atvrBefore = 0.0f;
+    float acmrAfter = 0.0f,  atvrAfter = 0.0f;
+};
+
+// A contiguous index range drawn with one material. name is the OBJ usemtl
+// material, or the o/g name for files without materials.
+struct MeshSubmesh
+{
+    std::string name;
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+};
+
+// One submesh at one level of detail: a range of GetIndices() followed by
+// GetLodIndices() (LOD 0 is the submesh range itself). error is the
+// object-space deviation from LOD 0, shared by all submeshes of a level, for
+// SelectLod().
+struct MeshLod
+{
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    float    error = 0.0f;
+};
+
 class Mesh
 {
 public:
     bool LoadOBJ(const std::wstring& path);
 
+    // Reorders triangles for vertex cache reuse (and optionally overdraw)
+    // within each submesh, then renumbers vertices in first-use order.
+    // Rendering is unaffected.
+    MeshOptimizeReport Optimize(bool reduceOverdraw = true);
+
+    // Builds a simplified LOD chain sharing the vertex buffer, each level
+    // targeting a ratio of LOD 0's triangles per submesh. GetLods() holds
+    // levels x submeshes entries, level-major. Call after Optimize(), which
+    // discards it. Stops early once maxError (object units) is reached.
+    void BuildLods(const std::vector<float>& ratios = { 0.5f, 0.25f, 0.125f, 0.0625f }, float maxError = 1e30f);
+
     const std::vector<Vertex>& GetVertices() const { return m_vertices; }
     const std::vector<uint32_t>& GetIndices()  const { return m_indices; }
+    const std::vector<MeshSubmesh>& GetSubmeshes() const { return m_submeshes; }
+    const std::vector<MeshLod>&  GetLods()     const { return m_lods; }
+    const std::vector<uint32_t>& GetLodIndices() const { return m_lodIndices; }
+    size_t GetLodLevelCount() const { return m_submeshes.empty() ? 0 : m_lods.size() / m_submeshes.size(); }
+    // Object space, computed at load; still conservative after Optimize()
+    const MeshBounds& GetBounds() const { return m_bounds; }
 
     void SetDefaultTriangle();
 
 private:
     std::vector<Vertex>   m_vertices;
     std::vector<uint32_t> m_indices;
+    std::vector<MeshSubmesh> m_submeshes;
+    std::vector<MeshLod>  m_lods;
+    std::vector<uint32_t> m_lodIndices;
+    MeshBounds m_bounds;
 };
@@ -0,0 +1,203 @@
+#include "MeshCache.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+static uint64_t AlignUp(uint64_t v, uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+static bool GetSourceStamp(const std::wstring& path, uint64_t& size, uint64_t& writeTime)
+{
+    std::error_code ec;
+    const std::filesystem::path p(path);
+    const auto sz = std::filesystem::file_size(p, ec);
+    if (ec) return false;
+    const auto t = std::filesystem::last_write_time(p, ec);
+    if (ec) return false;
+    size = static_cast<uint64_t>(sz);
+    writeTime = static_cast<uint64_t>(t.time_since_epoch().count());
+    return true;
+}
+
+static bool HashSource(const std::wstring& path, uint64_t& hash)
+{
+    MappedFile file;
+    if (!file.Open(path)) return false;
+    hash = HashBytes64(file.Data(), file.Size());
+    return true;
+}
+
+// Updates the stamp in place once the hash has shown the cache is current,
+// so the next Open takes the cheap path. Best effort: a cache that cannot be
+// written (read-only directory) just stays on the hash path.
+static void RestampSource(const std::wstring& cachePath, uint64_t writeTime)
+{
+    std::fstream f(std::filesystem::path(cachePath), std::ios::in | std::ios::out | std::ios::binary);
+    if (!f) return;
+    f.seekp(offsetof(MeshCacheHeader, sourceWriteTime));
+    f.write(reinterpret_cast<const char*>(&writeTime), sizeof(writeTime));
+}
+
+std::wstring MeshCache::PathFor(const std::wstring& sourcePath)
+{
+    const size_t slash = sourcePath.find_last_of(L"/\\");
+    const size_t dot = sourcePath.find_last_of(L'.');
+    if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash))
+        return sourcePath + L".usumesh";
+    return sourcePath.substr(0, dot) + L".usumesh";
+}
+
+bool MeshCache::Write(const std::wstring& cachePath, const std::wstring& sourcePath, const Mesh& mesh)
+{
+    const auto& vertices = mesh.GetVertices();
+    const auto& indices = mesh.GetIndices();
+    const auto& lods = mesh.GetLods();
+    const auto& lodIndices = mesh.GetLodIndices();
+    const auto& submeshes = mesh.GetSubmeshes();
+    if (vertices.empty() || indices.empty()) return false;
+
+    MeshCacheHeader header{};
+    header.magic = kMeshCacheMagic;
+    header.version = kMeshCacheVersion;
+    if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceWriteTime)) return false;
+    if (!HashSource(sourcePath, header.sourceHash)) return false;
+    header.vertexStride = sizeof(Vertex);
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    header.lodIndexCount = static_cast<uint32_t>(lodIndices.size());
+    header.submeshCount = static_cast<uint32_t>(submeshes.size());
+
+    const uint64_t vbBytes = vertices.size() * sizeof(Vertex);
+    const uint64_t ibBytes = indices.size() * sizeof(uint32_t);
+    const uint64_t lodIbBytes = lodIndices.size() * sizeof(uint32_t);
+    header.vertexOffset = AlignUp(sizeof(MeshCacheHeader), kMeshCacheAlignment);
+    header.indexOffset = AlignUp(header.vertexOffset + vbBytes, kMeshCacheAlignment);
+    header.lodOffset = header.indexOffset + ibBytes + lodIbBytes;
+    header.submeshOffset = header.lodOffset + lods.size() * sizeof(MeshLod);
+
+    std::vector<MeshCacheSubmesh> submeshTable(submeshes.size());
+    for (size_t i = 0; i < submeshes.size(); ++i) {
+        MeshCacheSubmesh& dst = submeshTable[i];
+        memset(&dst, 0, sizeof(dst));
+        dst.indexOffset = submeshes[i].indexOffset;
+        dst.indexCount = submeshes[i].indexCount;
+        memcpy(dst.name, submeshes[i].name.data(), std::min(submeshes[i].name.size(), sizeof(dst.name) - 1));
+    }
+
+    // Write to a temporary and rename so a crash never leaves a torn cache
+    const std::filesystem::path finalPath(cachePath);
+    std::filesystem::path tmpPath = finalPath;
+    tmpPath += L".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        static const char zeros[kMeshCacheAlignment] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(zeros, static_cast<std::streamsize>(header.vertexOffset - sizeof(header)));
+        out.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vbBytes));
+        out.write(zeros, static_cast<std::streamsize>(header.indexOffset - header.vertexOffset - vbBytes));
+        out.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(ibBytes));
+        out.write(reinterpret_cast<const char*>(lodIndices.data()), static_cast<std::streamsize>(lodIbBytes));
+        out.write(reinterpret_cast<const char*>(lods.data()), static_cast<std::streamsize>(lods.size() * sizeof(MeshLod)));
+        out.write(reinterpret_cast<const char*>(submeshTable.data()),
+                  static_cast<std::streamsize>(submeshTable.size() * sizeof(MeshCacheSubmesh)));
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, finalPath, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::Open(const std::wstring& cachePath, const std::wstring& sourcePath)
+{
+    Close();
+    if (!m_file.Open(cachePath)) return false;
+
+    const size_t fileSize = m_file.Size();
+    if (fileSize < sizeof(MeshCacheHeader)) { Close(); return false; }
+    const auto* header = reinterpret_cast<const MeshCacheHeader*>(m_file.Data());
+    if (header->magic != kMeshCacheMagic || header->version != kMeshCacheVersion ||
+        header->vertexStride != sizeof(Vertex) || header->vertexCount == 0 || header->indexCount == 0 ||
+        (header->vertexOffset % kMeshCacheAlignment) != 0 || (header->indexOffset % kMeshCacheAlignment) != 0 ||
+        header->vertexOffset + uint64_t(header->vertexCount) * sizeof(Vertex) > fileSize ||
+        header->indexOffset + (uint64_t(header->indexCount) + header->lodIndexCount) * sizeof(uint32_t) > fileSize ||
+        header->lodOffset + uint64_t(header->lodCount) * sizeof(MeshLod) > fileSize ||
+        header->submeshOffset + uint64_t(header->submeshCount) * sizeof(MeshCacheSubmesh) > fileSize) {
+        Close();
+        return false;
+    }
+
+    // Submeshes are drawn as they are, so unlike a bad LOD chain a range
+    // outside the LOD 0 indices or not whole triangles rejects the file
+    const auto* submeshes = reinterpret_cast<const MeshCacheSubmesh*>(m_file.Data() + header->submeshOffset);
+    for (uint32_t i = 0; i < header->submeshCount; ++i) {
+        if (uint64_t(submeshes[i].indexOffset) + submeshes[i].indexCount > header->indexCount ||
+            submeshes[i].indexCount % 3 != 0) {
+            Close();
+            return false;
+        }
+    }
+
+    // Stale check: size and write time are free; only hash when they disagree
+    // (e.g. the OBJ was touched or copied without changing its contents)
+    uint64_t srcSize = 0, srcTime = 0;
+    if (!GetSourceStamp(sourcePath, srcSize, srcTime) || srcSize != header->sourceSize) { Close(); return false; }
+    if (srcTime != header->sourceWriteTime) {
+        uint64_t hash = 0;
+        if (!HashSource(sourcePath, hash) || hash != header->sourceHash) { Close(); return false; }
+        // The mapping does not share write access, so restamp unmapped and
+        // map again; only the stamp changed
+        m_file.Close();
+        RestampSource(cachePath, srcTime);
+        if (!m_file.Open(cachePath) || m_file.Size() != fileSize) { Close(); return false; }
+        header = reinterpret_cast<const MeshCacheHeader*>(m_file.Data());
+    }
+
+    m_vertices = reinterpret_cast<const Vertex*>(m_file.Data() + header->vertexOffset);
+    m_indices = reinterpret_cast<const uint32_t*>(m_file.Data() + header->indexOffset);
+    m_vertexCount = header->vertexCount;
+    m_indexCount = header->indexCount;
+
+    const auto* table = reinterpret_cast<const MeshCacheSubmesh*>(m_file.Data() + header->submeshOffset);
+    m_submeshes.resize(header->submeshCount);
+    for (uint32_t i = 0; i < header->submeshCount; ++i) {
+        m_submeshes[i].name.assign(table[i].name, strnlen(table[i].name, sizeof(table[i].name)));
+        m_submeshes[i].indexOffset = table[i].indexOffset;
+        m_submeshes[i].indexCount = table[i].indexCount;
+    }
+
+    // A chain that does not fit the submeshes or the index blob is ignored,
+    // leaving LOD 0 only
+    const auto* lods = reinterpret_cast<const MeshLod*>(m_file.Data() + header->lodOffset);
+    const uint64_t totalIndices = uint64_t(header->indexCount) + header->lodIndexCount;
+    bool lodsValid = header->lodCount > 0 && header->submeshCount > 0 && header->lodCount % header->submeshCount == 0;
+    for (uint32_t i = 0; lodsValid && i < header->lodCount; ++i)
+        lodsValid = uint64_t(lods[i].indexOffset) + lods[i].indexCount <= totalIndices && lods[i].indexCount % 3 == 0;
+    if (lodsValid) {
+        m_lods = lods;
+        m_lodCount = header->lodCount;
+        m_lodIndexCount = header->lodIndexCount;
+    }
+    return true;
+}
+
+void MeshCache::Close()
+{
+    m_file.Close();
+    m_vertices = nullptr;
+    m_indices = nullptr;
+    m_vertexCount = 0;
+    m_indexCount = 0;
+    m_lods = nullptr;
+    m_lodCount = 0;
+    m_lodIndexCount = 0;
+    m_submeshes.clear();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Mesh.h"
+
+// On-disk layout of a .usumesh file (little endian). The vertex and index
+// blobs start on kMeshCacheAlignment boundaries so a mapped view can be
+// copied straight into GPU buffers. LOD indices follow the LOD 0 indices in
+// the same blob, so MeshLod::indexOffset applies to it directly.
+// LOD entries are levels x submeshes, as in Mesh::GetLods().
+static const uint32_t kMeshCacheMagic = 0x4D555355; // "USUM"
+static const uint32_t kMeshCacheVersion = 4; // 2: contents are Mesh::Optimize()d, 3: LOD chain, 4: submeshes
+static const uint32_t kMeshCacheAlignment = 64;
+
+struct MeshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;      // cheap staleness check, compared first
+    uint64_t sourceWriteTime;
+    uint64_t sourceHash;      // HashBytes64 of the OBJ contents
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t reserved;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t lodCount;        // MeshLod entries at lodOffset, 0 if none
+    uint32_t lodIndexCount;   // indices after the first indexCount
+    uint64_t lodOffset;
+    uint32_t submeshCount;    // MeshCacheSubmesh entries at submeshOffset
+    uint32_t reserved2;
+    uint64_t submeshOffset;
+};
+static_assert(sizeof(MeshCacheHeader) == 96, "MeshCacheHeader layout changed");
+
+// Submesh names longer than the field are truncated
+struct MeshCacheSubmesh
+{
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    char     name[56];
+};
+static_assert(sizeof(MeshCacheSubmesh) == 64, "MeshCacheSubmesh layout changed");
+
+// Read side keeps the file mapped; the pointers stay valid until Close().
+class MeshCache
+{
+public:
+    // <dir>\<name>.obj -> <dir>\<name>.usumesh
+    static std::wstring PathFor(const std::wstring& sourcePath);
+
+    // Writes mesh to cachePath, stamped with the current state of sourcePath.
+    static bool Write(const std::wstring& cachePath, const std::wstring& sourcePath, const Mesh& mesh);
+
+    // Maps cachePath and validates it against sourcePath. Size and write time
+    // are compared first; the source is only hashed if those disagree, and a
+    // matching hash rewrites the cache's write time so the next Open skips it.
+    bool Open(const std::wstring& cachePath, const std::wstring& sourcePath);
+    void Close();
+
+    const Vertex*   GetVertices()    const { return m_vertices; }
+    const uint32_t* GetIndices()     const { return m_indices; }
+    uint32_t        GetVertexCount() const { return m_vertexCount; }
+    uint32_t        GetIndexCount()  const { return m_indexCount; }
+    const MeshLod*  GetLods()        const { return m_lods; }
+    uint32_t        GetLodCount()    const { return m_lodCount; }
+    // LOD indices follow the first GetIndexCount() in GetIndices(); every
+    // LOD range lies within the two (checked by Open)
+    uint32_t        GetLodIndexCount() const { return m_lodIndexCount; }
+    uint32_t        GetLodLevelCount() const { return m_submeshes.empty() ? 0 : m_lodCount / static_cast<uint32_t>(m_submeshes.size()); }
+    // Index range of one submesh at one level, level < GetLodLevelCount()
+    const MeshLod&  GetLod(uint32_t level, uint32_t submesh) const { return m_lods[level * m_submeshes.size() + submesh]; }
+    const std::vector<MeshSubmesh>& GetSubmeshes() const { return m_submeshes; }
+
+private:
+    MappedFile m_file;
+    const Vertex*   m_vertices = nullptr;
+    const uint32_t* m_indices = nullptr;
+    uint32_t m_vertexCount = 0;
+    uint32_t m_indexCount = 0;
+    const MeshLod* m_lods = nullptr;
+    uint32_t m_lodCount = 0;
+    uint32_t m_lodIndexCount = 0;
+    std::vector<MeshSubmesh> m_submeshes;
+};
@@ -0,0 +1,50 @@
+#include "MeshIndexing.h"
+#include <algorithm>
+
+static const uint32_t kMaxRangeVertices = 65536;
+
+bool SplitIndexRanges16(const uint32_t* indices, size_t indexCount, std::vector<IndexRange>& ranges)
+{
+    ranges.clear();
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0) return false;
+
+    IndexRange current;
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (size_t t = 0; t < triCount; ++t) {
+        const uint32_t a = indices[t * 3 + 0], b = indices[t * 3 + 1], c = indices[t * 3 + 2];
+        const uint32_t triLo = std::min({ a, b, c });
+        const uint32_t triHi = std::max({ a, b, c });
+        if (triHi - triLo >= kMaxRangeVertices) {
+            ranges.clear();
+            return false;
+        }
+        const uint32_t newLo = std::min(lo, triLo);
+        const uint32_t newHi = std::max(hi, triHi);
+        if (current.indexCount > 0 && newHi - newLo >= kMaxRangeVertices) {
+            // Close the run; this triangle starts the next one
+            current.baseVertex = static_cast<int32_t>(lo);
+            ranges.push_back(current);
+            current.firstIndex = static_cast<uint32_t>(t * 3);
+            current.indexCount = 0;
+            lo = triLo;
+            hi = triHi;
+        } else {
+            lo = newLo;
+            hi = newHi;
+        }
+        current.indexCount += 3;
+    }
+    current.baseVertex = static_cast<int32_t>(lo);
+    ranges.push_back(current);
+    return true;
+}
+
+void WriteIndices16(uint16_t* dst, const uint32_t* indices, const std::vector<IndexRange>& ranges)
+{
+    for (const IndexRange& r : ranges) {
+        const uint32_t base = static_cast<uint32_t>(r.baseVertex);
+        for (uint32_t i = r.firstIndex; i < r.firstIndex + r.indexCount; ++i)
+            dst[i] = static_cast<uint16_t>(indices[i] - base);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A contiguous run of triangles drawn with one DrawIndexedInstanced call.
+// Indices inside the run are relative to baseVertex.
+struct IndexRange
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t  baseVertex = 0;
+    uint32_t submesh = 0; // MeshSubmesh the run belongs to
+};
+
+// Splits a 32-bit triangle list into runs whose referenced vertices span at
+// most 65536 entries, so each run can be stored as 16-bit indices relative
+// to its lowest vertex. A single run is produced when the whole mesh fits.
+// Returns false (ranges cleared) if one triangle alone spans more than that,
+// in which case the caller should keep 32-bit indices.
+bool SplitIndexRanges16(const uint32_t* indices, size_t indexCount, std::vector<IndexRange>& ranges);
+
+// Writes the 16-bit index buffer described by ranges; dst holds indexCount
+// entries and may point straight into a mapped upload buffer.
+void WriteIndices16(uint16_t* dst, const uint32_t* indices, const std::vector<IndexRange>& ranges);
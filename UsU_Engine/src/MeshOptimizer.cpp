@@ -0,0 +1,266 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+// Forsyth scoring parameters, see "Linear-Speed Vertex Cache Optimisation"
+static const int   kForsythCacheSize = 32;
+static const int   kForsythMaxValence = 32;
+static const float kCacheDecayPower = 1.5f;
+static const float kLastTriScore = 0.75f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+
+struct ForsythTables
+{
+    float cache[kForsythCacheSize];
+    float valence[kForsythMaxValence + 1];
+
+    ForsythTables()
+    {
+        for (int i = 0; i < kForsythCacheSize; ++i) {
+            if (i < 3) {
+                // The three most recent vertices belong to the last triangle;
+                // a fixed score avoids favouring one of them
+                cache[i] = kLastTriScore;
+            } else {
+                const float scaler = 1.0f / (kForsythCacheSize - 3);
+                cache[i] = std::pow(1.0f - (i - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i <= kForsythMaxValence; ++i)
+            valence[i] = kValenceBoostScale * std::pow(static_cast<float>(i), -kValenceBoostPower);
+    }
+};
+
+static float ForsythVertexScore(const ForsythTables& t, int cachePos, uint32_t remaining)
+{
+    if (remaining == 0) return -1.0f;
+    float score = cachePos >= 0 ? t.cache[cachePos] : 0.0f;
+    score += remaining <= (uint32_t)kForsythMaxValence
+        ? t.valence[remaining]
+        : kValenceBoostScale * std::pow(static_cast<float>(remaining), -kValenceBoostPower);
+    return score;
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize)
+{
+    VertexCacheStats stats;
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0 || vertexCount == 0) return stats;
+
+    // FIFO simulation via timestamps: a vertex is resident while fewer than
+    // cacheSize misses happened since it was loaded
+    std::vector<uint32_t> stamp(vertexCount, 0);
+    std::vector<char> seen(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0, referenced = 0;
+    for (size_t i = 0; i < triCount * 3; ++i) {
+        const uint32_t v = indices[i];
+        if (v >= vertexCount) continue;
+        if (!seen[v]) { seen[v] = 1; ++referenced; }
+        if (time - stamp[v] > cacheSize) {
+            stamp[v] = time++;
+            ++misses;
+        }
+    }
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triCount);
+    stats.atvr = referenced ? static_cast<float>(misses) / static_cast<float>(referenced) : 0.0f;
+    return stats;
+}
+
+void OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    static const ForsythTables tables;
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0) return;
+
+    // Triangle adjacency per vertex; the first remaining[v] entries of each
+    // list are the triangles that have not been emitted yet
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triCount * 3; ++i) remaining[indices[i]]++;
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<uint32_t> adjacency(triCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<int> cachePos(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScore[v] = ForsythVertexScore(tables, -1, remaining[v]);
+
+    std::vector<char> emitted(triCount, 0);
+    int best = 0;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triCount; ++t) {
+        const float s = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (s > bestScore) { bestScore = s; best = static_cast<int>(t); }
+    }
+
+    uint32_t cache[kForsythCacheSize + 3];
+    uint32_t newCache[kForsythCacheSize + 3];
+    int cacheCount = 0;
+    size_t cursor = 0;
+    size_t out = 0;
+
+    while (out < triCount * 3) {
+        if (best < 0) {
+            // Nothing adjacent to the cache is left; continue with the next
+            // unemitted triangle in input order
+            while (cursor < triCount && emitted[cursor]) ++cursor;
+            if (cursor == triCount) break;
+            best = static_cast<int>(cursor);
+        }
+
+        const uint32_t* tri = indices + static_cast<size_t>(best) * 3;
+        dst[out++] = tri[0];
+        dst[out++] = tri[1];
+        dst[out++] = tri[2];
+        emitted[best] = 1;
+
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = tri[k];
+            uint32_t* list = adjacency.data() + offsets[v];
+            for (uint32_t i = 0; i < remaining[v]; ++i) {
+                if (list[i] == static_cast<uint32_t>(best)) {
+                    list[i] = list[remaining[v] - 1];
+                    remaining[v]--;
+                    break;
+                }
+            }
+        }
+
+        // New LRU order: the emitted triangle's vertices move to the front
+        int newCount = 0;
+        newCache[newCount++] = tri[0];
+        newCache[newCount++] = tri[1];
+        newCache[newCount++] = tri[2];
+        for (int i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) newCache[newCount++] = v;
+        }
+        for (int i = kForsythCacheSize; i < newCount; ++i) cachePos[newCache[i]] = -1;
+        for (int i = 0; i < std::min(newCount, kForsythCacheSize); ++i) cachePos[newCache[i]] = i;
+        for (int i = 0; i < newCount; ++i)
+            vertexScore[newCache[i]] = ForsythVertexScore(tables, cachePos[newCache[i]], remaining[newCache[i]]);
+
+        // Only triangles touching the (old or new) cache can change score
+        best = -1;
+        bestScore = -1.0f;
+        for (int i = 0; i < newCount; ++i) {
+            const uint32_t v = newCache[i];
+            const uint32_t* list = adjacency.data() + offsets[v];
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                const uint32_t t = list[j];
+                const float s = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (s > bestScore) { bestScore = s; best = static_cast<int>(t); }
+            }
+        }
+
+        cacheCount = std::min(newCount, kForsythCacheSize);
+        memcpy(cache, newCache, sizeof(uint32_t) * cacheCount);
+    }
+}
+
+void OptimizeOverdraw(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                      const Vertex* vertices, size_t vertexCount, float threshold)
+{
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0) return;
+
+    // Cluster boundaries are triangles that miss on all three vertices; the
+    // cache is cold there anyway, so clusters can be reordered cheaply
+    const unsigned kCacheSize = 16;
+    std::vector<uint32_t> stamp(vertexCount, 0);
+    uint32_t time = kCacheSize + 1;
+    std::vector<uint32_t> clusterStart;
+    for (size_t t = 0; t < triCount; ++t) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = indices[t * 3 + k];
+            if (time - stamp[v] > kCacheSize) { stamp[v] = time++; ++misses; }
+        }
+        if (t == 0 || misses == 3) clusterStart.push_back(static_cast<uint32_t>(t));
+    }
+    clusterStart.push_back(static_cast<uint32_t>(triCount));
+    const size_t clusterCount = clusterStart.size() - 1;
+
+    // Area-weighted centroid and normal per cluster
+    std::vector<XMFLOAT3> centroid(clusterCount), normal(clusterCount);
+    double meshC[3] = {}, meshArea = 0.0;
+    for (size_t c = 0; c < clusterCount; ++c) {
+        double cc[3] = {}, nn[3] = {}, area = 0.0;
+        for (uint32_t t = clusterStart[c]; t < clusterStart[c + 1]; ++t) {
+            const XMFLOAT3& a = vertices[indices[t * 3 + 0]].position;
+            const XMFLOAT3& b = vertices[indices[t * 3 + 1]].position;
+            const XMFLOAT3& d = vertices[indices[t * 3 + 2]].position;
+            const double e1[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+            const double e2[3] = { d.x - a.x, d.y - a.y, d.z - a.z };
+            const double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            const double w = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5;
+            cc[0] += (a.x + b.x + d.x) / 3.0 * w;
+            cc[1] += (a.y + b.y + d.y) / 3.0 * w;
+            cc[2] += (a.z + b.z + d.z) / 3.0 * w;
+            nn[0] += n[0]; nn[1] += n[1]; nn[2] += n[2];
+            area += w;
+        }
+        meshC[0] += cc[0]; meshC[1] += cc[1]; meshC[2] += cc[2];
+        meshArea += area;
+        const double inv = area > 0.0 ? 1.0 / area : 0.0;
+        centroid[c] = XMFLOAT3((float)(cc[0] * inv), (float)(cc[1] * inv), (float)(cc[2] * inv));
+        const double len = std::sqrt(nn[0] * nn[0] + nn[1] * nn[1] + nn[2] * nn[2]);
+        const double ninv = len > 0.0 ? 1.0 / len : 0.0;
+        normal[c] = XMFLOAT3((float)(nn[0] * ninv), (float)(nn[1] * ninv), (float)(nn[2] * ninv));
+    }
+    if (meshArea > 0.0) { meshC[0] /= meshArea; meshC[1] /= meshArea; meshC[2] /= meshArea; }
+
+    // Clusters facing away from the mesh centre are likely occluders; draw them first
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        sortKey[c] = (centroid[c].x - (float)meshC[0]) * normal[c].x +
+                     (centroid[c].y - (float)meshC[1]) * normal[c].y +
+                     (centroid[c].z - (float)meshC[2]) * normal[c].z;
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) order[c] = static_cast<uint32_t>(c);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+    size_t out = 0;
+    for (uint32_t c : order) {
+        const size_t first = static_cast<size_t>(clusterStart[c]) * 3;
+        const size_t count = static_cast<size_t>(clusterStart[c + 1] - clusterStart[c]) * 3;
+        memcpy(dst + out, indices + first, count * sizeof(uint32_t));
+        out += count;
+    }
+
+    const float acmrIn = AnalyzeVertexCache(indices, triCount * 3, vertexCount, kCacheSize).acmr;
+    const float acmrOut = AnalyzeVertexCache(dst, triCount * 3, vertexCount, kCacheSize).acmr;
+    if (acmrOut > acmrIn * threshold)
+        memcpy(dst, indices, triCount * 3 * sizeof(uint32_t));
+}
+
+size_t OptimizeVertexFetch(Vertex* dstVertices, uint32_t* indices, size_t indexCount,
+                           const Vertex* vertices, size_t vertexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        const uint32_t v = indices[i];
+        if (remap[v] == UINT32_MAX) {
+            remap[v] = next;
+            dstVertices[next] = vertices[v];
+            ++next;
+        }
+        indices[i] = remap[v];
+    }
+    return next;
+}
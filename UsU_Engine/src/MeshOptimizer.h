@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Mesh.h"
+
+// Post-transform cache statistics from a FIFO cache simulation.
+// ACMR = misses per triangle (0.5 is ideal for large regular grids, 3 is worst)
+// ATVR = misses per referenced vertex (1.0 is ideal)
+struct VertexCacheStats
+{
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                    unsigned cacheSize = 16);
+
+// Reorders triangles for post-transform cache reuse (Forsyth's linear-speed
+// algorithm). dst and indices must not alias.
+void OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// Reorders clusters of an already cache-optimized index buffer so outward
+// facing clusters are drawn first, which reduces overdraw. The result is
+// rejected (input copied through) if ACMR grows beyond threshold times the
+// input's. dst and indices must not alias.
+void OptimizeOverdraw(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                      const Vertex* vertices, size_t vertexCount, float threshold = 1.05f);
+
+// Rewrites indices in place so vertices are numbered in first-use order and
+// writes the reordered vertices to dstVertices (vertexCount capacity).
+// Unreferenced vertices are dropped; returns the number written.
+size_t OptimizeVertexFetch(Vertex* dstVertices, uint32_t* indices, size_t indexCount,
+                           const Vertex* vertices, size_t vertexCount);
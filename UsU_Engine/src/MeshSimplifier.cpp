@@ -0,0 +1,381 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace {
+
+// Symmetric 3x3 A, vector b, scalar c and accumulated weight w:
+// error(p) = (p^T A p + 2 b.p + c) / w, i.e. a weighted mean squared distance
+struct Quadric
+{
+    double a00 = 0, a11 = 0, a22 = 0, a10 = 0, a20 = 0, a21 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0, w = 0;
+};
+
+enum VertexKind : uint8_t
+{
+    kKindManifold,
+    kKindBorder,
+    kKindSeam,
+    kKindLocked,
+};
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    float cost;
+};
+
+struct PositionKey
+{
+    uint32_t x, y, z;
+    bool operator==(const PositionKey& o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct PositionKeyHash
+{
+    size_t operator()(const PositionKey& k) const
+    {
+        uint64_t h = k.x * 73856093ull ^ k.y * 19349663ull ^ k.z * 83492791ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+
+// Per-vertex lists stored contiguously (CSR)
+struct VertexLists
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> items;
+
+    const uint32_t* Begin(uint32_t v) const { return items.data() + offsets[v]; }
+    const uint32_t* End(uint32_t v) const { return items.data() + offsets[v + 1]; }
+};
+
+} // namespace
+
+static const double kBorderWeight = 10.0;
+static const int kMaxPasses = 100;
+
+static void QuadricAdd(Quadric& q, const Quadric& r)
+{
+    q.a00 += r.a00; q.a11 += r.a11; q.a22 += r.a22;
+    q.a10 += r.a10; q.a20 += r.a20; q.a21 += r.a21;
+    q.b0 += r.b0; q.b1 += r.b1; q.b2 += r.b2;
+    q.c += r.c; q.w += r.w;
+}
+
+static Quadric PlaneQuadric(double nx, double ny, double nz, double d, double w)
+{
+    Quadric q;
+    q.a00 = w * nx * nx; q.a11 = w * ny * ny; q.a22 = w * nz * nz;
+    q.a10 = w * ny * nx; q.a20 = w * nz * nx; q.a21 = w * nz * ny;
+    q.b0 = w * nx * d; q.b1 = w * ny * d; q.b2 = w * nz * d;
+    q.c = w * d * d;
+    q.w = w;
+    return q;
+}
+
+static double QuadricError(const Quadric& q, const XMFLOAT3& p)
+{
+    const double x = p.x, y = p.y, z = p.z;
+    const double rx = q.a00 * x + q.a10 * y + q.a20 * z;
+    const double ry = q.a10 * x + q.a11 * y + q.a21 * z;
+    const double rz = q.a20 * x + q.a21 * y + q.a22 * z;
+    const double r = x * rx + y * ry + z * rz + 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    return q.w > 0.0 ? std::fabs(r) / q.w : std::fabs(r);
+}
+
+static void BuildLists(VertexLists& out, size_t vertexCount, const std::vector<uint32_t>& indices, int mode)
+{
+    // mode 0: outgoing edge targets, 1: incoming edge sources, 2: triangles
+    const size_t triCount = indices.size() / 3;
+    out.offsets.assign(vertexCount + 1, 0);
+    for (size_t i = 0; i < triCount * 3; ++i) out.offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) out.offsets[v + 1] += out.offsets[v];
+    out.items.resize(triCount * 3);
+    std::vector<uint32_t> fill(out.offsets.begin(), out.offsets.end() - 1);
+    for (size_t t = 0; t < triCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = indices[t * 3 + k];
+            uint32_t item;
+            if (mode == 0)      item = indices[t * 3 + (k + 1) % 3];
+            else if (mode == 1) item = indices[t * 3 + (k + 2) % 3];
+            else                item = static_cast<uint32_t>(t);
+            out.items[fill[v]++] = item;
+        }
+    }
+}
+
+static bool HasEdge(const VertexLists& out, uint32_t a, uint32_t b)
+{
+    for (const uint32_t* it = out.Begin(a); it != out.End(a); ++it)
+        if (*it == b) return true;
+    return false;
+}
+
+static inline XMFLOAT3 TriNormal(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+{
+    const float e1x = b.x - a.x, e1y = b.y - a.y, e1z = b.z - a.z;
+    const float e2x = c.x - a.x, e2y = c.y - a.y, e2z = c.z - a.z;
+    return XMFLOAT3(e1y * e2z - e1z * e2y, e1z * e2x - e1x * e2z, e1x * e2y - e1y * e2x);
+}
+
+size_t SimplifyMesh(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                    const Vertex* vertices, size_t vertexCount,
+                    size_t targetIndexCount, float maxError, float* outError)
+{
+    if (outError) *outError = 0.0f;
+    std::vector<uint32_t> current(indices, indices + (indexCount - indexCount % 3));
+    if (current.empty() || vertexCount == 0) return 0;
+
+    // Weld by exact position: rep is the first vertex at a position, wedge
+    // links all vertices sharing it in a ring (attribute seams)
+    std::vector<uint32_t> rep(vertexCount), wedge(vertexCount);
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> map;
+        map.reserve(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            const XMFLOAT3& p = vertices[v].position;
+            PositionKey key;
+            const float px = p.x + 0.0f, py = p.y + 0.0f, pz = p.z + 0.0f; // fold -0 into +0
+            memcpy(&key.x, &px, 4);
+            memcpy(&key.y, &py, 4);
+            memcpy(&key.z, &pz, 4);
+            rep[v] = map.try_emplace(key, v).first->second;
+            wedge[v] = v;
+            if (rep[v] != v) {
+                wedge[v] = wedge[rep[v]];
+                wedge[rep[v]] = v;
+            }
+        }
+    }
+
+    VertexLists outEdges, inEdges, vertexTris;
+    std::vector<char> referenced(vertexCount);
+    std::vector<uint8_t> kind(vertexCount);
+
+    auto hasPositionEdge = [&](uint32_t a, uint32_t b) {
+        // Any wedge of a -> any wedge of b
+        uint32_t wa = a;
+        do {
+            if (referenced[wa]) {
+                for (const uint32_t* it = outEdges.Begin(wa); it != outEdges.End(wa); ++it)
+                    if (rep[*it] == rep[b]) return true;
+            }
+            wa = wedge[wa];
+        } while (wa != a);
+        return false;
+    };
+    auto otherWedge = [&](uint32_t v) -> uint32_t {
+        // The single other referenced vertex at v's position (seam vertices)
+        for (uint32_t w = wedge[v]; w != v; w = wedge[w])
+            if (referenced[w]) return w;
+        return v;
+    };
+    auto liveWedges = [&](uint32_t v) {
+        uint32_t n = 0, w = v;
+        do { n += referenced[w] ? 1 : 0; w = wedge[w]; } while (w != v);
+        return n;
+    };
+    auto classify = [&]() {
+        BuildLists(outEdges, vertexCount, current, 0);
+        BuildLists(inEdges, vertexCount, current, 1);
+        BuildLists(vertexTris, vertexCount, current, 2);
+        std::fill(referenced.begin(), referenced.end(), 0);
+        for (uint32_t i : current) referenced[i] = 1;
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            kind[v] = kKindLocked;
+            if (!referenced[v]) continue;
+            int indexOpenOut = 0, indexOpenIn = 0, posOpenOut = 0, posOpenIn = 0;
+            for (const uint32_t* it = outEdges.Begin(v); it != outEdges.End(v); ++it) {
+                if (!HasEdge(outEdges, *it, v)) {
+                    ++indexOpenOut;
+                    if (!hasPositionEdge(*it, v)) ++posOpenOut;
+                }
+            }
+            for (const uint32_t* it = inEdges.Begin(v); it != inEdges.End(v); ++it) {
+                if (!HasEdge(outEdges, v, *it)) {
+                    ++indexOpenIn;
+                    if (!hasPositionEdge(v, *it)) ++posOpenIn;
+                }
+            }
+            const uint32_t wedges = liveWedges(v);
+            if (wedges == 1) {
+                if (posOpenOut == 0 && posOpenIn == 0) kind[v] = kKindManifold;
+                else if (posOpenOut == 1 && posOpenIn == 1) kind[v] = kKindBorder;
+            } else if (wedges == 2) {
+                if (posOpenOut == 0 && posOpenIn == 0 && indexOpenOut == 1 && indexOpenIn == 1) kind[v] = kKindSeam;
+            }
+        }
+    };
+
+    // Quadrics per welded position: area-weighted face planes, plus planes
+    // perpendicular to open borders so they resist moving inwards
+    std::vector<Quadric> quadrics(vertexCount);
+    classify();
+    for (size_t t = 0; t < current.size() / 3; ++t) {
+        const uint32_t i0 = current[t * 3 + 0], i1 = current[t * 3 + 1], i2 = current[t * 3 + 2];
+        const XMFLOAT3& p0 = vertices[i0].position;
+        const XMFLOAT3 n = TriNormal(p0, vertices[i1].position, vertices[i2].position);
+        const double len = std::sqrt((double)n.x * n.x + (double)n.y * n.y + (double)n.z * n.z);
+        if (len <= 0.0) continue;
+        const double nx = n.x / len, ny = n.y / len, nz = n.z / len;
+        const double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+        const Quadric q = PlaneQuadric(nx, ny, nz, d, len * 0.5);
+        QuadricAdd(quadrics[rep[i0]], q);
+        QuadricAdd(quadrics[rep[i1]], q);
+        QuadricAdd(quadrics[rep[i2]], q);
+
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t a = current[t * 3 + k], b = current[t * 3 + (k + 1) % 3];
+            if (HasEdge(outEdges, b, a) || hasPositionEdge(b, a)) continue;
+            const XMFLOAT3& pa = vertices[a].position;
+            const XMFLOAT3& pb = vertices[b].position;
+            const double ex = pb.x - pa.x, ey = pb.y - pa.y, ez = pb.z - pa.z;
+            double px = ey * nz - ez * ny, py = ez * nx - ex * nz, pz = ex * ny - ey * nx;
+            const double plen = std::sqrt(px * px + py * py + pz * pz);
+            if (plen <= 0.0) continue;
+            px /= plen; py /= plen; pz /= plen;
+            const double pd = -(px * pa.x + py * pa.y + pz * pa.z);
+            const Quadric bq = PlaneQuadric(px, py, pz, pd, (ex * ex + ey * ey + ez * ez) * kBorderWeight);
+            QuadricAdd(quadrics[rep[a]], bq);
+            QuadricAdd(quadrics[rep[b]], bq);
+        }
+    }
+
+    const double errorLimit = static_cast<double>(maxError) * maxError;
+    double resultError = 0.0;
+    std::vector<Collapse> candidates;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<char> passLocked(vertexCount);
+
+    // Would moving 'from' to 'to' flip (or nearly flip) any surviving triangle?
+    auto flips = [&](uint32_t from, uint32_t to) {
+        const XMFLOAT3& target = vertices[to].position;
+        for (const uint32_t* it = vertexTris.Begin(from); it != vertexTris.End(from); ++it) {
+            const uint32_t* tri = current.data() + static_cast<size_t>(*it) * 3;
+            if (rep[tri[0]] == rep[to] || rep[tri[1]] == rep[to] || rep[tri[2]] == rep[to]) continue;
+            XMFLOAT3 p[3] = { vertices[tri[0]].position, vertices[tri[1]].position, vertices[tri[2]].position };
+            const XMFLOAT3 n0 = TriNormal(p[0], p[1], p[2]);
+            for (int k = 0; k < 3; ++k) if (tri[k] == from) p[k] = target;
+            const XMFLOAT3 n1 = TriNormal(p[0], p[1], p[2]);
+            const float dot = n0.x * n1.x + n0.y * n1.y + n0.z * n1.z;
+            const float l0 = std::sqrt(n0.x * n0.x + n0.y * n0.y + n0.z * n0.z);
+            const float l1 = std::sqrt(n1.x * n1.x + n1.y * n1.y + n1.z * n1.z);
+            if (dot < 0.25f * l0 * l1) return true;
+        }
+        return false;
+    };
+    auto lockRing = [&](uint32_t v) {
+        passLocked[rep[v]] = 1;
+        for (const uint32_t* it = vertexTris.Begin(v); it != vertexTris.End(v); ++it)
+            for (int k = 0; k < 3; ++k) passLocked[rep[current[static_cast<size_t>(*it) * 3 + k]]] = 1;
+    };
+
+    for (int pass = 0; pass < kMaxPasses && current.size() > targetIndexCount; ++pass) {
+        if (pass > 0) classify();
+
+        candidates.clear();
+        for (uint32_t a = 0; a < vertexCount; ++a) {
+            if (!referenced[a] || kind[a] == kKindLocked) continue;
+            auto consider = [&](uint32_t b) {
+                const double cost = QuadricError(quadrics[rep[a]], vertices[b].position);
+                candidates.push_back({ a, b, static_cast<float>(cost) });
+            };
+            if (kind[a] == kKindManifold) {
+                for (const uint32_t* it = outEdges.Begin(a); it != outEdges.End(a); ++it) consider(*it);
+            } else {
+                // Border: along the open edges. Seam: along the seam edges,
+                // which are open in index space only.
+                const uint8_t targetKind = kind[a];
+                for (const uint32_t* it = outEdges.Begin(a); it != outEdges.End(a); ++it)
+                    if (!HasEdge(outEdges, *it, a) && (kind[*it] == targetKind || kind[*it] == kKindLocked)) consider(*it);
+                for (const uint32_t* it = inEdges.Begin(a); it != inEdges.End(a); ++it)
+                    if (!HasEdge(outEdges, a, *it) && (kind[*it] == targetKind || kind[*it] == kKindLocked)) consider(*it);
+            }
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        for (uint32_t v = 0; v < vertexCount; ++v) remap[v] = v;
+        std::fill(passLocked.begin(), passLocked.end(), 0);
+
+        const size_t triCount = current.size() / 3;
+        const size_t targetTris = targetIndexCount / 3;
+        size_t removed = 0;
+        size_t collapses = 0;
+        for (const Collapse& c : candidates) {
+            if (c.cost > errorLimit) break;
+            if (triCount - removed <= targetTris) break;
+            if (passLocked[rep[c.from]] || passLocked[rep[c.to]]) continue;
+
+            uint32_t sibling = c.from, siblingTo = c.to;
+            if (kind[c.from] == kKindSeam) {
+                // Move the other side of the seam along with it
+                sibling = otherWedge(c.from);
+                siblingTo = UINT32_MAX;
+                if (sibling == c.from || kind[sibling] != kKindSeam) continue;
+                uint32_t w = c.to;
+                do {
+                    if (referenced[w] && w != c.to && (HasEdge(outEdges, sibling, w) || HasEdge(outEdges, w, sibling))) {
+                        siblingTo = w;
+                        break;
+                    }
+                    w = wedge[w];
+                } while (w != c.to);
+                if (siblingTo == UINT32_MAX) continue;
+            }
+            if (flips(c.from, c.to)) continue;
+            if (sibling != c.from && flips(sibling, siblingTo)) continue;
+
+            remap[c.from] = c.to;
+            if (sibling != c.from) remap[sibling] = siblingTo;
+            QuadricAdd(quadrics[rep[c.to]], quadrics[rep[c.from]]);
+            lockRing(c.from);
+            if (sibling != c.from) lockRing(sibling);
+            passLocked[rep[c.to]] = 1;
+
+            resultError = std::max(resultError, static_cast<double>(c.cost));
+            removed += (kind[c.from] == kKindBorder) ? 1 : 2;
+            ++collapses;
+        }
+        if (collapses == 0) break;
+
+        // Apply and drop triangles that became degenerate in position space
+        size_t w = 0;
+        for (size_t t = 0; t < triCount; ++t) {
+            const uint32_t a = remap[current[t * 3 + 0]];
+            const uint32_t b = remap[current[t * 3 + 1]];
+            const uint32_t c = remap[current[t * 3 + 2]];
+            if (rep[a] == rep[b] || rep[b] == rep[c] || rep[a] == rep[c]) continue;
+            current[w++] = a;
+            current[w++] = b;
+            current[w++] = c;
+        }
+        current.resize(w);
+    }
+
+    memcpy(dst, current.data(), current.size() * sizeof(uint32_t));
+    if (outError) *outError = static_cast<float>(std::sqrt(resultError));
+    return current.size();
+}
+
+uint32_t SelectLod(const std::vector<MeshLod>& lods, size_t submeshCount, float distance, float objectScale,
+                   float fovY, float viewportHeight, float maxPixelError)
+{
+    if (lods.empty() || submeshCount == 0 || distance <= 0.0f) return 0;
+    const float pixelsPerUnit = viewportHeight / (2.0f * distance * std::tan(fovY * 0.5f));
+    for (size_t i = lods.size() / submeshCount; i-- > 1;) {
+        if (lods[i * submeshCount].error * objectScale * pixelsPerUnit <= maxPixelError)
+            return static_cast<uint32_t>(i);
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Mesh.h"
+
+// Quadric error metric simplification by edge collapse. Vertices are only
+// ever collapsed onto existing vertices, so the result indexes the original
+// vertex buffer and LODs can share it.
+//
+// Vertices are classified on the position-welded mesh: interior vertices
+// collapse freely, border vertices only along the border, and UV seam
+// vertices only along the seam (both sides together). Anything more complex
+// is locked, so open borders and attribute seams keep their shape.
+//
+// Writes at most indexCount indices to dst and returns how many were written.
+// outError receives the largest collapse error as an object-space distance.
+size_t SimplifyMesh(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                    const Vertex* vertices, size_t vertexCount,
+                    size_t targetIndexCount, float maxError, float* outError = nullptr);
+
+// Picks the coarsest LOD level whose error, projected to the screen, stays
+// within maxPixelError. lods is level-major with submeshCount entries per
+// level (Mesh::GetLods()). distance is from the eye to the object in world
+// units, objectScale maps object-space error to world units.
+uint32_t SelectLod(const std::vector<MeshLod>& lods, size_t submeshCount, float distance, float objectScale,
+                   float fovY, float viewportHeight, float maxPixelError = 1.0f);
@@ -0,0 +1,224 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+static inline XMFLOAT3 Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+static inline float Dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static inline float Length(const XMFLOAT3& a) { return std::sqrt(Dot(a, a)); }
+static inline XMFLOAT3 Cross(const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+void BuildMeshlets(MeshletData& out, const Mesh& mesh, size_t maxVertices, size_t maxTriangles)
+{
+    out = MeshletData();
+    const auto& indices = mesh.GetIndices();
+    const size_t vertexCount = mesh.GetVertices().size();
+    const size_t triCount = indices.size() / 3;
+    if (triCount == 0) return;
+
+    // Local corners are uint8
+    maxVertices = std::min<size_t>(std::max<size_t>(maxVertices, 3), 256);
+    maxTriangles = std::max<size_t>(maxTriangles, 1);
+
+    // vertex -> triangle adjacency (CSR)
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triCount * 3; ++i) offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> adjacency(triCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<char> used(triCount, 0);
+    std::vector<char> queued(triCount, 0);
+    std::vector<int> localIndex(vertexCount, -1);
+    std::vector<uint32_t> candidates;
+    out.meshlets.reserve(triCount / maxTriangles + 1);
+    out.vertices.reserve(triCount);
+    out.triangles.reserve(triCount * 3);
+
+    size_t seed = 0;
+    for (;;) {
+        while (seed < triCount && used[seed]) ++seed;
+        if (seed == triCount) break;
+
+        Meshlet m;
+        m.vertexOffset = static_cast<uint32_t>(out.vertices.size());
+        m.triangleOffset = static_cast<uint32_t>(out.triangles.size());
+        candidates.clear();
+
+        size_t tri = seed;
+        for (;;) {
+            used[tri] = 1;
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t v = indices[tri * 3 + k];
+                if (localIndex[v] < 0) {
+                    localIndex[v] = static_cast<int>(m.vertexCount++);
+                    out.vertices.push_back(v);
+                }
+                out.triangles.push_back(static_cast<uint8_t>(localIndex[v]));
+            }
+            m.triangleCount++;
+            if (m.triangleCount >= maxTriangles) break;
+
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t v = indices[tri * 3 + k];
+                for (uint32_t j = offsets[v]; j < offsets[v + 1]; ++j) {
+                    const uint32_t t = adjacency[j];
+                    if (!used[t] && !queued[t]) { queued[t] = 1; candidates.push_back(t); }
+                }
+            }
+
+            // Next triangle: fewest new vertices, ties broken by input order
+            size_t best = SIZE_MAX;
+            int bestNew = 4;
+            size_t w = 0;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                const uint32_t t = candidates[i];
+                if (used[t]) { queued[t] = 0; continue; }
+                candidates[w++] = t;
+                int newVerts = 0;
+                for (int k = 0; k < 3; ++k) newVerts += localIndex[indices[t * 3 + k]] < 0 ? 1 : 0;
+                if (m.vertexCount + newVerts > maxVertices) continue;
+                if (newVerts < bestNew || (newVerts == bestNew && t < best)) { bestNew = newVerts; best = t; }
+            }
+            candidates.resize(w);
+            if (best == SIZE_MAX) break;
+            tri = best;
+        }
+
+        for (uint32_t t : candidates) queued[t] = 0;
+        for (uint32_t i = 0; i < m.vertexCount; ++i) localIndex[out.vertices[m.vertexOffset + i]] = -1;
+        out.meshlets.push_back(m);
+        out.bounds.push_back(ComputeMeshletBounds(out, m, mesh));
+    }
+}
+
+MeshletBounds ComputeMeshletBounds(const MeshletData& data, const Meshlet& meshlet, const Mesh& mesh)
+{
+    MeshletBounds b;
+    const auto& vertices = mesh.GetVertices();
+    if (meshlet.vertexCount == 0) return b;
+    auto pos = [&](uint32_t local) -> const XMFLOAT3& {
+        return vertices[data.vertices[meshlet.vertexOffset + local]].position;
+    };
+
+    // Ritter: start from the most distant pair among the axis extremes, then grow
+    uint32_t extremes[6] = {};
+    for (uint32_t i = 1; i < meshlet.vertexCount; ++i) {
+        const XMFLOAT3& p = pos(i);
+        if (p.x < pos(extremes[0]).x) extremes[0] = i;
+        if (p.x > pos(extremes[1]).x) extremes[1] = i;
+        if (p.y < pos(extremes[2]).y) extremes[2] = i;
+        if (p.y > pos(extremes[3]).y) extremes[3] = i;
+        if (p.z < pos(extremes[4]).z) extremes[4] = i;
+        if (p.z > pos(extremes[5]).z) extremes[5] = i;
+    }
+    int axis = 0;
+    float axisDist = -1.0f;
+    for (int a = 0; a < 3; ++a) {
+        const float d = Length(Sub(pos(extremes[a * 2 + 1]), pos(extremes[a * 2])));
+        if (d > axisDist) { axisDist = d; axis = a; }
+    }
+    const XMFLOAT3& p0 = pos(extremes[axis * 2]);
+    const XMFLOAT3& p1 = pos(extremes[axis * 2 + 1]);
+    XMFLOAT3 c((p0.x + p1.x) * 0.5f, (p0.y + p1.y) * 0.5f, (p0.z + p1.z) * 0.5f);
+    float r = axisDist * 0.5f;
+    for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+        const XMFLOAT3 d = Sub(pos(i), c);
+        const float dist = Length(d);
+        if (dist > r) {
+            const float newR = (r + dist) * 0.5f;
+            const float k = (newR - r) / dist;
+            c = XMFLOAT3(c.x + d.x * k, c.y + d.y * k, c.z + d.z * k);
+            r = newR;
+        }
+    }
+    b.center = c;
+    b.radius = r;
+
+    // Normal cone: average of unit face normals, half-angle from the widest one
+    std::vector<XMFLOAT3> normals;
+    normals.reserve(meshlet.triangleCount);
+    XMFLOAT3 sum(0, 0, 0);
+    const uint8_t* tris = data.triangles.data() + meshlet.triangleOffset;
+    for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+        const XMFLOAT3& a = pos(tris[t * 3 + 0]);
+        const XMFLOAT3 n = Cross(Sub(pos(tris[t * 3 + 1]), a), Sub(pos(tris[t * 3 + 2]), a));
+        const float len = Length(n);
+        if (len <= 0.0f) continue;
+        const XMFLOAT3 un(n.x / len, n.y / len, n.z / len);
+        normals.push_back(un);
+        sum = XMFLOAT3(sum.x + un.x, sum.y + un.y, sum.z + un.z);
+    }
+    const float sumLen = Length(sum);
+    if (normals.empty() || sumLen <= 0.0f) return b;
+    const XMFLOAT3 coneAxis(sum.x / sumLen, sum.y / sumLen, sum.z / sumLen);
+    float minDot = 1.0f;
+    for (const XMFLOAT3& n : normals) minDot = std::min(minDot, Dot(n, coneAxis));
+    b.coneAxis = coneAxis;
+    b.coneCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+    return b;
+}
+
+MeshletCullView MakeMeshletCullView(const XMFLOAT4X4& mvp, const XMFLOAT3& eye)
+{
+    // Gribb/Hartmann plane extraction for clip = v * M with D3D depth [0, w]
+    auto col = [&](int j) { return XMFLOAT4(mvp.m[0][j], mvp.m[1][j], mvp.m[2][j], mvp.m[3][j]); };
+    const XMFLOAT4 c0 = col(0), c1 = col(1), c2 = col(2), c3 = col(3);
+    MeshletCullView view;
+    view.planes[0] = XMFLOAT4(c3.x + c0.x, c3.y + c0.y, c3.z + c0.z, c3.w + c0.w); // left
+    view.planes[1] = XMFLOAT4(c3.x - c0.x, c3.y - c0.y, c3.z - c0.z, c3.w - c0.w); // right
+    view.planes[2] = XMFLOAT4(c3.x + c1.x, c3.y + c1.y, c3.z + c1.z, c3.w + c1.w); // bottom
+    view.planes[3] = XMFLOAT4(c3.x - c1.x, c3.y - c1.y, c3.z - c1.z, c3.w - c1.w); // top
+    view.planes[4] = c2;                                                           // near
+    view.planes[5] = XMFLOAT4(c3.x - c2.x, c3.y - c2.y, c3.z - c2.z, c3.w - c2.w); // far
+    for (XMFLOAT4& p : view.planes) {
+        const float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        if (len > 0.0f) { p.x /= len; p.y /= len; p.z /= len; p.w /= len; }
+    }
+    view.eye = eye;
+    return view;
+}
+
+MeshletCullResult CullMeshlet(const MeshletBounds& b, const MeshletCullView& view)
+{
+    for (const XMFLOAT4& p : view.planes) {
+        if (p.x * b.center.x + p.y * b.center.y + p.z * b.center.z + p.w < -b.radius)
+            return MeshletCullResult::Frustum;
+    }
+    if (b.coneCutoff < 1.0f) {
+        const XMFLOAT3 d = Sub(b.center, view.eye);
+        if (Dot(d, b.coneAxis) >= b.coneCutoff * Length(d) + b.radius)
+            return MeshletCullResult::Backface;
+    }
+    return MeshletCullResult::Visible;
+}
+
+MeshletCullStats CullMeshlets(const MeshletData& data, const MeshletCullView& view, std::vector<uint32_t>* visible)
+{
+    MeshletCullStats stats;
+    if (visible) visible->clear();
+    stats.meshlets = data.meshlets.size();
+    for (size_t i = 0; i < data.meshlets.size(); ++i) {
+        const size_t tris = data.meshlets[i].triangleCount;
+        stats.triangles += tris;
+        switch (CullMeshlet(data.bounds[i], view)) {
+        case MeshletCullResult::Frustum:  stats.frustumCulled++; break;
+        case MeshletCullResult::Backface: stats.backfaceCulled++; break;
+        case MeshletCullResult::Visible:
+            stats.visibleMeshlets++;
+            stats.visibleTriangles += tris;
+            if (visible) visible->push_back(static_cast<uint32_t>(i));
+            break;
+        }
+    }
+    return stats;
+}
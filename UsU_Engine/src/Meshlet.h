@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "Mesh.h"
+
+static const size_t kMeshletMaxVertices = 64;
+static const size_t kMeshletMaxTriangles = 124;
+
+// A cluster of up to kMeshletMaxVertices vertices / kMeshletMaxTriangles
+// triangles. Vertex ids live in MeshletData::vertices, triangles are three
+// local (uint8) corners each in MeshletData::triangles.
+struct Meshlet
+{
+    uint32_t vertexOffset = 0;
+    uint32_t triangleOffset = 0; // in bytes, 3 per triangle
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+};
+
+// Bounding sphere plus backface normal cone. A cluster is entirely
+// back-facing for a viewer at eye when
+//   dot(center - eye, coneAxis) >= coneCutoff * |center - eye| + radius
+// coneCutoff is sin(cone half-angle); 1 means the cone is too wide to cull.
+// Faces are assumed counter-clockwise when seen from the front (OBJ).
+struct MeshletBounds
+{
+    DirectX::XMFLOAT3 center{ 0, 0, 0 };
+    float radius = 0.0f;
+    DirectX::XMFLOAT3 coneAxis{ 0, 0, 1 };
+    float coneCutoff = 1.0f;
+};
+
+struct MeshletData
+{
+    std::vector<Meshlet>       meshlets;
+    std::vector<MeshletBounds> bounds;
+    std::vector<uint32_t>      vertices;
+    std::vector<uint8_t>       triangles;
+};
+
+// Greedy clustering: each meshlet grows from a seed triangle by adding the
+// neighbouring triangle that brings in the fewest new vertices. Works best on
+// a Mesh::Optimize()d index buffer, whose order is used for seeds.
+void BuildMeshlets(MeshletData& out, const Mesh& mesh,
+                   size_t maxVertices = kMeshletMaxVertices, size_t maxTriangles = kMeshletMaxTriangles);
+
+MeshletBounds ComputeMeshletBounds(const MeshletData& data, const Meshlet& meshlet, const Mesh& mesh);
+
+// Culling inputs in the mesh's object space: frustum planes (ax+by+cz+d >= 0
+// inside) and the eye position.
+struct MeshletCullView
+{
+    DirectX::XMFLOAT4 planes[6];
+    DirectX::XMFLOAT3 eye{ 0, 0, 0 };
+};
+
+// mvp is world*view*proj in row-vector convention (not transposed); eye is
+// the camera position transformed into object space.
+MeshletCullView MakeMeshletCullView(const DirectX::XMFLOAT4X4& mvp, const DirectX::XMFLOAT3& eye);
+
+enum class MeshletCullResult { Visible, Frustum, Backface };
+MeshletCullResult CullMeshlet(const MeshletBounds& bounds, const MeshletCullView& view);
+
+struct MeshletCullStats
+{
+    size_t meshlets = 0;
+    size_t visibleMeshlets = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t triangles = 0;
+    size_t visibleTriangles = 0;
+
+    float CulledTrianglePercent() const
+    {
+        return triangles ? 100.0f * (1.0f - (float)visibleTriangles / (float)triangles) : 0.0f;
+    }
+};
+
+// Culls every meshlet; optionally returns the surviving meshlet ids.
+MeshletCullStats CullMeshlets(const MeshletData& data, const MeshletCullView& view,
+                              std::vector<uint32_t>* visible = nullptr);
@@ -0,0 +1,260 @@
+#include "MipGenerator.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USU_MIP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Per destination pixel: a contiguous run of source taps (edge-clamped) and
+// normalized weights, flattened.
+struct Kernel
+{
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<size_t> offset; // into weights
+    std::vector<float> weights;
+};
+
+struct SrgbTables
+{
+    float toLinear[256];
+    uint8_t fromLinear[65536]; // indexed by linear * 65535
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            const float c = i / 255.0f;
+            toLinear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < 65536; ++i) {
+            const float l = i / 65535.0f;
+            const float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            fromLinear[i] = static_cast<uint8_t>(std::min(255.0f, c * 255.0f + 0.5f));
+        }
+    }
+};
+
+} // namespace
+
+static const SrgbTables& GetSrgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+const char* MipFilterName(MipFilter filter)
+{
+    switch (filter) {
+    case MipFilter::Box:     return "box";
+    case MipFilter::Lanczos: return "lanczos3";
+    case MipFilter::Kaiser:  return "kaiser";
+    }
+    return "?";
+}
+
+static float Sinc(float x)
+{
+    if (std::fabs(x) < 1e-6f) return 1.0f;
+    const float px = 3.14159265f * x;
+    return std::sin(px) / px;
+}
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window
+static float BesselI0(float x)
+{
+    float sum = 1.0f, term = 1.0f;
+    const float q = x * x * 0.25f;
+    for (int k = 1; k < 32 && term > sum * 1e-8f; ++k) {
+        term *= q / static_cast<float>(k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+// x in destination pixels from the sample center
+static float FilterWeight(MipFilter filter, float x)
+{
+    const float kWidth = 3.0f;
+    const float ax = std::fabs(x);
+    if (ax >= kWidth) return 0.0f;
+    if (filter == MipFilter::Lanczos) return Sinc(x) * Sinc(x / kWidth);
+    const float kAlpha = 4.0f;
+    const float t = x / kWidth;
+    return Sinc(x) * BesselI0(kAlpha * std::sqrt(1.0f - t * t)) / BesselI0(kAlpha);
+}
+
+static Kernel BuildKernel(MipFilter filter, int srcSize, int dstSize)
+{
+    Kernel k;
+    k.first.resize(dstSize);
+    k.count.resize(dstSize);
+    k.offset.resize(dstSize);
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    std::vector<float> taps;
+    for (int i = 0; i < dstSize; ++i) {
+        const float center = (i + 0.5f) * scale;
+        int lo, hi;
+        if (filter == MipFilter::Box) {
+            lo = static_cast<int>(std::floor(center - 0.5f * scale));
+            hi = static_cast<int>(std::ceil(center + 0.5f * scale)) - 1;
+        } else {
+            lo = static_cast<int>(std::floor(center - 3.0f * scale));
+            hi = static_cast<int>(std::ceil(center + 3.0f * scale));
+        }
+        const int first = std::max(lo, 0);
+        const int last = std::min(hi, srcSize - 1);
+        taps.assign(static_cast<size_t>(last - first + 1), 0.0f);
+        float sum = 0.0f;
+        for (int j = lo; j <= hi; ++j) {
+            float w;
+            if (filter == MipFilter::Box) {
+                // Coverage of source pixel [j, j + 1] by the footprint
+                w = std::min(j + 1.0f, center + 0.5f * scale) - std::max(static_cast<float>(j), center - 0.5f * scale);
+                w = std::max(w, 0.0f);
+            } else {
+                w = FilterWeight(filter, (j + 0.5f - center) / scale);
+            }
+            taps[std::min(std::max(j, first), last) - first] += w;
+            sum += w;
+        }
+        k.first[i] = first;
+        k.count[i] = static_cast<int>(taps.size());
+        k.offset[i] = k.weights.size();
+        for (float w : taps) k.weights.push_back(sum != 0.0f ? w / sum : 0.0f);
+    }
+    return k;
+}
+
+// Splits [0, rows) into bands of about kMinBandCost on the shared job pool;
+// small levels stay on the caller's thread since scheduling would dominate.
+template <typename Fn>
+static void ParallelRows(size_t rows, size_t rowCost, Fn&& fn)
+{
+    const size_t kMinBandCost = 64 * 1024;
+    const size_t grain = std::max<size_t>(1, kMinBandCost / std::max<size_t>(1, rowCost));
+    GetJobSystem().ParallelFor(static_cast<uint32_t>(rows), static_cast<uint32_t>(std::min<size_t>(grain, rows)), fn);
+}
+
+// dst[x] = sum_k w[k] * src[first + k], one RGBA float4 per pixel
+static void FilterRowHorizontal(const float* src, float* dst, const Kernel& k)
+{
+    const int count = static_cast<int>(k.first.size());
+    for (int x = 0; x < count; ++x) {
+        const float* s = src + static_cast<size_t>(k.first[x]) * 4;
+        const float* w = k.weights.data() + k.offset[x];
+        const int taps = k.count[x];
+#if defined(USU_MIP_SSE2)
+        __m128 acc = _mm_setzero_ps();
+        for (int t = 0; t < taps; ++t)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(s + t * 4)));
+        _mm_storeu_ps(dst + x * 4, acc);
+#else
+        float acc[4] = {};
+        for (int t = 0; t < taps; ++t)
+            for (int c = 0; c < 4; ++c) acc[c] += w[t] * s[t * 4 + c];
+        memcpy(dst + x * 4, acc, sizeof(acc));
+#endif
+    }
+}
+
+// dst = sum_k w[k] * rows[first + k], across the whole row, clamped to [0, 1]
+// since the sinc lobes can ring past the input range
+static void FilterRowVertical(const float* src, size_t srcStride, float* dst, size_t floats, const float* w, int first, int taps)
+{
+    size_t i = 0;
+#if defined(USU_MIP_SSE2)
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    for (; i + 8 <= floats; i += 8) {
+        __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+        for (int t = 0; t < taps; ++t) {
+            const float* s = src + (first + t) * srcStride + i;
+            const __m128 wt = _mm_set1_ps(w[t]);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(wt, _mm_loadu_ps(s)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(wt, _mm_loadu_ps(s + 4)));
+        }
+        _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(a0, zero), one));
+        _mm_storeu_ps(dst + i + 4, _mm_min_ps(_mm_max_ps(a1, zero), one));
+    }
+#endif
+    for (; i < floats; ++i) {
+        float acc = 0.0f;
+        for (int t = 0; t < taps; ++t) acc += w[t] * src[(first + t) * srcStride + i];
+        dst[i] = std::min(std::max(acc, 0.0f), 1.0f);
+    }
+}
+
+static void DecodeRow(const uint8_t* src, float* dst, uint32_t width, bool srgb)
+{
+    const SrgbTables& tables = GetSrgbTables();
+    for (uint32_t x = 0; x < width; ++x) {
+        for (int c = 0; c < 3; ++c) dst[x * 4 + c] = srgb ? tables.toLinear[src[x * 4 + c]] : src[x * 4 + c] * (1.0f / 255.0f);
+        dst[x * 4 + 3] = src[x * 4 + 3] * (1.0f / 255.0f);
+    }
+}
+
+static void EncodeRow(const float* src, uint8_t* dst, uint32_t width, bool srgb)
+{
+    const SrgbTables& tables = GetSrgbTables();
+    for (uint32_t x = 0; x < width; ++x) {
+        for (int c = 0; c < 3; ++c) {
+            const float v = src[x * 4 + c];
+            dst[x * 4 + c] = srgb ? tables.fromLinear[static_cast<int>(v * 65535.0f + 0.5f)]
+                                  : static_cast<uint8_t>(v * 255.0f + 0.5f);
+        }
+        dst[x * 4 + 3] = static_cast<uint8_t>(src[x * 4 + 3] * 255.0f + 0.5f);
+    }
+}
+
+bool GenerateMips(TextureData& tex, MipFilter filter, bool srgb)
+{
+    USU_PROFILE_ZONE("GenerateMips");
+    if (tex.format != TextureFormat::RGBA8 || tex.width == 0 || tex.height == 0 || tex.mips.empty()) return false;
+
+    TextureData out;
+    AllocateTexture(out, TextureFormat::RGBA8, tex.width, tex.height, 32);
+    memcpy(out.MipData(0), tex.MipData(0), out.mips[0].size);
+
+    // Level n is filtered from level n - 1 kept in float, so rounding does
+    // not accumulate down the chain
+    std::vector<float> src(static_cast<size_t>(tex.width) * tex.height * 4);
+    std::vector<float> dst, tmp;
+    ParallelRows(tex.height, tex.width * 4, [&](size_t y0, size_t y1) {
+        for (size_t y = y0; y < y1; ++y)
+            DecodeRow(out.MipData(0) + y * out.mips[0].rowPitch, src.data() + y * tex.width * 4, tex.width, srgb);
+    });
+
+    for (size_t level = 1; level < out.mips.size(); ++level) {
+        const TextureMip& prev = out.mips[level - 1];
+        const TextureMip& mip = out.mips[level];
+        const Kernel kx = BuildKernel(filter, static_cast<int>(prev.width), static_cast<int>(mip.width));
+        const Kernel ky = BuildKernel(filter, static_cast<int>(prev.height), static_cast<int>(mip.height));
+
+        // Horizontal into tmp (mip.width x prev.height), then vertical into dst
+        tmp.resize(static_cast<size_t>(mip.width) * prev.height * 4);
+        dst.resize(static_cast<size_t>(mip.width) * mip.height * 4);
+        const size_t tmpStride = static_cast<size_t>(mip.width) * 4;
+        ParallelRows(prev.height, kx.weights.size() * 4, [&](size_t y0, size_t y1) {
+            for (size_t y = y0; y < y1; ++y)
+                FilterRowHorizontal(src.data() + y * prev.width * 4, tmp.data() + y * tmpStride, kx);
+        });
+        uint8_t* bytes = out.MipData(level);
+        ParallelRows(mip.height, tmpStride * 2, [&](size_t y0, size_t y1) {
+            for (size_t y = y0; y < y1; ++y) {
+                float* row = dst.data() + y * tmpStride;
+                FilterRowVertical(tmp.data(), tmpStride, row, tmpStride, ky.weights.data() + ky.offset[y], ky.first[y], ky.count[y]);
+                EncodeRow(row, bytes + y * mip.rowPitch, mip.width, srgb);
+            }
+        });
+        src.swap(dst);
+    }
+
+    tex = std::move(out);
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "Texture.h"
+
+// Downsampling filter for the mip chain. Box averages the 2x2 (or 3x2 for
+// odd sizes) footprint; Lanczos3 and Kaiser (windowed sinc, alpha 4, width 3)
+// keep more detail at the cost of a wider footprint: 3 destination pixels
+// each side, so 12 source taps per axis for a 2x reduction.
+enum class MipFilter { Box, Lanczos, Kaiser };
+
+const char* MipFilterName(MipFilter filter);
+
+// Replaces an RGBA8 texture's levels with the full chain built from level 0.
+// Each level is filtered from the previous one in linear light: with srgb the
+// color channels are decoded before and re-encoded after filtering, alpha is
+// always linear. Rows are split across threads. Fails for other formats.
+bool GenerateMips(TextureData& tex, MipFilter filter = MipFilter::Kaiser, bool srgb = true);
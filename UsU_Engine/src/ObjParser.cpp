@@ -0,0 +1,431 @@
+#include "ObjParser.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace {
+
+// Corner indices as written, 0 = absent. Negative (relative) references are
+// rebased onto the chunk-local record count and flagged in 'relative', since
+// the chunk does not know how many records precede it yet.
+struct ObjCornerKey
+{
+    int pi = 0, ti = 0, ni = 0;
+    uint32_t relative = 0; // bit 0: pi, bit 1: ti, bit 2: ni
+
+    bool operator==(const ObjCornerKey& o) const
+    {
+        return pi == o.pi && ti == o.ti && ni == o.ni && relative == o.relative;
+    }
+};
+
+struct ObjCornerKeyHash
+{
+    size_t operator()(const ObjCornerKey& k) const
+    {
+        uint64_t h = static_cast<uint32_t>(k.pi) * 0x9E3779B185EBCA87ull;
+        h ^= (static_cast<uint32_t>(k.ti) + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+        h ^= (static_cast<uint32_t>(k.ni) + k.relative * 0x165667B1u + (h << 6) + (h >> 2)) * 0x9E3779B185EBCA87ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+// Absolute 1-based record indices after rebasing, 0 = absent/out of range.
+struct ObjVertexKey
+{
+    uint32_t pi = 0, ti = 0, ni = 0;
+
+    bool operator==(const ObjVertexKey& o) const { return pi == o.pi && ti == o.ti && ni == o.ni; }
+};
+
+struct ObjVertexKeyHash
+{
+    size_t operator()(const ObjVertexKey& k) const
+    {
+        uint64_t h = k.pi * 0x9E3779B185EBCA87ull;
+        h ^= (k.ti + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+        h ^= (k.ni + (h << 6) + (h >> 2)) * 0x9E3779B185EBCA87ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+// Triangles [firstTriangle, next run) use these names. -1 means the name was
+// set in an earlier chunk (or never set).
+struct ObjRun
+{
+    uint32_t firstTriangle = 0;
+    int material = -1;
+    int group = -1;
+};
+
+struct ObjChunk
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    std::vector<XMFLOAT3> positions;
+    std::vector<XMFLOAT3> normals;
+    std::vector<XMFLOAT2> uvs;
+    std::vector<ObjCornerKey> uniques; // first-use order within the chunk
+    std::vector<uint32_t> corners;     // index into uniques, 3 per triangle
+    std::vector<uint32_t> remap;       // uniques -> global vertex index
+    std::vector<std::string_view> names; // usemtl/o/g arguments seen in the chunk
+    std::vector<ObjRun> runs;
+    bool hasMaterials = false;
+
+    size_t posBase = 0, uvBase = 0, nrmBase = 0;
+    std::vector<uint32_t> runSubmesh;  // runs -> output submesh
+    std::vector<uint32_t> runOutput;   // runs -> first output index
+};
+
+} // namespace
+
+// Same classification as std::isspace in the "C" locale, which is what the
+// stream extraction used by the old loader skipped.
+static inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static inline const char* SkipSpace(const char* p, const char* end)
+{
+    while (p < end && IsSpace(*p)) ++p;
+    return p;
+}
+
+static inline const char* SkipToken(const char* p, const char* end)
+{
+    while (p < end && !IsSpace(*p)) ++p;
+    return p;
+}
+
+static const char* ParseFloat(const char* p, const char* end, float& out)
+{
+    p = SkipSpace(p, end);
+    const char* s = p;
+    if (s < end && *s == '+') ++s; // from_chars rejects a leading '+', streams accept it
+    auto res = std::from_chars(s, end, out);
+    if (res.ec != std::errc()) {
+        out = 0.0f;
+        return SkipToken(p, end);
+    }
+    return res.ptr;
+}
+
+// Equivalent of a single "%d" conversion.
+static bool ParseInt(const char*& p, const char* end, int& out)
+{
+    const char* s = p;
+    bool neg = false;
+    if (s < end && (*s == '+' || *s == '-')) { neg = (*s == '-'); ++s; }
+    const char* digits = s;
+    int64_t v = 0;
+    while (s < end && *s >= '0' && *s <= '9') {
+        if (v < INT32_MAX) v = v * 10 + (*s - '0');
+        ++s;
+    }
+    if (s == digits) return false;
+    v = std::min<int64_t>(v, INT32_MAX);
+    out = static_cast<int>(neg ? -v : v);
+    p = s;
+    return true;
+}
+
+// "p", "p/t", "p//n" or "p/t/n"; missing or malformed fields are 0.
+static void ParseCorner(const char* p, const char* end, int& pi, int& ti, int& ni)
+{
+    pi = ti = ni = 0;
+    if (!ParseInt(p, end, pi)) return;
+    if (p == end || *p != '/') return;
+    ++p;
+    ParseInt(p, end, ti);
+    if (p == end || *p != '/') return;
+    ++p;
+    ParseInt(p, end, ni);
+}
+
+// Rebases a negative reference onto the chunk's record count so far.
+static inline void RebaseRelative(int& index, size_t count, uint32_t bit, uint32_t& relative)
+{
+    if (index >= 0) return;
+    index = static_cast<int>(count) + index + 1;
+    relative |= bit;
+}
+
+// Rest of the line with surrounding whitespace removed (names may contain spaces)
+static std::string_view LineArgument(const char* p, const char* eol)
+{
+    p = SkipSpace(p, eol);
+    const char* e = eol;
+    while (e > p && IsSpace(e[-1])) --e;
+    return std::string_view(p, static_cast<size_t>(e - p));
+}
+
+static void TokenizeChunk(ObjChunk& c)
+{
+    const size_t bytes = static_cast<size_t>(c.end - c.begin);
+    // Rough guesses for typical exports; avoids most regrowth on large files
+    c.positions.reserve(bytes / 96);
+    c.normals.reserve(bytes / 96);
+    c.uvs.reserve(bytes / 96);
+    c.corners.reserve(bytes / 24);
+    c.uniques.reserve(bytes / 96);
+
+    std::unordered_map<ObjCornerKey, uint32_t, ObjCornerKeyHash> local;
+    local.reserve(bytes / 96);
+    c.runs.push_back(ObjRun());
+
+    const char* p = c.begin;
+    while (p < c.end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(c.end - p)));
+        if (!eol) eol = c.end;
+
+        const char* tag = SkipSpace(p, eol);
+        const char* tagEnd = SkipToken(tag, eol);
+        const size_t tagLen = static_cast<size_t>(tagEnd - tag);
+
+        if (tagLen == 1 && tag[0] == 'v') {
+            XMFLOAT3 v;
+            const char* q = ParseFloat(tagEnd, eol, v.x);
+            q = ParseFloat(q, eol, v.y);
+            ParseFloat(q, eol, v.z);
+            c.positions.push_back(v);
+        } else if (tagLen == 2 && tag[0] == 'v' && tag[1] == 'n') {
+            XMFLOAT3 n;
+            const char* q = ParseFloat(tagEnd, eol, n.x);
+            q = ParseFloat(q, eol, n.y);
+            ParseFloat(q, eol, n.z);
+            c.normals.push_back(n);
+        } else if (tagLen == 2 && tag[0] == 'v' && tag[1] == 't') {
+            XMFLOAT2 t;
+            const char* q = ParseFloat(tagEnd, eol, t.x);
+            ParseFloat(q, eol, t.y);
+            c.uvs.push_back(t);
+        } else if (tagLen == 1 && tag[0] == 'f') {
+            // Polygons are triangulated as a fan around the first corner
+            const char* q = tagEnd;
+            uint32_t first = 0, prev = 0;
+            int cornerCount = 0;
+            for (;;) {
+                q = SkipSpace(q, eol);
+                if (q == eol) break;
+                const char* qEnd = SkipToken(q, eol);
+                ObjCornerKey k;
+                ParseCorner(q, qEnd, k.pi, k.ti, k.ni);
+                RebaseRelative(k.pi, c.positions.size(), 1u, k.relative);
+                RebaseRelative(k.ti, c.uvs.size(), 2u, k.relative);
+                RebaseRelative(k.ni, c.normals.size(), 4u, k.relative);
+                auto res = local.try_emplace(k, static_cast<uint32_t>(c.uniques.size()));
+                if (res.second) c.uniques.push_back(k);
+                const uint32_t id = res.first->second;
+                if (cornerCount == 0) {
+                    first = id;
+                } else if (cornerCount >= 2) {
+                    c.corners.push_back(first);
+                    c.corners.push_back(prev);
+                    c.corners.push_back(id);
+                }
+                prev = id;
+                ++cornerCount;
+                q = qEnd;
+            }
+        } else if ((tagLen == 6 && memcmp(tag, "usemtl", 6) == 0) ||
+                   (tagLen == 1 && (tag[0] == 'o' || tag[0] == 'g'))) {
+            const bool material = tagLen == 6;
+            c.hasMaterials |= material;
+            const uint32_t triangle = static_cast<uint32_t>(c.corners.size() / 3);
+            if (c.runs.empty() || c.runs.back().firstTriangle != triangle) {
+                ObjRun run;
+                if (!c.runs.empty()) run = c.runs.back();
+                run.firstTriangle = triangle;
+                c.runs.push_back(run);
+            }
+            c.names.push_back(LineArgument(tagEnd, eol));
+            (material ? c.runs.back().material : c.runs.back().group) = static_cast<int>(c.names.size() - 1);
+        }
+        p = (eol < c.end) ? eol + 1 : c.end;
+    }
+}
+
+// fn(i) for every chunk, one job each on the shared pool
+template <typename Fn>
+static void RunParallel(size_t count, Fn&& fn)
+{
+    GetJobSystem().ParallelFor(static_cast<uint32_t>(count), 1, [&fn](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) fn(i);
+    });
+}
+
+bool ParseOBJ(const char* data, size_t size,
+              std::vector<Vertex>& outVertices,
+              std::vector<uint32_t>& outIndices,
+              std::vector<MeshSubmesh>& outSubmeshes,
+              ObjParseStats* stats)
+{
+    USU_PROFILE_ZONE("ParseOBJ");
+    const auto t0 = std::chrono::steady_clock::now();
+    outVertices.clear();
+    outIndices.clear();
+    outSubmeshes.clear();
+    if (!data || size == 0) return false;
+
+    // Split on line boundaries; small files stay single-chunk since thread
+    // startup would dominate.
+    const size_t kMinChunkBytes = 1u << 20;
+    const unsigned hw = GetJobSystem().GetThreadCount();
+    const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(hw, size / kMinChunkBytes));
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* end = data + size;
+    const char* cursor = data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* chunkEnd = end;
+        if (i + 1 < chunkCount) {
+            const char* split = std::max(cursor, data + size * (i + 1) / chunkCount);
+            const char* nl = static_cast<const char*>(memchr(split, '\n', static_cast<size_t>(end - split)));
+            chunkEnd = nl ? nl + 1 : end;
+        }
+        chunks[i].begin = cursor;
+        chunks[i].end = chunkEnd;
+        cursor = chunkEnd;
+    }
+
+    RunParallel(chunkCount, [&](size_t i) { TokenizeChunk(chunks[i]); });
+
+    // Prefix sums give every chunk its global record offsets
+    size_t posTotal = 0, uvTotal = 0, nrmTotal = 0, cornerTotal = 0, uniqueTotal = 0;
+    bool hasMaterials = false;
+    for (auto& c : chunks) {
+        c.posBase = posTotal;   posTotal += c.positions.size();
+        c.uvBase = uvTotal;     uvTotal += c.uvs.size();
+        c.nrmBase = nrmTotal;   nrmTotal += c.normals.size();
+        cornerTotal += c.corners.size();
+        uniqueTotal += c.uniques.size();
+        hasMaterials |= c.hasMaterials;
+    }
+
+    std::vector<XMFLOAT3> positions, normals;
+    std::vector<XMFLOAT2> uvs;
+    if (chunkCount > 1) {
+        positions.reserve(posTotal);
+        normals.reserve(nrmTotal);
+        uvs.reserve(uvTotal);
+        for (auto& c : chunks) {
+            positions.insert(positions.end(), c.positions.begin(), c.positions.end());
+            normals.insert(normals.end(), c.normals.begin(), c.normals.end());
+            uvs.insert(uvs.end(), c.uvs.begin(), c.uvs.end());
+        }
+    } else {
+        positions.swap(chunks[0].positions);
+        normals.swap(chunks[0].normals);
+        uvs.swap(chunks[0].uvs);
+    }
+
+    // Assign global vertex ids in file order, deduplicating on the resolved
+    // record indices so relative and absolute references to the same
+    // corner share a vertex.
+    auto resolve = [](int index, bool relative, size_t base, size_t total) -> uint32_t {
+        const int64_t abs = relative ? int64_t(base) + index : int64_t(index);
+        return (abs > 0 && abs <= int64_t(total)) ? static_cast<uint32_t>(abs) : 0u;
+    };
+    outVertices.reserve(uniqueTotal);
+    std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> global;
+    global.reserve(uniqueTotal);
+    for (auto& c : chunks) {
+        c.remap.resize(c.uniques.size());
+        for (size_t u = 0; u < c.uniques.size(); ++u) {
+            const ObjCornerKey& k = c.uniques[u];
+            ObjVertexKey key;
+            key.pi = resolve(k.pi, (k.relative & 1u) != 0, c.posBase, posTotal);
+            key.ti = resolve(k.ti, (k.relative & 2u) != 0, c.uvBase, uvTotal);
+            key.ni = resolve(k.ni, (k.relative & 4u) != 0, c.nrmBase, nrmTotal);
+            auto res = global.try_emplace(key, static_cast<uint32_t>(outVertices.size()));
+            if (res.second) {
+                Vertex v{};
+                if (key.pi) v.position = positions[key.pi - 1];
+                if (key.ni) v.normal = normals[key.ni - 1];
+                if (key.ti) v.uv = uvs[key.ti - 1];
+                outVertices.push_back(v);
+            }
+            c.remap[u] = res.first->second;
+        }
+    }
+
+    // Submeshes: one per material (or per o/g name when the file has no
+    // usemtl at all), in order of first use. Names carry over chunk
+    // boundaries, so this walk is sequential; it only touches runs.
+    std::unordered_map<std::string_view, uint32_t> submeshIds;
+    std::vector<size_t> submeshTriangles;
+    int currentMaterial = -1, currentGroup = -1;
+    const ObjChunk* materialChunk = nullptr;
+    const ObjChunk* groupChunk = nullptr;
+    for (auto& c : chunks) {
+        const size_t triCount = c.corners.size() / 3;
+        c.runSubmesh.resize(c.runs.size());
+        for (size_t r = 0; r < c.runs.size(); ++r) {
+            const ObjRun& run = c.runs[r];
+            if (run.material >= 0) { currentMaterial = run.material; materialChunk = &c; }
+            if (run.group >= 0)    { currentGroup = run.group;       groupChunk = &c; }
+            const uint32_t last = (r + 1 < c.runs.size()) ? c.runs[r + 1].firstTriangle : static_cast<uint32_t>(triCount);
+            if (last == run.firstTriangle) continue;
+
+            std::string_view name;
+            if (hasMaterials && materialChunk) name = materialChunk->names[currentMaterial];
+            else if (!hasMaterials && groupChunk) name = groupChunk->names[currentGroup];
+            auto res = submeshIds.try_emplace(name, static_cast<uint32_t>(outSubmeshes.size()));
+            if (res.second) {
+                MeshSubmesh sm;
+                sm.name.assign(name.data(), name.size());
+                outSubmeshes.push_back(sm);
+                submeshTriangles.push_back(0);
+            }
+            c.runSubmesh[r] = res.first->second;
+            submeshTriangles[res.first->second] += last - run.firstTriangle;
+        }
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < outSubmeshes.size(); ++i) {
+        outSubmeshes[i].indexOffset = static_cast<uint32_t>(offset);
+        outSubmeshes[i].indexCount = static_cast<uint32_t>(submeshTriangles[i] * 3);
+        offset += submeshTriangles[i] * 3;
+    }
+    std::vector<size_t> fill(outSubmeshes.size());
+    for (size_t i = 0; i < outSubmeshes.size(); ++i) fill[i] = outSubmeshes[i].indexOffset;
+    for (auto& c : chunks) {
+        const size_t triCount = c.corners.size() / 3;
+        c.runOutput.resize(c.runs.size());
+        for (size_t r = 0; r < c.runs.size(); ++r) {
+            const uint32_t last = (r + 1 < c.runs.size()) ? c.runs[r + 1].firstTriangle : static_cast<uint32_t>(triCount);
+            if (last == c.runs[r].firstTriangle) continue;
+            c.runOutput[r] = static_cast<uint32_t>(fill[c.runSubmesh[r]]);
+            fill[c.runSubmesh[r]] += size_t(last - c.runs[r].firstTriangle) * 3;
+        }
+    }
+
+    // Every run knows where its triangles go, so the scatter is parallel
+    outIndices.resize(cornerTotal);
+    RunParallel(chunkCount, [&](size_t i) {
+        const ObjChunk& c = chunks[i];
+        for (size_t r = 0; r < c.runs.size(); ++r) {
+            const size_t first = size_t(c.runs[r].firstTriangle) * 3;
+            const size_t last = (r + 1 < c.runs.size()) ? size_t(c.runs[r + 1].firstTriangle) * 3 : c.corners.size();
+            uint32_t* dst = outIndices.data() + c.runOutput[r];
+            for (size_t n = first; n < last; ++n)
+                *dst++ = c.remap[c.corners[n]];
+        }
+    });
+
+    if (stats) {
+        stats->bytes = size;
+        stats->chunks = static_cast<unsigned>(chunkCount);
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    return !outVertices.empty();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Mesh.h"
+
+struct ObjParseStats
+{
+    size_t bytes = 0;
+    unsigned chunks = 0;
+    double seconds = 0.0;
+
+    double MegabytesPerSecond() const
+    {
+        return seconds > 0.0 ? (double)bytes / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+};
+
+// Parses OBJ text that is already in memory (typically a MappedFile view).
+// The buffer is split into chunks on line boundaries which are tokenized in
+// parallel, then merged in file order so the output is identical to a
+// single-threaded pass.
+//
+// Faces may have any number of corners (fan-triangulated) and use negative
+// (relative) indices. Corners referencing the same position/uv/normal share
+// a vertex. Triangles are grouped into one contiguous index range per
+// usemtl material, or per o/g name if the file has no materials.
+bool ParseOBJ(const char* data, size_t size,
+              std::vector<Vertex>& outVertices,
+              std::vector<uint32_t>& outIndices,
+              std::vector<MeshSubmesh>& outSubmeshes,
+              ObjParseStats* stats = nullptr);
@@ -0,0 +1,23 @@
+#include "ParallelRecorder.h"
+
+bool ParallelRecorder::Initialize(ID3D12Device* device, UINT frameCount, UINT maxLists)
+{
+    m_frameCount = (std::max)(frameCount, 1u);
+    m_maxLists = (std::max)(maxLists, 1u);
+    m_allocators.assign(m_frameCount * m_maxLists, nullptr);
+    m_lists.assign(m_maxLists, nullptr);
+    m_closed.clear();
+    m_closed.reserve(m_maxLists);
+    for (auto& allocator : m_allocators) {
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator))))
+            return false;
+    }
+    // Created closed; Record resets each onto the frame's allocator
+    for (UINT i = 0; i < m_maxLists; ++i) {
+        if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_allocators[i].Get(), nullptr,
+                IID_PPV_ARGS(&m_lists[i]))))
+            return false;
+        if (FAILED(m_lists[i]->Close())) return false;
+    }
+    return true;
+}
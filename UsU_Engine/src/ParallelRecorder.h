@@ -0,0 +1,69 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "JobSystem.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Direct command lists recorded side by side on the job system. Each chunk
+// of a draw list gets its own list and, per frame in flight, its own
+// allocator, so no two threads ever touch the same one. The closed lists
+// come back in chunk order: submitted in one ExecuteCommandLists call they
+// draw exactly what a single list recording the chunks in turn would.
+class ParallelRecorder
+{
+public:
+    bool Initialize(ID3D12Device* device, UINT frameCount, UINT maxLists = 16);
+    UINT GetMaxLists() const { return m_maxLists; }
+
+    // Splits [0, itemCount) into chunks of at least minItemsPerList, no more
+    // than there are threads or lists, and calls fn(list, begin, end) for
+    // each on the job system with list open on frameIndex's allocators (so
+    // the caller must have waited for that frame's previous submission).
+    // Returns the number of lists recorded, 0 on failure.
+    template <typename Fn>
+    UINT Record(UINT frameIndex, UINT itemCount, UINT minItemsPerList, Fn&& fn);
+    // The lists of the last Record, closed, in chunk order
+    ID3D12CommandList* const* GetLists() const { return m_closed.data(); }
+
+private:
+    UINT m_frameCount = 1;
+    UINT m_maxLists = 0;
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_allocators; // [frame * m_maxLists + chunk]
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_lists;   // [chunk]
+    std::vector<ID3D12CommandList*> m_closed;
+};
+
+template <typename Fn>
+UINT ParallelRecorder::Record(UINT frameIndex, UINT itemCount, UINT minItemsPerList, Fn&& fn)
+{
+    m_closed.clear();
+    if (itemCount == 0 || m_lists.empty()) return 0;
+    if (minItemsPerList == 0) minItemsPerList = 1;
+    const UINT frame = frameIndex % m_frameCount;
+    const UINT chunks = (std::min)((itemCount + minItemsPerList - 1) / minItemsPerList,
+                                   (std::min)(m_maxLists, GetJobSystem().GetThreadCount()));
+
+    // Even split; the order of the lists, not of the threads, fixes the result
+    std::atomic<bool> failed{ false };
+    GetJobSystem().ParallelFor(chunks, 1, [&](uint32_t firstChunk, uint32_t lastChunk) {
+        for (uint32_t c = firstChunk; c < lastChunk; ++c) {
+            ID3D12CommandAllocator* allocator = m_allocators[frame * m_maxLists + c].Get();
+            ID3D12GraphicsCommandList* list = m_lists[c].Get();
+            if (FAILED(allocator->Reset()) || FAILED(list->Reset(allocator, nullptr))) {
+                failed.store(true);
+                continue;
+            }
+            const UINT begin = static_cast<UINT>(static_cast<uint64_t>(itemCount) * c / chunks);
+            const UINT end = static_cast<UINT>(static_cast<uint64_t>(itemCount) * (c + 1) / chunks);
+            fn(list, begin, end);
+            if (FAILED(list->Close())) failed.store(true);
+        }
+    });
+    if (failed.load()) return 0;
+    for (UINT c = 0; c < chunks; ++c) m_closed.push_back(m_lists[c].Get());
+    return chunks;
+}
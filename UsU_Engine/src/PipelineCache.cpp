@@ -0,0 +1,145 @@
+#include "PipelineCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <windows.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+struct DescHasher
+{
+    uint64_t hash = 0;
+    void Add(const void* data, size_t size) { hash = HashBytes64(data, size, hash); }
+    template <typename T>
+    void Add(const T& value) { Add(&value, sizeof(value)); }
+    void AddShader(const D3D12_SHADER_BYTECODE& shader)
+    {
+        Add(shader.BytecodeLength);
+        if (shader.BytecodeLength) Add(shader.pShaderBytecode, shader.BytecodeLength);
+    }
+};
+
+// Everything but pointers: what they point at is hashed in their place
+uint64_t HashPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+    DescHasher h;
+    h.Add(rootSignatureHash);
+    h.AddShader(desc.VS);
+    h.AddShader(desc.PS);
+    h.AddShader(desc.DS);
+    h.AddShader(desc.HS);
+    h.AddShader(desc.GS);
+    h.Add(desc.StreamOutput.NumEntries);
+    h.Add(desc.StreamOutput.RasterizedStream);
+    h.Add(desc.BlendState);
+    h.Add(desc.SampleMask);
+    h.Add(desc.RasterizerState);
+    h.Add(desc.DepthStencilState);
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i) {
+        const D3D12_INPUT_ELEMENT_DESC& e = desc.InputLayout.pInputElementDescs[i];
+        h.Add(e.SemanticName, strlen(e.SemanticName) + 1);
+        h.Add(e.SemanticIndex);
+        h.Add(e.Format);
+        h.Add(e.InputSlot);
+        h.Add(e.AlignedByteOffset);
+        h.Add(e.InputSlotClass);
+        h.Add(e.InstanceDataStepRate);
+    }
+    h.Add(desc.IBStripCutValue);
+    h.Add(desc.PrimitiveTopologyType);
+    h.Add(desc.NumRenderTargets);
+    h.Add(desc.RTVFormats);
+    h.Add(desc.DSVFormat);
+    h.Add(desc.SampleDesc);
+    h.Add(desc.NodeMask);
+    h.Add(desc.Flags);
+    return h.hash;
+}
+
+} // namespace
+
+bool PipelineCache::Initialize(ID3D12Device* device, const std::wstring& path)
+{
+    m_device = device;
+    m_path = path;
+    m_library.Reset();
+    m_blob.clear();
+    m_dirty = false;
+    m_hits = m_misses = 0;
+
+    ComPtr<ID3D12Device1> device1;
+    if (FAILED(device->QueryInterface(IID_PPV_ARGS(&device1)))) return true;
+
+    MappedFile file;
+    if (file.Open(path) && file.Size() >= sizeof(PipelineCacheHeader)) {
+        const auto* header = reinterpret_cast<const PipelineCacheHeader*>(file.Data());
+        const uint8_t* data = file.Data() + sizeof(PipelineCacheHeader);
+        if (header->magic == kPipelineCacheMagic && header->version == kPipelineCacheVersion &&
+            header->librarySize == file.Size() - sizeof(PipelineCacheHeader) &&
+            HashBytes64(data, static_cast<size_t>(header->librarySize)) == header->libraryHash)
+            m_blob.assign(data, data + header->librarySize);
+    }
+    // A stale blob (new driver, other adapter) is refused; start over then
+    if (!m_blob.empty() && FAILED(device1->CreatePipelineLibrary(m_blob.data(), m_blob.size(), IID_PPV_ARGS(&m_library)))) {
+        OutputDebugStringA("[DX12] Pipeline cache out of date, rebuilding\n");
+        m_blob.clear();
+        m_library.Reset();
+    }
+    if (!m_library && FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library))))
+        m_library.Reset();
+    return true;
+}
+
+bool PipelineCache::CreateGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash,
+                                           ComPtr<ID3D12PipelineState>& out)
+{
+    out.Reset();
+    wchar_t name[32];
+    swprintf_s(name, L"pso_%016llx", static_cast<unsigned long long>(HashPipelineDesc(desc, rootSignatureHash)));
+    if (m_library && SUCCEEDED(m_library->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(&out)))) {
+        ++m_hits;
+        return true;
+    }
+    ++m_misses;
+    if (FAILED(m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&out)))) return false;
+    if (m_library && SUCCEEDED(m_library->StorePipeline(name, out.Get()))) m_dirty = true;
+    return true;
+}
+
+bool PipelineCache::Save()
+{
+    if (!m_library || !m_dirty) return true;
+    const SIZE_T size = m_library->GetSerializedSize();
+    std::vector<uint8_t> blob(size);
+    if (size == 0 || FAILED(m_library->Serialize(blob.data(), size))) return false;
+
+    PipelineCacheHeader header{};
+    header.magic = kPipelineCacheMagic;
+    header.version = kPipelineCacheVersion;
+    header.librarySize = size;
+    header.libraryHash = HashBytes64(blob.data(), blob.size());
+
+    // Write to a temporary and rename so a crash never leaves a torn cache
+    const std::filesystem::path finalPath(m_path);
+    std::filesystem::path tmpPath = finalPath;
+    tmpPath += L".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, finalPath, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+// On-disk layout of a .usupso file: the header, then the blob of a
+// serialized ID3D12PipelineLibrary.
+static const uint32_t kPipelineCacheMagic = 0x50555355; // "USUP"
+static const uint32_t kPipelineCacheVersion = 1;
+
+struct PipelineCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t librarySize;
+    uint64_t libraryHash; // HashBytes64 of the library blob
+};
+static_assert(sizeof(PipelineCacheHeader) == 24, "PipelineCacheHeader layout changed");
+
+// Graphics PSOs stored in a pipeline library under a hash of their full
+// description (shader bytecode, states, input layout, formats and the
+// serialized root signature), so a warm start loads them instead of
+// recompiling. The driver rejects a library from another driver or adapter;
+// the cache then starts empty and is rewritten by Save(). Without
+// ID3D12Device1 every PSO is simply created.
+class PipelineCache
+{
+public:
+    bool Initialize(ID3D12Device* device, const std::wstring& path);
+    // rootSignatureHash: HashBytes64 of the serialized root signature desc.
+    // Padding bytes in the desc are hashed too; they can only cause misses.
+    bool CreateGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash,
+                                ComPtr<ID3D12PipelineState>& out);
+    // Writes the library back if CreateGraphicsPipeline added to it
+    bool Save();
+
+    uint32_t GetHits() const { return m_hits; }
+    uint32_t GetMisses() const { return m_misses; }
+
+private:
+    ID3D12Device* m_device = nullptr;
+    ComPtr<ID3D12PipelineLibrary> m_library;
+    std::vector<uint8_t> m_blob; // the library reads from it for its whole lifetime
+    std::wstring m_path;
+    bool m_dirty = false;
+    uint32_t m_hits = 0;
+    uint32_t m_misses = 0;
+};
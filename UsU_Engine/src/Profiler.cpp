@@ -0,0 +1,260 @@
+#include "Profiler.h"
+
+#if USU_PROFILE
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Slot
+{
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<uint64_t> begin{ 0 };
+    std::atomic<uint64_t> end{ 0 };
+};
+
+// Single writer (the owning thread), any number of readers. claimed moves
+// before a slot is written and head after, so a reader can tell which of
+// the slots it copied the writer may have been overwriting meanwhile.
+struct Ring
+{
+    Slot slots[Profiler::kRingSize];
+    std::atomic<uint64_t> claimed{ 0 };
+    std::atomic<uint64_t> head{ 0 };
+    uint64_t summarized = 0; // EndFrame's cursor
+    uint32_t id = 0;
+    char name[32] = {};      // under g_registryMutex
+};
+
+struct Event
+{
+    const char* name;
+    uint64_t begin, end;
+};
+
+struct ZoneTotals
+{
+    const char* name;
+    double frameMs;
+    uint32_t frameCalls;
+    double sumMs, maxMs;
+    uint64_t calls;
+};
+
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<Ring>> g_rings; // kept after their threads exit
+thread_local Ring* t_ring = nullptr;
+thread_local char t_name[32] = {}; // until the first zone registers t_ring
+Ring* g_gpuRing = nullptr; // frame loop thread only
+
+// Frame loop thread only
+bool g_logSummary = false;
+std::vector<ZoneTotals> g_totals;
+std::vector<Event> g_frameEvents;
+uint32_t g_summaryFrames = 0;
+uint64_t g_frameStart = 0;
+double g_frameMsSum = 0.0, g_frameMsMax = 0.0;
+
+Ring* RegisterRing(const char* name)
+{
+    std::unique_ptr<Ring> ring(new Ring());
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    ring->id = static_cast<uint32_t>(g_rings.size()) + 1;
+    if (name) snprintf(ring->name, sizeof(ring->name), "%s", name);
+    else snprintf(ring->name, sizeof(ring->name), "Thread %u", ring->id);
+    g_rings.push_back(std::move(ring));
+    return g_rings.back().get();
+}
+
+void Write(Ring& ring, const char* name, uint64_t begin, uint64_t end)
+{
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.claimed.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot& s = ring.slots[head & (Profiler::kRingSize - 1)];
+    s.name.store(name, std::memory_order_relaxed);
+    s.begin.store(begin, std::memory_order_relaxed);
+    s.end.store(end, std::memory_order_relaxed);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+// Appends events [from, head) still intact in ring; returns head
+uint64_t ReadRing(const Ring& ring, uint64_t from, std::vector<Event>& out)
+{
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    const uint64_t first = (std::max)(from, head > Profiler::kRingSize ? head - Profiler::kRingSize : 0);
+    const size_t start = out.size();
+    for (uint64_t i = first; i < head; ++i) {
+        const Slot& s = ring.slots[i & (Profiler::kRingSize - 1)];
+        out.push_back(Event{ s.name.load(std::memory_order_relaxed), s.begin.load(std::memory_order_relaxed),
+                             s.end.load(std::memory_order_relaxed) });
+    }
+    // Slot claimed - 1 may be mid-write, so indices up to claimed - 1 - kRingSize are suspect
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t claimed = ring.claimed.load(std::memory_order_relaxed);
+    if (claimed > Profiler::kRingSize && claimed - Profiler::kRingSize > first) {
+        const size_t torn = static_cast<size_t>((std::min)(claimed - Profiler::kRingSize, head) - first);
+        out.erase(out.begin() + start, out.begin() + start + torn);
+    }
+    return head;
+}
+
+ZoneTotals& FindTotals(const char* name)
+{
+    // The same literal may have another address in another translation unit
+    for (ZoneTotals& z : g_totals) {
+        if (z.name == name || strcmp(z.name, name) == 0) return z;
+    }
+    g_totals.push_back(ZoneTotals{ name, 0.0, 0, 0.0, 0.0, 0 });
+    return g_totals.back();
+}
+
+void LogSummary()
+{
+    const double frames = static_cast<double>(g_summaryFrames);
+    std::sort(g_totals.begin(), g_totals.end(), [](const ZoneTotals& a, const ZoneTotals& b) { return a.sumMs > b.sumMs; });
+    char msg[192];
+    sprintf_s(msg, "[Profile] %u frames: %.3f ms/frame, max %.3f ms\n", g_summaryFrames, g_frameMsSum / frames, g_frameMsMax);
+    OutputDebugStringA(msg);
+    for (const ZoneTotals& z : g_totals) {
+        sprintf_s(msg, "[Profile]   %-24s %8.3f ms/frame  max %8.3f ms  %7.1f calls/frame\n", z.name, z.sumMs / frames,
+            z.maxMs, z.calls / frames);
+        OutputDebugStringA(msg);
+    }
+}
+
+std::string JsonEscape(const char* text)
+{
+    std::string out;
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20) out += *c;
+    }
+    return out;
+}
+
+} // namespace
+
+void Profiler::Record(const char* name, uint64_t begin, uint64_t end)
+{
+    Ring* ring = t_ring;
+    if (!ring) ring = t_ring = RegisterRing(t_name[0] ? t_name : nullptr);
+    Write(*ring, name, begin, end);
+}
+
+void Profiler::RecordGpu(const char* name, uint64_t begin, uint64_t end)
+{
+    if (!g_gpuRing) g_gpuRing = RegisterRing("GPU");
+    Write(*g_gpuRing, name, begin, end);
+}
+
+// Threads that never record a zone never get a ring
+void Profiler::SetThreadName(const char* name)
+{
+    if (!t_ring) {
+        snprintf(t_name, sizeof(t_name), "%s", name);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    snprintf(t_ring->name, sizeof(t_ring->name), "%s", name);
+}
+
+void Profiler::SetSummaryLogging(bool enabled)
+{
+    g_logSummary = enabled;
+}
+
+void Profiler::EndFrame()
+{
+    const uint64_t now = Now();
+    const uint64_t frameStart = g_frameStart;
+    g_frameStart = now;
+    if (!g_logSummary || frameStart == 0) return;
+
+    // Everything finished since the last frame, on every thread
+    g_frameEvents.clear();
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto& ring : g_rings) ring->summarized = ReadRing(*ring, ring->summarized, g_frameEvents);
+    }
+    for (const Event& e : g_frameEvents) {
+        ZoneTotals& z = FindTotals(e.name);
+        z.frameMs += (e.end - e.begin) * 1e-6;
+        ++z.frameCalls;
+    }
+    for (ZoneTotals& z : g_totals) {
+        z.sumMs += z.frameMs;
+        z.maxMs = (std::max)(z.maxMs, z.frameMs);
+        z.calls += z.frameCalls;
+        z.frameMs = 0.0;
+        z.frameCalls = 0;
+    }
+    const double frameMs = (now - frameStart) * 1e-6;
+    g_frameMsSum += frameMs;
+    g_frameMsMax = (std::max)(g_frameMsMax, frameMs);
+    if (++g_summaryFrames < kSummaryFrames) return;
+
+    LogSummary();
+    g_totals.clear();
+    g_summaryFrames = 0;
+    g_frameMsSum = g_frameMsMax = 0.0;
+}
+
+bool Profiler::WriteChromeTrace(const std::wstring& path)
+{
+    struct Track
+    {
+        uint32_t id;
+        std::string name;
+        std::vector<Event> events;
+    };
+    std::vector<Track> tracks;
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto& ring : g_rings) {
+            tracks.push_back(Track{ ring->id, ring->name, std::vector<Event>() });
+            ReadRing(*ring, 0, tracks.back().events);
+        }
+    }
+    uint64_t origin = UINT64_MAX;
+    size_t count = 0;
+    for (const Track& t : tracks) {
+        for (const Event& e : t.events) origin = (std::min)(origin, e.begin);
+        count += t.events.size();
+    }
+
+    std::ofstream out(std::filesystem::path(path), std::ios::trunc);
+    if (!out) return false;
+    out << "{\"traceEvents\":[\n";
+    const char* separator = "";
+    char line[384];
+    for (const Track& t : tracks) {
+        snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            separator, t.id, JsonEscape(t.name.c_str()).c_str());
+        out << line;
+        separator = ",\n";
+        // Complete events; microseconds from the oldest event kept
+        for (const Event& e : t.events) {
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                JsonEscape(e.name).c_str(), t.id, (e.begin - origin) / 1000.0, (e.end - e.begin) / 1000.0);
+            out << line;
+        }
+    }
+    out << "\n]}\n";
+    if (!out) return false;
+
+    char msg[512];
+    sprintf_s(msg, "[Profile] Chrome trace: %zu zones on %zu track(s) -> %ls\n", count, tracks.size(), path.c_str());
+    OutputDebugStringA(msg);
+    return true;
+}
+
+#endif
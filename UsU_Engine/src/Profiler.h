@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Instrumentation switch: build with USU_PROFILE=0 and every zone macro
+// expands to nothing and the profiler classes to empty inline functions
+#ifndef USU_PROFILE
+#define USU_PROFILE 1
+#endif
+
+#define USU_PROFILE_CONCAT2(a, b) a##b
+#define USU_PROFILE_CONCAT(a, b) USU_PROFILE_CONCAT2(a, b)
+
+#if USU_PROFILE
+
+// Scoped CPU zones go into a ring of the calling thread (kRingSize events
+// each, the oldest overwritten), so recording never takes a lock; only a
+// thread's first zone registers its ring. Names must be string literals or
+// otherwise outlive the profiler. EndFrame, on the frame loop's thread,
+// folds the zones finished since the last frame into per-name totals and
+// logs them every kSummaryFrames frames; WriteChromeTrace dumps what the
+// rings still hold as chrome://tracing / Perfetto JSON.
+class Profiler
+{
+public:
+    static const uint32_t kRingSize = 16384;
+    static const uint32_t kSummaryFrames = 240;
+
+    // Nanoseconds on steady_clock (QueryPerformanceCounter with MSVC)
+    static uint64_t Now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void Record(const char* name, uint64_t begin, uint64_t end);
+    // Zones measured on the GPU, already on the Now() timeline
+    static void RecordGpu(const char* name, uint64_t begin, uint64_t end);
+    static void SetThreadName(const char* name);
+
+    static void EndFrame();
+    static void SetSummaryLogging(bool enabled);
+    static bool WriteChromeTrace(const std::wstring& path);
+};
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name) : m_name(name), m_begin(Profiler::Now()) {}
+    ~ProfileZone() { Profiler::Record(m_name, m_begin, Profiler::Now()); }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
+
+#define USU_PROFILE_ZONE(name) ProfileZone USU_PROFILE_CONCAT(usuProfileZone, __LINE__)(name)
+
+#else
+
+class Profiler
+{
+public:
+    static uint64_t Now() { return 0; }
+    static void Record(const char*, uint64_t, uint64_t) {}
+    static void RecordGpu(const char*, uint64_t, uint64_t) {}
+    static void SetThreadName(const char*) {}
+    static void EndFrame() {}
+    static void SetSummaryLogging(bool) {}
+    static bool WriteChromeTrace(const std::wstring&) { return false; }
+};
+
+#define USU_PROFILE_ZONE(name) ((void)0)
+
+#endif
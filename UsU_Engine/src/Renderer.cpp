@@ -1,85 +1,142 @@
 #include "Renderer.h"
+#include "ImageDecoder.h"
+#include "MipGenerator.h"
+#include "Hash.h"
+#include "Profiler.h"
 #include <stdexcept>
 #include <windows.h>
-#include <wincodec.h>
 #include <vector>
-#pragma comment(lib, "ole32.lib")
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 using namespace DirectX;
 
-bool Renderer::Initialize(ID3D12Device* device)
+static const UINT64 kUploadRingSize = 8ull << 20;
+
+Renderer::~Renderer()
+{
+    if (m_copyEvent) CloseHandle(m_copyEvent);
+}
+
+bool Renderer::Initialize(ID3D12Device* device, ID3D12CommandQueue* graphicsQueue, UINT frameCount)
 {
     m_device = device;
+    m_graphicsQueue = graphicsQueue;
+    m_frameCount = (std::max)(frameCount, 1u);
+    m_frameIndex = 0;
 
-    // Create constant buffer (upload heap, 256-byte aligned)
-    const UINT cbSize = (sizeof(PerObjectCB) + 255) & ~255u;
-    D3D12_HEAP_PROPERTIES heapProps{};
-    heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
-
-    D3D12_RESOURCE_DESC resDesc{};
-    resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    resDesc.Width = cbSize;
-    resDesc.Height = 1;
-    resDesc.DepthOrArraySize = 1;
-    resDesc.MipLevels = 1;
-    resDesc.SampleDesc.Count = 1;
-    resDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-    if (FAILED(m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_cb))))
+    m_memory.Initialize(device);
+
+    // Constant buffers: a 256-byte aligned slice per frame in a persistently
+    // mapped upload range, so the CPU never writes one the GPU may be reading
+    if (!m_memory.CreateBuffer(sizeof(PerObjectCB) * m_frameCount, GpuMemoryKind::UploadBuffers,
+            D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, m_cb))
+        return false;
+    m_cbMapped = reinterpret_cast<PerObjectCB*>(m_cb.mapped);
+
+    // Instance buffer: the same per-frame slicing, read by the VS as a root SRV
+    if (!m_memory.CreateBuffer(sizeof(InstanceData) * kMaxInstancesPerFrame * m_frameCount, GpuMemoryKind::UploadBuffers,
+            sizeof(InstanceData), m_instances))
         return false;
+    m_instancesMapped = reinterpret_cast<InstanceData*>(m_instances.mapped);
+    m_instanceCount = 0;
 
-    // Map once
-    if (FAILED(m_cb->Map(0, nullptr, reinterpret_cast<void**>(&m_cbMapped))))
+    // Draw constants: one PerObjectCB per draw, root CBV per draw
+    if (!m_memory.CreateBuffer(sizeof(PerObjectCB) * kMaxDrawsPerFrame * m_frameCount, GpuMemoryKind::UploadBuffers,
+            D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, m_drawCb))
         return false;
+    m_drawCbMapped = reinterpret_cast<PerObjectCB*>(m_drawCb.mapped);
+    m_drawCount = 0;
 
-    // Create SRV heap (1 descriptor, shader visible)
+    // Create SRV heap (one descriptor per skin, shader visible). Null views
+    // until a texture is loaded, so every slot of the table is valid.
     D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
-    heapDesc.NumDescriptors = 1;
+    heapDesc.NumDescriptors = kMaxSkins;
     heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
     heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
     if (FAILED(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_srvHeap))))
         return false;
+    m_srvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    D3D12_SHADER_RESOURCE_VIEW_DESC nullSrv{};
+    nullSrv.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    nullSrv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    nullSrv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    nullSrv.Texture2D.MipLevels = 1;
+    D3D12_CPU_DESCRIPTOR_HANDLE slot = m_srvHeap->GetCPUDescriptorHandleForHeapStart();
+    for (UINT i = 0; i < kMaxSkins; ++i, slot.ptr += m_srvDescriptorSize)
+        m_device->CreateShaderResourceView(nullptr, &nullSrv, slot);
+
+    // Copy queue, its fence and the staging ring (mapped for its lifetime)
+    D3D12_COMMAND_QUEUE_DESC copyDesc{};
+    copyDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    if (FAILED(m_device->CreateCommandQueue(&copyDesc, IID_PPV_ARGS(&m_copyQueue))))
+        return false;
+    if (FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_copyFence))))
+        return false;
+    m_copyEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_copyEvent) return false;
+    if (!CreateBuffer(kUploadRingSize, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD, m_uploadBuffer))
+        return false;
+    D3D12_RANGE noRead{ 0, 0 };
+    if (FAILED(m_uploadBuffer->Map(0, &noRead, reinterpret_cast<void**>(&m_uploadMapped))))
+        return false;
+    m_uploadRing.Reset(kUploadRingSize);
 
     return true;
 }
 
+// ShaderCache's compiler on a miss. The standard include handler resolves
+// #includes next to the including file, the way the cache keys them.
+static bool CompileShader(const std::wstring& shaderFile, const char* entry, const char* target, uint32_t flags,
+                          std::vector<uint8_t>& bytecode)
+{
+    ComPtr<ID3DBlob> out, err;
+    if (SUCCEEDED(D3DCompileFromFile(shaderFile.c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, entry, target, flags, 0,
+            &out, &err))) {
+        const uint8_t* p = static_cast<const uint8_t*>(out->GetBufferPointer());
+        bytecode.assign(p, p + out->GetBufferSize());
+        return true;
+    }
+    if (err) OutputDebugStringA((const char*)err->GetBufferPointer());
+    char msg[512];
+    sprintf_s(msg, "[DX12] %s compile failed: %ls\n", entry, shaderFile.c_str());
+    OutputDebugStringA(msg);
+    return false;
+}
+
 bool Renderer::CreatePipeline(const wchar_t* shaderFile)
 {
-    // Compile shaders
+    const auto t0 = std::chrono::steady_clock::now();
+    // Warm starts read bytecode and PSOs from <shader dir>\ShaderCache
+    const std::filesystem::path cacheDir = std::filesystem::path(shaderFile).parent_path() / L"ShaderCache";
+    m_shaderCache.Initialize(cacheDir.wstring(), CompileShader, D3D_COMPILER_VERSION);
+    m_pipelineCache.Initialize(m_device, (cacheDir / L"pipelines.usupso").wstring());
+
+    // Shaders (5.1: the instanced pixel shader indexes the skin table)
     UINT compileFlags = 0;
 #if defined(_DEBUG)
     compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
-    ComPtr<ID3DBlob> vsBlob, psBlob, err;
-    HRESULT hrVS = D3DCompileFromFile(shaderFile, nullptr, nullptr, "VSMain", "vs_5_0", compileFlags, 0, &vsBlob, &err);
-    if (FAILED(hrVS)) {
-        if (err) OutputDebugStringA((const char*)err->GetBufferPointer());
-        OutputDebugStringW(L"[DX12] VS compile failed: ");
-        OutputDebugStringW(shaderFile);
-        OutputDebugStringW(L"\n");
-        // MessageBoxW(nullptr, shaderFile, L"VS compile failed", MB_OK);
-        return false;
-    }
-    err.Reset();
-    HRESULT hrPS = D3DCompileFromFile(shaderFile, nullptr, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &psBlob, &err);
-    if (FAILED(hrPS)) {
-        if (err) OutputDebugStringA((const char*)err->GetBufferPointer());
-        OutputDebugStringW(L"[DX12] PS compile failed: ");
-        OutputDebugStringW(shaderFile);
-        OutputDebugStringW(L"\n");
-        // MessageBoxW(nullptr, shaderFile, L"PS compile failed", MB_OK);
+    std::vector<uint8_t> vsBlob, vsPackedBlob, vsInstancedBlob, vsInstancedPackedBlob, psBlob, psInstancedBlob;
+    if (!m_shaderCache.Get(shaderFile, "VSMain", "vs_5_1", compileFlags, vsBlob) ||
+        !m_shaderCache.Get(shaderFile, "VSMainPacked", "vs_5_1", compileFlags, vsPackedBlob) ||
+        !m_shaderCache.Get(shaderFile, "VSMainInstanced", "vs_5_1", compileFlags, vsInstancedBlob) ||
+        !m_shaderCache.Get(shaderFile, "VSMainInstancedPacked", "vs_5_1", compileFlags, vsInstancedPackedBlob) ||
+        !m_shaderCache.Get(shaderFile, "PSMain", "ps_5_1", compileFlags, psBlob) ||
+        !m_shaderCache.Get(shaderFile, "PSMainInstanced", "ps_5_1", compileFlags, psInstancedBlob))
         return false;
-    }
 
-    // Root signature: b0 (VS CBV) + t0 (PS SRV) and a static sampler s0
+    // Root signature: b0 (VS CBV) + t0..t7 (PS skin table) + t8 (VS instance
+    // SRV) and a static sampler s0
     D3D12_DESCRIPTOR_RANGE srvRange{};
     srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-    srvRange.NumDescriptors = 1;
+    srvRange.NumDescriptors = kMaxSkins;
     srvRange.BaseShaderRegister = 0; // t0
     srvRange.RegisterSpace = 0;
     srvRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
 
-    D3D12_ROOT_PARAMETER params[2] = {};
+    D3D12_ROOT_PARAMETER params[3] = {};
     // b0
     params[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
     params[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
@@ -89,6 +146,10 @@ bool Renderer::CreatePipeline(const wchar_t* shaderFile)
     params[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
     params[1].DescriptorTable.NumDescriptorRanges = 1;
     params[1].DescriptorTable.pDescriptorRanges = &srvRange;
+    // t8, structured buffer as a root descriptor so each batch can start anywhere
+    params[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    params[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    params[2].Descriptor.ShaderRegister = kMaxSkins;
 
     D3D12_STATIC_SAMPLER_DESC samp{};
     samp.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
@@ -117,6 +178,7 @@ bool Renderer::CreatePipeline(const wchar_t* shaderFile)
         return false;
     if (FAILED(m_device->CreateRootSignature(0, sig->GetBufferPointer(), sig->GetBufferSize(), IID_PPV_ARGS(&m_rootSig))))
         return false;
+    const uint64_t rootSigHash = HashBytes64(sig->GetBufferPointer(), sig->GetBufferSize());
 
     // Input layout
     D3D12_INPUT_ELEMENT_DESC layout[] = {
@@ -128,8 +190,8 @@ bool Renderer::CreatePipeline(const wchar_t* shaderFile)
     // PSO
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
     psoDesc.pRootSignature = m_rootSig.Get();
-    psoDesc.VS = { vsBlob->GetBufferPointer(), vsBlob->GetBufferSize() };
-    psoDesc.PS = { psBlob->GetBufferPointer(), psBlob->GetBufferSize() };
+    psoDesc.VS = { vsBlob.data(), vsBlob.size() };
+    psoDesc.PS = { psBlob.data(), psBlob.size() };
     D3D12_BLEND_DESC blend{};
     blend.AlphaToCoverageEnable = FALSE;
     blend.IndependentBlendEnable = FALSE;
@@ -169,9 +231,40 @@ bool Renderer::CreatePipeline(const wchar_t* shaderFile)
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
     psoDesc.SampleDesc.Count = 1;
 
-    if (FAILED(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso))))
+    if (!m_pipelineCache.CreateGraphicsPipeline(psoDesc, rootSigHash, m_pso))
         return false;
 
+    // Packed layout: same state, 16-byte PackedVertex decoded in VSMainPacked
+    D3D12_INPUT_ELEMENT_DESC packedLayout[] = {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, offsetof(PackedVertex, position), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,       0, offsetof(PackedVertex, normal),   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, offsetof(PackedVertex, uv),       D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+    psoDesc.VS = { vsPackedBlob.data(), vsPackedBlob.size() };
+    psoDesc.InputLayout = { packedLayout, _countof(packedLayout) };
+    if (!m_pipelineCache.CreateGraphicsPipeline(psoDesc, rootSigHash, m_psoPacked))
+        return false;
+
+    // Instanced variants of both
+    psoDesc.PS = { psInstancedBlob.data(), psInstancedBlob.size() };
+    psoDesc.VS = { vsInstancedPackedBlob.data(), vsInstancedPackedBlob.size() };
+    if (!m_pipelineCache.CreateGraphicsPipeline(psoDesc, rootSigHash, m_psoInstancedPacked))
+        return false;
+    psoDesc.VS = { vsInstancedBlob.data(), vsInstancedBlob.size() };
+    psoDesc.InputLayout = { layout, _countof(layout) };
+    if (!m_pipelineCache.CreateGraphicsPipeline(psoDesc, rootSigHash, m_psoInstanced))
+        return false;
+
+    m_pipelineCache.Save();
+    {
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        char msg[160];
+        sprintf_s(msg, "[DX12] Pipeline: %u shader(s) cached, %u compiled; %u PSO(s) cached, %u created; %.1f ms\n",
+            m_shaderCache.GetHits(), m_shaderCache.GetCompiles(), m_pipelineCache.GetHits(), m_pipelineCache.GetMisses(), ms);
+        OutputDebugStringA(msg);
+    }
+
+    if (m_indexCount > 0) RecordDrawBundles();
     return true;
 }
 
@@ -189,55 +282,329 @@ bool Renderer::CreateBuffer(size_t byteSize, D3D12_RESOURCE_STATES initialState,
     return SUCCEEDED(m_device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &desc, initialState, nullptr, IID_PPV_ARGS(&out)));
 }
 
-bool Renderer::UploadMesh(const Mesh& mesh)
+void Renderer::WaitForCopyFence(UINT64 value)
 {
-    const auto& vertices = mesh.GetVertices();
-    const auto& indices  = mesh.GetIndices();
-    if (vertices.empty() || indices.empty()) return false;
+    if (m_copyFence->GetCompletedValue() >= value) return;
+    if (SUCCEEDED(m_copyFence->SetEventOnCompletion(value, m_copyEvent)))
+        WaitForSingleObject(m_copyEvent, INFINITE);
+}
 
-    const size_t vbBytes = vertices.size() * sizeof(Vertex);
-    const size_t ibBytes = indices.size()  * sizeof(uint32_t);
+void Renderer::WaitForUploads()
+{
+    if (!m_copyFence) return;
+    WaitForCopyFence(m_copyFenceValue);
+    RetireUploads();
+}
 
-    // For simplicity, keep both in UPLOAD heap and bind directly
-    if (!CreateBuffer(vbBytes, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD, m_vertexBuffer)) return false;
-    if (!CreateBuffer(ibBytes, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD, m_indexBuffer)) return false;
+void Renderer::RetireUploads()
+{
+    const UINT64 completed = m_copyFence->GetCompletedValue();
+    m_uploadRing.Retire(completed);
+    m_oversizedStaging.erase(std::remove_if(m_oversizedStaging.begin(), m_oversizedStaging.end(),
+        [completed](const StagingBuffer& b) { return b.fenceValue <= completed; }), m_oversizedStaging.end());
+}
 
-    // Upload
+bool Renderer::BeginUpload()
+{
+    if (m_copyListOpen) return true;
+    RetireUploads();
+
+    // Reuse an allocator whose last batch has completed, else add one
+    const UINT64 completed = m_copyFence->GetCompletedValue();
+    size_t index = m_copyAllocators.size();
+    for (size_t i = 0; i < m_copyAllocators.size(); ++i) {
+        if (m_copyAllocators[i].fenceValue <= completed) { index = i; break; }
+    }
+    if (index == m_copyAllocators.size()) {
+        CopyAllocator a;
+        if (FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&a.allocator))))
+            return false;
+        m_copyAllocators.push_back(a);
+    } else if (FAILED(m_copyAllocators[index].allocator->Reset())) {
+        return false;
+    }
+    ID3D12CommandAllocator* allocator = m_copyAllocators[index].allocator.Get();
+    if (!m_copyList) {
+        if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, allocator, nullptr, IID_PPV_ARGS(&m_copyList))))
+            return false;
+    } else if (FAILED(m_copyList->Reset(allocator, nullptr))) {
+        return false;
+    }
+    m_currentCopyAllocator = index;
+    m_copyListOpen = true;
+    return true;
+}
+
+uint8_t* Renderer::AllocateUpload(uint64_t size, uint64_t alignment, ID3D12Resource*& buffer, uint64_t& offset)
+{
+    if (size <= m_uploadRing.Capacity()) {
+        for (;;) {
+            offset = m_uploadRing.Allocate(size, alignment);
+            if (offset != UploadRing::kInvalidOffset) {
+                buffer = m_uploadBuffer.Get();
+                return m_uploadMapped + offset;
+            }
+            // An empty ring fits anything up to its capacity, so there is
+            // nothing to wait for
+            if (m_uploadRing.Empty()) return nullptr;
+            // Full: if the open batch itself holds the space, flush it, then
+            // wait for the oldest batch to free its part of the ring
+            if (m_uploadRing.OldestPendingFence() == 0 && !(SubmitUpload() && BeginUpload())) return nullptr;
+            WaitForCopyFence(m_uploadRing.OldestPendingFence());
+            RetireUploads();
+        }
+    }
+
+    // Larger than the whole ring: a one-off buffer kept until its copy completes
+    StagingBuffer staging;
+    if (!CreateBuffer(static_cast<size_t>(size), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD, staging.resource))
+        return nullptr;
     void* p = nullptr;
-    if (FAILED(m_vertexBuffer->Map(0, nullptr, &p))) return false;
-    memcpy(p, vertices.data(), vbBytes);
-    m_vertexBuffer->Unmap(0, nullptr);
+    D3D12_RANGE noRead{ 0, 0 };
+    if (FAILED(staging.resource->Map(0, &noRead, &p))) return nullptr;
+    staging.fenceValue = m_copyFenceValue + 1; // the batch being recorded
+    buffer = staging.resource.Get();
+    offset = 0;
+    m_oversizedStaging.push_back(staging);
+    return static_cast<uint8_t*>(p);
+}
+
+bool Renderer::SubmitUpload()
+{
+    if (!m_copyListOpen) return true;
+    m_copyListOpen = false;
+    if (FAILED(m_copyList->Close())) return false;
+    ID3D12CommandList* lists[] = { m_copyList.Get() };
+    m_copyQueue->ExecuteCommandLists(1, lists);
+    const UINT64 value = ++m_copyFenceValue;
+    if (FAILED(m_copyQueue->Signal(m_copyFence.Get(), value))) return false;
+    m_uploadRing.Submit(value);
+    m_copyAllocators[m_currentCopyAllocator].fenceValue = value;
+    // Resources decay to COMMON after the copy queue; the graphics queue
+    // promotes them implicitly on first use once this wait is satisfied
+    if (m_graphicsQueue) m_graphicsQueue->Wait(m_copyFence.Get(), value);
+    return true;
+}
+
+bool Renderer::UploadMesh(const Mesh& mesh, VertexFormat format)
+{
+    const auto& vertices = mesh.GetVertices();
+    const auto& indices  = mesh.GetIndices();
+    const auto& lodIndices = mesh.GetLodIndices();
+    if (mesh.GetLodLevelCount() < 2)
+        return UploadMesh(vertices.data(), vertices.size(), indices.data(), indices.size(), format, mesh.GetSubmeshes());
+
+    // LOD indices go after LOD 0's in one index buffer, as in a .usumesh
+    std::vector<uint32_t> allIndices;
+    allIndices.reserve(indices.size() + lodIndices.size());
+    allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+    allIndices.insert(allIndices.end(), lodIndices.begin(), lodIndices.end());
+    MeshLodChain chain;
+    chain.lods = mesh.GetLods().data();
+    chain.lodCount = mesh.GetLods().size();
+    chain.indexCount = lodIndices.size();
+    return UploadMesh(vertices.data(), vertices.size(), allIndices.data(), indices.size(), format, mesh.GetSubmeshes(), chain);
+}
+
+bool Renderer::UploadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+                          VertexFormat format, const std::vector<MeshSubmesh>& submeshes, const MeshLodChain& lodChain)
+{
+    USU_PROFILE_ZONE("UploadMesh");
+    if (!vertices || !indices || vertexCount == 0 || indexCount == 0) return false;
+
+    const size_t stride  = (format == VertexFormat::Packed16) ? sizeof(PackedVertex) : sizeof(Vertex);
+    const size_t vbBytes = vertexCount * stride;
+
+    // One draw per submesh (material) and LOD level, all from the same VB/IB
+    const size_t submeshCount = submeshes.size();
+    const bool hasLods = lodChain.lods && submeshCount > 0 && lodChain.lodCount >= 2 * submeshCount &&
+                         lodChain.lodCount % submeshCount == 0;
+    const size_t levels = hasLods ? lodChain.lodCount / submeshCount : 1;
+    const size_t totalIndexCount = indexCount + (hasLods ? lodChain.indexCount : 0);
+    std::vector<std::vector<IndexRange>> levelRanges(levels);
+    if (submeshes.empty()) {
+        IndexRange all;
+        all.indexCount = static_cast<uint32_t>(indexCount);
+        levelRanges[0].push_back(all);
+    } else {
+        for (size_t level = 0; level < levels; ++level) {
+            for (size_t i = 0; i < submeshCount; ++i) {
+                IndexRange r;
+                if (level == 0) {
+                    r.firstIndex = submeshes[i].indexOffset;
+                    r.indexCount = submeshes[i].indexCount;
+                } else {
+                    r.firstIndex = lodChain.lods[level * submeshCount + i].indexOffset;
+                    r.indexCount = lodChain.lods[level * submeshCount + i].indexCount;
+                }
+                if (uint64_t(r.firstIndex) + r.indexCount > (level == 0 ? indexCount : totalIndexCount)) return false;
+                r.submesh = static_cast<uint32_t>(i);
+                levelRanges[level].push_back(r);
+            }
+        }
+    }
 
-    if (FAILED(m_indexBuffer->Map(0, nullptr, &p))) return false;
-    memcpy(p, indices.data(), ibBytes);
-    m_indexBuffer->Unmap(0, nullptr);
+    // 16-bit indices whenever every draw range can address its vertices
+    // with them; large submeshes are split further with a base vertex
+    bool use16 = (totalIndexCount % 3) == 0;
+    std::vector<std::vector<IndexRange>> levelRanges16(levels);
+    std::vector<IndexRange> split;
+    for (size_t level = 0; use16 && level < levels; ++level) {
+        for (size_t i = 0; use16 && i < levelRanges[level].size(); ++i) {
+            const IndexRange& r = levelRanges[level][i];
+            if (r.indexCount % 3 != 0 || !SplitIndexRanges16(indices + r.firstIndex, r.indexCount, split)) {
+                use16 = r.indexCount == 0;
+                continue;
+            }
+            for (IndexRange s : split) {
+                s.firstIndex += r.firstIndex;
+                s.submesh = r.submesh;
+                levelRanges16[level].push_back(s);
+            }
+        }
+    }
+    if (use16) levelRanges.swap(levelRanges16);
+    const size_t ibBytes = totalIndexCount * (use16 ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    // DEFAULT heap buffers filled from the upload ring on the copy queue
+    m_memory.Free(m_vertexBuffer);
+    m_memory.Free(m_indexBuffer);
+    if (!m_memory.CreateBuffer(vbBytes, GpuMemoryKind::Buffers, 16, m_vertexBuffer)) return false;
+    if (!m_memory.CreateBuffer(ibBytes, GpuMemoryKind::Buffers, 16, m_indexBuffer)) return false;
+    if (!BeginUpload()) return false;
+
+    // Packed vertices are encoded straight into staging memory
+    ID3D12Resource* staging = nullptr;
+    uint64_t stagingOffset = 0;
+    uint8_t* p = AllocateUpload(vbBytes, 16, staging, stagingOffset);
+    if (!p) return false;
+    if (format == VertexFormat::Packed16) {
+        m_quantization = ComputeVertexQuantization(vertices, vertexCount);
+        PackVertices(reinterpret_cast<PackedVertex*>(p), vertices, vertexCount, m_quantization);
+#if defined(_DEBUG)
+        const PackedVertexError e = MeasurePackingError(vertices, reinterpret_cast<const PackedVertex*>(p), vertexCount, m_quantization);
+        char msg[192];
+        sprintf_s(msg, "[DX12] Packed vertices: %zu -> %zu bytes, max err pos %.6f nrm %.6f rad uv %.6f\n",
+            vertexCount * sizeof(Vertex), vbBytes, e.maxPosition, e.maxNormalRadians, e.maxUV);
+        OutputDebugStringA(msg);
+#endif
+    } else {
+        memcpy(p, vertices, vbBytes);
+    }
+    m_copyList->CopyBufferRegion(m_vertexBuffer.resource.Get(), m_vertexBuffer.offset, staging, stagingOffset, vbBytes);
+
+    p = AllocateUpload(ibBytes, 16, staging, stagingOffset);
+    if (!p) return false;
+    if (use16) {
+        // A level that kept a coarser level's range splits it the same way,
+        // so overlapping ranges write the same values
+        for (const std::vector<IndexRange>& ranges : levelRanges) WriteIndices16(reinterpret_cast<uint16_t*>(p), indices, ranges);
+    } else {
+        memcpy(p, indices, ibBytes);
+    }
+    m_copyList->CopyBufferRegion(m_indexBuffer.resource.Get(), m_indexBuffer.offset, staging, stagingOffset, ibBytes);
+    if (!SubmitUpload()) return false;
 
     // Views
-    m_vbView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
-    m_vbView.StrideInBytes = sizeof(Vertex);
+    m_vbView.BufferLocation = m_vertexBuffer.GpuAddress();
+    m_vbView.StrideInBytes = static_cast<UINT>(stride);
     m_vbView.SizeInBytes = static_cast<UINT>(vbBytes);
 
-    m_ibView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
-    m_ibView.Format = DXGI_FORMAT_R32_UINT;
+    m_ibView.BufferLocation = m_indexBuffer.GpuAddress();
+    m_ibView.Format = use16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
     m_ibView.SizeInBytes = static_cast<UINT>(ibBytes);
 
-    m_indexCount = static_cast<UINT>(indices.size());
+    m_indexCount = static_cast<UINT>(indexCount);
+    m_drawRanges.swap(levelRanges[0]);
+    m_lodDrawRanges.assign(levelRanges.begin() + 1, levelRanges.end());
+    if (hasLods) m_lods.assign(lodChain.lods, lodChain.lods + lodChain.lodCount);
+    else m_lods.clear();
+    m_lodSubmeshCount = hasLods ? submeshCount : 0;
+    {
+        char msg[160];
+        sprintf_s(msg, "[DX12] Index buffer: %s, %zu draw range(s) for %zu submesh(es), %zu LOD level(s), %zu KB\n",
+            use16 ? "R16_UINT" : "R32_UINT", m_drawRanges.size(), (std::max)(submeshCount, size_t(1)), levels, ibBytes / 1024);
+        OutputDebugStringA(msg);
+    }
+    m_vertexFormat = format;
+    RecordDrawBundles();
     return true;
 }
 
+void Renderer::BeginFrame(UINT frameIndex)
+{
+    m_frameIndex = frameIndex % m_frameCount;
+    m_instanceCount = 0;
+    m_drawCount = 0;
+}
+
 void Renderer::UpdateCB(const XMFLOAT4X4& mvp)
 {
     if (!m_cbMapped) return;
-    m_cbMapped->mvp = mvp;
+    // Write-combined memory: fill the whole slice, never read it back
+    PerObjectCB& cb = m_cbMapped[m_frameIndex];
+    cb.mvp = mvp;
+    cb.posOffset = XMFLOAT4(m_quantization.offset.x, m_quantization.offset.y, m_quantization.offset.z, 0.0f);
+    cb.posScale  = XMFLOAT4(m_quantization.scale.x,  m_quantization.scale.y,  m_quantization.scale.z,  0.0f);
+}
+
+void Renderer::UpdateViewProj(const XMFLOAT4X4& viewProj)
+{
+    if (!m_cbMapped) return;
+    PerObjectCB& cb = m_cbMapped[m_frameIndex];
+    cb.viewProj = viewProj;
+    cb.posOffset = XMFLOAT4(m_quantization.offset.x, m_quantization.offset.y, m_quantization.offset.z, 0.0f);
+    cb.posScale  = XMFLOAT4(m_quantization.scale.x,  m_quantization.scale.y,  m_quantization.scale.z,  0.0f);
+}
+
+UINT Renderer::PushInstances(const InstanceData* instances, UINT count)
+{
+    if (!m_instancesMapped || !instances || count == 0) return kInvalidInstance;
+    if (count > kMaxInstancesPerFrame - m_instanceCount) {
+        char msg[128];
+        sprintf_s(msg, "[DX12] Instance buffer full: %u + %u > %u per frame\n", m_instanceCount, count, kMaxInstancesPerFrame);
+        OutputDebugStringA(msg);
+        return kInvalidInstance;
+    }
+    // One sequential copy into write-combined memory per batch
+    const UINT first = m_instanceCount;
+    memcpy(m_instancesMapped + static_cast<size_t>(m_frameIndex) * kMaxInstancesPerFrame + first, instances,
+           sizeof(InstanceData) * count);
+    m_instanceCount += count;
+    return first;
+}
+
+UINT Renderer::PushDraws(const XMFLOAT4X4* mvps, UINT count, const uint8_t* lods)
+{
+    if (!m_drawCbMapped || !mvps || count == 0) return kInvalidDraw;
+    if (count > kMaxDrawsPerFrame - m_drawCount) {
+        char msg[128];
+        sprintf_s(msg, "[DX12] Draw constants full: %u + %u > %u per frame\n", m_drawCount, count, kMaxDrawsPerFrame);
+        OutputDebugStringA(msg);
+        return kInvalidDraw;
+    }
+    const UINT first = m_drawCount;
+    const XMFLOAT4 offset(m_quantization.offset.x, m_quantization.offset.y, m_quantization.offset.z, 0.0f);
+    const XMFLOAT4 scale(m_quantization.scale.x, m_quantization.scale.y, m_quantization.scale.z, 0.0f);
+    PerObjectCB* cb = m_drawCbMapped + static_cast<size_t>(m_frameIndex) * kMaxDrawsPerFrame + first;
+    for (UINT i = 0; i < count; ++i) {
+        cb[i].mvp = mvps[i];
+        cb[i].posOffset = offset;
+        cb[i].posScale = scale;
+    }
+    const UINT maxLod = GetLodLevelCount() - 1;
+    for (UINT i = 0; i < count; ++i) m_drawLods[first + i] = lods ? static_cast<uint8_t>((std::min)(UINT(lods[i]), maxLod)) : 0;
+    m_drawCount += count;
+    return first;
 }
 
-void Renderer::RecordDraw(ID3D12GraphicsCommandList* cmdList, UINT indexCount)
+void Renderer::BindCommon(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* pso)
 {
     cmdList->SetGraphicsRootSignature(m_rootSig.Get());
-    cmdList->SetPipelineState(m_pso.Get());
+    cmdList->SetPipelineState(pso);
 
     // Root CBV (as root descriptor)
-    D3D12_GPU_VIRTUAL_ADDRESS cbAddr = m_cb->GetGPUVirtualAddress();
+    D3D12_GPU_VIRTUAL_ADDRESS cbAddr = m_cb.GpuAddress() + static_cast<UINT64>(m_frameIndex) * sizeof(PerObjectCB);
     cmdList->SetGraphicsRootConstantBufferView(0, cbAddr);
 
     // Descriptor heap for SRV and set t0 table
@@ -251,76 +618,202 @@ void Renderer::RecordDraw(ID3D12GraphicsCommandList* cmdList, UINT indexCount)
     cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     cmdList->IASetVertexBuffers(0, 1, &m_vbView);
     cmdList->IASetIndexBuffer(&m_ibView);
-
-    cmdList->DrawIndexedInstanced(indexCount, 1, 0, 0, 0);
 }
 
-bool Renderer::LoadTexture(const std::wstring& filePath)
+void Renderer::RecordDraw(ID3D12GraphicsCommandList* cmdList, UINT indexCount, UINT lod)
 {
-    // Initialize WIC
-    HRESULT hrCI = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-    // RPC_E_CHANGED_MODE can be ignored; COM already initialized with different model
+    BindCommon(cmdList, m_vertexFormat == VertexFormat::Packed16 ? m_psoPacked.Get() : m_pso.Get());
 
-    Microsoft::WRL::ComPtr<IWICImagingFactory> wic;
-    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&wic))))
-        return false;
+    // One draw per range; 16-bit ranges carry their own base vertex
+    if (lod > 0 && lod <= m_lodDrawRanges.size()) {
+        for (const IndexRange& r : m_lodDrawRanges[lod - 1])
+            cmdList->DrawIndexedInstanced(r.indexCount, 1, r.firstIndex, r.baseVertex, 0);
+        return;
+    }
+    for (const IndexRange& r : m_drawRanges) {
+        if (r.firstIndex >= indexCount) continue;
+        const UINT count = (std::min)(r.indexCount, indexCount - r.firstIndex);
+        cmdList->DrawIndexedInstanced(count, 1, r.firstIndex, r.baseVertex, 0);
+    }
+}
 
-    Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
-    if (FAILED(wic->CreateDecoderFromFilename(filePath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnLoad, &decoder)))
+// Everything a draw needs except its root CBV and the SRV table, which a
+// bundle inherits from the direct list that executes it; one bundle per LOD
+// level. Recorded when the mesh changes, which only happens at load with no
+// frame in flight.
+bool Renderer::RecordDrawBundles()
+{
+    m_drawBundles.clear();
+    ID3D12PipelineState* pso = m_vertexFormat == VertexFormat::Packed16 ? m_psoPacked.Get() : m_pso.Get();
+    if (!pso || !m_rootSig || m_drawRanges.empty()) return false;
+    if (!m_bundleAllocator &&
+        FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&m_bundleAllocator))))
         return false;
-    Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
-    if (FAILED(decoder->GetFrame(0, &frame))) return false;
+    if (FAILED(m_bundleAllocator->Reset())) return false;
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> bundles(GetLodLevelCount());
+    for (UINT lod = 0; lod < bundles.size(); ++lod) {
+        ComPtr<ID3D12GraphicsCommandList>& bundle = bundles[lod];
+        if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, m_bundleAllocator.Get(), pso, IID_PPV_ARGS(&bundle))))
+            return false;
+        bundle->SetGraphicsRootSignature(m_rootSig.Get());
+        bundle->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        bundle->IASetVertexBuffers(0, 1, &m_vbView);
+        bundle->IASetIndexBuffer(&m_ibView);
+        for (const IndexRange& r : GetDrawRanges(lod))
+            bundle->DrawIndexedInstanced(r.indexCount, 1, r.firstIndex, r.baseVertex, 0);
+        if (FAILED(bundle->Close())) return false;
+    }
+    m_drawBundles.swap(bundles);
+    return true;
+}
 
-    Microsoft::WRL::ComPtr<IWICFormatConverter> conv;
-    if (FAILED(wic->CreateFormatConverter(&conv))) return false;
-    if (FAILED(conv->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
-        return false;
+void Renderer::RecordDraws(ID3D12GraphicsCommandList* cmdList, UINT firstDraw, UINT count, bool useBundle)
+{
+    if (count == 0 || firstDraw == kInvalidDraw || firstDraw + count > m_drawCount) return;
+    const bool bundle = useBundle && !m_drawBundles.empty();
+    if (bundle) {
+        // The root signature must match the bundle's for it to inherit the table
+        cmdList->SetGraphicsRootSignature(m_rootSig.Get());
+        ID3D12DescriptorHeap* heaps[] = { m_srvHeap.Get() };
+        cmdList->SetDescriptorHeaps(1, heaps);
+        cmdList->SetGraphicsRootDescriptorTable(1, m_srvHeap->GetGPUDescriptorHandleForHeapStart());
+    } else {
+        BindCommon(cmdList, m_vertexFormat == VertexFormat::Packed16 ? m_psoPacked.Get() : m_pso.Get());
+    }
+
+    // Each draw only switches its root CBV; the rest of the state is shared
+    D3D12_GPU_VIRTUAL_ADDRESS cbAddr = m_drawCb.GpuAddress() +
+        (static_cast<UINT64>(m_frameIndex) * kMaxDrawsPerFrame + firstDraw) * sizeof(PerObjectCB);
+    for (UINT i = 0; i < count; ++i, cbAddr += sizeof(PerObjectCB)) {
+        cmdList->SetGraphicsRootConstantBufferView(0, cbAddr);
+        const UINT lod = m_drawLods[firstDraw + i];
+        if (bundle) {
+            cmdList->ExecuteBundle(m_drawBundles[lod].Get());
+            continue;
+        }
+        for (const IndexRange& r : GetDrawRanges(lod))
+            cmdList->DrawIndexedInstanced(r.indexCount, 1, r.firstIndex, r.baseVertex, 0);
+    }
+}
+
+void Renderer::RecordDrawInstanced(ID3D12GraphicsCommandList* cmdList, UINT indexCount, UINT firstInstance, UINT instanceCount)
+{
+    if (instanceCount == 0 || firstInstance == kInvalidInstance || firstInstance + instanceCount > m_instanceCount) return;
+    BindCommon(cmdList, m_vertexFormat == VertexFormat::Packed16 ? m_psoInstancedPacked.Get() : m_psoInstanced.Get());
+
+    // SV_InstanceID ignores StartInstanceLocation, so the batch offset goes
+    // into the root SRV address instead
+    const UINT64 first = static_cast<UINT64>(m_frameIndex) * kMaxInstancesPerFrame + firstInstance;
+    cmdList->SetGraphicsRootShaderResourceView(2, m_instances.GpuAddress() + first * sizeof(InstanceData));
+
+    for (const IndexRange& r : m_drawRanges) {
+        if (r.firstIndex >= indexCount) continue;
+        const UINT count = (std::min)(r.indexCount, indexCount - r.firstIndex);
+        cmdList->DrawIndexedInstanced(count, instanceCount, r.firstIndex, r.baseVertex, 0);
+    }
+}
 
-    UINT w = 0, h = 0;
-    conv->GetSize(&w, &h);
-    if (w == 0 || h == 0) return false;
-    const UINT stride = w * 4;
-    const UINT imageSize = stride * h;
-    std::vector<BYTE> pixels(imageSize);
-    if (FAILED(conv->CopyPixels(nullptr, stride, imageSize, pixels.data())))
+bool Renderer::LoadTexture(const std::wstring& filePath, MipFilter mipFilter)
+{
+    TextureData tex;
+    if (!LoadImageFile(filePath, tex) || !GenerateMips(tex, mipFilter)) {
+        char msg[512];
+        sprintf_s(msg, "[DX12] Unsupported or unreadable image: %ls\n", filePath.c_str());
+        OutputDebugStringA(msg);
         return false;
+    }
+    return LoadTexture(tex);
+}
+
+static DXGI_FORMAT ToDxgiFormat(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+    case TextureFormat::BC2: return DXGI_FORMAT_BC2_UNORM;
+    case TextureFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+    case TextureFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+    default:                 return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+bool Renderer::LoadTexture(const TextureData& tex, UINT skin)
+{
+    USU_PROFILE_ZONE("LoadTexture");
+    if (tex.mips.empty() || tex.width == 0 || tex.height == 0 || skin >= kMaxSkins) return false;
+    // Block compressed top levels must be whole blocks
+    if (IsBlockCompressed(tex.format) && ((tex.width & 3) || (tex.height & 3))) return false;
+    const DXGI_FORMAT format = ToDxgiFormat(tex.format);
 
-    // Create texture in UPLOAD heap (simplified)
     D3D12_RESOURCE_DESC texDesc{};
     texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    texDesc.Width = w;
-    texDesc.Height = h;
+    texDesc.Width = tex.width;
+    texDesc.Height = tex.height;
     texDesc.DepthOrArraySize = 1;
-    texDesc.MipLevels = 1;
-    texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    texDesc.MipLevels = static_cast<UINT16>(tex.mips.size());
+    texDesc.Format = format;
     texDesc.SampleDesc.Count = 1;
-    // For UPLOAD heap textures, layout must be ROW_MAJOR
-    texDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-    D3D12_HEAP_PROPERTIES heap{}; heap.Type = D3D12_HEAP_TYPE_UPLOAD;
-    Microsoft::WRL::ComPtr<ID3D12Resource> texture;
-    HRESULT hrTex = m_device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &texDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&texture));
-    if (FAILED(hrTex)) {
-        OutputDebugStringW(L"[DX12] CreateCommittedResource for texture failed\n");
+    texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    GpuAllocation texture;
+    if (!m_memory.CreateTexture(texDesc, D3D12_RESOURCE_STATE_COMMON, texture)) {
+        OutputDebugStringW(L"[DX12] Placed texture creation failed\n");
         return false;
     }
 
-    // Write data
-    if (FAILED(texture->WriteToSubresource(0, nullptr, pixels.data(), stride, imageSize)))
-        return false;
+    // Stage every level with the pitch/placement alignment the copy needs
+    const UINT mipCount = static_cast<UINT>(tex.mips.size());
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(mipCount);
+    std::vector<UINT> rowCounts(mipCount);
+    std::vector<UINT64> rowBytes(mipCount);
+    UINT64 totalBytes = 0;
+    m_device->GetCopyableFootprints(&texDesc, 0, mipCount, 0, layouts.data(), rowCounts.data(), rowBytes.data(), &totalBytes);
+    if (!BeginUpload()) return false;
+    ID3D12Resource* staging = nullptr;
+    uint64_t stagingOffset = 0;
+    uint8_t* p = AllocateUpload(totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging, stagingOffset);
+    if (!p) return false;
+    for (UINT level = 0; level < mipCount; ++level) {
+        const TextureMip& mip = tex.mips[level];
+        const size_t copyBytes = (std::min)(static_cast<size_t>(rowBytes[level]), static_cast<size_t>(mip.rowPitch));
+        for (UINT row = 0; row < rowCounts[level]; ++row) {
+            memcpy(p + layouts[level].Offset + static_cast<UINT64>(row) * layouts[level].Footprint.RowPitch,
+                   tex.MipData(level) + static_cast<size_t>(row) * mip.rowPitch, copyBytes);
+        }
+        D3D12_TEXTURE_COPY_LOCATION src{};
+        src.pResource = staging;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        src.PlacedFootprint = layouts[level];
+        src.PlacedFootprint.Offset += stagingOffset;
+        D3D12_TEXTURE_COPY_LOCATION dst{};
+        dst.pResource = texture.resource.Get();
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dst.SubresourceIndex = level;
+        m_copyList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+    if (!SubmitUpload()) return false;
 
-    // Create SRV
+    // Create SRV in this skin's slot, and in every slot still without a
+    // texture of its own when this is skin 0
     if (!m_srvHeap) return false;
     D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
-    srv.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srv.Format = format;
     srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
     srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srv.Texture2D.MipLevels = 1;
-    m_device->CreateShaderResourceView(texture.Get(), &srv, m_srvHeap->GetCPUDescriptorHandleForHeapStart());
+    srv.Texture2D.MipLevels = static_cast<UINT>(tex.mips.size());
+    for (UINT i = 0; i < kMaxSkins; ++i) {
+        if (i != skin && (skin != 0 || m_textures[i].Valid())) continue;
+        D3D12_CPU_DESCRIPTOR_HANDLE slot = m_srvHeap->GetCPUDescriptorHandleForHeapStart();
+        slot.ptr += static_cast<SIZE_T>(i) * m_srvDescriptorSize;
+        m_device->CreateShaderResourceView(texture.resource.Get(), &srv, slot);
+    }
+
+    // Replace the previous texture
+    m_memory.Free(m_textures[skin]);
+    m_textures[skin] = texture;
 
-    // Keep reference
-    m_texture = texture;
-    (void)hrCI; // silence unused if not needed
+    char msg[160];
+    sprintf_s(msg, "[DX12] Texture %ux%u, %zu mip(s), %s, %zu KB, skin %u\n", tex.width, tex.height, tex.mips.size(),
+        TextureFormatName(tex.format), tex.bytes.size() / 1024, skin);
+    OutputDebugStringA(msg);
     return true;
 }
@@ -6,48 +6,214 @@
 #include <vector>
 #include <string>
 #include "Mesh.h"
+#include "VertexCompression.h"
+#include "MeshIndexing.h"
+#include "Texture.h"
+#include "MipGenerator.h"
+#include "UploadRing.h"
+#include "GpuAllocator.h"
+#include "ShaderCache.h"
+#include "PipelineCache.h"
 
 #pragma comment(lib, "d3dcompiler.lib")
-#pragma comment(lib, "windowscodecs.lib")
 
 using Microsoft::WRL::ComPtr;
 
 struct alignas(256) PerObjectCB
 {
     DirectX::XMFLOAT4X4 mvp;
+    // Packed vertices only: position = posOffset + unorm16 * posScale
+    DirectX::XMFLOAT4 posOffset;
+    DirectX::XMFLOAT4 posScale;
+    // Instanced draws: clip = (position * instance world) * viewProj
+    DirectX::XMFLOAT4X4 viewProj;
+};
+
+// LOD chain uploaded with a mesh: levels x submeshes MeshLod entries,
+// level-major with level 0 the submeshes themselves (Mesh::GetLods(),
+// MeshCache::GetLods()). indexCount more indices follow the mesh's own in
+// the same array, which the ranges of levels 1.. point into.
+struct MeshLodChain
+{
+    const MeshLod* lods = nullptr;
+    size_t lodCount = 0;
+    size_t indexCount = 0;
+};
+
+// One element of the per-frame instance buffer (StructuredBuffer<InstanceData>
+// in shaders.hlsl)
+struct InstanceData
+{
+    DirectX::XMFLOAT4X4 world; // untransposed (row_major in HLSL), as TransformStore stores it
+    DirectX::XMFLOAT4 color;   // multiplies the texture sample
+    uint32_t skin;             // texture slot, see LoadTexture
+    uint32_t pad[3];
+};
+static_assert(sizeof(InstanceData) == 96, "InstanceData must match the HLSL layout");
+
+enum class VertexFormat
+{
+    Float32,  // Vertex, 32 bytes
+    Packed16, // PackedVertex, 16 bytes
 };
 
 class Renderer
 {
 public:
-    bool Initialize(ID3D12Device* device);
+    ~Renderer();
+    // Uploads go through a copy queue; graphicsQueue waits on it (GPU side)
+    // before any work submitted after an upload. frameCount is the number of
+    // frames the caller keeps in flight; per-frame data is sliced by it.
+    bool Initialize(ID3D12Device* device, ID3D12CommandQueue* graphicsQueue, UINT frameCount = 2);
     bool CreatePipeline(const wchar_t* shaderFile);
-    bool UploadMesh(const Mesh& mesh);
-    bool LoadTexture(const std::wstring& filePath); // load to t0
+    bool UploadMesh(const Mesh& mesh, VertexFormat format = VertexFormat::Float32);
+    // Raw variant so callers can upload straight from a mapped .usumesh view.
+    // Without submeshes the whole index buffer is drawn as one. A LOD chain
+    // needs submeshes; its indices follow indexCount in indices.
+    bool UploadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+                    VertexFormat format = VertexFormat::Float32,
+                    const std::vector<MeshSubmesh>& submeshes = std::vector<MeshSubmesh>(),
+                    const MeshLodChain& lodChain = MeshLodChain());
+    bool LoadTexture(const std::wstring& filePath, MipFilter mipFilter = MipFilter::Kaiser); // load to t0, full mip chain
+    // Native format (block compressed data stays compressed) and all mips.
+    // skin selects the slot instances sample (kMaxSkins of them); slots
+    // never loaded fall back to skin 0, which the non-instanced draw uses.
+    bool LoadTexture(const TextureData& texture, UINT skin = 0);
+    // Selects the per-frame slices used by UpdateCB/RecordDraw; the caller
+    // must have waited for the GPU to finish frameIndex's previous use
+    void BeginFrame(UINT frameIndex);
     void UpdateCB(const DirectX::XMFLOAT4X4& mvp);
-    void RecordDraw(ID3D12GraphicsCommandList* cmdList, UINT indexCount);
+    // Draws LOD level lod of the uploaded chain; indexCount limits LOD 0
+    void RecordDraw(ID3D12GraphicsCommandList* cmdList, UINT indexCount, UINT lod = 0);
+
+    // Instancing: PushInstances copies a batch into this frame's slice of the
+    // instance buffer (emptied by BeginFrame) and returns its first instance,
+    // or kInvalidInstance if the slice is full. RecordDrawInstanced then draws
+    // the mesh once per instance of a batch with one DrawIndexedInstanced per
+    // draw range.
+    static const UINT kMaxSkins = 8;
+    static const UINT kMaxInstancesPerFrame = 16384;
+    static const UINT kInvalidInstance = ~0u;
+    void UpdateViewProj(const DirectX::XMFLOAT4X4& viewProj);
+    UINT PushInstances(const InstanceData* instances, UINT count);
+    void RecordDrawInstanced(ID3D12GraphicsCommandList* cmdList, UINT indexCount, UINT firstInstance, UINT instanceCount);
     UINT GetIndexCount() const { return m_indexCount; }
+    // The uploaded LOD chain for SelectLod(): levels x GetLodSubmeshCount()
+    // entries, empty without a chain
+    const std::vector<MeshLod>& GetLods() const { return m_lods; }
+    size_t GetLodSubmeshCount() const { return m_lodSubmeshCount; }
+    UINT GetLodLevelCount() const { return static_cast<UINT>(m_lodDrawRanges.size()) + 1; }
+
+    // Draw lists: PushDraws writes one PerObjectCB per mvp into this frame's
+    // slice of the draw constants (emptied by BeginFrame) and returns the
+    // first, or kInvalidDraw if the slice is full; lods, if given, is the LOD
+    // level of each draw (clamped to GetLodLevelCount() - 1), otherwise all
+    // draw LOD 0. RecordDraws records draws [firstDraw, firstDraw + count)
+    // with all the state they need, so several command lists can record
+    // disjoint spans on different threads. With useBundle each draw is a root
+    // CBV plus ExecuteBundle of a bundle per LOD level that UploadMesh
+    // records once (PSO, IA and one draw per range). As many draws as
+    // instances, so a lot that fits the instanced path fits this one too
+    // (256 bytes of constants per draw).
+    static const UINT kMaxDrawsPerFrame = kMaxInstancesPerFrame;
+    static const UINT kInvalidDraw = ~0u;
+    UINT PushDraws(const DirectX::XMFLOAT4X4* mvps, UINT count, const uint8_t* lods = nullptr);
+    void RecordDraws(ID3D12GraphicsCommandList* cmdList, UINT firstDraw, UINT count, bool useBundle);
+    // Blocks until every staged copy has completed (e.g. before shutdown)
+    void WaitForUploads();
+    void LogMemoryStats() const { m_memory.LogStats(); }
 
 private:
+    void BindCommon(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* pso);
+    bool RecordDrawBundles();
+    const std::vector<IndexRange>& GetDrawRanges(UINT lod) const { return lod == 0 ? m_drawRanges : m_lodDrawRanges[lod - 1]; }
+
+    // Committed buffer; only for the staging ring and one-off oversized staging
     bool CreateBuffer(size_t byteSize, D3D12_RESOURCE_STATES initialState, D3D12_HEAP_TYPE heapType, ComPtr<ID3D12Resource>& out);
 
+    // Copy-queue uploads: BeginUpload opens a batch on m_copyList,
+    // AllocateUpload hands out staging memory (ring, or a one-off buffer when
+    // larger than the ring) and SubmitUpload executes the batch
+    bool BeginUpload();
+    uint8_t* AllocateUpload(uint64_t size, uint64_t alignment, ID3D12Resource*& buffer, uint64_t& offset);
+    bool SubmitUpload();
+    void RetireUploads();
+    void WaitForCopyFence(UINT64 value);
+
 private:
     ID3D12Device* m_device = nullptr;
     ComPtr<ID3D12RootSignature> m_rootSig;
-    ComPtr<ID3D12PipelineState> m_pso;
+    ComPtr<ID3D12PipelineState> m_pso;       // VertexFormat::Float32
+    ComPtr<ID3D12PipelineState> m_psoPacked; // VertexFormat::Packed16
+    ComPtr<ID3D12PipelineState> m_psoInstanced;
+    ComPtr<ID3D12PipelineState> m_psoInstancedPacked;
+    // Bytecode and PSOs from the previous run, next to the shader source
+    ShaderCache m_shaderCache;
+    PipelineCache m_pipelineCache;
+    VertexFormat m_vertexFormat = VertexFormat::Float32;
+    VertexQuantization m_quantization;
 
-    // Buffers (upload heap for simplicity)
-    ComPtr<ID3D12Resource> m_vertexBuffer;
-    ComPtr<ID3D12Resource> m_indexBuffer;
+    // Placed buffers and textures
+    GpuAllocator m_memory;
+
+    // Buffers (DEFAULT heap, filled by the copy queue)
+    GpuAllocation m_vertexBuffer;
+    GpuAllocation m_indexBuffer;
     D3D12_VERTEX_BUFFER_VIEW m_vbView{};
     D3D12_INDEX_BUFFER_VIEW  m_ibView{};
     UINT m_indexCount = 0;
+    std::vector<IndexRange> m_drawRanges; // at least one per submesh, base vertex with R16_UINT
+    std::vector<std::vector<IndexRange>> m_lodDrawRanges; // LOD levels 1.., laid out like m_drawRanges
+    std::vector<MeshLod> m_lods;
+    size_t m_lodSubmeshCount = 0;
 
-    // Constant buffer (upload)
-    ComPtr<ID3D12Resource> m_cb;
+    // Constant buffer (upload, mapped), one PerObjectCB per frame in flight
+    GpuAllocation m_cb;
     PerObjectCB* m_cbMapped = nullptr;
+    UINT m_frameCount = 1;
+    UINT m_frameIndex = 0;
+
+    // Instance buffer (upload, mapped), kMaxInstancesPerFrame per frame in flight
+    GpuAllocation m_instances;
+    InstanceData* m_instancesMapped = nullptr;
+    UINT m_instanceCount = 0; // pushed so far this frame
+
+    // Draw constants (upload, mapped), kMaxDrawsPerFrame per frame in flight
+    GpuAllocation m_drawCb;
+    PerObjectCB* m_drawCbMapped = nullptr;
+    UINT m_drawCount = 0; // pushed so far this frame
+    uint8_t m_drawLods[kMaxDrawsPerFrame] = {}; // this frame's, per draw
+    ComPtr<ID3D12CommandAllocator> m_bundleAllocator;
+    // Per LOD level; empty until a mesh and the PSOs exist
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_drawBundles;
+
+    // Textures (DEFAULT heap, optimal layout) and SRV heap
+    GpuAllocation m_textures[kMaxSkins];
+    ComPtr<ID3D12DescriptorHeap> m_srvHeap; // kMaxSkins descriptors, shader visible
+    UINT m_srvDescriptorSize = 0;
 
-    // Texture (simple, stored in UPLOAD for demo) and SRV heap
-    ComPtr<ID3D12Resource> m_texture;
-    ComPtr<ID3D12DescriptorHeap> m_srvHeap; // 1 descriptor, shader visible
+    // Staging: persistently mapped UPLOAD ring, retired by copy fence value
+    struct CopyAllocator
+    {
+        ComPtr<ID3D12CommandAllocator> allocator;
+        UINT64 fenceValue = 0; // reusable once the copy fence reaches it
+    };
+    struct StagingBuffer
+    {
+        ComPtr<ID3D12Resource> resource;
+        UINT64 fenceValue = 0;
+    };
+    ID3D12CommandQueue* m_graphicsQueue = nullptr;
+    ComPtr<ID3D12CommandQueue> m_copyQueue;
+    ComPtr<ID3D12GraphicsCommandList> m_copyList;
+    std::vector<CopyAllocator> m_copyAllocators;
+    size_t m_currentCopyAllocator = 0;
+    bool m_copyListOpen = false;
+    ComPtr<ID3D12Fence> m_copyFence;
+    UINT64 m_copyFenceValue = 0;
+    HANDLE m_copyEvent = nullptr;
+    ComPtr<ID3D12Resource> m_uploadBuffer;
+    uint8_t* m_uploadMapped = nullptr;
+    UploadRing m_uploadRing;
+    std::vector<StagingBuffer> m_oversizedStaging; // released when their batch completes
 };
@@ -0,0 +1,158 @@
+#include "ShaderCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+bool IsBlank(char c) { return c == ' ' || c == '\t'; }
+
+// Appends the names of the #include lines in text; comments are not parsed,
+// so a commented-out include only costs a spurious dependency
+void FindIncludes(const char* text, size_t size, std::vector<std::string>& names)
+{
+    const char* end = text + size;
+    for (const char* p = text; p < end; ) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        const char* c = p;
+        while (c < lineEnd && IsBlank(*c)) ++c;
+        if (c < lineEnd && *c == '#') {
+            ++c;
+            while (c < lineEnd && IsBlank(*c)) ++c;
+            if (lineEnd - c > 7 && memcmp(c, "include", 7) == 0) {
+                c += 7;
+                while (c < lineEnd && IsBlank(*c)) ++c;
+                if (c < lineEnd && (*c == '"' || *c == '<')) {
+                    const char close = *c == '"' ? '"' : '>';
+                    const char* name = ++c;
+                    while (c < lineEnd && *c != close) ++c;
+                    if (c < lineEnd) names.emplace_back(name, c);
+                }
+            }
+        }
+        p = lineEnd + 1;
+    }
+}
+
+// Each file once, so include guards and cycles cost nothing
+bool HashSourceTree(const std::filesystem::path& path, uint64_t& hash, std::vector<std::filesystem::path>& visited)
+{
+    const std::filesystem::path normal = path.lexically_normal();
+    if (std::find(visited.begin(), visited.end(), normal) != visited.end()) return true;
+    visited.push_back(normal);
+    MappedFile file;
+    if (!file.Open(normal.wstring())) return false;
+    const uint64_t size = file.Size();
+    hash = HashBytes64(&size, sizeof(size), hash);
+    hash = HashBytes64(file.Data(), file.Size(), hash);
+
+    std::vector<std::string> includes;
+    FindIncludes(reinterpret_cast<const char*>(file.Data()), file.Size(), includes);
+    for (const std::string& name : includes) {
+        if (!HashSourceTree(normal.parent_path() / std::filesystem::u8path(name), hash, visited)) {
+            static const char kMissing[] = "missing include";
+            hash = HashBytes64(kMissing, sizeof(kMissing), hash);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ShaderCache::Initialize(const std::wstring& directory, ShaderCompileFunction compile, uint64_t compilerVersion)
+{
+    m_directory = directory;
+    m_compile = std::move(compile);
+    m_compilerVersion = compilerVersion;
+    m_hits = m_compiles = 0;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(directory), ec);
+    return !ec;
+}
+
+bool ShaderCache::ComputeKey(const std::wstring& sourcePath, const char* entry, const char* profile, uint32_t flags,
+                             uint64_t& key) const
+{
+    std::vector<std::filesystem::path> visited;
+    uint64_t hash = HashBytes64(&m_compilerVersion, sizeof(m_compilerVersion), kShaderCacheVersion);
+    if (!HashSourceTree(std::filesystem::path(sourcePath), hash, visited)) return false;
+    // Terminators included so "a" + "bc" and "ab" + "c" differ
+    hash = HashBytes64(entry, strlen(entry) + 1, hash);
+    hash = HashBytes64(profile, strlen(profile) + 1, hash);
+    key = HashBytes64(&flags, sizeof(flags), hash);
+    return true;
+}
+
+std::wstring ShaderCache::PathFor(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".usushader", key);
+    return (std::filesystem::path(m_directory) / name).wstring();
+}
+
+bool ShaderCache::Get(const std::wstring& sourcePath, const char* entry, const char* profile, uint32_t flags,
+                      std::vector<uint8_t>& bytecode)
+{
+    uint64_t key = 0;
+    const bool keyed = ComputeKey(sourcePath, entry, profile, flags, key);
+    if (keyed && Read(PathFor(key), key, bytecode)) {
+        ++m_hits;
+        return true;
+    }
+    if (!m_compile || !m_compile(sourcePath, entry, profile, flags, bytecode)) return false;
+    ++m_compiles;
+    // Best effort: a failed write only means compiling again next time
+    if (keyed) Write(PathFor(key), key, bytecode);
+    return true;
+}
+
+bool ShaderCache::Write(const std::wstring& path, uint64_t key, const std::vector<uint8_t>& bytecode)
+{
+    if (bytecode.empty()) return false;
+    ShaderCacheHeader header{};
+    header.magic = kShaderCacheMagic;
+    header.version = kShaderCacheVersion;
+    header.key = key;
+    header.bytecodeHash = HashBytes64(bytecode.data(), bytecode.size());
+    header.bytecodeSize = bytecode.size();
+
+    // Write to a temporary and rename so a crash never leaves a torn cache
+    const std::filesystem::path finalPath(path);
+    std::filesystem::path tmpPath = finalPath;
+    tmpPath += L".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, finalPath, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool ShaderCache::Read(const std::wstring& path, uint64_t key, std::vector<uint8_t>& bytecode)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.Size() < sizeof(ShaderCacheHeader)) return false;
+    const auto* header = reinterpret_cast<const ShaderCacheHeader*>(file.Data());
+    if (header->magic != kShaderCacheMagic || header->version != kShaderCacheVersion || header->key != key ||
+        header->bytecodeSize == 0 || header->bytecodeSize != file.Size() - sizeof(ShaderCacheHeader))
+        return false;
+    const uint8_t* data = file.Data() + sizeof(ShaderCacheHeader);
+    if (HashBytes64(data, static_cast<size_t>(header->bytecodeSize)) != header->bytecodeHash) return false;
+    bytecode.assign(data, data + header->bytecodeSize);
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// On-disk layout of a .usushader file (little endian): the header, then the
+// bytecode. One file per key, named after it, in the cache directory.
+static const uint32_t kShaderCacheMagic = 0x53555355; // "USUS"
+static const uint32_t kShaderCacheVersion = 1;
+
+struct ShaderCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t bytecodeHash; // HashBytes64 of the bytecode, catches torn files
+    uint64_t bytecodeSize;
+};
+static_assert(sizeof(ShaderCacheHeader) == 32, "ShaderCacheHeader layout changed");
+
+// Compiles entry of sourcePath for profile; false (after logging) on errors
+typedef std::function<bool(const std::wstring& sourcePath, const char* entry, const char* profile, uint32_t flags,
+                           std::vector<uint8_t>& bytecode)> ShaderCompileFunction;
+
+// Compiled bytecode keyed by everything the compiler sees: the source, every
+// file it #includes (recursively, resolved next to the including file, as
+// D3D_COMPILE_STANDARD_FILE_INCLUDE does), entry point, profile, flags and
+// the compiler version. Independent of D3D: the compiler is a callback.
+// Files for old keys are never pruned; deleting the directory is safe.
+class ShaderCache
+{
+public:
+    // directory is created if needed; compilerVersion goes into every key
+    bool Initialize(const std::wstring& directory, ShaderCompileFunction compile, uint64_t compilerVersion);
+
+    // false if sourcePath cannot be read; a missing include is hashed as
+    // missing and left for the compiler to report
+    bool ComputeKey(const std::wstring& sourcePath, const char* entry, const char* profile, uint32_t flags, uint64_t& key) const;
+    // <directory>\<key as 16 hex digits>.usushader
+    std::wstring PathFor(uint64_t key) const;
+
+    // Cached bytecode if a file for the key exists and is intact, otherwise
+    // compiles and stores the result
+    bool Get(const std::wstring& sourcePath, const char* entry, const char* profile, uint32_t flags, std::vector<uint8_t>& bytecode);
+
+    static bool Write(const std::wstring& path, uint64_t key, const std::vector<uint8_t>& bytecode);
+    static bool Read(const std::wstring& path, uint64_t key, std::vector<uint8_t>& bytecode);
+
+    uint32_t GetHits() const { return m_hits; }
+    uint32_t GetCompiles() const { return m_compiles; }
+
+private:
+    std::wstring m_directory;
+    ShaderCompileFunction m_compile;
+    uint64_t m_compilerVersion = 0;
+    uint32_t m_hits = 0;
+    uint32_t m_compiles = 0;
+};
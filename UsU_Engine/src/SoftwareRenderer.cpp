@@ -0,0 +1,504 @@
+#include "SoftwareRenderer.h"
+#include "BlockCompression.h"
+#include "ImageWriter.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USU_SR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const int kTileSize = 64; // even, so 2x2 quads never straddle tiles
+const int kSubpixelBits = 8;
+const float kSubpixels = 1 << kSubpixelBits;
+const float kGuardBand = 2.0f; // in NDC units, for targets up to kMaxSize
+const uint32_t kMaxSize = 8192;
+
+// Four lanes, one per pixel of a 2x2 quad: (x, y), (x+1, y), (x, y+1),
+// (x+1, y+1). Comparisons return a 4-bit lane mask.
+#if defined(USU_SR_SSE2)
+struct F4 { __m128 v; };
+inline F4 Splat(float a) { return { _mm_set1_ps(a) }; }
+inline F4 Set(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+inline F4 operator+(F4 a, F4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline F4 operator*(F4 a, F4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline F4 operator/(F4 a, F4 b) { return { _mm_div_ps(a.v, b.v) }; }
+inline int Gt(F4 a, F4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a.v, b.v)); }
+inline int Ge(F4 a, F4 b) { return _mm_movemask_ps(_mm_cmpge_ps(a.v, b.v)); }
+inline int Lt(F4 a, F4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+inline F4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void Store(float* p, F4 a) { _mm_storeu_ps(p, a.v); }
+#else
+struct F4 { float v[4]; };
+inline F4 Splat(float a) { return { { a, a, a, a } }; }
+inline F4 Set(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+inline F4 operator+(F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline F4 operator*(F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+inline F4 operator/(F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+inline int Gt(F4 a, F4 b) { int m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] > b.v[i]) << i; return m; }
+inline int Ge(F4 a, F4 b) { int m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] >= b.v[i]) << i; return m; }
+inline int Lt(F4 a, F4 b) { int m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] < b.v[i]) << i; return m; }
+inline F4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+inline void Store(float* p, F4 a) { memcpy(p, a.v, sizeof(a.v)); }
+#endif
+
+inline F4 Eval(const float plane[3], F4 x, F4 y)
+{
+    return Splat(plane[0]) * x + Splat(plane[1]) * y + Splat(plane[2]);
+}
+
+} // namespace
+
+// Runs fn(part) for part in [0, count) as jobs on the shared pool; per-part
+// state (bins) is indexed by part, not by the thread that happens to run it
+template <typename Fn>
+static void RunOnThreads(unsigned count, Fn&& fn)
+{
+    GetJobSystem().ParallelFor(count, 1, [&fn](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) fn(t);
+    });
+}
+
+static uint32_t PackColor(float r, float g, float b, float a)
+{
+    const auto c = [](float v) { return static_cast<uint32_t>(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return c(r) | (c(g) << 8) | (c(b) << 16) | (c(a) << 24);
+}
+
+// a + (b - a) * f / 256 on all four 8-bit channels, two at a time
+static uint32_t Lerp8(uint32_t a, uint32_t b, uint32_t f)
+{
+    const uint32_t rb = (((a & 0x00FF00FFu) * (256 - f) + (b & 0x00FF00FFu) * f) >> 8) & 0x00FF00FFu;
+    const uint32_t ga = (((a >> 8) & 0x00FF00FFu) * (256 - f) + ((b >> 8) & 0x00FF00FFu) * f) & 0xFF00FF00u;
+    return rb | ga;
+}
+
+bool SoftwareRenderer::Initialize(uint32_t width, uint32_t height, uint32_t threadCount)
+{
+    if (width == 0 || height == 0 || width > kMaxSize || height > kMaxSize) return false;
+    m_width = width;
+    m_height = height;
+    m_threads = threadCount ? threadCount : GetJobSystem().GetThreadCount();
+    m_tilesX = (width + kTileSize - 1) / kTileSize;
+    m_tilesY = (height + kTileSize - 1) / kTileSize;
+    AllocateTexture(m_color, TextureFormat::RGBA8, width, height);
+    m_depth.assign(static_cast<size_t>(width) * height, 1.0f);
+    m_bins.clear();
+    m_binCount = 0;
+    // Identity until the first UpdateCB
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j) m_mvp[i][j] = i == j ? 1.0f : 0.0f;
+    return true;
+}
+
+bool SoftwareRenderer::UploadMesh(const Mesh& mesh)
+{
+    return UploadMesh(mesh.GetVertices().data(), mesh.GetVertices().size(), mesh.GetIndices().data(), mesh.GetIndices().size());
+}
+
+bool SoftwareRenderer::UploadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+    if (!vertices || !indices || vertexCount == 0 || indexCount < 3) return false;
+    for (size_t i = 0; i < indexCount; ++i) {
+        if (indices[i] >= vertexCount) return false;
+    }
+    m_vertices.assign(vertices, vertices + vertexCount);
+    m_indices.assign(indices, indices + indexCount);
+    return true;
+}
+
+bool SoftwareRenderer::LoadTexture(const TextureData& texture)
+{
+    if (texture.mips.empty()) return false;
+    std::vector<Level> levels(texture.mips.size());
+    for (size_t i = 0; i < texture.mips.size(); ++i) {
+        const TextureMip& mip = texture.mips[i];
+        Level& level = levels[i];
+        level.width = mip.width;
+        level.height = mip.height;
+        level.texels.resize(static_cast<size_t>(mip.width) * mip.height);
+        uint8_t* dst = reinterpret_cast<uint8_t*>(level.texels.data());
+        if (texture.format == TextureFormat::RGBA8) {
+            for (uint32_t y = 0; y < mip.height; ++y)
+                memcpy(dst + static_cast<size_t>(y) * mip.width * 4, texture.MipData(i) + static_cast<size_t>(y) * mip.rowPitch, mip.width * 4);
+        } else if (!DecompressTextureLevel(texture, i, dst, mip.width * 4)) {
+            return false;
+        }
+    }
+    m_levels.swap(levels);
+    return true;
+}
+
+void SoftwareRenderer::UpdateCB(const DirectX::XMFLOAT4X4& mvp)
+{
+    memcpy(m_mvp, mvp.m, sizeof(m_mvp));
+}
+
+void SoftwareRenderer::Clear(float r, float g, float b, float a)
+{
+    const uint32_t c = PackColor(r, g, b, a);
+    uint32_t* px = reinterpret_cast<uint32_t*>(m_color.bytes.data());
+    std::fill(px, px + static_cast<size_t>(m_width) * m_height, c);
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+}
+
+bool SoftwareRenderer::WriteImage(const std::wstring& path) const
+{
+    TextureData opaque = m_color;
+    for (size_t i = 3; i < opaque.bytes.size(); i += 4) opaque.bytes[i] = 255;
+    return WriteImageFile(path, opaque);
+}
+
+// Rounds to the subpixel grid. Only vertices inside the guard band are
+// rasterized; the clamp just keeps the conversion defined for the others.
+static int32_t Snap(float v)
+{
+    v = std::min(std::max(v * kSubpixels, -4194304.0f), 4194304.0f);
+    return static_cast<int32_t>(v < 0.0f ? v - 0.5f : v + 0.5f);
+}
+
+// Bits 0-5 fail the view volume (x, y, near, far); bits 6-9 fail the guard
+// band, beyond which snapped coordinates would no longer be exact in a float
+static int Outcode(const float* p)
+{
+    const float x = p[0], y = p[1], z = p[2], w = p[3];
+    const float g = kGuardBand * w;
+    return (x < -w) | ((x > w) << 1) | ((y < -w) << 2) | ((y > w) << 3) | ((z < 0.0f) << 4) | ((z > w) << 5) |
+           ((x < -g) << 6) | ((x > g) << 7) | ((y < -g) << 8) | ((y > g) << 9);
+}
+
+SoftwareRenderer::ScreenVertex SoftwareRenderer::Project(const ClipVertex& c) const
+{
+    ScreenVertex s;
+    s.outcode = Outcode(&c.x);
+    if (!(c.w > 0.0f)) {
+        s.x = s.y = 0;
+        s.z = s.invW = s.uOverW = s.vOverW = 0.0f;
+        return s;
+    }
+    const float iw = 1.0f / c.w;
+    // Snapped to 8 subpixel bits like D3D; inside the guard band these are
+    // exact in a float, and so are the edge coefficients in SetupTriangle
+    s.x = Snap((c.x * iw * 0.5f + 0.5f) * m_width);
+    s.y = Snap((0.5f - c.y * iw * 0.5f) * m_height);
+    s.z = c.z * iw;
+    s.invW = iw;
+    s.uOverW = c.u * iw;
+    s.vOverW = c.v * iw;
+    return s;
+}
+
+void SoftwareRenderer::BinTriangle(uint32_t i0, uint32_t i1, uint32_t i2, Bin& bin)
+{
+    const ScreenVertex& a = m_screen[i0];
+    const ScreenVertex& b = m_screen[i1];
+    const ScreenVertex& c = m_screen[i2];
+    if (a.outcode & b.outcode & c.outcode & 0x3F) return; // entirely outside one plane
+    const int crossed = (a.outcode | b.outcode | c.outcode) & 0x3F0;
+    if (!crossed) {
+        SetupTriangle(a, b, c, bin);
+        return;
+    }
+
+    // Crosses near/far (DepthClipEnable) or the guard band: Sutherland-Hodgman
+    // against those planes only, then fan the polygon
+    const auto distance = [](const ClipVertex& p, int plane) {
+        const float g = kGuardBand * p.w;
+        switch (plane) {
+        case 4: return p.z;
+        case 5: return p.w - p.z;
+        case 6: return g + p.x;
+        case 7: return g - p.x;
+        case 8: return g + p.y;
+        default: return g - p.y;
+        }
+    };
+    ClipVertex poly[2][10]; // each plane adds at most one vertex
+    poly[0][0] = m_clip[i0];
+    poly[0][1] = m_clip[i1];
+    poly[0][2] = m_clip[i2];
+    int n = 3, src = 0;
+    for (int plane = 4; plane < 10 && n >= 3; ++plane) {
+        if (!((crossed >> plane) & 1)) continue;
+        const ClipVertex* in = poly[src];
+        ClipVertex* out = poly[src ^ 1];
+        int count = 0;
+        for (int i = 0; i < n; ++i) {
+            const ClipVertex& p = in[i];
+            const ClipVertex& q = in[(i + 1) % n];
+            const float dp = distance(p, plane), dq = distance(q, plane);
+            if (dp >= 0.0f) out[count++] = p;
+            if ((dp >= 0.0f) != (dq >= 0.0f)) {
+                const float t = dp / (dp - dq);
+                ClipVertex& v = out[count++];
+                v.x = p.x + (q.x - p.x) * t;
+                v.y = p.y + (q.y - p.y) * t;
+                v.z = p.z + (q.z - p.z) * t;
+                v.w = p.w + (q.w - p.w) * t;
+                v.u = p.u + (q.u - p.u) * t;
+                v.v = p.v + (q.v - p.v) * t;
+            }
+        }
+        n = count;
+        src ^= 1;
+    }
+    if (n < 3) return;
+    ScreenVertex projected[10];
+    for (int i = 0; i < n; ++i) projected[i] = Project(poly[src][i]);
+    for (int i = 1; i + 1 < n; ++i) SetupTriangle(projected[0], projected[i], projected[i + 1], bin);
+}
+
+void SoftwareRenderer::SetupTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, Bin& bin)
+{
+    const ScreenVertex* v[3] = { &a, &b, &c };
+    if (!(a.invW > 0.0f && b.invW > 0.0f && c.invW > 0.0f)) return;
+    const int32_t sx[3] = { a.x, b.x, c.x };
+    const int32_t sy[3] = { a.y, b.y, c.y };
+    float x[3], y[3], z[3], iw[3], uw[3], vw[3];
+    for (int i = 0; i < 3; ++i) {
+        x[i] = sx[i] * (1.0f / kSubpixels);
+        y[i] = sy[i] * (1.0f / kSubpixels);
+        z[i] = v[i]->z;
+        iw[i] = v[i]->invW;
+        uw[i] = v[i]->uOverW;
+        vw[i] = v[i]->vOverW;
+    }
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.0f) return;
+
+    // Pixel i is covered when its center i + 0.5 is inside: ceil(min - 0.5)
+    // to floor(max - 0.5), in subpixels (the shifts round toward -infinity)
+    const int32_t half = 1 << (kSubpixelBits - 1);
+    Triangle t;
+    t.minX = std::max(0, (std::min({ sx[0], sx[1], sx[2] }) - half + (1 << kSubpixelBits) - 1) >> kSubpixelBits);
+    t.maxX = std::min(static_cast<int>(m_width) - 1, (std::max({ sx[0], sx[1], sx[2] }) - half) >> kSubpixelBits);
+    t.minY = std::max(0, (std::min({ sy[0], sy[1], sy[2] }) - half + (1 << kSubpixelBits) - 1) >> kSubpixelBits);
+    t.maxY = std::min(static_cast<int>(m_height) - 1, (std::max({ sy[0], sy[1], sy[2] }) - half) >> kSubpixelBits);
+    if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+    // Edge k runs between the other two vertices. The constant term is
+    // exact in a double; a shared edge gets exactly negated coefficients in
+    // the neighbouring triangle, so with the top-left rule every pixel on it
+    // is owned by exactly one of the two.
+    for (int k = 0; k < 3; ++k) {
+        const int i = (k + 1) % 3, j = (k + 2) % 3;
+        t.edge[k][0] = y[i] - y[j];
+        t.edge[k][1] = x[j] - x[i];
+        t.edgeC[k] = static_cast<double>(x[i]) * y[j] - static_cast<double>(x[j]) * y[i];
+    }
+    // No culling: orient both windings so the inside is positive
+    const bool flip = area < 0.0f; // area is edge 0 evaluated at vertex 0
+    t.topLeft = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (flip) {
+            t.edge[k][0] = -t.edge[k][0];
+            t.edge[k][1] = -t.edge[k][1];
+            t.edgeC[k] = -t.edgeC[k];
+        }
+        if (t.edge[k][0] > 0.0f || (t.edge[k][0] == 0.0f && t.edge[k][1] > 0.0f)) t.topLeft |= 1 << k;
+    }
+
+    // Attribute planes, linear in screen space: z, 1/w, u/w, v/w
+    const float dx1 = x[1] - x[0], dx2 = x[2] - x[0], dy1 = y[1] - y[0], dy2 = y[2] - y[0];
+    const float invArea = 1.0f / area;
+    const auto plane = [&](const float f[3], float out[3]) {
+        const float df1 = f[1] - f[0], df2 = f[2] - f[0];
+        out[0] = (df1 * dy2 - df2 * dy1) * invArea;
+        out[1] = (df2 * dx1 - df1 * dx2) * invArea;
+        out[2] = f[0] - out[0] * x[0] - out[1] * y[0];
+    };
+    plane(z, t.z);
+    plane(iw, t.invW);
+    plane(uw, t.uOverW);
+    plane(vw, t.vOverW);
+
+    const uint32_t index = static_cast<uint32_t>(bin.triangles.size());
+    bin.triangles.push_back(t);
+    for (int ty = t.minY / kTileSize; ty <= t.maxY / kTileSize; ++ty)
+        for (int tx = t.minX / kTileSize; tx <= t.maxX / kTileSize; ++tx)
+            bin.tiles[static_cast<size_t>(ty) * m_tilesX + tx].push_back(index);
+}
+
+uint32_t SoftwareRenderer::Sample(float u, float v, size_t levelIndex) const
+{
+    if (m_levels.empty()) return 0xFFFFFFFFu;
+    const Level& level = m_levels[levelIndex];
+    // Wrap addressing; bilinear between texel centers
+    u -= std::floor(u);
+    v -= std::floor(v);
+    const float fx = u * level.width - 0.5f, fy = v * level.height - 0.5f;
+    const float flx = std::floor(fx), fly = std::floor(fy);
+    int x0 = static_cast<int>(flx), y0 = static_cast<int>(fly);
+    const uint32_t wx = std::min(256u, static_cast<uint32_t>((fx - flx) * 256.0f + 0.5f));
+    const uint32_t wy = std::min(256u, static_cast<uint32_t>((fy - fly) * 256.0f + 0.5f));
+    const int w = static_cast<int>(level.width), h = static_cast<int>(level.height);
+    if (x0 < 0) x0 += w;
+    if (y0 < 0) y0 += h;
+    x0 = std::min(x0, w - 1);
+    y0 = std::min(y0, h - 1);
+    const int x1 = x0 + 1 < w ? x0 + 1 : 0;
+    const int y1 = y0 + 1 < h ? y0 + 1 : 0;
+    const uint32_t* row0 = level.texels.data() + static_cast<size_t>(y0) * w;
+    const uint32_t* row1 = level.texels.data() + static_cast<size_t>(y1) * w;
+    return Lerp8(Lerp8(row0[x0], row0[x1], wx), Lerp8(row1[x0], row1[x1], wx), wy);
+}
+
+void SoftwareRenderer::RasterTriangle(const Triangle& t, int tileX0, int tileY0, int tileX1, int tileY1)
+{
+    const int xs = std::max(t.minX, tileX0) & ~1, ys = std::max(t.minY, tileY0) & ~1;
+    const int xe = std::min(t.maxX, tileX1 - 1), ye = std::min(t.maxY, tileY1 - 1);
+    const F4 laneX = Set(0.5f, 1.5f, 0.5f, 1.5f), laneY = Set(0.5f, 0.5f, 1.5f, 1.5f);
+    const F4 zero = Splat(0.0f), one = Splat(1.0f);
+    const float texW = m_levels.empty() ? 1.0f : static_cast<float>(m_levels[0].width);
+    const float texH = m_levels.empty() ? 1.0f : static_cast<float>(m_levels[0].height);
+    const int maxLevel = m_levels.empty() ? 0 : static_cast<int>(m_levels.size()) - 1;
+    uint32_t* color = reinterpret_cast<uint32_t*>(m_color.bytes.data());
+
+    // Edges relative to the tile origin: the same tile gives neighbours
+    // exactly negated values, and small coordinates keep float error far
+    // below the subpixel grid
+    float edge[3][3];
+    for (int k = 0; k < 3; ++k) {
+        edge[k][0] = t.edge[k][0];
+        edge[k][1] = t.edge[k][1];
+        edge[k][2] = static_cast<float>(t.edgeC[k] + static_cast<double>(t.edge[k][0]) * tileX0 + static_cast<double>(t.edge[k][1]) * tileY0);
+    }
+
+    for (int qy = ys; qy <= ye; qy += 2) {
+        const F4 py = Splat(static_cast<float>(qy)) + laneY;
+        const F4 ly = Splat(static_cast<float>(qy - tileY0)) + laneY;
+        int rowMask = 0xF;
+        if (qy + 1 >= static_cast<int>(m_height)) rowMask &= 0x3;
+        for (int qx = xs; qx <= xe; qx += 2) {
+            const F4 lx = Splat(static_cast<float>(qx - tileX0)) + laneX;
+            int mask = rowMask;
+            if (qx + 1 >= static_cast<int>(m_width)) mask &= 0x5;
+            for (int k = 0; k < 3 && mask; ++k) {
+                const F4 e = Eval(edge[k], lx, ly);
+                mask &= (t.topLeft >> k) & 1 ? Ge(e, zero) : Gt(e, zero);
+            }
+            if (!mask) continue;
+
+            const F4 px = Splat(static_cast<float>(qx)) + laneX;
+            const size_t base = static_cast<size_t>(qy) * m_width + qx;
+            const size_t offsets[4] = { base, base + 1, base + m_width, base + m_width + 1 };
+            float depth[4];
+            Store(depth, Eval(t.z, px, py));
+            if (m_depthTest) {
+                float stored[4];
+                for (int l = 0; l < 4; ++l) stored[l] = (mask >> l) & 1 ? m_depth[offsets[l]] : 0.0f;
+                mask &= Lt(Load(depth), Load(stored));
+                if (!mask) continue;
+            }
+
+            // Perspective-correct uv; helper lanes outside the triangle still
+            // feed the derivatives, as on the GPU
+            const F4 w = one / Eval(t.invW, px, py);
+            float u[4], v[4];
+            Store(u, Eval(t.uOverW, px, py) * w);
+            Store(v, Eval(t.vOverW, px, py) * w);
+            size_t level = 0;
+            if (maxLevel > 0) {
+                const float dudx = (u[1] - u[0]) * texW, dvdx = (v[1] - v[0]) * texH;
+                const float dudy = (u[2] - u[0]) * texW, dvdy = (v[2] - v[0]) * texH;
+                const float rho2 = std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+                if (rho2 > 1.0f) level = static_cast<size_t>(std::min(maxLevel, static_cast<int>(0.5f * std::log2(rho2) + 0.5f)));
+            }
+
+            for (int l = 0; l < 4; ++l) {
+                if (!((mask >> l) & 1)) continue;
+                color[offsets[l]] = Sample(u[l], v[l], level);
+                if (m_depthTest) m_depth[offsets[l]] = depth[l];
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::RasterTile(uint32_t tile)
+{
+    const int x0 = static_cast<int>(tile % m_tilesX) * kTileSize;
+    const int y0 = static_cast<int>(tile / m_tilesX) * kTileSize;
+    const int x1 = std::min(x0 + kTileSize, static_cast<int>(m_width));
+    const int y1 = std::min(y0 + kTileSize, static_cast<int>(m_height));
+    // Bins in thread order, each in submission order: the draw order of
+    // the index buffer is preserved within every tile
+    for (size_t b = 0; b < m_binCount; ++b) {
+        const Bin& bin = m_bins[b];
+        for (uint32_t index : bin.tiles[tile]) RasterTriangle(bin.triangles[index], x0, y0, x1, y1);
+    }
+}
+
+void SoftwareRenderer::RecordDraw(uint32_t indexCount)
+{
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Ms;
+    m_stats = SoftwareDrawStats();
+    if (m_width == 0 || m_vertices.empty()) return;
+    const size_t triangleCount = std::min<size_t>(indexCount, m_indices.size()) / 3;
+    m_stats.triangles = static_cast<uint32_t>(triangleCount);
+    if (triangleCount == 0) return;
+
+    // VSMain: clip = float4(position, 1) * MVP, uv passed through
+    const auto t0 = Clock::now();
+    const size_t vertexCount = m_vertices.size();
+    m_clip.resize(vertexCount);
+    m_screen.resize(vertexCount);
+    const unsigned vertexThreads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(m_threads, vertexCount / 16384)));
+    RunOnThreads(vertexThreads, [&](unsigned t) {
+        const F4 c0 = Set(m_mvp[0][0], m_mvp[1][0], m_mvp[2][0], m_mvp[3][0]);
+        const F4 c1 = Set(m_mvp[0][1], m_mvp[1][1], m_mvp[2][1], m_mvp[3][1]);
+        const F4 c2 = Set(m_mvp[0][2], m_mvp[1][2], m_mvp[2][2], m_mvp[3][2]);
+        const F4 c3 = Set(m_mvp[0][3], m_mvp[1][3], m_mvp[2][3], m_mvp[3][3]);
+        const size_t end = vertexCount * (t + 1) / vertexThreads;
+        for (size_t i = vertexCount * t / vertexThreads; i < end; ++i) {
+            const Vertex& in = m_vertices[i];
+            float clip[4];
+            Store(clip, Splat(in.position.x) * c0 + Splat(in.position.y) * c1 + Splat(in.position.z) * c2 + c3);
+            ClipVertex& out = m_clip[i];
+            out.x = clip[0];
+            out.y = clip[1];
+            out.z = clip[2];
+            out.w = clip[3];
+            out.u = in.uv.x;
+            out.v = in.uv.y;
+            m_screen[i] = Project(out);
+        }
+    });
+
+    // Clip, set up and bin contiguous triangle ranges, one bin per thread
+    const auto t1 = Clock::now();
+    const size_t tileCount = static_cast<size_t>(m_tilesX) * m_tilesY;
+    m_binCount = std::max<size_t>(1, std::min<size_t>(m_threads, triangleCount / 2048));
+    if (m_bins.size() < m_binCount) m_bins.resize(m_binCount);
+    RunOnThreads(static_cast<unsigned>(m_binCount), [&](unsigned t) {
+        Bin& bin = m_bins[t];
+        bin.triangles.clear();
+        bin.tiles.resize(tileCount);
+        for (auto& list : bin.tiles) list.clear();
+        const size_t end = triangleCount * (t + 1) / m_binCount;
+        for (size_t i = triangleCount * t / m_binCount; i < end; ++i) {
+            const uint32_t* idx = m_indices.data() + i * 3;
+            BinTriangle(idx[0], idx[1], idx[2], bin);
+        }
+    });
+    for (size_t b = 0; b < m_binCount; ++b) m_stats.binned += static_cast<uint32_t>(m_bins[b].triangles.size());
+
+    // Rasterize + PSMain, tiles handed out dynamically since their cost varies
+    const auto t2 = Clock::now();
+    std::atomic<uint32_t> nextTile(0);
+    RunOnThreads(static_cast<unsigned>(std::min<size_t>(m_threads, tileCount)), [&](unsigned) {
+        for (uint32_t tile = nextTile++; tile < tileCount; tile = nextTile++) RasterTile(tile);
+    });
+    const auto t3 = Clock::now();
+
+    m_stats.vertexMs = Ms(t1 - t0).count();
+    m_stats.binMs = Ms(t2 - t1).count();
+    m_stats.rasterMs = Ms(t3 - t2).count();
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+#include "Mesh.h"
+#include "Texture.h"
+
+struct SoftwareDrawStats
+{
+    double   vertexMs = 0.0;  // VSMain over the vertex buffer
+    double   binMs = 0.0;     // clipping, triangle setup and tile binning
+    double   rasterMs = 0.0;  // coverage + PSMain per tile
+    uint32_t triangles = 0;   // submitted
+    uint32_t binned = 0;      // survived culling/clipping (after clipping splits)
+};
+
+// CPU backend with the same operations as Renderer (upload mesh, load
+// texture, update CB, record draw) for machines without a GPU. Runs VSMain /
+// PSMain from shaders.hlsl in C++ into an RGBA8 framebuffer with the
+// pipeline's state: no culling, no depth buffer, bilinear wrap sampling (from
+// the nearest mip rather than trilinear). Triangles are binned into 64x64
+// tiles and tiles rasterized in parallel as 2x2 quads, four lanes at a time
+// (SSE2 where available). No D3D or Win32 dependency.
+class SoftwareRenderer
+{
+public:
+    // threadCount 0 uses every core
+    bool Initialize(uint32_t width, uint32_t height, uint32_t threadCount = 0); // up to 8192x8192
+    bool UploadMesh(const Mesh& mesh);
+    bool UploadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+    // Every level; block compressed data is decoded to RGBA8
+    bool LoadTexture(const TextureData& texture);
+    // Same (transposed) matrix as PerObjectCB::mvp
+    void UpdateCB(const DirectX::XMFLOAT4X4& mvp);
+    // Off by default to match the D3D pipeline, where draw order wins
+    void SetDepthTest(bool enable) { m_depthTest = enable; }
+    void Clear(float r, float g, float b, float a);
+    // Draws immediately; indexCount like Renderer::RecordDraw
+    void RecordDraw(uint32_t indexCount);
+    uint32_t GetIndexCount() const { return static_cast<uint32_t>(m_indices.size()); }
+
+    const TextureData& GetFramebuffer() const { return m_color; }
+    const SoftwareDrawStats& GetLastDrawStats() const { return m_stats; }
+    // PNG or BMP by extension; alpha is written opaque, as presented
+    bool WriteImage(const std::wstring& path) const;
+
+private:
+    struct ClipVertex
+    {
+        float x, y, z, w;
+        float u, v;
+    };
+
+    // Projected and snapped to subpixels, with its clip outcode
+    struct ScreenVertex
+    {
+        int32_t x, y;
+        float z, invW, uOverW, vOverW;
+        int outcode;
+    };
+
+    // Screen-space setup. Planes are a*x + b*y + c at pixel centers; edges
+    // are oriented so inside is positive, topLeft marks edges that also own
+    // their zero (fill convention). Edge constants are kept in double and
+    // rebased to each tile's origin before rasterizing in float.
+    struct Triangle
+    {
+        float  edge[3][2];
+        double edgeC[3];
+        float z[3];
+        float invW[3];
+        float uOverW[3];
+        float vOverW[3];
+        int   topLeft;
+        int   minX, minY, maxX, maxY; // inclusive pixel bounds, on target
+    };
+
+    // Triangles set up by one thread, in submission order, plus their tile lists
+    struct Bin
+    {
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<uint32_t>> tiles;
+    };
+
+    struct Level
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint32_t> texels;
+    };
+
+    ScreenVertex Project(const ClipVertex& v) const;
+    void SetupTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, Bin& bin);
+    void BinTriangle(uint32_t i0, uint32_t i1, uint32_t i2, Bin& bin);
+    void RasterTile(uint32_t tile);
+    void RasterTriangle(const Triangle& tri, int x0, int y0, int x1, int y1);
+    uint32_t Sample(float u, float v, size_t level) const;
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_threads = 1;
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+    TextureData m_color;      // RGBA8, one level
+    std::vector<float> m_depth;
+    bool m_depthTest = false;
+
+    std::vector<Vertex>   m_vertices;
+    std::vector<uint32_t> m_indices;
+    std::vector<Level>    m_levels;
+    float m_mvp[4][4] = {};
+
+    // Per-draw scratch, kept to avoid reallocating every frame
+    std::vector<ClipVertex> m_clip;
+    std::vector<ScreenVertex> m_screen;
+    std::vector<Bin> m_bins;
+    size_t m_binCount = 0;
+    SoftwareDrawStats m_stats;
+};
@@ -0,0 +1,57 @@
+#include "Texture.h"
+#include <algorithm>
+
+const char* TextureFormatName(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::RGBA8: return "RGBA8";
+    case TextureFormat::BC1:   return "BC1";
+    case TextureFormat::BC2:   return "BC2";
+    case TextureFormat::BC3:   return "BC3";
+    case TextureFormat::BC7:   return "BC7";
+    }
+    return "?";
+}
+
+bool IsBlockCompressed(TextureFormat format)
+{
+    return format != TextureFormat::RGBA8;
+}
+
+uint32_t TextureRowPitch(TextureFormat format, uint32_t width)
+{
+    if (!IsBlockCompressed(format)) return width * 4;
+    const uint32_t blockBytes = (format == TextureFormat::BC1) ? 8 : 16;
+    return std::max(1u, (width + 3) / 4) * blockBytes;
+}
+
+size_t TextureMipSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    const size_t rows = IsBlockCompressed(format) ? std::max(1u, (height + 3) / 4) : height;
+    return rows * TextureRowPitch(format, width);
+}
+
+void AllocateTexture(TextureData& tex, TextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    tex.format = format;
+    tex.width = width;
+    tex.height = height;
+    tex.mips.clear();
+
+    size_t offset = 0;
+    uint32_t w = width, h = height;
+    for (uint32_t level = 0; level < std::max(mipCount, 1u); ++level) {
+        TextureMip mip;
+        mip.width = w;
+        mip.height = h;
+        mip.rowPitch = TextureRowPitch(format, w);
+        mip.offset = offset;
+        mip.size = TextureMipSize(format, w, h);
+        offset += mip.size;
+        tex.mips.push_back(mip);
+        if (w == 1 && h == 1) break;
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+    }
+    tex.bytes.assign(offset, 0);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU-side texture in the layout the GPU will sample, independent of D3D so
+// readers and encoders can be built and tested anywhere.
+enum class TextureFormat
+{
+    RGBA8, // R8G8B8A8_UNORM
+    BC1,   // DXT1, 8 bytes per 4x4 block
+    BC2,   // DXT3, 16 bytes per 4x4 block
+    BC3,   // DXT5, 16 bytes per 4x4 block
+    BC7,   // 16 bytes per 4x4 block
+};
+
+struct TextureMip
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t rowPitch = 0; // bytes per row of pixels, or of 4x4 blocks
+    size_t   offset = 0;   // into TextureData::bytes
+    size_t   size = 0;
+};
+
+struct TextureData
+{
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<TextureMip> mips; // level 0 first, tightly packed in bytes
+    std::vector<uint8_t> bytes;
+
+    const uint8_t* MipData(size_t level) const { return bytes.data() + mips[level].offset; }
+    uint8_t*       MipData(size_t level)       { return bytes.data() + mips[level].offset; }
+};
+
+const char* TextureFormatName(TextureFormat format);
+bool     IsBlockCompressed(TextureFormat format);
+uint32_t TextureRowPitch(TextureFormat format, uint32_t width);
+size_t   TextureMipSize(TextureFormat format, uint32_t width, uint32_t height);
+
+// Lays out mipCount levels (clamped to the full chain) and sizes bytes.
+void AllocateTexture(TextureData& tex, TextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount = 1);
@@ -0,0 +1,113 @@
+#include "TextureCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <system_error>
+
+// Bytes of a mipCount-level chain as AllocateTexture lays it out, in 64-bit
+// math that fails instead of wrapping. Also fails for more levels than the
+// full chain has.
+static bool ChainSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount, uint64_t& size)
+{
+    const bool bc = IsBlockCompressed(format);
+    const uint64_t unitBytes = !bc ? 4 : (format == TextureFormat::BC1 ? 8 : 16);
+    uint64_t w = width, h = height;
+    size = 0;
+    for (uint32_t level = 0; level < mipCount; ++level) {
+        const uint64_t cols = bc ? std::max<uint64_t>(1, (w + 3) / 4) : w;
+        const uint64_t rows = bc ? std::max<uint64_t>(1, (h + 3) / 4) : h;
+        const uint64_t maxBytes = std::numeric_limits<uint64_t>::max() - size;
+        if (cols > maxBytes / unitBytes / rows) return false;
+        size += cols * rows * unitBytes;
+        if (w == 1 && h == 1 && level + 1 < mipCount) return false;
+        w = std::max<uint64_t>(1, w / 2);
+        h = std::max<uint64_t>(1, h / 2);
+    }
+    return true;
+}
+
+std::wstring TextureCache::PathFor(const std::wstring& sourcePath)
+{
+    const size_t slash = sourcePath.find_last_of(L"/\\");
+    const size_t dot = sourcePath.find_last_of(L'.');
+    if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash))
+        return sourcePath + L".usutex";
+    return sourcePath.substr(0, dot) + L".usutex";
+}
+
+bool TextureCache::HashSources(const std::wstring& colorPath, const std::wstring& alphaPath, uint64_t& hash)
+{
+    MappedFile file;
+    if (!file.Open(colorPath)) return false;
+    hash = HashBytes64(file.Data(), file.Size());
+    if (!alphaPath.empty()) {
+        if (!file.Open(alphaPath)) return false;
+        hash = HashBytes64(file.Data(), file.Size(), hash);
+    }
+    return true;
+}
+
+bool TextureCache::Write(const std::wstring& cachePath, uint64_t sourceHash, uint64_t settingsHash, const TextureData& tex)
+{
+    if (tex.mips.empty() || tex.bytes.empty()) return false;
+
+    TextureCacheHeader header{};
+    header.magic = kTextureCacheMagic;
+    header.version = kTextureCacheVersion;
+    header.sourceHash = sourceHash;
+    header.settingsHash = settingsHash;
+    header.format = static_cast<uint32_t>(tex.format);
+    header.width = tex.width;
+    header.height = tex.height;
+    header.mipCount = static_cast<uint32_t>(tex.mips.size());
+    header.dataOffset = kTextureCacheAlignment;
+    header.dataSize = tex.bytes.size();
+
+    // Write to a temporary and rename so a crash never leaves a torn cache
+    const std::filesystem::path finalPath(cachePath);
+    std::filesystem::path tmpPath = finalPath;
+    tmpPath += L".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        static const char zeros[kTextureCacheAlignment] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(zeros, static_cast<std::streamsize>(header.dataOffset - sizeof(header)));
+        out.write(reinterpret_cast<const char*>(tex.bytes.data()), static_cast<std::streamsize>(tex.bytes.size()));
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, finalPath, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TextureCache::Read(const std::wstring& cachePath, uint64_t sourceHash, uint64_t settingsHash, TextureData& tex)
+{
+    MappedFile file;
+    if (!file.Open(cachePath) || file.Size() < sizeof(TextureCacheHeader)) return false;
+    const auto* header = reinterpret_cast<const TextureCacheHeader*>(file.Data());
+    if (header->magic != kTextureCacheMagic || header->version != kTextureCacheVersion ||
+        header->sourceHash != sourceHash || header->settingsHash != settingsHash ||
+        header->format > static_cast<uint32_t>(TextureFormat::BC7) || header->width == 0 || header->height == 0 ||
+        header->mipCount == 0 || header->dataOffset > file.Size() || header->dataSize > file.Size() - header->dataOffset)
+        return false;
+
+    // Check the header describes exactly the stored bytes before allocating
+    const TextureFormat format = static_cast<TextureFormat>(header->format);
+    uint64_t chainSize = 0;
+    if (!ChainSize(format, header->width, header->height, header->mipCount, chainSize) || chainSize != header->dataSize)
+        return false;
+
+    AllocateTexture(tex, format, header->width, header->height, header->mipCount);
+    if (tex.mips.size() != header->mipCount || tex.bytes.size() != header->dataSize) return false;
+    memcpy(tex.bytes.data(), file.Data() + header->dataOffset, tex.bytes.size());
+    return true;
+}
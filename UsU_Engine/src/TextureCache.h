@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Texture.h"
+
+// On-disk layout of a .usutex file (little endian): the header, then every
+// level tightly packed as in TextureData::bytes, starting on a
+// kTextureCacheAlignment boundary. Holds the GPU-ready (block compressed)
+// result of decoding, mip generation and encoding a source image.
+static const uint32_t kTextureCacheMagic = 0x54555355; // "USUT"
+static const uint32_t kTextureCacheVersion = 1;
+static const uint32_t kTextureCacheAlignment = 64;
+
+struct TextureCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;   // HashBytes64 of the source image(s)
+    uint64_t settingsHash; // whatever else the contents depend on (filters, encoder)
+    uint32_t format;       // TextureFormat
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+static_assert(sizeof(TextureCacheHeader) == 56, "TextureCacheHeader layout changed");
+
+class TextureCache
+{
+public:
+    // <dir>\<name>.bmp -> <dir>\<name>.usutex
+    static std::wstring PathFor(const std::wstring& sourcePath);
+
+    // Content hash of a color image and its optional separate alpha plane.
+    static bool HashSources(const std::wstring& colorPath, const std::wstring& alphaPath, uint64_t& hash);
+
+    static bool Write(const std::wstring& cachePath, uint64_t sourceHash, uint64_t settingsHash, const TextureData& tex);
+
+    // Loads cachePath into tex if it was written for the same hashes.
+    static bool Read(const std::wstring& cachePath, uint64_t sourceHash, uint64_t settingsHash, TextureData& tex);
+};
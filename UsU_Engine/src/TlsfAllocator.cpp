@@ -0,0 +1,316 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+
+static int Log2(uint64_t v)
+{
+    int r = 0;
+    while (v >>= 1) ++r;
+    return r;
+}
+
+static int LowestBit(uint64_t v)
+{
+    int r = 0;
+    while (!(v & 1)) { v >>= 1; ++r; }
+    return r;
+}
+
+static uint64_t AlignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+// Sizes below kSlCount map one class per unit; above, each power of two is
+// split into kSlCount linear classes
+void TlsfAllocator::Mapping(uint64_t units, int& fl, int& sl)
+{
+    if (units < static_cast<uint64_t>(kSlCount)) {
+        fl = 0;
+        sl = static_cast<int>(units);
+        return;
+    }
+    const int log = Log2(units);
+    fl = log - kSlBits + 1;
+    sl = static_cast<int>((units >> (log - kSlBits)) - kSlCount);
+}
+
+void TlsfAllocator::Reset(uint64_t capacity, uint64_t granularity)
+{
+    m_granularity = std::max<uint64_t>(granularity, 1);
+    m_capacity = capacity / m_granularity;
+    m_blocks.clear();
+    m_unusedBlocks.clear();
+    m_allocated.clear();
+    m_flBitmap = 0;
+    for (int fl = 0; fl < kFlCount; ++fl) {
+        m_slBitmap[fl] = 0;
+        for (int sl = 0; sl < kSlCount; ++sl) m_heads[fl][sl] = kNone;
+    }
+    if (m_capacity == 0) return;
+    const uint32_t b = NewBlock();
+    m_blocks[b].offset = 0;
+    m_blocks[b].size = m_capacity;
+    InsertFree(b);
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+    if (!m_unusedBlocks.empty()) {
+        const uint32_t b = m_unusedBlocks.back();
+        m_unusedBlocks.pop_back();
+        m_blocks[b] = Block();
+        return b;
+    }
+    m_blocks.push_back(Block());
+    return static_cast<uint32_t>(m_blocks.size() - 1);
+}
+
+void TlsfAllocator::InsertFree(uint32_t b)
+{
+    Block& block = m_blocks[b];
+    int fl, sl;
+    Mapping(block.size, fl, sl);
+    block.free = true;
+    block.prevFree = kNone;
+    block.nextFree = m_heads[fl][sl];
+    if (block.nextFree != kNone) m_blocks[block.nextFree].prevFree = b;
+    m_heads[fl][sl] = b;
+    m_slBitmap[fl] |= 1u << sl;
+    m_flBitmap |= 1ull << fl;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t b)
+{
+    Block& block = m_blocks[b];
+    int fl, sl;
+    Mapping(block.size, fl, sl);
+    if (block.prevFree != kNone) m_blocks[block.prevFree].nextFree = block.nextFree;
+    else m_heads[fl][sl] = block.nextFree;
+    if (block.nextFree != kNone) m_blocks[block.nextFree].prevFree = block.prevFree;
+    if (m_heads[fl][sl] == kNone) {
+        m_slBitmap[fl] &= ~(1u << sl);
+        if (!m_slBitmap[fl]) m_flBitmap &= ~(1ull << fl);
+    }
+    block.free = false;
+    block.prevFree = block.nextFree = kNone;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t units, uint64_t alignment) const
+{
+    // Good fit: round up to the next class so any block found is big enough
+    const uint64_t need = units + alignment - 1;
+    uint64_t rounded = need;
+    if (need >= static_cast<uint64_t>(kSlCount)) rounded += (1ull << (Log2(need) - kSlBits)) - 1;
+    int fl, sl;
+    Mapping(rounded, fl, sl);
+    if (fl < kFlCount) {
+        uint32_t slMap = m_slBitmap[fl] & (~0u << sl);
+        if (!slMap && fl + 1 < kFlCount) {
+            const uint64_t flMap = m_flBitmap & (~0ull << (fl + 1));
+            if (flMap) {
+                fl = LowestBit(flMap);
+                slMap = m_slBitmap[fl];
+            }
+        }
+        if (slMap) return m_heads[fl][LowestBit(slMap)];
+    }
+
+    // Nothing in the larger classes: the exact class may still hold a fit
+    Mapping(units, fl, sl);
+    for (uint32_t b = m_heads[fl][sl]; b != kNone; b = m_blocks[b].nextFree) {
+        const Block& block = m_blocks[b];
+        if (AlignUp(block.offset, alignment) + units <= block.offset + block.size) return b;
+    }
+    return kNone;
+}
+
+// Takes units (aligned) out of free block b, returning the leftovers on
+// either side to the free lists
+uint64_t TlsfAllocator::Carve(uint32_t b, uint64_t units, uint64_t alignment)
+{
+    RemoveFree(b);
+    const uint64_t aligned = AlignUp(m_blocks[b].offset, alignment);
+    if (aligned > m_blocks[b].offset) {
+        const uint32_t front = NewBlock();
+        Block& f = m_blocks[front];
+        Block& block = m_blocks[b];
+        f.offset = block.offset;
+        f.size = aligned - block.offset;
+        f.prevPhys = block.prevPhys;
+        f.nextPhys = b;
+        if (f.prevPhys != kNone) m_blocks[f.prevPhys].nextPhys = front;
+        block.prevPhys = front;
+        block.offset = aligned;
+        block.size -= f.size;
+        InsertFree(front);
+    }
+    if (m_blocks[b].size > units) {
+        const uint32_t back = NewBlock();
+        Block& k = m_blocks[back];
+        Block& block = m_blocks[b];
+        k.offset = block.offset + units;
+        k.size = block.size - units;
+        k.prevPhys = b;
+        k.nextPhys = block.nextPhys;
+        if (k.nextPhys != kNone) m_blocks[k.nextPhys].prevPhys = back;
+        block.nextPhys = back;
+        block.size = units;
+        InsertFree(back);
+    }
+    m_blocks[b].alignment = alignment;
+    m_allocated[aligned] = b;
+    return aligned;
+}
+
+uint64_t TlsfAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) return kInvalidOffset;
+    const uint64_t units = (size + m_granularity - 1) / m_granularity;
+    const uint64_t alignUnits = alignment > m_granularity ? alignment / m_granularity : 1;
+    if (units > m_capacity) return kInvalidOffset;
+    const uint32_t b = FindFree(units, alignUnits);
+    if (b == kNone) return kInvalidOffset;
+    return Carve(b, units, alignUnits) * m_granularity;
+}
+
+bool TlsfAllocator::Free(uint64_t offset)
+{
+    if (offset % m_granularity) return false;
+    const auto it = m_allocated.find(offset / m_granularity);
+    if (it == m_allocated.end()) return false;
+    uint32_t b = it->second;
+    m_allocated.erase(it);
+
+    // Coalesce with free physical neighbours
+    const uint32_t prev = m_blocks[b].prevPhys;
+    if (prev != kNone && m_blocks[prev].free) {
+        RemoveFree(prev);
+        Block& p = m_blocks[prev];
+        p.size += m_blocks[b].size;
+        p.nextPhys = m_blocks[b].nextPhys;
+        if (p.nextPhys != kNone) m_blocks[p.nextPhys].prevPhys = prev;
+        m_unusedBlocks.push_back(b);
+        b = prev;
+    }
+    const uint32_t next = m_blocks[b].nextPhys;
+    if (next != kNone && m_blocks[next].free) {
+        RemoveFree(next);
+        Block& block = m_blocks[b];
+        block.size += m_blocks[next].size;
+        block.nextPhys = m_blocks[next].nextPhys;
+        if (block.nextPhys != kNone) m_blocks[block.nextPhys].prevPhys = b;
+        m_unusedBlocks.push_back(next);
+    }
+    m_blocks[b].alignment = 1;
+    InsertFree(b);
+    return true;
+}
+
+uint64_t TlsfAllocator::SizeOf(uint64_t offset) const
+{
+    if (offset % m_granularity) return 0;
+    const auto it = m_allocated.find(offset / m_granularity);
+    return it == m_allocated.end() ? 0 : m_blocks[it->second].size * m_granularity;
+}
+
+TlsfAllocator::Stats TlsfAllocator::GetStats() const
+{
+    Stats s;
+    s.capacity = m_capacity * m_granularity;
+    s.allocationCount = static_cast<uint32_t>(m_allocated.size());
+    for (int fl = 0; fl < kFlCount; ++fl) {
+        for (int sl = 0; sl < kSlCount; ++sl) {
+            for (uint32_t b = m_heads[fl][sl]; b != kNone; b = m_blocks[b].nextFree) {
+                s.freeBytes += m_blocks[b].size * m_granularity;
+                s.largestFreeBlock = std::max(s.largestFreeBlock, m_blocks[b].size * m_granularity);
+                s.freeBlockCount++;
+            }
+        }
+    }
+    s.usedBytes = s.capacity - s.freeBytes;
+    return s;
+}
+
+size_t TlsfAllocator::PlanDefragment(size_t maxMoves, std::vector<Move>& moves)
+{
+    std::vector<uint64_t> offsets;
+    offsets.reserve(m_allocated.size());
+    for (const auto& kv : m_allocated) offsets.push_back(kv.first);
+    std::sort(offsets.begin(), offsets.end(), [](uint64_t a, uint64_t b) { return a > b; });
+
+    // Lowest-address first fit below each allocation, so repeated passes
+    // pack everything towards offset 0. The block at offset 0 is always
+    // block 0: it is created by Reset and never merged into a predecessor.
+    size_t added = 0;
+    for (uint64_t offset : offsets) {
+        if (added >= maxMoves) break;
+        const Block& src = m_blocks[m_allocated[offset]];
+        const uint64_t units = src.size, alignment = src.alignment;
+        for (uint32_t b = 0; b != kNone && m_blocks[b].offset < offset; b = m_blocks[b].nextPhys) {
+            const Block& cand = m_blocks[b];
+            if (!cand.free) continue;
+            const uint64_t aligned = AlignUp(cand.offset, alignment);
+            if (aligned + units > cand.offset + cand.size || aligned + units > offset) continue;
+            Move move;
+            move.from = offset * m_granularity;
+            move.to = Carve(b, units, alignment) * m_granularity;
+            move.size = units * m_granularity;
+            moves.push_back(move);
+            ++added;
+            break;
+        }
+    }
+    return added;
+}
+
+bool TlsfAllocator::Validate() const
+{
+    // Physical chain: contiguous, covers the range, no adjacent free blocks
+    std::vector<bool> unused(m_blocks.size(), false);
+    for (uint32_t b : m_unusedBlocks) unused[b] = true;
+    uint32_t first = kNone;
+    size_t live = 0;
+    for (uint32_t i = 0; i < m_blocks.size(); ++i) {
+        if (unused[i]) continue;
+        ++live;
+        if (m_blocks[i].prevPhys == kNone) {
+            if (first != kNone) return false;
+            first = i;
+        }
+    }
+    if (m_capacity == 0) return live == 0;
+    if (first == kNone || m_blocks[first].offset != 0) return false;
+    uint64_t end = 0;
+    size_t chained = 0, freeCount = 0, usedCount = 0;
+    for (uint32_t b = first; b != kNone; b = m_blocks[b].nextPhys) {
+        const Block& block = m_blocks[b];
+        if (block.offset != end || block.size == 0) return false;
+        if (block.nextPhys != kNone && m_blocks[block.nextPhys].prevPhys != b) return false;
+        if (block.free && block.nextPhys != kNone && m_blocks[block.nextPhys].free) return false;
+        if (block.free) {
+            ++freeCount;
+        } else {
+            ++usedCount;
+            const auto it = m_allocated.find(block.offset);
+            if (it == m_allocated.end() || it->second != b || block.offset % block.alignment) return false;
+        }
+        end += block.size;
+        if (++chained > live) return false;
+    }
+    if (end != m_capacity || chained != live || usedCount != m_allocated.size()) return false;
+
+    // Free lists: right class, bitmaps in sync, every free block listed once
+    size_t listed = 0;
+    for (int fl = 0; fl < kFlCount; ++fl) {
+        if (((m_flBitmap >> fl) & 1) != (m_slBitmap[fl] != 0)) return false;
+        for (int sl = 0; sl < kSlCount; ++sl) {
+            if (((m_slBitmap[fl] >> sl) & 1) != (m_heads[fl][sl] != kNone)) return false;
+            uint32_t prev = kNone;
+            for (uint32_t b = m_heads[fl][sl]; b != kNone; b = m_blocks[b].nextFree) {
+                int bfl, bsl;
+                Mapping(m_blocks[b].size, bfl, bsl);
+                if (!m_blocks[b].free || bfl != fl || bsl != sl || m_blocks[b].prevFree != prev) return false;
+                prev = b;
+                if (++listed > freeCount) return false;
+            }
+        }
+    }
+    return listed == freeCount;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Two-level segregated fit allocator over an abstract range [0, capacity):
+// O(1) allocate/free with immediate coalescing. It only does offset
+// bookkeeping; GPU heaps, placed resources and buffer pages sit on top (see
+// GpuAllocator), which keeps the policy testable and fuzzable on its own.
+// Sizes and offsets are kept in units of granularity; alignments up to the
+// granularity are free, larger ones must be multiples of it.
+class TlsfAllocator
+{
+public:
+    static const uint64_t kInvalidOffset = ~0ull;
+
+    struct Stats
+    {
+        uint64_t capacity = 0;
+        uint64_t usedBytes = 0;
+        uint64_t freeBytes = 0;
+        uint64_t largestFreeBlock = 0;
+        uint32_t allocationCount = 0;
+        uint32_t freeBlockCount = 0;
+    };
+
+    // Planned relocation: the range at 'to' is already reserved; the caller
+    // copies the data and then frees 'from'.
+    struct Move
+    {
+        uint64_t from;
+        uint64_t to;
+        uint64_t size;
+    };
+
+    explicit TlsfAllocator(uint64_t capacity = 0, uint64_t granularity = 1) { Reset(capacity, granularity); }
+
+    // Drops every allocation; granularity must be a power of two.
+    void Reset(uint64_t capacity, uint64_t granularity = 1);
+
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+    bool     Free(uint64_t offset); // false if offset is not an allocation
+    uint64_t SizeOf(uint64_t offset) const; // 0 if offset is not an allocation
+
+    Stats    GetStats() const;
+    uint64_t Capacity() const { return m_capacity * m_granularity; }
+    uint64_t Granularity() const { return m_granularity; }
+    bool     Empty() const { return m_allocated.empty(); }
+
+    // Defragmentation hook: for up to maxMoves allocations, highest first,
+    // reserves the lowest free range below them that fits and appends the
+    // move. Returns the number of moves added.
+    size_t PlanDefragment(size_t maxMoves, std::vector<Move>& moves);
+
+    // Checks every internal invariant (for fuzzing).
+    bool Validate() const;
+
+private:
+    static const int kSlBits = 4;
+    static const int kSlCount = 1 << kSlBits;
+    static const int kFlCount = 64;
+    static const uint32_t kNone = ~0u;
+
+    struct Block
+    {
+        uint64_t offset = 0; // units
+        uint64_t size = 0;   // units
+        uint64_t alignment = 1;
+        uint32_t prevPhys = kNone;
+        uint32_t nextPhys = kNone;
+        uint32_t prevFree = kNone;
+        uint32_t nextFree = kNone;
+        bool     free = false;
+    };
+
+    static void Mapping(uint64_t units, int& fl, int& sl);
+    uint32_t NewBlock();
+    void     InsertFree(uint32_t b);
+    void     RemoveFree(uint32_t b);
+    uint32_t FindFree(uint64_t units, uint64_t alignment) const;
+    uint64_t Carve(uint32_t b, uint64_t units, uint64_t alignment);
+
+    uint64_t m_capacity = 0; // units
+    uint64_t m_granularity = 1;
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_unusedBlocks;
+    uint64_t m_flBitmap = 0;
+    uint32_t m_slBitmap[kFlCount] = {};
+    uint32_t m_heads[kFlCount][kSlCount];
+    std::unordered_map<uint64_t, uint32_t> m_allocated; // offset (units) -> block
+};
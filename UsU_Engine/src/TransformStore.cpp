@@ -0,0 +1,229 @@
+#include "TransformStore.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USU_TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace DirectX;
+
+namespace {
+
+const size_t kMinBatchesPerThread = 1024; // 4096 objects; below that threads cost more than they save
+
+#if defined(USU_TRANSFORM_SSE2)
+struct V4 { __m128 v; };
+inline V4 Splat(float a) { return { _mm_set1_ps(a) }; }
+inline V4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void Store(float* p, V4 a) { _mm_storeu_ps(p, a.v); }
+inline V4 operator+(V4 a, V4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline V4 operator-(V4 a, V4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline V4 operator*(V4 a, V4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+template <int i> inline V4 Lane(V4 a) { return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(i, i, i, i)) }; }
+inline void Transpose(V4& a, V4& b, V4& c, V4& d) { _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v); }
+// Lane k = a[ids[k]]: one component of four objects
+inline V4 Gather(const float* a, const uint32_t* ids) { return { _mm_setr_ps(a[ids[0]], a[ids[1]], a[ids[2]], a[ids[3]]) }; }
+#else
+struct V4 { float v[4]; };
+inline V4 Splat(float a) { return { { a, a, a, a } }; }
+inline V4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+inline void Store(float* p, V4 a) { memcpy(p, a.v, sizeof(a.v)); }
+inline V4 operator+(V4 a, V4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline V4 operator-(V4 a, V4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+inline V4 operator*(V4 a, V4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+template <int i> inline V4 Lane(V4 a) { return Splat(a.v[i]); }
+inline void Transpose(V4& a, V4& b, V4& c, V4& d)
+{
+    V4* rows[4] = { &a, &b, &c, &d };
+    for (int r = 0; r < 4; ++r)
+        for (int c2 = r + 1; c2 < 4; ++c2) std::swap(rows[r]->v[c2], rows[c2]->v[r]);
+}
+inline V4 Gather(const float* a, const uint32_t* ids) { return { { a[ids[0]], a[ids[1]], a[ids[2]], a[ids[3]] } }; }
+#endif
+
+// row * m, m given as its four rows
+inline V4 MulRow(V4 row, const V4 m[4])
+{
+    return Lane<0>(row) * m[0] + Lane<1>(row) * m[1] + Lane<2>(row) * m[2] + Lane<3>(row) * m[3];
+}
+
+} // namespace
+
+// Runs fn(begin, end) over [0, batches) split into contiguous ranges on the
+// shared job pool; threadCount > 0 caps how many ranges there are
+template <typename Fn>
+static void ParallelBatches(size_t batches, uint32_t threadCount, Fn&& fn)
+{
+    size_t grain = kMinBatchesPerThread;
+    if (threadCount > 0) grain = std::max(grain, (batches + threadCount - 1) / threadCount);
+    GetJobSystem().ParallelFor(static_cast<uint32_t>(batches), static_cast<uint32_t>(std::min(grain, std::max<size_t>(batches, 1))), fn);
+}
+
+uint32_t TransformStore::Create(uint32_t parent)
+{
+    const uint32_t id = static_cast<uint32_t>(m_parent.size());
+    if (parent != kNoParent && parent >= id) parent = kNoParent;
+    m_px.push_back(0.0f); m_py.push_back(0.0f); m_pz.push_back(0.0f);
+    m_qx.push_back(0.0f); m_qy.push_back(0.0f); m_qz.push_back(0.0f); m_qw.push_back(1.0f);
+    m_sx.push_back(1.0f); m_sy.push_back(1.0f); m_sz.push_back(1.0f);
+    m_parent.push_back(parent);
+    m_dirty.push_back(1);
+    m_changed.push_back(0);
+    XMFLOAT4X4 identity = {};
+    identity.m[0][0] = identity.m[1][1] = identity.m[2][2] = identity.m[3][3] = 1.0f;
+    m_world.push_back(identity);
+    m_mvp.push_back(identity);
+
+    // Depth = parent's + 1; ids only grow, so every level stays sorted
+    size_t depth = 0;
+    for (uint32_t p = parent; p != kNoParent; p = m_parent[p]) ++depth;
+    if (m_levels.size() <= depth) m_levels.resize(depth + 1);
+    m_levels[depth].push_back(id);
+    return id;
+}
+
+void TransformStore::Reserve(size_t count)
+{
+    for (auto* v : { &m_px, &m_py, &m_pz, &m_qx, &m_qy, &m_qz, &m_qw, &m_sx, &m_sy, &m_sz }) v->reserve(count);
+    m_parent.reserve(count);
+    m_dirty.reserve(count);
+    m_changed.reserve(count);
+    m_world.reserve(count);
+    m_mvp.reserve(count);
+}
+
+void TransformStore::Clear()
+{
+    for (auto* v : { &m_px, &m_py, &m_pz, &m_qx, &m_qy, &m_qz, &m_qw, &m_sx, &m_sy, &m_sz }) v->clear();
+    m_parent.clear();
+    m_levels.clear();
+    m_dirty.clear();
+    m_changed.clear();
+    m_world.clear();
+    m_mvp.clear();
+    m_viewProjValid = false;
+}
+
+void TransformStore::SetPosition(uint32_t id, const XMFLOAT3& position)
+{
+    m_px[id] = position.x;
+    m_py[id] = position.y;
+    m_pz[id] = position.z;
+    m_dirty[id] = 1;
+}
+
+void TransformStore::SetRotation(uint32_t id, const XMFLOAT4& quaternion)
+{
+    m_qx[id] = quaternion.x;
+    m_qy[id] = quaternion.y;
+    m_qz[id] = quaternion.z;
+    m_qw[id] = quaternion.w;
+    m_dirty[id] = 1;
+}
+
+void TransformStore::SetScale(uint32_t id, const XMFLOAT3& scale)
+{
+    m_sx[id] = scale.x;
+    m_sy[id] = scale.y;
+    m_sz[id] = scale.z;
+    m_dirty[id] = 1;
+}
+
+// ids holds count entries padded to a multiple of four by repeating the last
+// one; the duplicates just store the same result twice
+void TransformStore::UpdateWorlds(const uint32_t* ids, size_t count, bool roots)
+{
+    ParallelBatches((count + 3) / 4, m_threads, [&](size_t b0, size_t b1) {
+        for (size_t b = b0; b < b1; ++b) {
+            const uint32_t* id = ids + b * 4;
+            // S * R(q) * T for four objects at once, one matrix element per vector
+            const V4 qx = Gather(m_qx.data(), id), qy = Gather(m_qy.data(), id);
+            const V4 qz = Gather(m_qz.data(), id), qw = Gather(m_qw.data(), id);
+            const V4 two = Splat(2.0f), one = Splat(1.0f);
+            const V4 xx = qx * qx, yy = qy * qy, zz = qz * qz;
+            const V4 xy = qx * qy, xz = qx * qz, yz = qy * qz;
+            const V4 wx = qw * qx, wy = qw * qy, wz = qw * qz;
+            const V4 sx = Gather(m_sx.data(), id), sy = Gather(m_sy.data(), id), sz = Gather(m_sz.data(), id);
+            V4 m[4][4] = {
+                { sx * (one - two * (yy + zz)), sx * two * (xy + wz), sx * two * (xz - wy), Splat(0.0f) },
+                { sy * two * (xy - wz), sy * (one - two * (xx + zz)), sy * two * (yz + wx), Splat(0.0f) },
+                { sz * two * (xz + wy), sz * two * (yz - wx), sz * (one - two * (xx + yy)), Splat(0.0f) },
+                { Gather(m_px.data(), id), Gather(m_py.data(), id), Gather(m_pz.data(), id), one },
+            };
+            // After transposing, m[r][k] is row r of object k
+            for (int r = 0; r < 4; ++r) Transpose(m[r][0], m[r][1], m[r][2], m[r][3]);
+
+            for (int k = 0; k < 4; ++k) {
+                float* world = &m_world[id[k]].m[0][0];
+                if (roots) {
+                    for (int r = 0; r < 4; ++r) Store(world + r * 4, m[r][k]);
+                } else {
+                    const float* p = &m_world[m_parent[id[k]]].m[0][0];
+                    const V4 parent[4] = { Load(p), Load(p + 4), Load(p + 8), Load(p + 12) };
+                    for (int r = 0; r < 4; ++r) Store(world + r * 4, MulRow(m[r][k], parent));
+                }
+                m_dirty[id[k]] = 0;
+                m_changed[id[k]] = 1;
+            }
+        }
+    });
+}
+
+void TransformStore::UpdateMvps(const uint32_t* ids, size_t count)
+{
+    const float* vp = &m_viewProj.m[0][0];
+    const V4 viewProj[4] = { Load(vp), Load(vp + 4), Load(vp + 8), Load(vp + 12) };
+    ParallelBatches((count + 3) / 4, m_threads, [&](size_t b0, size_t b1) {
+        for (size_t i = b0 * 4; i < std::min(count, b1 * 4); ++i) {
+            const float* w = &m_world[ids[i]].m[0][0];
+            V4 r0 = MulRow(Load(w), viewProj), r1 = MulRow(Load(w + 4), viewProj);
+            V4 r2 = MulRow(Load(w + 8), viewProj), r3 = MulRow(Load(w + 12), viewProj);
+            Transpose(r0, r1, r2, r3);
+            float* mvp = &m_mvp[ids[i]].m[0][0];
+            Store(mvp, r0);
+            Store(mvp + 4, r1);
+            Store(mvp + 8, r2);
+            Store(mvp + 12, r3);
+        }
+    });
+}
+
+void TransformStore::Update(const XMFLOAT4X4& viewProj, uint32_t threadCount)
+{
+    USU_PROFILE_ZONE("TransformUpdate");
+    const auto t0 = std::chrono::steady_clock::now();
+    m_stats = TransformUpdateStats();
+    m_threads = threadCount;
+    std::fill(m_changed.begin(), m_changed.end(), 0);
+
+    // Parents are final before their children's level starts
+    for (size_t level = 0; level < m_levels.size(); ++level) {
+        m_work.clear();
+        for (uint32_t id : m_levels[level]) {
+            if (m_dirty[id] || (level > 0 && m_changed[m_parent[id]])) m_work.push_back(id);
+        }
+        if (m_work.empty()) continue;
+        const size_t count = m_work.size();
+        while (m_work.size() & 3) m_work.push_back(m_work.back());
+        UpdateWorlds(m_work.data(), count, level == 0);
+        m_stats.worlds += static_cast<uint32_t>(count);
+        m_stats.levels = static_cast<uint32_t>(level + 1);
+    }
+
+    // Every MVP when the camera moved, else only those under a new world
+    const bool viewProjChanged = !m_viewProjValid || memcmp(&viewProj, &m_viewProj, sizeof(viewProj)) != 0;
+    m_viewProj = viewProj;
+    m_viewProjValid = true;
+    m_work.clear();
+    for (uint32_t id = 0; id < m_parent.size(); ++id) {
+        if (viewProjChanged || m_changed[id]) m_work.push_back(id);
+    }
+    UpdateMvps(m_work.data(), m_work.size());
+    m_stats.mvps = static_cast<uint32_t>(m_work.size());
+    m_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+struct TransformUpdateStats
+{
+    uint32_t worlds = 0;  // world matrices recomputed
+    uint32_t mvps = 0;    // MVPs recomputed
+    uint32_t levels = 0;  // hierarchy depth walked
+    double   milliseconds = 0.0;
+};
+
+// Local position / rotation (quaternion) / scale of many objects, stored as
+// structure of arrays, with an optional parent per object (wheels under a
+// car body, cars under a parking lot). Update() rebuilds world = S * R * T *
+// parentWorld (DirectXMath row-vector order) and MVP = world * viewProj for
+// what changed since the last call only: objects whose local transform was
+// set, their descendants, and everything when viewProj changes. Work goes
+// one hierarchy level at a time, four objects per SIMD batch (SSE2 where
+// available), split across threads for large levels. No D3D dependency.
+class TransformStore
+{
+public:
+    static const uint32_t kNoParent = ~0u;
+
+    // Identity local transform. A parent must already exist, so parents
+    // always come before their children.
+    uint32_t Create(uint32_t parent = kNoParent);
+    void Reserve(size_t count);
+    void Clear();
+    size_t Size() const { return m_parent.size(); }
+
+    void SetPosition(uint32_t id, const DirectX::XMFLOAT3& position);
+    void SetRotation(uint32_t id, const DirectX::XMFLOAT4& quaternion); // unit length
+    void SetScale(uint32_t id, const DirectX::XMFLOAT3& scale);
+    uint32_t GetParent(uint32_t id) const { return m_parent[id]; }
+
+    // viewProj untransposed; threadCount 0 uses every core for large levels
+    void Update(const DirectX::XMFLOAT4X4& viewProj, uint32_t threadCount = 0);
+    const TransformUpdateStats& GetLastUpdateStats() const { return m_stats; }
+
+    // Untransposed, like XMStoreFloat4x4 of an XMMATRIX; also what
+    // InstanceData::world holds
+    const DirectX::XMFLOAT4X4& GetWorld(uint32_t id) const { return m_world[id]; }
+    const DirectX::XMFLOAT4X4* GetWorlds() const { return m_world.data(); }
+    // Transposed, ready for PerObjectCB::mvp
+    const DirectX::XMFLOAT4X4& GetMvp(uint32_t id) const { return m_mvp[id]; }
+    const DirectX::XMFLOAT4X4* GetMvps() const { return m_mvp.data(); }
+
+private:
+    void UpdateWorlds(const uint32_t* ids, size_t count, bool roots);
+    void UpdateMvps(const uint32_t* ids, size_t count);
+
+    // Local transforms, one array per component
+    std::vector<float> m_px, m_py, m_pz;
+    std::vector<float> m_qx, m_qy, m_qz, m_qw;
+    std::vector<float> m_sx, m_sy, m_sz;
+    std::vector<uint32_t> m_parent;
+    std::vector<std::vector<uint32_t>> m_levels; // ids by depth, ascending
+
+    std::vector<uint8_t> m_dirty;   // local transform set since the last Update
+    std::vector<uint8_t> m_changed; // world recomputed by the current Update
+    std::vector<DirectX::XMFLOAT4X4> m_world;
+    std::vector<DirectX::XMFLOAT4X4> m_mvp;
+    DirectX::XMFLOAT4X4 m_viewProj = {};
+    bool m_viewProjValid = false;
+
+    std::vector<uint32_t> m_work; // per-level scratch
+    uint32_t m_threads = 0;
+    TransformUpdateStats m_stats;
+};
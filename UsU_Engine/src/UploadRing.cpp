@@ -0,0 +1,53 @@
+#include "UploadRing.h"
+
+void UploadRing::Reset(uint64_t capacity)
+{
+    m_capacity = capacity;
+    m_head = 0;
+    m_tail = 0;
+    m_submitted = 0;
+    m_batches.clear();
+}
+
+uint64_t UploadRing::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || size > m_capacity || alignment == 0 || (alignment & (alignment - 1)) != 0) return kInvalidOffset;
+
+    // Nothing in flight or open: start over at offset 0, or the skipped tail
+    // of a mid-buffer head could count against an empty ring
+    if (m_batches.empty() && m_head == m_submitted) {
+        m_head = 0;
+        m_tail = 0;
+        m_submitted = 0;
+    }
+
+    const uint64_t offset = m_head % m_capacity;
+    uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+    uint64_t start = m_head + (aligned - offset);
+    if (aligned + size > m_capacity) {
+        // Skip the rest of the ring; offset 0 satisfies any alignment
+        start = m_head + (m_capacity - offset);
+        aligned = 0;
+    }
+    if (start + size - m_tail > m_capacity) return kInvalidOffset;
+    m_head = start + size;
+    return aligned;
+}
+
+void UploadRing::Submit(uint64_t fenceValue)
+{
+    if (m_head == m_submitted) return;
+    Batch batch;
+    batch.fenceValue = fenceValue;
+    batch.end = m_head;
+    m_batches.push_back(batch);
+    m_submitted = m_head;
+}
+
+void UploadRing::Retire(uint64_t completedValue)
+{
+    while (!m_batches.empty() && m_batches.front().fenceValue <= completedValue) {
+        m_tail = m_batches.front().end;
+        m_batches.pop_front();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+// Allocation bookkeeping for a fixed-size staging ring. Allocations are
+// linear and never straddle the end (the tail is skipped instead); each
+// Submit() closes a batch tagged with the fence value that signals when the
+// GPU has consumed it, and Retire() frees every batch up to the fence's
+// completed value. Knows nothing about D3D, so wraparound, alignment and
+// retirement can be exercised with a plain counter standing in for a fence.
+class UploadRing
+{
+public:
+    static const uint64_t kInvalidOffset = ~0ull;
+
+    explicit UploadRing(uint64_t capacity = 0) { Reset(capacity); }
+
+    // Drops all state; everything in flight must have completed.
+    void Reset(uint64_t capacity);
+
+    // Offset of size bytes aligned to alignment (a power of two), or
+    // kInvalidOffset until enough older batches retire (or, for size >
+    // capacity, never). Always succeeds on an empty ring for size <= capacity.
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+    // Ends the current batch: everything allocated since the previous Submit
+    // stays reserved until fenceValue completes. Fence values must increase.
+    void Submit(uint64_t fenceValue);
+
+    // Frees every batch whose fence value is <= completedValue.
+    void Retire(uint64_t completedValue);
+
+    // Fence value of the oldest batch still in flight, 0 if none; waiting on
+    // it is the minimum to make progress when Allocate fails.
+    uint64_t OldestPendingFence() const { return m_batches.empty() ? 0 : m_batches.front().fenceValue; }
+
+    uint64_t Capacity() const { return m_capacity; }
+    uint64_t UsedBytes() const { return m_head - m_tail; } // including skipped tails
+    bool     Empty() const { return m_head == m_tail; }
+
+private:
+    struct Batch
+    {
+        uint64_t fenceValue;
+        uint64_t end; // m_head when submitted
+    };
+
+    // Positions grow monotonically; the physical offset is position % capacity
+    uint64_t m_capacity = 0;
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    uint64_t m_submitted = 0; // m_head at the last Submit
+    std::deque<Batch> m_batches;
+};
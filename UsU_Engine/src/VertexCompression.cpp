@@ -0,0 +1,194 @@
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+uint16_t FloatToHalf(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    const uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+    const uint32_t absx = x & 0x7FFFFFFF;
+
+    if (absx >= 0x7F800000) // inf / nan (keep nan quiet)
+        return sign | 0x7C00 | (absx > 0x7F800000 ? 0x0200 : 0);
+    if (absx >= 0x477FF000) // rounds past 65504
+        return sign | 0x7C00;
+    if (absx < 0x38800000) {
+        // Result is a half subnormal (or zero)
+        if (absx < 0x33000000) return sign;
+        const uint32_t e = absx >> 23;
+        const uint32_t m = (absx & 0x007FFFFF) | 0x00800000;
+        const uint32_t shift = 126 - e;
+        uint32_t h = m >> shift;
+        const uint32_t rem = m & ((1u << shift) - 1);
+        const uint32_t half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1))) ++h;
+        return static_cast<uint16_t>(sign | h);
+    }
+    // Normal: rebias exponent (127 -> 15) and round mantissa to nearest even
+    uint32_t h = (absx - 0x38000000) >> 13;
+    const uint32_t rem = absx & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ++h;
+    return static_cast<uint16_t>(sign | h);
+}
+
+float HalfToFloat(uint16_t h)
+{
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    const uint32_t e = (h >> 10) & 0x1F;
+    uint32_t m = h & 0x3FF;
+    uint32_t x;
+    if (e == 0) {
+        if (m == 0) {
+            x = sign;
+        } else {
+            // Normalize the subnormal
+            int shift = 0;
+            while (!(m & 0x400)) { m <<= 1; ++shift; }
+            m &= 0x3FF;
+            x = sign | ((113 - shift) << 23) | (m << 13);
+        }
+    } else if (e == 31) {
+        x = sign | 0x7F800000 | (m << 13);
+    } else {
+        x = sign | ((e + 112) << 23) | (m << 13);
+    }
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static inline float SignNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+static inline float SnormToFloat(int16_t v) { return std::max(-1.0f, v / 32767.0f); }
+
+XMFLOAT3 OctDecodeNormal(const int16_t in[2])
+{
+    float x = SnormToFloat(in[0]);
+    float y = SnormToFloat(in[1]);
+    const float z = 1.0f - std::fabs(x) - std::fabs(y);
+    const float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+    const float len = std::sqrt(x * x + y * y + z * z);
+    const float inv = len > 0.0f ? 1.0f / len : 0.0f;
+    return XMFLOAT3(x * inv, y * inv, z * inv);
+}
+
+void OctEncodeNormal(const XMFLOAT3& n, int16_t out[2])
+{
+    const float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if (l1 <= 0.0f) { out[0] = 0; out[1] = 0; return; } // degenerate -> +Z
+    float x = n.x / l1;
+    float y = n.y / l1;
+    if (n.z < 0.0f) {
+        const float ox = x;
+        x = (1.0f - std::fabs(y)) * SignNotZero(ox);
+        y = (1.0f - std::fabs(ox)) * SignNotZero(y);
+    }
+
+    // Plain rounding is off by up to one step; test the four neighbouring
+    // codes and keep the one that decodes closest to the input direction
+    // (ranked by |n x d|: dot products differ by less than float epsilon here)
+    const float fx = std::floor(std::min(1.0f, std::max(-1.0f, x)) * 32767.0f);
+    const float fy = std::floor(std::min(1.0f, std::max(-1.0f, y)) * 32767.0f);
+    double bestErr = DBL_MAX;
+    for (int i = 0; i < 4; ++i) {
+        const float cx = std::min(32767.0f, fx + (i & 1));
+        const float cy = std::min(32767.0f, fy + (i >> 1));
+        const int16_t code[2] = { static_cast<int16_t>(cx), static_cast<int16_t>(cy) };
+        const XMFLOAT3 d = OctDecodeNormal(code);
+        const double ex = (double)n.y * d.z - (double)n.z * d.y;
+        const double ey = (double)n.z * d.x - (double)n.x * d.z;
+        const double ez = (double)n.x * d.y - (double)n.y * d.x;
+        const double dot = (double)n.x * d.x + (double)n.y * d.y + (double)n.z * d.z;
+        const double err = dot > 0.0 ? ex * ex + ey * ey + ez * ez : DBL_MAX;
+        if (err < bestErr) { bestErr = err; out[0] = code[0]; out[1] = code[1]; }
+    }
+}
+
+VertexQuantization ComputeVertexQuantization(const Vertex* vertices, size_t count)
+{
+    VertexQuantization q;
+    if (count == 0) return q;
+    XMFLOAT3 lo(FLT_MAX, FLT_MAX, FLT_MAX), hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < count; ++i) {
+        const XMFLOAT3& p = vertices[i].position;
+        lo.x = std::min(lo.x, p.x); hi.x = std::max(hi.x, p.x);
+        lo.y = std::min(lo.y, p.y); hi.y = std::max(hi.y, p.y);
+        lo.z = std::min(lo.z, p.z); hi.z = std::max(hi.z, p.z);
+    }
+    q.offset = lo;
+    q.scale = XMFLOAT3(hi.x - lo.x, hi.y - lo.y, hi.z - lo.z);
+    return q;
+}
+
+XMFLOAT3 PositionErrorBound(const VertexQuantization& q)
+{
+    // Half a quantization step, plus float rounding of offset + t * scale
+    auto axis = [](float offset, float scale) {
+        return scale / 131070.0f + 2.0f * FLT_EPSILON * (std::fabs(offset) + scale);
+    };
+    return XMFLOAT3(axis(q.offset.x, q.scale.x), axis(q.offset.y, q.scale.y), axis(q.offset.z, q.scale.z));
+}
+
+static inline uint16_t QuantizeUnorm16(float v, float offset, float scale)
+{
+    if (scale <= 0.0f) return 0;
+    const float t = std::min(1.0f, std::max(0.0f, (v - offset) / scale));
+    return static_cast<uint16_t>(std::lround(t * 65535.0f));
+}
+
+void PackVertices(PackedVertex* dst, const Vertex* src, size_t count, const VertexQuantization& q)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const Vertex& v = src[i];
+        PackedVertex p;
+        p.position[0] = QuantizeUnorm16(v.position.x, q.offset.x, q.scale.x);
+        p.position[1] = QuantizeUnorm16(v.position.y, q.offset.y, q.scale.y);
+        p.position[2] = QuantizeUnorm16(v.position.z, q.offset.z, q.scale.z);
+        p.position[3] = 0;
+        OctEncodeNormal(v.normal, p.normal);
+        p.uv[0] = FloatToHalf(v.uv.x);
+        p.uv[1] = FloatToHalf(v.uv.y);
+        dst[i] = p;
+    }
+}
+
+Vertex UnpackVertex(const PackedVertex& p, const VertexQuantization& q)
+{
+    Vertex v;
+    v.position = XMFLOAT3(q.offset.x + p.position[0] / 65535.0f * q.scale.x,
+                          q.offset.y + p.position[1] / 65535.0f * q.scale.y,
+                          q.offset.z + p.position[2] / 65535.0f * q.scale.z);
+    v.normal = OctDecodeNormal(p.normal);
+    v.uv = XMFLOAT2(HalfToFloat(p.uv[0]), HalfToFloat(p.uv[1]));
+    return v;
+}
+
+PackedVertexError MeasurePackingError(const Vertex* src, const PackedVertex* packed, size_t count,
+                                      const VertexQuantization& q)
+{
+    PackedVertexError err;
+    for (size_t i = 0; i < count; ++i) {
+        const Vertex& a = src[i];
+        const Vertex b = UnpackVertex(packed[i], q);
+        err.maxPosition = std::max({ err.maxPosition, std::fabs(a.position.x - b.position.x),
+                                     std::fabs(a.position.y - b.position.y), std::fabs(a.position.z - b.position.z) });
+        // atan2(|a x b|, a.b) in double; acos of a float dot cannot resolve angles this small
+        const double ax = a.normal.x, ay = a.normal.y, az = a.normal.z;
+        const double bx = b.normal.x, by = b.normal.y, bz = b.normal.z;
+        const double cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+        const double dot = ax * bx + ay * by + az * bz;
+        if (ax != 0.0 || ay != 0.0 || az != 0.0) {
+            const double angle = std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot);
+            err.maxNormalRadians = std::max(err.maxNormalRadians, static_cast<float>(angle));
+        }
+        err.maxUV = std::max({ err.maxUV, std::fabs(a.uv.x - b.uv.x), std::fabs(a.uv.y - b.uv.y) });
+    }
+    return err;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Mesh.h"
+
+// 16-byte packed vertex, bound as
+//   POSITION R16G16B16A16_UNORM  (xyz quantized to the mesh bounds, w = 0)
+//   NORMAL   R16G16_SNORM        (octahedral encoding)
+//   TEXCOORD R16G16_FLOAT        (IEEE half)
+struct PackedVertex
+{
+    uint16_t position[4];
+    int16_t  normal[2];
+    uint16_t uv[2];
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+// Dequantization: position = offset + unorm * scale (scale = bounds extent)
+struct VertexQuantization
+{
+    DirectX::XMFLOAT3 offset{ 0, 0, 0 };
+    DirectX::XMFLOAT3 scale{ 0, 0, 0 };
+};
+
+// Worst-case errors of the encoding:
+//   position: scale / 65535 / 2 per axis (see PositionErrorBound)
+//   normal:   kOctNormalMaxErrorRadians between input and decoded direction
+//   uv:       2^-11 relative (half precision), i.e. <= 2^-12 for uv in [0, 1)
+static const float kOctNormalMaxErrorRadians = 0.00005f;
+
+struct PackedVertexError
+{
+    float maxPosition = 0.0f;     // largest per-axis absolute error
+    float maxNormalRadians = 0.0f;
+    float maxUV = 0.0f;           // largest absolute error
+};
+
+uint16_t FloatToHalf(float f);
+float    HalfToFloat(uint16_t h);
+
+void              OctEncodeNormal(const DirectX::XMFLOAT3& n, int16_t out[2]);
+DirectX::XMFLOAT3 OctDecodeNormal(const int16_t in[2]);
+
+VertexQuantization ComputeVertexQuantization(const Vertex* vertices, size_t count);
+DirectX::XMFLOAT3  PositionErrorBound(const VertexQuantization& q);
+
+// dst may point straight into a mapped upload buffer
+void   PackVertices(PackedVertex* dst, const Vertex* src, size_t count, const VertexQuantization& q);
+Vertex UnpackVertex(const PackedVertex& v, const VertexQuantization& q);
+
+PackedVertexError MeasurePackingError(const Vertex* src, const PackedVertex* packed, size_t count,
+                                      const VertexQuantization& q);
@@ -7,7 +7,30 @@
 #include <DirectXMath.h>
 #include "Renderer.h"
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+#include "FshArchive.h"
+#include "ImageDecoder.h"
+#include "MipGenerator.h"
+#include "BlockCompression.h"
+#include "TextureCache.h"
+#include "ImageDecodeBenchmark.h"
+#include "SoftwareRenderer.h"
+#include "TransformStore.h"
+#include "Bvh.h"
+#include "CullingBenchmark.h"
+#include "JobSystem.h"
+#include "JobBenchmark.h"
+#include "ParallelRecorder.h"
+#include "AssetManager.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include <algorithm>
 #include <vector>
+#include <chrono>
+#include <cstdio>
+#include <memory>
 
 // Hint hybrid systems (NV/AMD) to use high-performance GPU
 extern "C" {
@@ -23,7 +46,9 @@ extern "C" {
 using Microsoft::WRL::ComPtr;
 
   // Globals
-  static const UINT kFrameCount = 2;
+  static const UINT kMaxFrameCount = 4;
+  // Frames the CPU may run ahead of the GPU (= swap chain buffers), 2..kMaxFrameCount
+  UINT g_frameCount = 2;
   HWND g_hWnd = nullptr;
   UINT g_width = 1280;
   UINT g_height = 720;
@@ -33,8 +58,14 @@ ComPtr<IDXGISwapChain3> g_swapChain;
 ComPtr<ID3D12CommandQueue> g_commandQueue;
   ComPtr<ID3D12DescriptorHeap> g_rtvHeap;
   UINT g_rtvDescriptorSize = 0;
-  ComPtr<ID3D12Resource> g_renderTargets[kFrameCount];
-  ComPtr<ID3D12CommandAllocator> g_commandAllocator;
+  ComPtr<ID3D12Resource> g_renderTargets[kMaxFrameCount];
+  // Per back buffer: its allocator and the fence value of its last submission
+  struct FrameContext
+  {
+    ComPtr<ID3D12CommandAllocator> allocator;
+    UINT64 fenceValue = 0;
+  };
+  FrameContext g_frames[kMaxFrameCount];
   ComPtr<ID3D12GraphicsCommandList> g_commandList;
   ComPtr<ID3D12Fence> g_fence;
   UINT64 g_fenceValue = 0;
@@ -48,6 +79,76 @@ ComPtr<ID3D12CommandQueue> g_commandQueue;
   float g_modelScale = 0.1f;
   // Model yaw (Y-axis rotation) controlled by keyboard
   float g_modelYaw = 0.0f;
+  // Upload meshes as 16-byte PackedVertex instead of 32-byte Vertex
+  bool g_packedVertices = true;
+  // Build meshlets for a cold-loaded mesh and log how many triangles the
+  // meshlet cull test rejects from the starting view
+  bool g_logMeshletCulling = false;
+  // Draw the coarsest LOD whose error, projected to the screen, stays under
+  // g_lodPixelError pixels
+  bool g_useLods = true;
+  float g_lodPixelError = 1.0f;
+  // Log WIC vs built-in decoder timings and BC encoder throughput/PSNR for
+  // the skin bitmaps at startup
+  bool g_benchmarkImageDecode = false;
+  // Filter for CPU-generated mips of decoded (RGBA8) textures
+  MipFilter g_mipFilter = MipFilter::Kaiser;
+  // Block-compress decoded textures (BC1 opaque, g_bcAlphaFormat with alpha)
+  // and cache the result as .usutex next to the source
+  bool g_compressTextures = true;
+  BcQuality g_bcQuality = BcQuality::High;
+  TextureFormat g_bcAlphaFormat = TextureFormat::BC3; // BC7 is mode 6 only, softer alpha
+  // Keep up to g_frameCount frames in flight; false waits for the GPU to go
+  // idle after every frame (the old behaviour, for comparison)
+  bool g_pipelineFrames = true;
+  // Log averaged CPU record/present/fence wait times every kFrameStatsInterval frames
+  bool g_logFrameTimings = false;
+  static const UINT kFrameStatsInterval = 240;
+  // Also draw the first frame with the CPU rasterizer after loading and
+  // write it to snapshot.png next to the executable
+  bool g_softwareSnapshot = false;
+  SoftwareRenderer g_softwareRenderer;
+  // >0 draws the model as a g_instanceGrid x g_instanceGrid parking lot in
+  // one instanced draw per range (e.g. 71 for ~5000 cars)
+  UINT g_instanceGrid = 0;
+  float g_instanceSpacing = 0.6f; // grid cell, world units
+  std::vector<InstanceData> g_instances;
+  // Lot root (yaw/scale from the keyboard) with one child per car
+  TransformStore g_transforms;
+  uint32_t g_lotTransform = TransformStore::kNoParent;
+  // Object-space bounds of the uploaded mesh; cars outside the view are
+  // culled against their world boxes through g_instanceBvh
+  MeshBounds g_meshBounds;
+  Bvh g_instanceBvh;
+  std::vector<uint32_t> g_visibleCars;
+  std::vector<InstanceData> g_visibleInstances;
+  // false draws the lot with one draw (own MVP) per visible car, recorded
+  // per g_recordMode ('M' cycles it); with g_logFrameTimings the recording
+  // cost per draw of each mode is logged as "[Draw] ..."
+  bool g_instancedLot = true;
+  enum class RecordMode { SingleList, ParallelLists, ParallelBundles };
+  RecordMode g_recordMode = RecordMode::ParallelLists;
+  ParallelRecorder g_recorder;
+  static const UINT kMinDrawsPerList = 256;
+  std::vector<DirectX::XMFLOAT4X4> g_visibleMvps;
+  // Per-car LOD of the non-instanced lot (g_useLods, g_lodPixelError); the
+  // instanced lot draws LOD 0
+  std::vector<uint8_t> g_visibleLods;
+  // This frame's command lists in submission order
+  std::vector<ID3D12CommandList*> g_submitLists;
+  // The car and its skin load on the loader thread; until they are
+  // published the renderer draws the default triangle with a 1x1 texture
+  AssetManager g_assets;
+  // Start of wWinMain, for time to first frame and to fully loaded
+  std::chrono::steady_clock::time_point g_startTime;
+  // Log brute-force vs BVH frustum culling of 100k boxes at startup
+  bool g_benchmarkCulling = false;
+  // Log job system scaling from 1 to all cores at startup
+  bool g_benchmarkJobs = false;
+  // Log the CPU and GPU profile zones every Profiler::kSummaryFrames frames
+  // as "[Profile] ..."; 'P' writes trace.json next to the executable either way
+  bool g_logProfile = false;
+  GpuProfiler g_gpuProfiler;
   // Model scale controlled by keyboard
 static std::wstring GetExecutableDir()
 {
@@ -79,6 +180,156 @@ static std::wstring ResolveAssetPath(const std::wstring& exeDir, const std::wstr
     return cands[0];
 }
 
+// Hands a finished texture to the renderer (and the CPU rasterizer)
+static bool UploadTexture(const TextureData& tex)
+{
+    if (g_softwareSnapshot) g_softwareRenderer.LoadTexture(tex);
+    return g_renderer.LoadTexture(tex);
+}
+
+// Decode + mips + block compression, or the cached result of all three when
+// the .usutex next to colorPath matches the sources and settings. CPU work
+// only; the caller uploads tex.
+static bool PrepareImageTexture(const std::wstring& colorPath, const std::wstring& alphaPath, TextureData& tex)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::wstring cachePath = TextureCache::PathFor(colorPath);
+    const uint64_t settings = (uint64_t(kBcEncoderVersion) << 32) | (uint64_t(g_mipFilter) << 16) |
+                              (uint64_t(g_bcQuality) << 8) | uint64_t(g_bcAlphaFormat);
+    uint64_t sourceHash = 0;
+    const bool hashed = g_compressTextures && TextureCache::HashSources(colorPath, alphaPath, sourceHash);
+    char msg[256];
+    if (hashed && TextureCache::Read(cachePath, sourceHash, settings, tex)) {
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        sprintf_s(msg, "[Texture] warm cache: %s, %zu mip(s), %.1f ms\n", TextureFormatName(tex.format), tex.mips.size(), ms);
+        OutputDebugStringA(msg);
+        return true;
+    }
+
+    if (!LoadImageFile(colorPath, tex, alphaPath)) return false;
+    const auto t1 = std::chrono::steady_clock::now();
+    if (!GenerateMips(tex, g_mipFilter)) return false;
+    const double mipMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+    sprintf_s(msg, "[Texture] %zu mip(s), %s filter: %.1f ms\n", tex.mips.size(), MipFilterName(g_mipFilter), mipMs);
+    OutputDebugStringA(msg);
+    if (g_benchmarkImageDecode) BenchmarkBlockCompression(tex);
+
+    TextureData bc;
+    BcEncodeStats stats;
+    const TextureFormat format = ChooseBcFormat(tex, g_bcAlphaFormat);
+    if (g_compressTextures && CompressTexture(tex, format, g_bcQuality, bc, &stats)) {
+        double psnrRgb = 0.0, psnrAlpha = 0.0;
+        MeasureCompressionPsnr(tex, bc, psnrRgb, psnrAlpha);
+        sprintf_s(msg, "[Texture] %s %s: %.1f ms, %.1f MPix/s, PSNR rgb %.2f dB alpha %.2f dB, %zu -> %zu KB\n",
+            TextureFormatName(format), g_bcQuality == BcQuality::High ? "high" : "fast", stats.milliseconds,
+            stats.megapixelsPerSecond, psnrRgb, psnrAlpha, tex.bytes.size() / 1024, bc.bytes.size() / 1024);
+        OutputDebugStringA(msg);
+        if (hashed) TextureCache::Write(cachePath, sourceHash, settings, bc);
+        tex = std::move(bc);
+    }
+    return true;
+}
+
+// The skin: the FSH archive first (DXT stays compressed), then FSHTool's
+// unpacked index.fsh, then loose images. Runs on the loader thread.
+static bool PrepareSkinTexture(const std::wstring& exeDir, TextureData& tex, const std::atomic<bool>& cancelled)
+{
+    USU_PROFILE_ZONE("PrepareSkinTexture");
+    const std::wstring base = L"assets\\mesh\\skin00";
+    const std::wstring fshPaths[] = {
+        ResolveAssetPath(exeDir, base + L".fsh"),
+        ResolveAssetPath(exeDir, base + L"\\index.fsh")
+    };
+    for (const auto& p : fshPaths) {
+        FshArchive fsh;
+        if (cancelled || !Exists(p) || !fsh.Open(p)) continue;
+        const auto& entries = fsh.GetEntries();
+        for (size_t i = 0; i < entries.size() && !cancelled; ++i) {
+            char msg[192];
+            sprintf_s(msg, "[FSH] %s entry '%s': %s %ux%u, %u mip(s)%s\n", fsh.IsIndex() ? "index" : "archive",
+                entries[i].name.c_str(), FshFormatName(entries[i].format), entries[i].width, entries[i].height,
+                entries[i].mipCount, entries[i].alphaFile.empty() ? "" : ", separate alpha");
+            OutputDebugStringA(msg);
+            if (fsh.IsIndex()) {
+                if (g_benchmarkImageDecode) BenchmarkImageDecode(entries[i].colorFile, entries[i].alphaFile);
+                if (PrepareImageTexture(entries[i].colorFile, entries[i].alphaFile, tex)) return true;
+            } else if (fsh.Decode(i, tex)) {
+                // Uncompressed entries usually carry no mips of their own
+                if (tex.format == TextureFormat::RGBA8 && tex.mips.size() == 1) GenerateMips(tex, g_mipFilter);
+                return true;
+            }
+        }
+    }
+    const std::wstring cands[] = {
+        ResolveAssetPath(exeDir, base + L".png"),
+        //ResolveAssetPath(exeDir, base + L".jpg"),
+        //ResolveAssetPath(exeDir, base + L".jpeg"),
+        ResolveAssetPath(exeDir, base + L".BMP")
+    };
+    for (const auto& p : cands) {
+        // Exists() checks files only; skip non-existing
+        if (cancelled) break;
+        if (Exists(p) && PrepareImageTexture(p, std::wstring(), tex)) return true;
+    }
+    return false;
+}
+
+// Filled on the loader thread: a validated, mapped .usumesh (warm path, no
+// parsing) or a freshly parsed OBJ, which also writes the cache
+struct MeshLoad
+{
+    std::wstring objPath;
+    MeshCache cache;
+    bool warm = false;
+    Mesh mesh;
+};
+
+static bool PrepareMesh(MeshLoad& load, const std::atomic<bool>& cancelled)
+{
+    USU_PROFILE_ZONE("PrepareMesh");
+    const std::wstring cachePath = MeshCache::PathFor(load.objPath);
+    load.warm = load.cache.Open(cachePath, load.objPath);
+    if (load.warm) return true;
+    if (cancelled || !load.mesh.LoadOBJ(load.objPath) || cancelled) return false;
+    load.mesh.Optimize();
+    load.mesh.BuildLods();
+    MeshCache::Write(cachePath, load.objPath, load.mesh);
+    return true;
+}
+
+// Replaces the placeholder mesh; the GPU must be idle
+static bool PublishMesh(MeshLoad& load)
+{
+    const VertexFormat format = g_packedVertices ? VertexFormat::Packed16 : VertexFormat::Float32;
+    bool uploaded = false;
+    if (load.warm) {
+        const MeshCache& c = load.cache;
+        MeshLodChain chain;
+        chain.lods = c.GetLods();
+        chain.lodCount = c.GetLodCount();
+        chain.indexCount = c.GetLodIndexCount();
+        uploaded = g_renderer.UploadMesh(c.GetVertices(), c.GetVertexCount(), c.GetIndices(), c.GetIndexCount(), format,
+                                         c.GetSubmeshes(), chain);
+        if (uploaded) {
+            g_meshBounds = ComputeMeshBounds(c.GetVertices(), c.GetVertexCount());
+            if (g_softwareSnapshot) g_softwareRenderer.UploadMesh(c.GetVertices(), c.GetVertexCount(), c.GetIndices(), c.GetIndexCount());
+        }
+        load.cache.Close();
+    } else {
+        uploaded = g_renderer.UploadMesh(load.mesh, format);
+        if (uploaded) {
+            g_meshBounds = load.mesh.GetBounds();
+            if (g_softwareSnapshot) g_softwareRenderer.UploadMesh(load.mesh);
+        }
+    }
+    // New bounds: the lot rebuilds its boxes and tree next frame
+    g_instances.clear();
+    char msg[96];
+    sprintf_s(msg, "[Mesh] %s%s\n", load.warm ? "warm cache" : "cold OBJ", uploaded ? "" : ", upload failed");
+    OutputDebugStringA(msg);
+    return uploaded;
+}
+
 void ThrowIfFailed(HRESULT hr) {
   if (FAILED(hr)) {
     assert(false);
@@ -86,15 +337,6 @@ void ThrowIfFailed(HRESULT hr) {
   }
 }
 
-void SignalAndWaitForGPU() {
-  const UINT64 fenceToWaitFor = ++g_fenceValue;
-  ThrowIfFailed(g_commandQueue->Signal(g_fence.Get(), fenceToWaitFor));
-  if (g_fence->GetCompletedValue() < fenceToWaitFor) {
-    ThrowIfFailed(g_fence->SetEventOnCompletion(fenceToWaitFor, g_fenceEvent));
-    WaitForSingleObject(g_fenceEvent, INFINITE);
-  }
-}
-
   void WaitForGPU() {
     const UINT64 fenceToWaitFor = ++g_fenceValue;
     ThrowIfFailed(g_commandQueue->Signal(g_fence.Get(), fenceToWaitFor));
@@ -177,7 +419,9 @@ void SignalAndWaitForGPU() {
 
     // Swapchain
     DXGI_SWAP_CHAIN_DESC1 scDesc = {};
-    scDesc.BufferCount = kFrameCount;
+    if (g_frameCount < 2) g_frameCount = 2;
+    if (g_frameCount > kMaxFrameCount) g_frameCount = kMaxFrameCount;
+    scDesc.BufferCount = g_frameCount;
     scDesc.Width = g_width;
     scDesc.Height = g_height;
     scDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -193,7 +437,7 @@ void SignalAndWaitForGPU() {
 
     // RTV heap
     D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-    rtvHeapDesc.NumDescriptors = kFrameCount;
+    rtvHeapDesc.NumDescriptors = g_frameCount;
     rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
     rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     ThrowIfFailed(g_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&g_rtvHeap)));
@@ -202,16 +446,19 @@ void SignalAndWaitForGPU() {
     // Back buffers and RTVs
     {
       D3D12_CPU_DESCRIPTOR_HANDLE rtv = g_rtvHeap->GetCPUDescriptorHandleForHeapStart();
-      for (UINT n = 0; n < kFrameCount; ++n) {
+      for (UINT n = 0; n < g_frameCount; ++n) {
         ThrowIfFailed(g_swapChain->GetBuffer(n, IID_PPV_ARGS(&g_renderTargets[n])));
         g_device->CreateRenderTargetView(g_renderTargets[n].Get(), nullptr, rtv);
         rtv.ptr += static_cast<SIZE_T>(g_rtvDescriptorSize);
       }
     }
 
-    // Command allocator/list
-    ThrowIfFailed(g_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&g_commandAllocator)));
-    ThrowIfFailed(g_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, g_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&g_commandList)));
+    // Command allocator per frame, one list reset onto the current one
+    for (UINT n = 0; n < g_frameCount; ++n) {
+      ThrowIfFailed(g_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&g_frames[n].allocator)));
+      g_frames[n].fenceValue = 0;
+    }
+    ThrowIfFailed(g_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, g_frames[0].allocator.Get(), nullptr, IID_PPV_ARGS(&g_commandList)));
     ThrowIfFailed(g_commandList->Close());
 
     // Fence and event
@@ -224,17 +471,17 @@ void SignalAndWaitForGPU() {
     if (!g_swapChain || width == 0 || height == 0) return;
     WaitForGPU();
 
-    for (UINT n = 0; n < kFrameCount; ++n) {
+    for (UINT n = 0; n < g_frameCount; ++n) {
       g_renderTargets[n].Reset();
     }
 
     DXGI_SWAP_CHAIN_DESC scDesc = {};
     ThrowIfFailed(g_swapChain->GetDesc(&scDesc));
-    ThrowIfFailed(g_swapChain->ResizeBuffers(kFrameCount, width, height, scDesc.BufferDesc.Format, scDesc.Flags));
+    ThrowIfFailed(g_swapChain->ResizeBuffers(g_frameCount, width, height, scDesc.BufferDesc.Format, scDesc.Flags));
     g_frameIndex = g_swapChain->GetCurrentBackBufferIndex();
 
     D3D12_CPU_DESCRIPTOR_HANDLE rtv = g_rtvHeap->GetCPUDescriptorHandleForHeapStart();
-    for (UINT n = 0; n < kFrameCount; ++n) {
+    for (UINT n = 0; n < g_frameCount; ++n) {
       ThrowIfFailed(g_swapChain->GetBuffer(n, IID_PPV_ARGS(&g_renderTargets[n])));
       g_device->CreateRenderTargetView(g_renderTargets[n].Get(), nullptr, rtv);
       rtv.ptr += static_cast<SIZE_T>(g_rtvDescriptorSize);
@@ -244,11 +491,255 @@ void SignalAndWaitForGPU() {
     g_height = height;
   }
 
+  // Camera of the single model (no instance grid)
+  const DirectX::XMVECTORF32 kModelEye = { { { 0.0f, 0.0f, -2.0f, 1.0f } } };
+
+  // World = Rotation(Yaw) * Scale
+  DirectX::XMMATRIX ComputeModelWorld() {
+    using namespace DirectX;
+    return XMMatrixRotationY(g_modelYaw) * XMMatrixScaling(g_modelScale, g_modelScale, g_modelScale);
+  }
+
+  // Transposed world * view * proj, as the shader's constant buffer expects
+  DirectX::XMFLOAT4X4 ComputeMvp() {
+    using namespace DirectX;
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)g_width / (float)g_height, 0.1f, 100.0f);
+    XMMATRIX view = XMMatrixLookAtLH(kModelEye, XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    XMFLOAT4X4 mvp;
+    XMStoreFloat4x4(&mvp, XMMatrixTranspose(ComputeModelWorld() * view * proj));
+    return mvp;
+  }
+
+  // LOD of the single model, centered kModelEye's distance away
+  UINT SelectModelLod() {
+    using namespace DirectX;
+    if (!g_useLods) return 0;
+    return SelectLod(g_renderer.GetLods(), g_renderer.GetLodSubmeshCount(), XMVectorGetX(XMVector3Length(kModelEye)),
+        g_modelScale, XM_PIDIV4, (float)g_height, g_lodPixelError);
+  }
+
+  // How much of a freshly imported mesh the meshlet cull test would reject
+  // from the single-model camera, as "[Meshlet] ..."
+  void LogMeshletCulling(const Mesh& mesh) {
+    using namespace DirectX;
+    MeshletData meshlets;
+    BuildMeshlets(meshlets, mesh);
+    const XMFLOAT4X4 transposed = ComputeMvp();
+    XMFLOAT4X4 mvp;
+    XMStoreFloat4x4(&mvp, XMMatrixTranspose(XMLoadFloat4x4(&transposed)));
+    XMFLOAT3 eye;
+    XMStoreFloat3(&eye, XMVector3TransformCoord(kModelEye, XMMatrixInverse(nullptr, ComputeModelWorld())));
+    const MeshletCullStats stats = CullMeshlets(meshlets, MakeMeshletCullView(mvp, eye));
+    char msg[192];
+    sprintf_s(msg, "[Meshlet] %zu meshlet(s): %zu visible, %zu frustum culled, %zu backface culled, %.1f%% of %zu tris culled\n",
+        stats.meshlets, stats.visibleMeshlets, stats.frustumCulled, stats.backfaceCulled, stats.CulledTrianglePercent(),
+        stats.triangles);
+    OutputDebugStringA(msg);
+  }
+
+  // Camera pulled back and up far enough to see the whole instance grid
+  float GetLotExtent() {
+    return (std::max)(1.0f, g_instanceGrid * g_instanceSpacing);
+  }
+
+  DirectX::XMVECTOR GetLotEye() {
+    const float extent = GetLotExtent();
+    return DirectX::XMVectorSet(0.0f, 0.6f * extent, -1.1f * extent, 1.0f);
+  }
+
+  DirectX::XMMATRIX ComputeViewProjMatrix() {
+    using namespace DirectX;
+    const float extent = GetLotExtent();
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)g_width / (float)g_height, 0.1f, 10.0f * extent);
+    XMMATRIX view = XMMatrixLookAtLH(GetLotEye(), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    return view * proj;
+  }
+
+  // LOD per visible car from the distance of its bounding sphere to the eye
+  void SelectLotLods(UINT draws) {
+    using namespace DirectX;
+    g_visibleLods.assign(draws, 0);
+    if (!g_useLods || g_renderer.GetLodLevelCount() < 2) return;
+    const XMVECTOR eye = GetLotEye();
+    const XMVECTOR center = XMLoadFloat3(&g_meshBounds.center);
+    const XMFLOAT4X4* worlds = g_transforms.GetWorlds();
+    for (UINT i = 0; i < draws; ++i) {
+      const XMVECTOR worldCenter = XMVector3TransformCoord(center, XMLoadFloat4x4(&worlds[g_visibleCars[i] + 1]));
+      const float distance = XMVectorGetX(XMVector3Length(worldCenter - eye)) - g_meshBounds.radius * g_modelScale;
+      g_visibleLods[i] = static_cast<uint8_t>(SelectLod(g_renderer.GetLods(), g_renderer.GetLodSubmeshCount(), distance,
+        g_modelScale, XM_PIDIV4, (float)g_height, g_lodPixelError));
+    }
+  }
+
+  // Transposed, as PerObjectCB::viewProj expects
+  DirectX::XMFLOAT4X4 ComputeViewProj() {
+    DirectX::XMFLOAT4X4 viewProj;
+    DirectX::XMStoreFloat4x4(&viewProj, DirectX::XMMatrixTranspose(ComputeViewProjMatrix()));
+    return viewProj;
+  }
+
+  // Cars are created once under a lot transform, each with its own tint and
+  // skin; frames without keyboard input recompute no transforms at all
+  void BuildInstances() {
+    using namespace DirectX;
+    USU_PROFILE_ZONE("BuildInstances");
+    const UINT count = g_instanceGrid * g_instanceGrid;
+    const bool rebuilt = g_instances.size() != count;
+    if (rebuilt) {
+      g_transforms.Clear();
+      g_transforms.Reserve(count + 1);
+      g_lotTransform = g_transforms.Create();
+      g_instances.resize(count);
+      const float origin = -0.5f * (g_instanceGrid - 1) * g_instanceSpacing;
+      for (UINT i = 0; i < count; ++i) {
+        const UINT gx = i % g_instanceGrid, gz = i / g_instanceGrid;
+        const uint32_t car = g_transforms.Create(g_lotTransform);
+        XMFLOAT4 rotation;
+        XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(0.0f, 0.5f * static_cast<float>((gx * 7 + gz * 3) % 13), 0.0f));
+        g_transforms.SetRotation(car, rotation);
+        g_transforms.SetPosition(car, XMFLOAT3(origin + gx * g_instanceSpacing, 0.0f, origin + gz * g_instanceSpacing));
+        InstanceData& inst = g_instances[i];
+        const float shade = 0.6f + 0.4f * static_cast<float>((i * 2654435761u) >> 24) / 255.0f;
+        inst.color = XMFLOAT4(shade, shade, shade, 1.0f);
+        inst.skin = i % Renderer::kMaxSkins;
+      }
+    }
+    // Mark only what the keyboard changed: the lot for yaw, the cars for
+    // scale (which applies per car, not to the spacing between them)
+    static float appliedYaw = 0.0f, appliedScale = 0.0f;
+    if (rebuilt || appliedYaw != g_modelYaw) {
+      XMFLOAT4 lotRotation;
+      XMStoreFloat4(&lotRotation, XMQuaternionRotationRollPitchYaw(0.0f, g_modelYaw, 0.0f));
+      g_transforms.SetRotation(g_lotTransform, lotRotation);
+      appliedYaw = g_modelYaw;
+    }
+    if (rebuilt || appliedScale != g_modelScale) {
+      for (UINT i = 0; i < count; ++i) g_transforms.SetScale(i + 1, XMFLOAT3(g_modelScale, g_modelScale, g_modelScale));
+      appliedScale = g_modelScale;
+    }
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, ComputeViewProjMatrix());
+    g_transforms.Update(viewProj);
+    const XMFLOAT4X4* worlds = g_transforms.GetWorlds();
+    for (UINT i = 0; i < count; ++i) g_instances[i].world = worlds[i + 1];
+
+    // Boxes follow the worlds; a new lot builds the tree, keyboard changes refit it
+    if (rebuilt) {
+      std::vector<Aabb> boxes(count);
+      for (UINT i = 0; i < count; ++i) boxes[i] = TransformAabb(g_meshBounds.box, worlds[i + 1]);
+      g_instanceBvh.Build(boxes.data(), count);
+    } else if (g_transforms.GetLastUpdateStats().worlds > 0) {
+      for (UINT i = 0; i < count; ++i) g_instanceBvh.SetBox(i, TransformAabb(g_meshBounds.box, worlds[i + 1]));
+      g_instanceBvh.Refit();
+    }
+    g_visibleCars.clear();
+    g_instanceBvh.Cull(ExtractFrustum(viewProj), g_visibleCars);
+    g_visibleInstances.resize(g_visibleCars.size());
+    for (size_t i = 0; i < g_visibleCars.size(); ++i) g_visibleInstances[i] = g_instances[g_visibleCars[i]];
+  }
+
+  // Same clear color, MVP and draw as the first GPU frame, on the CPU
+  void RenderSoftwareSnapshot(const std::wstring& path) {
+    if (g_softwareRenderer.GetIndexCount() == 0 || !g_softwareRenderer.Initialize(g_width, g_height)) return;
+    g_softwareRenderer.Clear(0.0f, 0.0f, 1.0f, 1.0f);
+    g_softwareRenderer.UpdateCB(ComputeMvp());
+    g_softwareRenderer.RecordDraw(g_softwareRenderer.GetIndexCount());
+    const SoftwareDrawStats& stats = g_softwareRenderer.GetLastDrawStats();
+    const bool written = g_softwareRenderer.WriteImage(path);
+    char msg[192];
+    sprintf_s(msg, "[SW] %u tris (%u binned): vertex %.2f ms, bin %.2f ms, raster %.2f ms%s\n", stats.triangles,
+        stats.binned, stats.vertexMs, stats.binMs, stats.rasterMs, written ? "" : ", snapshot not written");
+    OutputDebugStringA(msg);
+  }
+
+  static const char* RecordModeName(RecordMode mode) {
+    switch (mode) {
+    case RecordMode::SingleList: return "single list";
+    case RecordMode::ParallelLists: return "parallel lists";
+    default: return "parallel bundles";
+    }
+  }
+
+  // Averaged over kFrameStatsInterval frames of the same mode
+  static void LogDrawTimings(UINT draws, UINT lists, double recordMs) {
+    static double sumMs = 0.0;
+    static double sumDraws = 0.0, sumLists = 0.0;
+    static UINT frames = 0;
+    static RecordMode mode = g_recordMode;
+    if (mode != g_recordMode) {
+      sumMs = sumDraws = sumLists = 0.0;
+      frames = 0;
+      mode = g_recordMode;
+    }
+    sumMs += recordMs; sumDraws += draws; sumLists += (std::max)(lists, 1u);
+    if (++frames < kFrameStatsInterval) return;
+    const double n = static_cast<double>(frames);
+    char msg[192];
+    sprintf_s(msg, "[Draw] %s: %.0f draws on %.1f list(s), record %.3f ms (%.0f ns/draw)\n", RecordModeName(mode),
+      sumDraws / n, sumLists / n, sumMs / n, sumDraws > 0.0 ? sumMs * 1e6 / sumDraws : 0.0);
+    OutputDebugStringA(msg);
+    sumMs = sumDraws = sumLists = 0.0;
+    frames = 0;
+  }
+
+  // Non-instanced lot: one draw per visible car. The single-list mode
+  // records into g_commandList; the parallel modes split the draws across
+  // g_recorder's lists, which set their own render target and viewport, the
+  // last one also returning the back buffer to present. Returns how many
+  // of those lists follow g_commandList this frame.
+  UINT RecordLotDraws(const D3D12_CPU_DESCRIPTOR_HANDLE& rtv, const D3D12_VIEWPORT& viewport, const RECT& scissor,
+                      const D3D12_RESOURCE_BARRIER& toPresent) {
+    BuildInstances();
+    const UINT visible = static_cast<UINT>(g_visibleCars.size());
+    const UINT draws = (std::min)(visible, Renderer::kMaxDrawsPerFrame);
+    static bool truncationLogged = false;
+    if (draws < visible && !truncationLogged) {
+      char msg[128];
+      sprintf_s(msg, "[Draw] %u cars visible, drawing only the first %u (Renderer::kMaxDrawsPerFrame)\n",
+                visible, draws);
+      OutputDebugStringA(msg);
+      truncationLogged = true;
+    }
+    g_visibleMvps.resize(draws);
+    for (UINT i = 0; i < draws; ++i) g_visibleMvps[i] = g_transforms.GetMvp(g_visibleCars[i] + 1);
+    SelectLotLods(draws);
+    const UINT first = g_renderer.PushDraws(g_visibleMvps.data(), draws, g_visibleLods.data());
+    if (first == Renderer::kInvalidDraw || g_renderer.GetIndexCount() == 0) return 0;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    UINT lists = 0;
+    if (g_recordMode == RecordMode::SingleList) {
+      USU_PROFILE_GPU_ZONE(g_gpuProfiler, g_commandList.Get(), "GPU draws");
+      g_renderer.RecordDraws(g_commandList.Get(), first, draws, false);
+    } else {
+      const bool bundles = g_recordMode == RecordMode::ParallelBundles;
+      lists = g_recorder.Record(g_frameIndex, draws, kMinDrawsPerList,
+        [&](ID3D12GraphicsCommandList* list, UINT begin, UINT end) {
+          USU_PROFILE_ZONE("Record draws");
+          list->RSSetViewports(1, &viewport);
+          list->RSSetScissorRects(1, &scissor);
+          list->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
+          {
+            USU_PROFILE_GPU_ZONE(g_gpuProfiler, list, "GPU draws");
+            g_renderer.RecordDraws(list, first + begin, end - begin, bundles);
+          }
+          if (end == draws) list->ResourceBarrier(1, &toPresent);
+        });
+    }
+    if (g_logFrameTimings)
+      LogDrawTimings(draws, lists, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    return lists;
+  }
+
   void PopulateCommandList() {
-    // Ensure the previous frame finished before we reset the allocator
-    SignalAndWaitForGPU();
-    ThrowIfFailed(g_commandAllocator->Reset());
-    ThrowIfFailed(g_commandList->Reset(g_commandAllocator.Get(), nullptr));
+    USU_PROFILE_ZONE("PopulateCommandList");
+    // MoveToNextFrame has waited for this back buffer's previous frame, so
+    // its allocator, constant buffer slice and timestamps are free again
+    FrameContext& frame = g_frames[g_frameIndex];
+    ThrowIfFailed(frame.allocator->Reset());
+    ThrowIfFailed(g_commandList->Reset(frame.allocator.Get(), nullptr));
+    g_renderer.BeginFrame(g_frameIndex);
+    g_gpuProfiler.BeginFrame(g_frameIndex, g_commandList.Get());
     
     // Viewport & Scissor
     D3D12_VIEWPORT viewport{};
@@ -281,39 +772,132 @@ void SignalAndWaitForGPU() {
     float clearColor[] = { 0.0f, 0.0f, 1.0f, 1.0f };
     g_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
 
-    // Update MVP (world * view * proj)
-    using namespace DirectX;
-    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)g_width / (float)g_height, 0.1f, 100.0f);
-    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -2.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
-    // World = Rotation(Yaw) * Scale
-    XMMATRIX world = XMMatrixRotationY(g_modelYaw) * XMMatrixScaling(g_modelScale, g_modelScale, g_modelScale);
-    XMFLOAT4X4 mvp;
-    XMStoreFloat4x4(&mvp, XMMatrixTranspose(world * view * proj));
-    g_renderer.UpdateCB(mvp);
+    // Transition back to present, at the end of the last list submitted
+    D3D12_RESOURCE_BARRIER toPresent = barrier;
+    toPresent.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    toPresent.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
+    UINT recordedLists = 0;
 
-    // Record draw
-    if (g_renderer.GetIndexCount() > 0) {
-        g_renderer.RecordDraw(g_commandList.Get(), g_renderer.GetIndexCount());
-    }
+    if (g_instanceGrid > 0 && !g_instancedLot) {
+        recordedLists = RecordLotDraws(rtvHandle, viewport, scissor, toPresent);
+    } else if (g_instanceGrid > 0) {
+        // Per-instance worlds in the instance buffer, view * proj in the CB
+        BuildInstances();
+        g_renderer.UpdateViewProj(ComputeViewProj());
+        const UINT visible = static_cast<UINT>(g_visibleInstances.size());
+        const UINT first = g_renderer.PushInstances(g_visibleInstances.data(), visible);
+        if (g_renderer.GetIndexCount() > 0 && visible > 0) {
+            USU_PROFILE_GPU_ZONE(g_gpuProfiler, g_commandList.Get(), "GPU draws");
+            g_renderer.RecordDrawInstanced(g_commandList.Get(), g_renderer.GetIndexCount(), first, visible);
+        }
+    } else {
+        // Update MVP (world * view * proj)
+        g_renderer.UpdateCB(ComputeMvp());
 
-    // Transition back to present
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    barrier.Transition.pResource = g_renderTargets[g_frameIndex].Get();
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    g_commandList->ResourceBarrier(1, &barrier);
+        // Record draw
+        if (g_renderer.GetIndexCount() > 0) {
+            USU_PROFILE_GPU_ZONE(g_gpuProfiler, g_commandList.Get(), "GPU draws");
+            g_renderer.RecordDraw(g_commandList.Get(), g_renderer.GetIndexCount(), SelectModelLod());
+        }
+    }
 
+    if (recordedLists == 0) g_commandList->ResourceBarrier(1, &toPresent);
     ThrowIfFailed(g_commandList->Close());
+
+    // Clear first, then the draw lists in chunk order, then the timestamp resolve
+    g_submitLists.assign(1, g_commandList.Get());
+    g_submitLists.insert(g_submitLists.end(), g_recorder.GetLists(), g_recorder.GetLists() + recordedLists);
+    if (ID3D12CommandList* timestamps = g_gpuProfiler.EndFrame()) g_submitLists.push_back(timestamps);
+  }
+
+  // Signals the frame just submitted, then blocks until the next back
+  // buffer's previous frame has completed (or, unpipelined, the GPU is idle)
+  void MoveToNextFrame() {
+    const UINT64 submitted = ++g_fenceValue;
+    ThrowIfFailed(g_commandQueue->Signal(g_fence.Get(), submitted));
+    g_frames[g_frameIndex].fenceValue = submitted;
+    g_frameIndex = g_swapChain->GetCurrentBackBufferIndex();
+
+    const UINT64 fenceToWaitFor = g_pipelineFrames ? g_frames[g_frameIndex].fenceValue : submitted;
+    if (g_fence->GetCompletedValue() < fenceToWaitFor) {
+      USU_PROFILE_ZONE("Fence wait");
+      ThrowIfFailed(g_fence->SetEventOnCompletion(fenceToWaitFor, g_fenceEvent));
+      WaitForSingleObject(g_fenceEvent, INFINITE);
+    }
+  }
+
+  // CPU time per frame phase; a fence wait close to the frame time means the
+  // CPU is idling on the GPU instead of overlapping with it
+  static void LogFrameTimings(double recordMs, double presentMs, double waitMs, double frameMs) {
+    static double sums[4] = {};
+    static UINT frames = 0;
+    sums[0] += recordMs; sums[1] += presentMs; sums[2] += waitMs; sums[3] += frameMs;
+    if (++frames < kFrameStatsInterval) return;
+    const double n = static_cast<double>(frames);
+    char msg[224];
+    sprintf_s(msg, "[Frame] %u buffer(s), %s: %.3f ms/frame, record %.3f ms, present %.3f ms, fence wait %.3f ms (%.0f%%)\n",
+      g_frameCount, g_pipelineFrames ? "pipelined" : "serialized", sums[3] / n, sums[0] / n, sums[1] / n, sums[2] / n,
+      sums[3] > 0.0 ? 100.0 * sums[2] / sums[3] : 0.0);
+    OutputDebugStringA(msg);
+    sums[0] = sums[1] = sums[2] = sums[3] = 0.0;
+    frames = 0;
+  }
+
+  // Time to first frame (placeholders) and to fully loaded (every request
+  // published, failed or cancelled), then the startup extras that need the
+  // real assets
+  static void ReportLoadProgress() {
+    static bool firstFrame = false, fullyLoaded = false;
+    if (fullyLoaded) return;
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_startTime).count();
+    char msg[160];
+    if (!firstFrame) {
+      sprintf_s(msg, "[Assets] first frame: %.1f ms\n", ms);
+      OutputDebugStringA(msg);
+      firstFrame = true;
+    }
+    if (!g_assets.IsIdle()) return;
+    fullyLoaded = true;
+    const AssetCounts counts = g_assets.GetCounts();
+    sprintf_s(msg, "[Assets] fully loaded: %.1f ms, %u ready, %u failed, %u cancelled\n", ms, counts.ready, counts.failed,
+      counts.cancelled);
+    OutputDebugStringA(msg);
+    g_renderer.LogMemoryStats();
+    if (g_benchmarkCulling) BenchmarkCulling();
+    if (g_benchmarkJobs) BenchmarkJobSystem();
+    if (g_softwareSnapshot) RenderSoftwareSnapshot(GetExecutableDir() + L"\\snapshot.png");
   }
 
   void Render() {
+    typedef std::chrono::steady_clock Clock;
+    static Clock::time_point lastFrameEnd = Clock::now();
+    // Frame boundary: swap in finished assets. Uploads free the buffers and
+    // textures they replace, which frames in flight may still read, so the
+    // GPU drains first; once per batch of finished assets, not per frame.
+    if (g_assets.HasPublishable()) {
+      USU_PROFILE_ZONE("Publish assets");
+      WaitForGPU();
+      g_assets.Publish();
+    }
+    const auto t0 = Clock::now();
     PopulateCommandList();
-    ID3D12CommandList* ppCommandLists[] = { g_commandList.Get() };
-    g_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-    ThrowIfFailed(g_swapChain->Present(1, 0));
-    g_frameIndex = g_swapChain->GetCurrentBackBufferIndex();
+    g_commandQueue->ExecuteCommandLists(static_cast<UINT>(g_submitLists.size()), g_submitLists.data());
+    const auto t1 = Clock::now();
+    {
+      USU_PROFILE_ZONE("Present");
+      ThrowIfFailed(g_swapChain->Present(1, 0));
+    }
+    const auto t2 = Clock::now();
+    MoveToNextFrame();
+    const auto t3 = Clock::now();
+    ReportLoadProgress();
+
+    if (g_logFrameTimings) {
+      typedef std::chrono::duration<double, std::milli> Ms;
+      LogFrameTimings(Ms(t1 - t0).count(), Ms(t2 - t1).count(), Ms(t3 - t2).count(), Ms(t3 - lastFrameEnd).count());
+    }
+    lastFrameEnd = t3;
+    Profiler::EndFrame();
   }
 
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
@@ -335,6 +919,14 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             g_modelYaw += 0.1f; // rotate right (clockwise)
             if (g_modelYaw > DirectX::XM_PI) g_modelYaw -= DirectX::XM_2PI; // wrap
             return 0;
+        } else if (wParam == 'M') {
+            // Next draw recording mode for the non-instanced lot
+            g_recordMode = static_cast<RecordMode>((static_cast<int>(g_recordMode) + 1) % 3);
+            return 0;
+        } else if (wParam == 'P') {
+            // Last zones of every thread and the GPU, for chrome://tracing or Perfetto
+            Profiler::WriteChromeTrace(GetExecutableDir() + L"\\trace.json");
+            return 0;
         }
         break;
     case WM_PAINT: {
@@ -357,6 +949,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 }
 
 INT WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, INT nCmdShow) {
+    g_startTime = std::chrono::steady_clock::now();
+    Profiler::SetThreadName("Main");
+    Profiler::SetSummaryLogging(g_logProfile);
     // Register class
     WNDCLASSEXW wcex = {};
     wcex.cbSize = sizeof(WNDCLASSEX);
@@ -373,43 +968,57 @@ INT WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, INT nCmdShow) {
         CW_USEDEFAULT, CW_USEDEFAULT, rc.right - rc.left, rc.bottom - rc.top, nullptr, nullptr, hInstance, nullptr);
     ShowWindow(g_hWnd, nCmdShow);
 
+    // Start the worker pool up front rather than inside the first load
+    {
+        char msg[64];
+        sprintf_s(msg, "[Jobs] %u worker thread(s)\n", GetJobSystem().GetWorkerCount());
+        OutputDebugStringA(msg);
+    }
+
     CreateDeviceAndSwapchain();
 
     // Initialize renderer and load a simple mesh
-    if (!g_renderer.Initialize(g_device.Get())) {
+    if (!g_renderer.Initialize(g_device.Get(), g_commandQueue.Get(), g_frameCount) ||
+        !g_recorder.Initialize(g_device.Get(), g_frameCount)) {
         PostQuitMessage(1);
         return 0;
     }
+    if (!g_gpuProfiler.Initialize(g_device.Get(), g_commandQueue.Get(), g_frameCount))
+        OutputDebugStringA("[Profile] No GPU timestamps on this queue\n");
     std::wstring exeDir = L"D:\\Personal\\project\\UsU_Engine\\UsU_Engine";//GetExecutableDir();
     std::wstring shaderPath = ResolveAssetPath(exeDir, L"src\\shaders.hlsl");
     if (!g_renderer.CreatePipeline(shaderPath.c_str())) {
         PostQuitMessage(1);
         return 0;
     }
-    // Try load sample OBJ; fallback to triangle
-    std::wstring objPath = ResolveAssetPath(exeDir, L"assets\\mesh\\Porsche_911_GT2.obj");
-    if (!g_mesh.LoadOBJ(objPath)) {
-        g_mesh.SetDefaultTriangle();
-    }
-    if (!g_renderer.UploadMesh(g_mesh)) {
+    // Placeholders until the loads below are published: the default
+    // triangle and a 1x1 grey skin
+    g_mesh.SetDefaultTriangle();
+    TextureData placeholder;
+    AllocateTexture(placeholder, TextureFormat::RGBA8, 1, 1);
+    const uint8_t grey[4] = { 192, 192, 192, 255 };
+    memcpy(placeholder.bytes.data(), grey, sizeof(grey));
+    if (!g_renderer.UploadMesh(g_mesh, g_packedVertices ? VertexFormat::Packed16 : VertexFormat::Float32) ||
+        !UploadTexture(placeholder)) {
         PostQuitMessage(1);
         return 0;
     }
+    g_meshBounds = g_mesh.GetBounds();
 
-    // Load skin texture: try common extensions
-    {
-        const std::wstring base = L"assets\\mesh\\skin00";
-        const std::wstring cands[] = {
-            ResolveAssetPath(exeDir, base + L".png"),
-            //ResolveAssetPath(exeDir, base + L".jpg"),
-            //ResolveAssetPath(exeDir, base + L".jpeg"),
-            ResolveAssetPath(exeDir, base + L".BMP")
-        };
-        for (const auto& p : cands) {
-            // Exists() checks files only; skip non-existing
-            if (Exists(p)) { g_renderer.LoadTexture(p); break; }
-        }
-    }
+    // The car first, its skin after; both publish at a frame boundary
+    g_assets.Start();
+    auto meshLoad = std::make_shared<MeshLoad>();
+    meshLoad->objPath = ResolveAssetPath(exeDir, L"assets\\mesh\\Porsche_911_GT2.obj");
+    g_assets.Request("Porsche_911_GT2", AssetPriority::High,
+        [meshLoad](const std::atomic<bool>& cancelled) { return PrepareMesh(*meshLoad, cancelled); },
+        [meshLoad]() {
+            if (g_logMeshletCulling && !meshLoad->warm) LogMeshletCulling(meshLoad->mesh);
+            return PublishMesh(*meshLoad);
+        });
+    auto skin = std::make_shared<TextureData>();
+    g_assets.Request("skin00", AssetPriority::Normal,
+        [skin, exeDir](const std::atomic<bool>& cancelled) { return PrepareSkinTexture(exeDir, *skin, cancelled); },
+        [skin]() { return UploadTexture(*skin); });
 
     // Main loop
     MSG msg = {};
@@ -422,7 +1031,10 @@ INT WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, INT nCmdShow) {
         }
     }
 
+    // Drops loads still queued; one already running finishes its current step
+    g_assets.Shutdown();
     WaitForGPU();
+    g_renderer.WaitForUploads();
     CloseHandle(g_fenceEvent);
 
     return 0;
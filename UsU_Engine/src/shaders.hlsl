@@ -1,9 +1,23 @@
 cbuffer PerObjectCB : register(b0)
 {
     float4x4 gMVP;
+    float4 gPosOffset; // packed vertices: position = offset + unorm * scale
+    float4 gPosScale;
+    float4x4 gViewProj; // instanced draws
 };
 
-Texture2D gTex : register(t0);
+#define MAX_SKINS 8 // Renderer::kMaxSkins
+
+struct InstanceData
+{
+    row_major float4x4 world;
+    float4 color;
+    uint skin;
+    uint3 pad;
+};
+
+Texture2D gSkins[MAX_SKINS] : register(t0);
+StructuredBuffer<InstanceData> gInstances : register(t8); // root SRV at the batch's first instance
 SamplerState gSamp : register(s0);
 
 struct VSIn
@@ -13,6 +27,14 @@ struct VSIn
     float2 uv       : TEXCOORD;
 };
 
+// 16-byte PackedVertex: R16G16B16A16_UNORM / R16G16_SNORM / R16G16_FLOAT
+struct VSInPacked
+{
+    float4 position : POSITION;
+    float2 normal   : NORMAL;
+    float2 uv       : TEXCOORD;
+};
+
 struct VSOut
 {
     float4 position : SV_Position;
@@ -20,6 +42,29 @@ struct VSOut
     float2 uv       : TEXCOORD;
 };
 
+struct VSOutInstanced
+{
+    float4 position : SV_Position;
+    float3 normal   : NORMAL;
+    float2 uv       : TEXCOORD;
+    float4 color    : COLOR;
+    nointerpolation uint skin : SKIN;
+};
+
+VSOutInstanced InstanceTransform(float3 position, float3 normal, float2 uv, uint instanceId)
+{
+    // SV_InstanceID starts at 0 for every draw; the root SRV is already
+    // offset to the batch
+    InstanceData inst = gInstances[instanceId];
+    VSOutInstanced o;
+    o.position = mul(mul(float4(position, 1.0f), inst.world), gViewProj);
+    o.normal = normalize(mul(normal, (float3x3)inst.world));
+    o.uv = uv;
+    o.color = inst.color;
+    o.skin = min(inst.skin, MAX_SKINS - 1);
+    return o;
+}
+
 VSOut VSMain(VSIn input)
 {
     VSOut o;
@@ -29,9 +74,44 @@ VSOut VSMain(VSIn input)
     return o;
 }
 
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+VSOut VSMainPacked(VSInPacked input)
+{
+    VSOut o;
+    float3 position = gPosOffset.xyz + input.position.xyz * gPosScale.xyz;
+    o.position = mul(float4(position, 1.0f), gMVP);
+    o.normal = OctDecode(input.normal);
+    o.uv = input.uv;
+    return o;
+}
+
+VSOutInstanced VSMainInstanced(VSIn input, uint instanceId : SV_InstanceID)
+{
+    return InstanceTransform(input.position, input.normal, input.uv, instanceId);
+}
+
+VSOutInstanced VSMainInstancedPacked(VSInPacked input, uint instanceId : SV_InstanceID)
+{
+    float3 position = gPosOffset.xyz + input.position.xyz * gPosScale.xyz;
+    return InstanceTransform(position, OctDecode(input.normal), input.uv, instanceId);
+}
+
 float4 PSMain(VSOut input) : SV_Target
 {
     // Sample texture with provided UVs
-    float4 color = gTex.Sample(gSamp, input.uv);
+    float4 color = gSkins[0].Sample(gSamp, input.uv);
     return color;
 }
+
+float4 PSMainInstanced(VSOutInstanced input) : SV_Target
+{
+    // The skin varies per instance, so within a wave too
+    return gSkins[NonUniformResourceIndex(input.skin)].Sample(gSamp, input.uv) * input.color;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdio>
+
+// Minimal assertions for the test executables: a failed check is reported
+// and counted, and main returns TestResult() so ctest sees the failure.
+inline int& TestFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define USU_CHECK(cond)                                                             \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++TestFailures();                                                       \
+        }                                                                           \
+    } while (0)
+
+inline int TestResult(const char* name)
+{
+    if (TestFailures()) fprintf(stderr, "%s: %d check(s) failed\n", name, TestFailures());
+    else fprintf(stderr, "%s: passed\n", name);
+    return TestFailures() ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+#include "Check.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <memory>
+
+namespace {
+
+// Every index of a large grain-1 ParallelFor must run exactly once. Long
+// runs of LIFO push/pop on the owner's deque while thieves take its oldest
+// jobs are what a reused job slot gets wrong, so small counts are not enough.
+void TestParallelForCoverage(uint32_t workers, uint32_t count, int repetitions)
+{
+    JobSystem jobs;
+    jobs.Initialize(workers);
+    std::unique_ptr<std::atomic<uint8_t>[]> runs(new std::atomic<uint8_t>[count]);
+    for (int rep = 0; rep < repetitions; ++rep) {
+        for (uint32_t i = 0; i < count; ++i) runs[i].store(0, std::memory_order_relaxed);
+        jobs.ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) runs[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        uint32_t missing = 0, repeated = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint8_t n = runs[i].load(std::memory_order_relaxed);
+            missing += n == 0;
+            repeated += n > 1;
+        }
+        if (missing || repeated) fprintf(stderr, "  %u worker(s), rep %d: %u missing, %u repeated\n", workers, rep, missing, repeated);
+        USU_CHECK(missing == 0);
+        USU_CHECK(repeated == 0);
+    }
+}
+
+struct Tree
+{
+    JobSystem* jobs;
+    JobCounter* counter;
+    std::atomic<uint32_t>* leaves;
+    uint32_t depth;
+};
+
+// Each job spawns two children under the same counter until depth runs out
+void Spawn(void* data)
+{
+    Tree* node = static_cast<Tree*>(data);
+    if (node->depth == 0) {
+        node->leaves->fetch_add(1, std::memory_order_relaxed);
+        delete node;
+        return;
+    }
+    for (int c = 0; c < 2; ++c) node->jobs->Run(&Spawn, new Tree{ node->jobs, node->counter, node->leaves, node->depth - 1 }, *node->counter);
+    delete node;
+}
+
+void TestNestedRun(uint32_t workers)
+{
+    JobSystem jobs;
+    jobs.Initialize(workers);
+    for (int rep = 0; rep < 10; ++rep) {
+        JobCounter counter;
+        std::atomic<uint32_t> leaves{ 0 };
+        jobs.Run(&Spawn, new Tree{ &jobs, &counter, &leaves, 14 }, counter);
+        jobs.Wait(counter);
+        USU_CHECK(counter.IsDone());
+        USU_CHECK(leaves.load() == 1u << 14);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestParallelForCoverage(0, 1000, 1);
+    TestParallelForCoverage(1, 200000, 5);
+    TestParallelForCoverage(3, 200000, 20);
+    TestParallelForCoverage(7, 200000, 10);
+    TestNestedRun(3);
+    return TestResult("JobSystemTest");
+}
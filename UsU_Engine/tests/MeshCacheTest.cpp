@@ -0,0 +1,120 @@
+#include "Check.h"
+#include "MeshCache.h"
+#include "MeshFixtures.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+bool WriteText(const std::filesystem::path& path, const std::string& text)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+    return static_cast<bool>(file);
+}
+
+bool ReadHeader(const std::filesystem::path& path, MeshCacheHeader& header)
+{
+    std::ifstream file(path, std::ios::binary);
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    return static_cast<bool>(file);
+}
+
+uint64_t WriteTimeOf(const std::filesystem::path& path)
+{
+    return static_cast<uint64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+// A touched but unchanged source is hashed once, then the cache carries its
+// new write time; a changed source of the same size is rejected
+void TestStaleCheck()
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path objPath = dir / "usu_meshcache_test.obj";
+    const std::string obj = MakeSphereObj(8, 16);
+    USU_CHECK(WriteText(objPath, obj));
+    const std::wstring source = objPath.wstring();
+    const std::wstring cachePath = MeshCache::PathFor(source);
+
+    Mesh mesh;
+    USU_CHECK(mesh.LoadOBJ(source));
+    USU_CHECK(MeshCache::Write(cachePath, source, mesh));
+    MeshCache cache;
+    USU_CHECK(cache.Open(cachePath, source));
+    USU_CHECK(cache.GetIndexCount() == mesh.GetIndices().size());
+    cache.Close();
+
+    // Touch: same contents, later write time
+    std::filesystem::last_write_time(objPath, std::filesystem::last_write_time(objPath) + std::chrono::seconds(10));
+    MeshCacheHeader header;
+    USU_CHECK(ReadHeader(cachePath, header) && header.sourceWriteTime != WriteTimeOf(objPath));
+    USU_CHECK(cache.Open(cachePath, source));
+    USU_CHECK(cache.GetVertexCount() == mesh.GetVertices().size() && cache.GetIndexCount() == mesh.GetIndices().size());
+    cache.Close();
+    USU_CHECK(ReadHeader(cachePath, header) && header.sourceWriteTime == WriteTimeOf(objPath));
+    USU_CHECK(cache.Open(cachePath, source));
+    cache.Close();
+
+    // Same size, different contents: the hash no longer matches
+    std::string edited = obj;
+    const size_t digit = edited.find_first_of("123456789");
+    edited[digit] = edited[digit] == '9' ? '8' : static_cast<char>(edited[digit] + 1);
+    USU_CHECK(WriteText(objPath, edited));
+    USU_CHECK(!cache.Open(cachePath, source));
+
+    std::error_code ec;
+    std::filesystem::remove(objPath, ec);
+    std::filesystem::remove(std::filesystem::path(cachePath), ec);
+}
+
+// A submesh range past the LOD 0 indices or not made of whole triangles
+// rejects the cache (the OBJ is loaded instead)
+void TestBadSubmeshes()
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path objPath = dir / "usu_meshcache_submesh_test.obj";
+    USU_CHECK(WriteText(objPath, MakeSphereObj(8, 16)));
+    const std::wstring source = objPath.wstring();
+    const std::wstring cachePath = MeshCache::PathFor(source);
+
+    Mesh mesh;
+    USU_CHECK(mesh.LoadOBJ(source));
+    USU_CHECK(!mesh.GetSubmeshes().empty());
+    const uint32_t indexCount = static_cast<uint32_t>(mesh.GetIndices().size());
+    const MeshCacheSubmesh bad[] = {
+        { 0, indexCount + 3, {} },
+        { indexCount - 3, 6, {} },
+        { 0xFFFFFFFFu, 3, {} },
+        { 0, 4, {} },
+    };
+    for (const MeshCacheSubmesh& submesh : bad) {
+        USU_CHECK(MeshCache::Write(cachePath, source, mesh));
+        MeshCache cache;
+        USU_CHECK(cache.Open(cachePath, source));
+        cache.Close();
+
+        MeshCacheHeader header;
+        USU_CHECK(ReadHeader(cachePath, header));
+        {
+            std::fstream file(std::filesystem::path(cachePath), std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(header.submeshOffset));
+            file.write(reinterpret_cast<const char*>(&submesh), sizeof(submesh));
+        }
+        USU_CHECK(!cache.Open(cachePath, source));
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(objPath, ec);
+    std::filesystem::remove(std::filesystem::path(cachePath), ec);
+}
+
+} // namespace
+
+int main()
+{
+    TestStaleCheck();
+    TestBadSubmeshes();
+    return TestResult("MeshCacheTest");
+}
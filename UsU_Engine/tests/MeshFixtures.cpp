@@ -0,0 +1,83 @@
+#include "MeshFixtures.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+void AppendVertex(std::string& out, float x, float y, float z, float u, float v)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", x, y, z, u, v);
+    out += line;
+}
+
+void AppendTriangle(std::string& out, uint32_t a, uint32_t b, uint32_t c)
+{
+    char line[96];
+    snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u\n", a + 1, a + 1, b + 1, b + 1, c + 1, c + 1);
+    out += line;
+}
+
+} // namespace
+
+std::string MakeSphereObj(uint32_t rings, uint32_t segments, float bumps)
+{
+    const float pi = 3.14159265f;
+    std::string out = "o sphere\n";
+    // Poles are duplicated per segment, like the uv seam
+    for (uint32_t r = 0; r <= rings; ++r) {
+        const float theta = pi * r / rings;
+        for (uint32_t s = 0; s <= segments; ++s) {
+            const float phi = 2.0f * pi * s / segments;
+            const float radius = 1.0f + bumps * std::sin(5.0f * theta) * std::cos(7.0f * phi);
+            AppendVertex(out, radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+                radius * std::sin(theta) * std::sin(phi), static_cast<float>(s) / segments, static_cast<float>(r) / rings);
+        }
+    }
+    // Seen from outside, +phi runs clockwise around +y, so (top, bottom,
+    // next bottom) is counter-clockwise
+    for (uint32_t r = 0; r < rings; ++r) {
+        for (uint32_t s = 0; s < segments; ++s) {
+            const uint32_t a = r * (segments + 1) + s, b = a + segments + 1;
+            if (r > 0) AppendTriangle(out, a, a + 1, b);
+            if (r + 1 < rings) AppendTriangle(out, a + 1, b + 1, b);
+        }
+    }
+    return out;
+}
+
+std::string MakeGridObj(uint32_t size)
+{
+    std::string out = "o grid\n";
+    for (uint32_t z = 0; z <= size; ++z) {
+        for (uint32_t x = 0; x <= size; ++x) {
+            AppendVertex(out, -1.0f + 2.0f * x / size, 0.0f, -1.0f + 2.0f * z / size, static_cast<float>(x) / size,
+                static_cast<float>(z) / size);
+        }
+    }
+    // Counter-clockwise seen from +y
+    for (uint32_t z = 0; z < size; ++z) {
+        for (uint32_t x = 0; x < size; ++x) {
+            const uint32_t a = z * (size + 1) + x, b = a + size + 1;
+            AppendTriangle(out, a, b, b + 1);
+            AppendTriangle(out, a, b + 1, a + 1);
+        }
+    }
+    return out;
+}
+
+bool LoadTestMesh(Mesh& mesh, const std::string& obj, const char* name)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << obj;
+        if (!file) return false;
+    }
+    const bool loaded = mesh.LoadOBJ(path.wstring());
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return loaded;
+}
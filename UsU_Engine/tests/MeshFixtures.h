@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Mesh.h"
+
+// Test meshes go through the real OBJ path: they are written as OBJ text to
+// the temp directory and loaded with Mesh::LoadOBJ.
+
+// Unit sphere around the origin, faces counter-clockwise seen from outside.
+// bumps > 0 adds radial ripples so normal cones are not all tiny.
+std::string MakeSphereObj(uint32_t rings, uint32_t segments, float bumps = 0.0f);
+
+// size x size quads in the xz plane, y up, uv 0..1 over the sheet
+std::string MakeGridObj(uint32_t size);
+
+// Writes obj to the temp directory as name and loads it
+bool LoadTestMesh(Mesh& mesh, const std::string& obj, const char* name);
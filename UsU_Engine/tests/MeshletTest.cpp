@@ -0,0 +1,168 @@
+#include "Check.h"
+#include "MeshFixtures.h"
+#include "Meshlet.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+XMFLOAT3 Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+float Dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+XMFLOAT3 Cross(const XMFLOAT3& a, const XMFLOAT3& b)
+{
+    return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+const XMFLOAT3& Position(const Mesh& mesh, uint32_t v) { return mesh.GetVertices()[v].position; }
+
+// Every triangle lands in exactly one meshlet, corners in their original order
+void CheckStructure(const Mesh& mesh, const MeshletData& data, size_t maxVertices, size_t maxTriangles)
+{
+    USU_CHECK(data.meshlets.size() == data.bounds.size());
+    std::vector<std::array<uint32_t, 3>> expected, clustered;
+    const auto& indices = mesh.GetIndices();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) expected.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+
+    for (const Meshlet& m : data.meshlets) {
+        USU_CHECK(m.vertexCount > 0 && m.vertexCount <= maxVertices);
+        USU_CHECK(m.triangleCount > 0 && m.triangleCount <= maxTriangles);
+        USU_CHECK(m.vertexOffset + m.vertexCount <= data.vertices.size());
+        USU_CHECK(m.triangleOffset + m.triangleCount * 3 <= data.triangles.size());
+        const uint8_t* tris = data.triangles.data() + m.triangleOffset;
+        for (uint32_t t = 0; t < m.triangleCount; ++t) {
+            std::array<uint32_t, 3> tri;
+            for (int k = 0; k < 3; ++k) {
+                const uint8_t local = tris[t * 3 + k];
+                USU_CHECK(local < m.vertexCount);
+                tri[k] = data.vertices[m.vertexOffset + local];
+            }
+            clustered.push_back(tri);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(clustered.begin(), clustered.end());
+    USU_CHECK(expected == clustered);
+}
+
+void CheckSpheres(const Mesh& mesh, const MeshletData& data)
+{
+    for (size_t i = 0; i < data.meshlets.size(); ++i) {
+        const Meshlet& m = data.meshlets[i];
+        const MeshletBounds& b = data.bounds[i];
+        for (uint32_t v = 0; v < m.vertexCount; ++v) {
+            const XMFLOAT3 d = Sub(Position(mesh, data.vertices[m.vertexOffset + v]), b.center);
+            USU_CHECK(std::sqrt(Dot(d, d)) <= b.radius * 1.0001f + 1e-6f);
+        }
+    }
+}
+
+// Strictly inside the D3D clip volume, for v * mvp (row vectors)
+bool InsideClip(const XMFLOAT3& p, const XMFLOAT4X4& mvp)
+{
+    float clip[4];
+    for (int j = 0; j < 4; ++j) clip[j] = p.x * mvp.m[0][j] + p.y * mvp.m[1][j] + p.z * mvp.m[2][j] + mvp.m[3][j];
+    const float w = clip[3];
+    return w > 0.0f && std::fabs(clip[0]) < w && std::fabs(clip[1]) < w && clip[2] > 0.0f && clip[2] < w;
+}
+
+// Random cameras around the mesh: no culled meshlet may hold a triangle that
+// faces the eye and has a corner inside the frustum
+MeshletCullStats CheckCulling(const Mesh& mesh, const MeshletData& data, uint32_t seed, int views)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    MeshletCullStats total;
+    std::vector<uint32_t> visible;
+    for (int view = 0; view < views; ++view) {
+        XMFLOAT3 dir(unit(rng), unit(rng), unit(rng));
+        const float len = std::sqrt(Dot(dir, dir));
+        if (len < 1e-3f) continue;
+        const float distance = 1.5f + 4.0f * (unit(rng) * 0.5f + 0.5f);
+        const XMFLOAT3 eye(dir.x / len * distance, dir.y / len * distance, dir.z / len * distance);
+        // Look roughly at the mesh, sometimes well off to the side
+        const float spread = view % 4 == 0 ? 1.5f : 0.3f;
+        const XMFLOAT3 target(unit(rng) * spread, unit(rng) * spread, unit(rng) * spread);
+        const XMFLOAT3 forward = Sub(target, eye);
+        const XMFLOAT3 up = std::fabs(forward.y) > 0.99f * std::sqrt(Dot(forward, forward)) ? XMFLOAT3(1, 0, 0) : XMFLOAT3(0, 1, 0);
+        const XMMATRIX viewMatrix = XMMatrixLookToLH(XMVectorSet(eye.x, eye.y, eye.z, 1.0f),
+            XMVectorSet(forward.x, forward.y, forward.z, 0.0f), XMVectorSet(up.x, up.y, up.z, 0.0f));
+        const float fov = view % 3 == 0 ? XM_PIDIV4 * 0.5f : XM_PIDIV4;
+        XMFLOAT4X4 mvp;
+        XMStoreFloat4x4(&mvp, viewMatrix * XMMatrixPerspectiveFovLH(fov, 16.0f / 9.0f, 0.1f, 100.0f));
+        const MeshletCullView cullView = MakeMeshletCullView(mvp, eye);
+
+        const MeshletCullStats stats = CullMeshlets(data, cullView, &visible);
+        USU_CHECK(stats.meshlets == data.meshlets.size());
+        USU_CHECK(stats.visibleMeshlets + stats.frustumCulled + stats.backfaceCulled == stats.meshlets);
+        USU_CHECK(stats.visibleMeshlets == visible.size());
+        USU_CHECK(stats.triangles == mesh.GetIndices().size() / 3);
+        total.meshlets += stats.meshlets;
+        total.visibleMeshlets += stats.visibleMeshlets;
+        total.frustumCulled += stats.frustumCulled;
+        total.backfaceCulled += stats.backfaceCulled;
+        total.triangles += stats.triangles;
+        total.visibleTriangles += stats.visibleTriangles;
+
+        size_t next = 0, visibleTriangles = 0;
+        for (size_t i = 0; i < data.meshlets.size(); ++i) {
+            const Meshlet& m = data.meshlets[i];
+            if (next < visible.size() && visible[next] == i) {
+                ++next;
+                visibleTriangles += m.triangleCount;
+                continue;
+            }
+            const uint8_t* tris = data.triangles.data() + m.triangleOffset;
+            for (uint32_t t = 0; t < m.triangleCount; ++t) {
+                const XMFLOAT3& a = Position(mesh, data.vertices[m.vertexOffset + tris[t * 3 + 0]]);
+                const XMFLOAT3& b = Position(mesh, data.vertices[m.vertexOffset + tris[t * 3 + 1]]);
+                const XMFLOAT3& c = Position(mesh, data.vertices[m.vertexOffset + tris[t * 3 + 2]]);
+                const bool front = Dot(Cross(Sub(b, a), Sub(c, a)), Sub(eye, a)) > 0.0f;
+                const bool inside = InsideClip(a, mvp) || InsideClip(b, mvp) || InsideClip(c, mvp);
+                if (front && inside) fprintf(stderr, "  view %d: meshlet %zu culled with a visible triangle\n", view, i);
+                USU_CHECK(!(front && inside));
+            }
+        }
+        USU_CHECK(next == visible.size());
+        USU_CHECK(stats.visibleTriangles == visibleTriangles);
+    }
+    return total;
+}
+
+void TestMesh(const char* name, const std::string& obj, size_t maxVertices, size_t maxTriangles, bool expectBackface)
+{
+    Mesh mesh;
+    USU_CHECK(LoadTestMesh(mesh, obj, "usu_meshlet_test.obj"));
+    mesh.Optimize();
+    MeshletData data;
+    BuildMeshlets(data, mesh, maxVertices, maxTriangles);
+    USU_CHECK(!data.meshlets.empty());
+    CheckStructure(mesh, data, maxVertices, maxTriangles);
+    CheckSpheres(mesh, data);
+    const MeshletCullStats stats = CheckCulling(mesh, data, 42, 200);
+    USU_CHECK(stats.frustumCulled > 0);
+    if (expectBackface) USU_CHECK(stats.backfaceCulled > 0);
+    fprintf(stderr, "%s (%zu/%zu): %zu meshlets, %zu frustum and %zu backface culls over %zu views, %.1f%% of triangles culled\n",
+        name, maxVertices, maxTriangles, data.meshlets.size(), stats.frustumCulled, stats.backfaceCulled, stats.meshlets / data.meshlets.size(),
+        stats.CulledTrianglePercent());
+}
+
+} // namespace
+
+int main()
+{
+    const std::string sphere = MakeSphereObj(48, 96);
+    const std::string bumpy = MakeSphereObj(64, 128, 0.15f);
+    // The plane's cones are degenerate-narrow: every cluster faces +y
+    const std::string grid = MakeGridObj(64);
+    TestMesh("sphere", sphere, kMeshletMaxVertices, kMeshletMaxTriangles, true);
+    TestMesh("sphere", sphere, 32, 32, true);
+    TestMesh("bumpy sphere", bumpy, kMeshletMaxVertices, kMeshletMaxTriangles, true);
+    TestMesh("grid", grid, kMeshletMaxVertices, kMeshletMaxTriangles, true);
+    TestMesh("grid", grid, 255, 256, true);
+    return TestResult("MeshletTest");
+}
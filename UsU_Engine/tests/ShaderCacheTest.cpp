@@ -0,0 +1,199 @@
+#include "Check.h"
+#include "ShaderCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool WriteText(const fs::path& path, const std::string& text)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+    return static_cast<bool>(file);
+}
+
+// Stands in for D3DCompile: the "bytecode" names what was compiled, and every
+// call is counted so a test can tell a cache hit from a compile
+struct StubCompiler
+{
+    int calls = 0;
+    bool fail = false;
+
+    ShaderCompileFunction Function()
+    {
+        return [this](const std::wstring& sourcePath, const char* entry, const char* profile, uint32_t flags,
+                      std::vector<uint8_t>& bytecode) {
+            ++calls;
+            if (fail) return false;
+            const std::string text = fs::path(sourcePath).filename().string() + ":" + entry + ":" + profile + ":" +
+                                     std::to_string(flags);
+            bytecode.assign(text.begin(), text.end());
+            return true;
+        };
+    }
+};
+
+struct TestDir
+{
+    fs::path path = fs::temp_directory_path() / "usu_shadercache_test";
+    TestDir() { Clear(); fs::create_directories(path); }
+    ~TestDir() { Clear(); }
+    void Clear() { std::error_code ec; fs::remove_all(path, ec); }
+};
+
+std::string ToString(const std::vector<uint8_t>& bytes) { return std::string(bytes.begin(), bytes.end()); }
+
+// Second Get of the same key is served from disk, also by a new cache on
+// the same directory (the next run)
+void TestHitAndMiss()
+{
+    TestDir dir;
+    const std::wstring source = (dir.path / "shader.hlsl").wstring();
+    USU_CHECK(WriteText(source, "float4 VSMain() : SV_Position { return 0; }\n"));
+
+    StubCompiler compiler;
+    ShaderCache cache;
+    USU_CHECK(cache.Initialize((dir.path / "cache").wstring(), compiler.Function(), 1));
+    std::vector<uint8_t> bytecode;
+    USU_CHECK(cache.Get(source, "VSMain", "vs_5_0", 0, bytecode));
+    USU_CHECK(ToString(bytecode) == "shader.hlsl:VSMain:vs_5_0:0");
+    USU_CHECK(cache.GetCompiles() == 1 && cache.GetHits() == 0);
+
+    bytecode.clear();
+    USU_CHECK(cache.Get(source, "VSMain", "vs_5_0", 0, bytecode));
+    USU_CHECK(ToString(bytecode) == "shader.hlsl:VSMain:vs_5_0:0");
+    USU_CHECK(cache.GetCompiles() == 1 && cache.GetHits() == 1 && compiler.calls == 1);
+
+    ShaderCache nextRun;
+    USU_CHECK(nextRun.Initialize((dir.path / "cache").wstring(), compiler.Function(), 1));
+    USU_CHECK(nextRun.Get(source, "VSMain", "vs_5_0", 0, bytecode));
+    USU_CHECK(nextRun.GetHits() == 1 && compiler.calls == 1);
+
+    // A failed compile is reported and leaves nothing behind to hit later
+    compiler.fail = true;
+    USU_CHECK(!cache.Get(source, "PSMain", "ps_5_0", 0, bytecode));
+    compiler.fail = false;
+    USU_CHECK(cache.Get(source, "PSMain", "ps_5_0", 0, bytecode));
+    USU_CHECK(cache.GetCompiles() == 2);
+
+    // No source, no key
+    uint64_t key = 0;
+    USU_CHECK(!cache.ComputeKey((dir.path / "absent.hlsl").wstring(), "VSMain", "vs_5_0", 0, key));
+}
+
+// Everything the compiler sees is part of the key: nested includes, entry,
+// profile, flags and the compiler version
+void TestInvalidation()
+{
+    TestDir dir;
+    const std::wstring source = (dir.path / "shader.hlsl").wstring();
+    USU_CHECK(WriteText(source, "#include \"common.hlsli\"\nfloat4 VSMain() : SV_Position { return 0; }\n"));
+    USU_CHECK(WriteText(dir.path / "common.hlsli", "  #  include <lighting.hlsli>\n"));
+    USU_CHECK(WriteText(dir.path / "lighting.hlsli", "static const float kAmbient = 0.1;\n"));
+
+    StubCompiler compiler;
+    ShaderCache cache;
+    USU_CHECK(cache.Initialize(dir.path.wstring(), compiler.Function(), 1));
+    uint64_t base = 0, key = 0;
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, base));
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, key) && key == base);
+    USU_CHECK(cache.ComputeKey(source, "PSMain", "vs_5_0", 0, key) && key != base);
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_1", 0, key) && key != base);
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 1, key) && key != base);
+
+    ShaderCache newCompiler;
+    USU_CHECK(newCompiler.Initialize(dir.path.wstring(), compiler.Function(), 2));
+    USU_CHECK(newCompiler.ComputeKey(source, "VSMain", "vs_5_0", 0, key) && key != base);
+
+    std::vector<uint8_t> bytecode;
+    USU_CHECK(cache.Get(source, "VSMain", "vs_5_0", 0, bytecode));
+    USU_CHECK(newCompiler.Get(source, "VSMain", "vs_5_0", 0, bytecode));
+    USU_CHECK(compiler.calls == 2);
+
+    // An edit two includes deep recompiles; the old key's file stays
+    USU_CHECK(WriteText(dir.path / "lighting.hlsli", "static const float kAmbient = 0.2;\n"));
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, key) && key != base);
+    USU_CHECK(cache.Get(source, "VSMain", "vs_5_0", 0, bytecode));
+    USU_CHECK(cache.GetCompiles() == 2 && fs::exists(cache.PathFor(base)));
+}
+
+// Mutual includes are hashed once each; a missing include still gives a key
+// (the compiler reports it), which changes once the file appears
+void TestIncludeGraph()
+{
+    TestDir dir;
+    const std::wstring source = (dir.path / "shader.hlsl").wstring();
+    USU_CHECK(WriteText(source, "#include \"a.hlsli\"\n"));
+    USU_CHECK(WriteText(dir.path / "a.hlsli", "#pragma once\n#include \"b.hlsli\"\n"));
+    USU_CHECK(WriteText(dir.path / "b.hlsli", "#pragma once\n#include \"a.hlsli\"\n#include \"../usu_missing.hlsli\"\n"));
+
+    StubCompiler compiler;
+    ShaderCache cache;
+    USU_CHECK(cache.Initialize(dir.path.wstring(), compiler.Function(), 1));
+    uint64_t missing = 0, key = 0;
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, missing));
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, key) && key == missing);
+
+    const fs::path appeared = dir.path.parent_path() / "usu_missing.hlsli";
+    USU_CHECK(WriteText(appeared, "\n"));
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, key) && key != missing);
+    std::error_code ec;
+    fs::remove(appeared, ec);
+    USU_CHECK(cache.ComputeKey(source, "VSMain", "vs_5_0", 0, key) && key == missing);
+}
+
+// A damaged file is a miss that compiles and replaces it
+void TestCorruptFile()
+{
+    TestDir dir;
+    const std::wstring source = (dir.path / "shader.hlsl").wstring();
+    USU_CHECK(WriteText(source, "float4 PSMain() : SV_Target { return 1; }\n"));
+
+    StubCompiler compiler;
+    ShaderCache cache;
+    USU_CHECK(cache.Initialize(dir.path.wstring(), compiler.Function(), 1));
+    std::vector<uint8_t> bytecode;
+    USU_CHECK(cache.Get(source, "PSMain", "ps_5_0", 0, bytecode));
+    uint64_t key = 0;
+    USU_CHECK(cache.ComputeKey(source, "PSMain", "ps_5_0", 0, key));
+    const fs::path path = cache.PathFor(key);
+    USU_CHECK(ShaderCache::Read(path.wstring(), key, bytecode));
+    USU_CHECK(!ShaderCache::Read(path.wstring(), key + 1, bytecode));
+
+    // Flipped bytecode byte: the stored hash no longer matches
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(ShaderCacheHeader));
+        file.put('#');
+    }
+    USU_CHECK(!ShaderCache::Read(path.wstring(), key, bytecode));
+    USU_CHECK(cache.Get(source, "PSMain", "ps_5_0", 0, bytecode));
+    USU_CHECK(ToString(bytecode) == "shader.hlsl:PSMain:ps_5_0:0");
+    USU_CHECK(cache.GetCompiles() == 2 && ShaderCache::Read(path.wstring(), key, bytecode));
+
+    // Torn write: the size no longer matches the header
+    fs::resize_file(path, fs::file_size(path) - 1);
+    USU_CHECK(!ShaderCache::Read(path.wstring(), key, bytecode));
+    fs::resize_file(path, sizeof(ShaderCacheHeader) / 2);
+    USU_CHECK(!ShaderCache::Read(path.wstring(), key, bytecode));
+    USU_CHECK(cache.Get(source, "PSMain", "ps_5_0", 0, bytecode));
+    USU_CHECK(cache.GetCompiles() == 3 && compiler.calls == 3);
+    USU_CHECK(cache.Get(source, "PSMain", "ps_5_0", 0, bytecode));
+    USU_CHECK(cache.GetHits() == 1);
+}
+
+} // namespace
+
+int main()
+{
+    TestHitAndMiss();
+    TestInvalidation();
+    TestIncludeGraph();
+    TestCorruptFile();
+    return TestResult("ShaderCacheTest");
+}
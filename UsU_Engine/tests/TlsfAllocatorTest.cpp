@@ -0,0 +1,171 @@
+#include "Check.h"
+#include "TlsfAllocator.h"
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+// What the allocator should hold: offset -> size in bytes (SizeOf's)
+typedef std::map<uint64_t, uint64_t> Shadow;
+
+// A new range must lie inside the allocator and clear of its neighbours
+bool FitsShadow(const Shadow& shadow, const TlsfAllocator& tlsf, uint64_t offset, uint64_t size)
+{
+    if (size == 0 || offset + size > tlsf.Capacity()) return false;
+    const auto next = shadow.lower_bound(offset);
+    if (next != shadow.end() && next->first < offset + size) return false;
+    if (next != shadow.begin()) {
+        const auto prev = std::prev(next);
+        if (prev->first + prev->second > offset) return false;
+    }
+    return true;
+}
+
+bool MatchesShadow(const Shadow& shadow, const TlsfAllocator& tlsf)
+{
+    uint64_t used = 0;
+    for (const auto& kv : shadow) {
+        if (tlsf.SizeOf(kv.first) != kv.second) return false;
+        used += kv.second;
+    }
+    const TlsfAllocator::Stats stats = tlsf.GetStats();
+    return stats.allocationCount == shadow.size() && stats.usedBytes == used &&
+           stats.usedBytes + stats.freeBytes == tlsf.Capacity() && stats.largestFreeBlock <= stats.freeBytes;
+}
+
+uint64_t RandomKey(const Shadow& shadow, std::mt19937& rng)
+{
+    auto it = shadow.begin();
+    std::advance(it, std::uniform_int_distribution<size_t>(0, shadow.size() - 1)(rng));
+    return it->first;
+}
+
+void TestBasics()
+{
+    TlsfAllocator tlsf(1024);
+    USU_CHECK(tlsf.Validate());
+    USU_CHECK(tlsf.Allocate(0) == TlsfAllocator::kInvalidOffset);
+    USU_CHECK(tlsf.Allocate(8, 3) == TlsfAllocator::kInvalidOffset); // not a power of two
+    USU_CHECK(tlsf.Allocate(2048) == TlsfAllocator::kInvalidOffset);
+    const uint64_t all = tlsf.Allocate(1024);
+    USU_CHECK(all == 0 && tlsf.Validate());
+    USU_CHECK(tlsf.Allocate(1) == TlsfAllocator::kInvalidOffset);
+    USU_CHECK(!tlsf.Free(1) && tlsf.Free(all) && !tlsf.Free(all));
+    USU_CHECK(tlsf.Empty() && tlsf.Validate());
+    USU_CHECK(tlsf.GetStats().largestFreeBlock == 1024);
+}
+
+// Random allocate/free/defragment with Validate() after every operation;
+// a shadow map checks ranges, sizes and the stats alongside
+void Fuzz(uint32_t seed, uint64_t capacity, uint64_t granularity, int operations)
+{
+    std::mt19937 rng(seed);
+    TlsfAllocator tlsf(capacity, granularity);
+    Shadow shadow;
+    std::vector<TlsfAllocator::Move> moves;
+    int failures = 0;
+    for (int op = 0; op < operations && failures == 0; ++op) {
+        const uint32_t kind = rng() % 100;
+        if (kind < 50 || shadow.empty()) {
+            // Mostly small, sometimes up to a quarter of the range
+            const uint64_t maxSize = rng() % 8 == 0 ? capacity / 4 : capacity / 64;
+            const uint64_t size = 1 + rng() % maxSize;
+            const uint64_t alignment = uint64_t(1) << (rng() % 10);
+            const uint64_t offset = tlsf.Allocate(size, alignment);
+            if (offset != TlsfAllocator::kInvalidOffset) {
+                const uint64_t actual = tlsf.SizeOf(offset);
+                if (actual < size || offset % alignment != 0 || offset % granularity != 0 ||
+                    !FitsShadow(shadow, tlsf, offset, actual)) {
+                    ++failures;
+                    USU_CHECK(!"allocation overlaps, is misaligned or too small");
+                }
+                shadow[offset] = actual;
+            }
+        } else if (kind < 90) {
+            const uint64_t offset = RandomKey(shadow, rng);
+            if (!tlsf.Free(offset) || tlsf.SizeOf(offset) != 0) {
+                ++failures;
+                USU_CHECK(!"free of a live allocation failed");
+            }
+            shadow.erase(offset);
+        } else if (kind < 95) {
+            // Not an allocation: the middle of one, or past the end
+            const uint64_t offset = RandomKey(shadow, rng);
+            const uint64_t bogus = shadow[offset] > granularity ? offset + granularity : capacity + granularity;
+            if (tlsf.Free(bogus)) {
+                ++failures;
+                USU_CHECK(!"free of a non-allocation succeeded");
+            }
+        } else {
+            // Plan a few moves, then "copy" and free the sources as GpuAllocator's callers do
+            moves.clear();
+            const size_t added = tlsf.PlanDefragment(1 + rng() % 8, moves);
+            if (added != moves.size()) ++failures;
+            USU_CHECK(tlsf.Validate());
+            for (const TlsfAllocator::Move& m : moves) {
+                const auto src = shadow.find(m.from);
+                if (src == shadow.end() || src->second != m.size || m.to >= m.from || tlsf.SizeOf(m.to) < m.size ||
+                    !FitsShadow(shadow, tlsf, m.to, tlsf.SizeOf(m.to))) {
+                    ++failures;
+                    USU_CHECK(!"defragment move is not a lower free range of the same size");
+                    break;
+                }
+                shadow[m.to] = tlsf.SizeOf(m.to);
+                if (!tlsf.Free(m.from)) ++failures;
+                shadow.erase(m.from);
+                USU_CHECK(tlsf.Validate());
+            }
+        }
+        if (!tlsf.Validate() || !MatchesShadow(shadow, tlsf)) {
+            fprintf(stderr, "seed %u, granularity %llu: invalid after operation %d\n", seed,
+                static_cast<unsigned long long>(granularity), op);
+            ++failures;
+            USU_CHECK(!"allocator invariants broken");
+        }
+    }
+
+    // Freeing everything coalesces back to one block
+    for (const auto& kv : shadow) USU_CHECK(tlsf.Free(kv.first));
+    USU_CHECK(tlsf.Empty() && tlsf.Validate());
+    const TlsfAllocator::Stats stats = tlsf.GetStats();
+    USU_CHECK(stats.freeBlockCount == 1 && stats.largestFreeBlock == tlsf.Capacity());
+}
+
+// Repeated full passes pack a fragmented allocator towards offset 0 and
+// finish with no moves left
+void TestDefragmentConverges()
+{
+    TlsfAllocator tlsf(64 * 1024, 16);
+    std::vector<uint64_t> offsets;
+    for (int i = 0; i < 256; ++i) offsets.push_back(tlsf.Allocate(256));
+    for (size_t i = 0; i < offsets.size(); i += 2) tlsf.Free(offsets[i]);
+    const uint64_t used = tlsf.GetStats().usedBytes;
+    std::vector<TlsfAllocator::Move> moves;
+    int passes = 0;
+    for (; passes < 256; ++passes) {
+        moves.clear();
+        if (tlsf.PlanDefragment(~size_t(0), moves) == 0) break;
+        for (const TlsfAllocator::Move& m : moves) tlsf.Free(m.from);
+        USU_CHECK(tlsf.Validate());
+    }
+    USU_CHECK(passes < 256);
+    const TlsfAllocator::Stats stats = tlsf.GetStats();
+    USU_CHECK(stats.usedBytes == used && stats.freeBlockCount == 1 && stats.largestFreeBlock == stats.freeBytes);
+}
+
+} // namespace
+
+int main()
+{
+    TestBasics();
+    TestDefragmentConverges();
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+        Fuzz(seed, 1 << 20, 1, 10000);
+        Fuzz(seed, 64 << 20, 256, 10000);
+        Fuzz(seed, 3000, 1, 5000); // not a power of two, tiny
+    }
+    return TestResult("TlsfAllocatorTest");
+}
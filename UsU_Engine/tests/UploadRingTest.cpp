@@ -0,0 +1,140 @@
+#include "Check.h"
+#include "UploadRing.h"
+#include <cstdint>
+#include <deque>
+#include <random>
+
+namespace {
+
+const uint64_t kMB = 1024 * 1024;
+
+// Stands in for the copy queue's fence: Signal hands out increasing values
+// and Complete advances what the "GPU" has finished
+struct FakeFence
+{
+    uint64_t signaled = 0;
+    uint64_t completed = 0;
+
+    uint64_t Signal() { return ++signaled; }
+    void Complete(uint64_t value) { completed = value; }
+};
+
+void TestAlignment()
+{
+    UploadRing ring(1024);
+    USU_CHECK(ring.Allocate(3) == 0);
+    USU_CHECK(ring.Allocate(16, 16) == 16);
+    USU_CHECK(ring.Allocate(1, 256) == 256);
+    USU_CHECK(ring.Allocate(8, 3) == UploadRing::kInvalidOffset); // not a power of two
+    USU_CHECK(ring.Allocate(0) == UploadRing::kInvalidOffset);
+    USU_CHECK(ring.Allocate(2048) == UploadRing::kInvalidOffset); // larger than the ring
+}
+
+void TestWrapAndRetire()
+{
+    FakeFence fence;
+    UploadRing ring(1000);
+    USU_CHECK(ring.Allocate(600) == 0);
+    ring.Submit(fence.Signal());
+    USU_CHECK(ring.Allocate(300) == 600);
+    ring.Submit(fence.Signal());
+
+    // 200 does not fit behind 900 and the front is still in flight
+    USU_CHECK(ring.Allocate(200) == UploadRing::kInvalidOffset);
+    USU_CHECK(ring.OldestPendingFence() == 1);
+    fence.Complete(1);
+    ring.Retire(fence.completed);
+    USU_CHECK(ring.Allocate(200) == 0); // the skipped tail wraps to the front
+    ring.Submit(fence.Signal());
+    USU_CHECK(ring.OldestPendingFence() == 2);
+
+    fence.Complete(fence.signaled);
+    ring.Retire(fence.completed);
+    USU_CHECK(ring.Empty());
+    USU_CHECK(ring.OldestPendingFence() == 0);
+}
+
+// An empty ring must take anything up to its capacity, wherever the last
+// batch left the head
+void TestEmptyRingAfterPartialUse()
+{
+    FakeFence fence;
+    UploadRing ring(8 * kMB);
+    USU_CHECK(ring.Allocate(4 * kMB) == 0);
+    ring.Submit(fence.Signal());
+    fence.Complete(fence.signaled);
+    ring.Retire(fence.completed);
+    USU_CHECK(ring.Empty());
+    USU_CHECK(ring.Allocate(5 * kMB) == 0);
+    ring.Submit(fence.Signal());
+    fence.Complete(fence.signaled);
+    ring.Retire(fence.completed);
+    USU_CHECK(ring.Allocate(8 * kMB) == 0);
+}
+
+// Random sizes with the fence lagging a few batches behind; checks that live
+// allocations never overlap and that the minimal wait always makes progress
+void TestRandomTraffic()
+{
+    struct Live
+    {
+        uint64_t fence, offset, size;
+    };
+    std::mt19937 rng(1234);
+    FakeFence fence;
+    UploadRing ring(64 * 1024);
+    std::deque<Live> live;
+    std::deque<Live> open;
+    for (int i = 0; i < 20000; ++i) {
+        const uint64_t size = 1 + rng() % (rng() % 8 == 0 ? 40000 : 2000);
+        const uint64_t alignment = 1ull << (rng() % 9);
+        uint64_t offset = ring.Allocate(size, alignment);
+        // What Renderer::AllocateUpload does: flush the open batch if it is
+        // all there is, then wait for the oldest one
+        while (offset == UploadRing::kInvalidOffset) {
+            USU_CHECK(!ring.Empty());
+            if (ring.Empty()) return;
+            if (ring.OldestPendingFence() == 0) {
+                const uint64_t value = fence.Signal();
+                ring.Submit(value);
+                for (Live& a : open) a.fence = value;
+                live.insert(live.end(), open.begin(), open.end());
+                open.clear();
+            }
+            fence.Complete(ring.OldestPendingFence());
+            ring.Retire(fence.completed);
+            while (!live.empty() && live.front().fence <= fence.completed) live.pop_front();
+            offset = ring.Allocate(size, alignment);
+        }
+        USU_CHECK(offset % alignment == 0);
+        USU_CHECK(offset + size <= ring.Capacity());
+        for (const std::deque<Live>* list : { &live, &open }) {
+            for (const Live& a : *list) USU_CHECK(offset + size <= a.offset || a.offset + a.size <= offset);
+        }
+        open.push_back(Live{ 0, offset, size });
+
+        if (rng() % 4 == 0) {
+            const uint64_t value = fence.Signal();
+            ring.Submit(value);
+            for (Live& a : open) a.fence = value;
+            live.insert(live.end(), open.begin(), open.end());
+            open.clear();
+        }
+        if (rng() % 3 == 0 && fence.completed + 2 < fence.signaled) {
+            fence.Complete(fence.completed + 1);
+            ring.Retire(fence.completed);
+            while (!live.empty() && live.front().fence <= fence.completed) live.pop_front();
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestAlignment();
+    TestWrapAndRetire();
+    TestEmptyRingAfterPartialUse();
+    TestRandomTraffic();
+    return TestResult("UploadRingTest");
+}